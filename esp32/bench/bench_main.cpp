@@ -0,0 +1,670 @@
+/**
+ * Host micro-benchmarks for the firmware hot paths (env:native).
+ *
+ * Build & run:  pio run -e native -t exec   (or .pio/build/native/program)
+ *
+ * Options:
+ *   --filter <text>      Only run checks and benchmarks whose name contains <text>
+ *   --save <file>        Write results as "<name> <ns/op>" lines
+ *   --compare <file>     Fail (exit 1) if a benchmark got slower than the
+ *                        saved baseline by more than --tolerance percent
+ *   --tolerance <pct>    Allowed slowdown for --compare (default 25)
+ *   --no-budget          Don't fail on budgets (sanitizer or debug builds)
+ *
+ * Correctness checks run first (COBS/CRC framing, field parsing, parameter
+ * ranges, timeline easing); any failed check exits 1 before timing starts.
+ *
+ * Numbers are host nanoseconds, useful for spotting regressions between
+ * commits on the same machine - not a prediction of ESP32 timings. Each
+ * benchmark also has a budget about 10x what a typical development machine
+ * measures: exceeding it (exit 1) means a gross regression, such as a lost
+ * fast path, on any host. --compare is the fine-grained check.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "hal_native.h"
+#include "config.h"
+#include "pins.h"
+#include "state.h"
+#include "uart_handler.h"
+#include "binary_protocol.h"
+#include "packet_fields.h"
+#include "servo_controller.h"
+#include "target_predictor.h"
+#include "valve_safety.h"
+#include "dispense.h"
+#include "color_utils.h"
+#include "compositor.h"
+#include "neopixel_matrix.h"
+#include "neopixel_ring.h"
+#include "led_matrix.h"
+#include "matrix_driver.h"
+#include "scroll_store.h"
+#include "timeline.h"
+#include "param_store.h"
+#include "trace.h"
+
+// Minimum measured time per sample, and samples per benchmark (best one wins)
+#define BENCH_MIN_TIME_NS   50000000ULL
+#define BENCH_SAMPLES       5
+
+// Hooks main.cpp normally provides to uart_handler
+TaskHandle_t g_comm_task_handle = NULL;
+void on_command_received() {}
+void on_leds_changed() {}
+void on_flash_write(bool active) {}
+bool is_test_active() { return false; }
+
+// Keeps results observable so the optimizer can't drop the work
+static volatile uint32_t bench_sink;
+
+// Failed CHECK()s in the current check
+static int check_failures;
+
+#define CHECK(cond) check_true((cond), #cond, __LINE__)
+
+static DeviceState g_state;
+static NpmState g_npm;
+static NprState g_npr;
+static MatrixScrollState g_matrix;
+static ValveState g_valve;
+static DispenseState g_dispense;
+
+static void check_true(bool ok, const char* expr, int line) {
+    if (!ok) {
+        printf("  line %d: CHECK(%s) failed\n", line, expr);
+        check_failures++;
+    }
+}
+
+// =============================================================================
+// Checks
+// =============================================================================
+
+static void check_cobs_crc() {
+    // CRC-16/CCITT-FALSE check value, as the Pi computes it (binascii.crc_hqx)
+    const char* check_input = "123456789";
+    CHECK(bin_crc16((const uint8_t*)check_input, 9) == 0x29B1);
+
+    // Zero bytes in the payload must not survive COBS encoding
+    BinServoVelocityPayload p = {900, 0, 1200, 0, -35, 0};
+    uint8_t wire[BIN_COBS_MAX_SIZE + 2];
+    size_t wire_len = bin_build_frame(BIN_TYPE_SRVV, &p, sizeof(p), wire);
+    CHECK(wire_len > 2 && wire[0] == 0x00 && wire[wire_len - 1] == 0x00);
+    CHECK(memchr(&wire[1], 0x00, wire_len - 2) == NULL);
+
+    uint8_t frame[BIN_FRAME_MAX_SIZE];
+    size_t frame_len = bin_cobs_decode(&wire[1], wire_len - 2, frame, sizeof(frame));
+    CHECK(frame_len == sizeof(p) + BIN_FRAME_OVERHEAD);
+    CHECK(bin_frame_valid(frame, frame_len));
+    CHECK(frame[0] == BIN_TYPE_SRVV && frame[1] == sizeof(p));
+    CHECK(memcmp(&frame[2], &p, sizeof(p)) == 0);
+
+    // A flipped bit fails the CRC, a truncated frame the length check
+    frame[3] ^= 0x01;
+    CHECK(!bin_frame_valid(frame, frame_len));
+    frame[3] ^= 0x01;
+    CHECK(!bin_frame_valid(frame, frame_len - 1));
+
+    // Addressed frames carry the address as the first payload byte
+    wire_len = bin_build_addressed_frame(BIN_TYPE_SRVV, 7, &p, sizeof(p), wire);
+    frame_len = bin_cobs_decode(&wire[1], wire_len - 2, frame, sizeof(frame));
+    CHECK(bin_frame_valid(frame, frame_len));
+    CHECK(frame[0] == (BIN_TYPE_SRVV | BIN_TYPE_ADDRESSED) && frame[2] == 7);
+
+    // Oversized payloads are refused rather than truncated
+    uint8_t big[BIN_FRAME_MAX_SIZE] = {0};
+    CHECK(bin_build_frame(BIN_TYPE_TXT, big, sizeof(big), wire) == 0);
+}
+
+static void check_packet_fields() {
+    PacketFields f;
+
+    CHECK(packet_fields_parse("12,-3,+4", "iii", &f) == 3);
+    CHECK(f.value[0] == 12 && f.value[1] == -3 && f.value[2] == 4);
+
+    // Tenths: whole numbers scale, the hundredths digit rounds
+    CHECK(packet_fields_parse("87.5,90,-3.55,0.04", "tttt", &f) == 4);
+    CHECK(f.value[0] == 875 && f.value[1] == 900 && f.value[2] == -36 && f.value[3] == 0);
+
+    // Optional trailing fields, and extra fields past the schema
+    CHECK(packet_fields_parse("1,2", "iiii", &f) == 2);
+    CHECK(packet_fields_parse("1,2,3", "ii", &f) == 2);
+
+    // Parsing stops at the first empty or malformed field
+    CHECK(packet_fields_parse("", "i", &f) == 0);
+    CHECK(packet_fields_parse("1,,3", "iii", &f) == 1);
+    CHECK(packet_fields_parse("1,x,3", "iii", &f) == 1);
+    CHECK(packet_fields_parse("12a", "i", &f) == 0);
+    CHECK(packet_fields_parse("-", "i", &f) == 0);
+    CHECK(packet_fields_parse("999999999999", "i", &f) == 0);
+
+    // Characters are exactly one byte
+    CHECK(packet_fields_parse("A,5", "ci", &f) == 2 && f.value[0] == 'A');
+    CHECK(packet_fields_parse("AB", "c", &f) == 0);
+
+    // A string takes the rest of the packet, commas included
+    CHECK(packet_fields_parse("0,5,HELLO, WORLD", "iis", &f) == 3);
+    CHECK(f.rest != NULL && strcmp(f.rest, "HELLO, WORLD") == 0);
+}
+
+static void check_param_ranges() {
+    int32_t tenths;
+
+    param_store_reset();
+    CHECK(param_get(PARAM_NPM_BRIGHTNESS, &tenths) && tenths == NPM_BRIGHTNESS * 10);
+
+    // Out of range, fractional integer, unknown id: refused, value unchanged
+    CHECK(!param_set(PARAM_NPM_BRIGHTNESS, 2560));
+    CHECK(!param_set(PARAM_NPM_BRIGHTNESS, -10));
+    CHECK(!param_set(PARAM_VALVE_MAX_OPEN_MS, 10005));
+    CHECK(!param_set(PARAM_COUNT, 0));
+    CHECK(g_params.npm_brightness == NPM_BRIGHTNESS);
+
+    CHECK(param_set(PARAM_NPM_BRIGHTNESS, 2550) && g_params.npm_brightness == 255);
+    CHECK(param_set(PARAM_SERVO_MAX_ANGLE, 875) && g_params.servo_max_angle == 87.5f);
+
+    // Servo travel low end may not pass the high end
+    CHECK(!param_set(PARAM_SERVO_MIN_ANGLE, 900));
+    CHECK(param_set(PARAM_SERVO_MIN_ANGLE, 875));
+    CHECK(!param_set(PARAM_SERVO_MAX_ANGLE, 870));
+
+    param_store_reset();
+}
+
+// NPM red at 0 ms, then blue at 1000 ms with the given easing
+static void load_fade_sequence(uint8_t easing, uint8_t mode) {
+    TimelineKey from = {TIMELINE_DEV_NPM, 0, NPM_MODE_LETTER, 'A', 255, 0, 0, 0, 0, 0, 10, 0};
+    TimelineKey to = from;
+    to.time_ms = 1000;
+    to.mode = mode;
+    to.r = 0;
+    to.b = 255;
+    to.easing = easing;
+    timeline_write_key(0, 0, &from);
+    timeline_write_key(0, 1, &to);
+}
+
+// Red channel of the NPM target half-way through the fade
+static int fade_midpoint_red(uint8_t easing) {
+    TimelineKey out[TIMELINE_DEV_COUNT];
+
+    load_fade_sequence(easing, NPM_MODE_LETTER);
+    timeline_trigger(0, TIMELINE_ACTION_PLAY);
+    uint32_t start = millis();
+
+    // out keeps the last reported target when nothing changed
+    timeline_update(start, out);
+    timeline_update(start + 500, out);
+    return out[TIMELINE_DEV_NPM].r;
+}
+
+static void check_timeline() {
+    TimelineKey out[TIMELINE_DEV_COUNT];
+
+    hal_clock_manual(true);
+    timeline_init();
+
+    // Half-way through a 255 -> 0 fade under each curve
+    CHECK(fade_midpoint_red(TIMELINE_EASE_STEP) == 255);
+    CHECK(fade_midpoint_red(TIMELINE_EASE_LINEAR) == 128);
+    CHECK(fade_midpoint_red(TIMELINE_EASE_IN) == 192);
+    CHECK(fade_midpoint_red(TIMELINE_EASE_OUT) == 64);
+    CHECK(fade_midpoint_red(TIMELINE_EASE_IN_OUT) == 129);
+
+    // A mode change jumps at the keyframe instead of fading
+    load_fade_sequence(TIMELINE_EASE_LINEAR, NPM_MODE_RAINBOW);
+    timeline_trigger(0, TIMELINE_ACTION_PLAY);
+    uint32_t start = millis();
+    CHECK(timeline_update(start + 500, out) == (1 << TIMELINE_DEV_NPM));
+    CHECK(out[TIMELINE_DEV_NPM].r == 255 && out[TIMELINE_DEV_NPM].mode == NPM_MODE_LETTER);
+
+    // Unchanged targets are not re-reported
+    CHECK(timeline_update(start + 500, out) == 0);
+
+    // Play once: the last keyframe is held and the player stops
+    CHECK(timeline_update(start + 1500, out) == (1 << TIMELINE_DEV_NPM));
+    CHECK(out[TIMELINE_DEV_NPM].b == 255 && out[TIMELINE_DEV_NPM].mode == NPM_MODE_RAINBOW);
+    CHECK(!timeline_active());
+
+    // Loop: wraps around to the first keyframe and keeps playing
+    load_fade_sequence(TIMELINE_EASE_LINEAR, NPM_MODE_LETTER);
+    timeline_trigger(0, TIMELINE_ACTION_LOOP);
+    start = millis();
+    timeline_update(start + 900, out);
+    CHECK(timeline_update(start + 1000, out) == (1 << TIMELINE_DEV_NPM));
+    CHECK(out[TIMELINE_DEV_NPM].r == 255 && timeline_active());
+
+    // Stop ends playback; keyframes must then follow in time order
+    CHECK(timeline_trigger(0, TIMELINE_ACTION_STOP) && !timeline_active());
+    TimelineKey late = out[TIMELINE_DEV_NPM];
+    late.time_ms = 500;
+    CHECK(!timeline_write_key(0, 2, &late));
+
+    timeline_init();
+    hal_clock_manual(false);
+}
+
+typedef struct {
+    const char* name;
+    void (*run)();
+} Check;
+
+static const Check checks[] = {
+    {"check/cobs_crc",      check_cobs_crc},
+    {"check/packet_fields", check_packet_fields},
+    {"check/param_ranges",  check_param_ranges},
+    {"check/timeline",      check_timeline},
+};
+
+// =============================================================================
+// Parse path
+// =============================================================================
+
+static const char SRV_PACKET[] = "$SRV,90.0,45.5,120.0\n";
+static const char MIXED_PACKETS[] =
+    "$TXN,3\n"
+    "$SRV,91.5,44.0,119.5,12.0,-3.5,0.0,1234,8\n"
+    "$NPM,9,A,255,0,0,0,0,255,12\n"
+    "$RGB,2,10,20,30\n";
+
+static uint8_t srv_frame[BIN_COBS_MAX_SIZE + 2];
+static size_t srv_frame_len;
+
+static void setup_uart() {
+    state_init(&g_state);
+    uart_init();
+    g_state.command.connected = true;
+
+    BinServoVelocityPayload p = {900, 455, 1200, 120, -35, 0};
+    srv_frame_len = bin_build_frame(BIN_TYPE_SRVV, &p, sizeof(p), srv_frame);
+}
+
+static void bench_packet_fields(uint32_t n) {
+    PacketFields f;
+    for (uint32_t i = 0; i < n; i++) {
+        bench_sink += packet_fields_parse("9,A,255,0,0,0,0,255,12", "iciiiiiii", &f);
+        bench_sink += packet_fields_parse("91.5,44.0,119.5,12.0,-3.5,0.0,1234,8", "ttttttii", &f);
+    }
+}
+
+static void bench_parse_srv_ascii(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        hal_serial_feed(SRV_PACKET, sizeof(SRV_PACKET) - 1);
+        uart_receive(&g_state);
+    }
+    bench_sink += (uint32_t)g_state.command.target_servo_angles[0];
+}
+
+static void bench_parse_mixed_ascii(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        hal_serial_feed(MIXED_PACKETS, sizeof(MIXED_PACKETS) - 1);
+        uart_receive(&g_state);
+    }
+    bench_sink += g_state.command.npm_mode;
+}
+
+static void bench_parse_srv_binary(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        hal_serial_feed(srv_frame, srv_frame_len);
+        uart_receive(&g_state);
+    }
+    bench_sink += (uint32_t)g_state.command.target_servo_angles[1];
+}
+
+static void bench_trace_rx(uint32_t n) {
+    // One received-packet record, as dispatch_packet() logs it (ring wraps)
+    for (uint32_t i = 0; i < n; i++) {
+        trace_rx(false, true, SRV_PACKET, sizeof(SRV_PACKET) - 2);
+    }
+    TraceInfo info;
+    trace_get_info(&info);
+    bench_sink += info.bytes;
+}
+
+// =============================================================================
+// Render path
+// =============================================================================
+
+static void setup_render() {
+    npm_state_init(&g_npm);
+    npr_state_init(&g_npr);
+    npm_init(NPM_DATA_PIN);
+    npr_init(NPR_DATA_PIN);
+    led_matrix_init();
+    scroll_store_init();
+}
+
+static void bench_gradient_color(uint32_t n) {
+    uint16_t pos = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t r, g, b;
+        gradient_color(gradient_position_to_t(pos), 255, 40, 0, 0, 80, 255, &r, &g, &b);
+        pos = gradient_advance_pingpong(pos, 7);
+        bench_sink += r + g + b;
+    }
+}
+
+static void bench_npm_rainbow(uint32_t n) {
+    npm_set_mode(&g_npm, NPM_MODE_RAINBOW, 'A', 0, 0, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        npm_update(&g_npm);
+    }
+    bench_sink += g_npm.fx.hue;
+}
+
+static void bench_npm_gradient(uint32_t n) {
+    npm_set_mode(&g_npm, NPM_MODE_GRADIENT, 'A', 255, 0, 0, 0, 0, 255, 5);
+    for (uint32_t i = 0; i < n; i++) {
+        npm_update(&g_npm);
+    }
+    bench_sink += g_npm.fx.gradient_position;
+}
+
+static void bench_npm_glyph(uint32_t n) {
+    // A different letter every frame: one registry lookup and blit each
+    for (uint32_t i = 0; i < n; i++) {
+        npm_set_mode(&g_npm, NPM_MODE_LETTER, 'A' + (i % 26), 0, 200, 80);
+        npm_update(&g_npm);
+    }
+    bench_sink += g_npm.letter;
+}
+
+static void bench_npm_scroll_start(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        npm_set_scroll_string(&g_npm, "FIZZ BALL 2026", 0, 200, 80);
+    }
+    bench_sink += g_npm.scroll_length;
+}
+
+static void bench_npm_scroll_step(uint32_t n) {
+    // Manual clock: every update shifts exactly one column
+    hal_clock_manual(true);
+    npm_set_mode(&g_npm, NPM_MODE_SCROLL, 0, 0, 200, 80);
+    npm_set_scroll_string(&g_npm, "FIZZ BALL 2026", 0, 200, 80);
+    for (uint32_t i = 0; i < n; i++) {
+        hal_clock_advance_us(g_npm.scroll_speed * 1000);
+        npm_update(&g_npm);
+    }
+    hal_clock_manual(false);
+    bench_sink += g_npm.scroll_position;
+}
+
+static void bench_npr_rainbow(uint32_t n) {
+    npr_set_mode(&g_npr, NPR_MODE_RAINBOW, 0, 0, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        npr_update(&g_npr);
+    }
+    bench_sink += g_npr.fx.hue;
+}
+
+static void bench_npm_breathe(uint32_t n) {
+    // Ring effect on the matrix, from the shared effect library
+    npm_set_mode(&g_npm, NPM_MODE_BREATHE, 'A', 255, 120, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        npm_update(&g_npm);
+    }
+    bench_sink += g_npm.fx.breathe_level;
+}
+
+static void bench_matrix_scroll_step(uint32_t n) {
+    // Manual clock: every update shifts the text by one line
+    hal_clock_manual(true);
+    led_matrix_scroll_init(&g_matrix);
+    for (uint32_t i = 0; i < n; i++) {
+        hal_clock_advance_us(g_matrix.scroll_speed * 1000);
+        bench_sink += led_matrix_update(&g_matrix);
+    }
+    hal_clock_manual(false);
+    bench_sink += matrix_driver_rows_sent();
+}
+
+static void bench_compositor_show(uint32_t n) {
+    npm_set_mode(&g_npm, NPM_MODE_RAINBOW, 'A', 0, 0, 0);
+    npr_set_mode(&g_npr, NPR_MODE_RAINBOW, 0, 0, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        npm_update(&g_npm);
+        npr_update(&g_npr);
+        bench_sink += compositor_show();
+    }
+}
+
+// =============================================================================
+// Motion path
+// =============================================================================
+
+static void setup_motion() {
+    servo_init();
+    predictor_init();
+    valve_safety_init(&g_valve);
+    dispense_init(&g_dispense);
+}
+
+static void bench_servo_update(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        // Reverse every 100 steps so the planner keeps accelerating and braking
+        float target = ((i / 100) & 1) ? 30.0f : 150.0f;
+        for (uint8_t s = 0; s < NUM_SERVOS; s++) {
+            servo_set_target(s, target, 0.0f);
+            bench_sink += (uint32_t)servo_update(s, 0.01f);
+        }
+    }
+    bench_sink += hal_ledc_duty(0);
+}
+
+static void bench_predictor(uint32_t n) {
+    hal_clock_manual(true);
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t now = millis();
+        if ((i & 3) == 0) {
+            predictor_sample(0, 90.0f + (i & 63), 0.0f, now, (uint16_t)(i >> 2));
+        }
+        float vel;
+        bench_sink += (uint32_t)predictor_predict(0, now, &vel);
+        hal_clock_advance_us(10000);
+    }
+    hal_clock_manual(false);
+}
+
+static void bench_valve_update(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        valve_safety_set_command(&g_valve, (i & 7) < 4);
+        bench_sink += valve_safety_update(&g_valve, true);
+    }
+}
+
+static void bench_dispense_update(uint32_t n) {
+    // Metering and close prediction at a valve somewhere mid-stroke
+    dispense_start(&g_dispense, &g_valve, DISPENSE_MAX_ML);
+    valve_safety_update(&g_valve, true);
+    for (uint32_t i = 0; i < n; i++) {
+        float angle = (float)(i % 180);
+        bench_sink += dispense_update(&g_dispense, &g_valve, angle, 0.01f, true);
+        g_dispense.poured_ml = 0.0f;
+    }
+    dispense_cancel(&g_dispense, &g_valve);
+}
+
+// =============================================================================
+// Runner
+// =============================================================================
+
+typedef struct {
+    const char* name;
+    void (*setup)();
+    void (*run)(uint32_t iterations);
+    double budget_ns;           // Fail above this many ns/op (see top of file)
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"parse/packet_fields",      setup_uart,   bench_packet_fields,       1000},
+    {"parse/srv_ascii",          setup_uart,   bench_parse_srv_ascii,     3000},
+    {"parse/txn_mixed_ascii",    setup_uart,   bench_parse_mixed_ascii,   10000},
+    {"parse/srvv_binary",        setup_uart,   bench_parse_srv_binary,    3000},
+    {"trace/record_rx",          setup_uart,   bench_trace_rx,            1000},
+    {"render/gradient_color",    setup_render, bench_gradient_color,      50},
+    {"render/npm_rainbow",       setup_render, bench_npm_rainbow,         1000},
+    {"render/npm_gradient",      setup_render, bench_npm_gradient,        500},
+    {"render/npm_glyph",         setup_render, bench_npm_glyph,           600},
+    {"render/npm_scroll_start",  setup_render, bench_npm_scroll_start,    400},
+    {"render/npm_scroll_step",   setup_render, bench_npm_scroll_step,     400},
+    {"render/npr_rainbow",       setup_render, bench_npr_rainbow,         500},
+    {"render/npm_breathe",       setup_render, bench_npm_breathe,         500},
+    {"render/matrix_scroll_step", setup_render, bench_matrix_scroll_step, 400},
+    {"render/compositor_show",   setup_render, bench_compositor_show,     2000},
+    {"motion/servo_update",      setup_motion, bench_servo_update,        400},
+    {"motion/predictor",         setup_motion, bench_predictor,           100},
+    {"motion/valve_update",      setup_motion, bench_valve_update,        400},
+    {"motion/dispense_update",   setup_motion, bench_dispense_update,     200},
+};
+
+#define BENCH_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static uint64_t elapsed_ns(void (*run)(uint32_t), uint32_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    run(iterations);
+    auto end = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+ * Measure one benchmark: grow the iteration count until a run takes
+ * BENCH_MIN_TIME_NS, then keep the fastest of BENCH_SAMPLES runs.
+ */
+static double measure(const Benchmark* b) {
+    b->setup();
+
+    uint32_t iterations = 1;
+    while (elapsed_ns(b->run, iterations) < BENCH_MIN_TIME_NS / 10 && iterations < (1u << 30)) {
+        iterations *= 2;
+    }
+    iterations *= 10;
+
+    double best = 0.0;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        double ns_per_op = (double)elapsed_ns(b->run, iterations) / iterations;
+        if (i == 0 || ns_per_op < best) best = ns_per_op;
+    }
+    return best;
+}
+
+/**
+ * Look up a benchmark in a saved results file.
+ *
+ * @return Saved ns/op, or a negative value if absent
+ */
+static double baseline_lookup(FILE* f, const char* name) {
+    char line_name[64];
+    double value;
+
+    rewind(f);
+    while (fscanf(f, "%63s %lf", line_name, &value) == 2) {
+        if (strcmp(line_name, name) == 0) return value;
+    }
+    return -1.0;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* save_path = NULL;
+    const char* compare_path = NULL;
+    double tolerance = 25.0;
+    bool budgets = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--no-budget") == 0) {
+            budgets = false;
+        } else {
+            fprintf(stderr, "usage: %s [--filter text] [--save file] "
+                            "[--compare file] [--tolerance pct] [--no-budget]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Tuned values start at their defaults, as on a fresh board
+    param_store_init();
+
+    int failed_checks = 0;
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        const Check* c = &checks[i];
+        if (filter != NULL && strstr(c->name, filter) == NULL) continue;
+
+        check_failures = 0;
+        c->run();
+        printf("%-28s %12s\n", c->name, check_failures == 0 ? "ok" : "FAILED");
+        failed_checks += (check_failures > 0) ? 1 : 0;
+    }
+    if (failed_checks > 0) {
+        printf("%d check(s) failed\n", failed_checks);
+        return 1;
+    }
+
+    FILE* baseline = NULL;
+    if (compare_path != NULL && (baseline = fopen(compare_path, "r")) == NULL) {
+        fprintf(stderr, "cannot open baseline %s\n", compare_path);
+        return 2;
+    }
+
+    const char* names[BENCH_COUNT];
+    double results[BENCH_COUNT];
+    size_t count = 0;
+    int regressions = 0;
+    int over_budget = 0;
+
+    printf("%-28s %12s %12s %12s\n", "benchmark", "ns/op", "budget", "baseline");
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        const Benchmark* b = &benchmarks[i];
+        if (filter != NULL && strstr(b->name, filter) == NULL) continue;
+
+        double ns = measure(b);
+        names[count] = b->name;
+        results[count++] = ns;
+
+        bool over = budgets && ns > b->budget_ns;
+        over_budget += over ? 1 : 0;
+        printf("%-28s %12.1f %12.0f", b->name, ns, b->budget_ns);
+        if (baseline != NULL) {
+            double base = baseline_lookup(baseline, b->name);
+            if (base > 0.0) {
+                double change = (ns - base) * 100.0 / base;
+                bool slower = change > tolerance;
+                regressions += slower ? 1 : 0;
+                printf(" %12.1f %+6.1f%%%s", base, change, slower ? "  REGRESSION" : "");
+            } else {
+                printf(" %12s", "-");
+            }
+        }
+        printf("%s\n", over ? "  OVER BUDGET" : "");
+    }
+
+    if (baseline != NULL) fclose(baseline);
+
+    if (save_path != NULL) {
+        FILE* out = fopen(save_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "cannot write %s\n", save_path);
+            return 2;
+        }
+        for (size_t i = 0; i < count; i++) {
+            fprintf(out, "%s %.1f\n", names[i], results[i]);
+        }
+        fclose(out);
+    }
+
+    if (over_budget > 0) {
+        printf("%d benchmark(s) over budget\n", over_budget);
+    }
+    if (regressions > 0) {
+        printf("%d benchmark(s) slower than baseline by more than %.0f%%\n", regressions, tolerance);
+    }
+    return (over_budget > 0 || regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// =============================================================================
+// Native HAL Shim - Arduino core
+// =============================================================================
+// Just enough of the Arduino-ESP32 API for the logic modules to build and run
+// on the host (env:native). Timing comes from hal_native.h's clock, PWM and
+// serial are recorded in memory. Nothing here talks to hardware.
+// =============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define RISING          0x01
+#define FALLING         0x02
+#define CHANGE          0x03
+
+#define IRAM_ATTR
+#define SERIAL_8N1      0x800001c
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+// Arduino-ESP32 takes min/max from std:: rather than defining macros
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// GPIO (reads return the level set with hal_set_pin)
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+
+// LEDC PWM (duty recorded per channel, see hal_ledc_duty)
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+class Print {
+public:
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* s);
+    size_t print(int value);
+    size_t println(const char* s);
+    size_t println();
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void flush() {}
+};
+
+// Serial port backed by in-memory RX/TX buffers (see hal_native.h)
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    void begin(unsigned long baud, uint32_t config, int8_t rx_pin, int8_t tx_pin) {}
+    void end() {}
+    int available();
+    int read();
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t setRxBufferSize(size_t size) { return size; }
+    size_t setTxBufferSize(size_t size) { return size; }
+    void updateBaudRate(unsigned long baud) {}
+    int availableForWrite() { return 256; }
+    void onReceive(void (*callback)(void), bool only_on_timeout = false);
+    void setRxTimeout(uint8_t symbols) {}
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,23 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// NVS stand-in with nothing stored: reads return defaults, writes are dropped
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false) { return true; }
+    void end() {}
+    bool clear() { return true; }
+    bool remove(const char* key) { return true; }
+    size_t getBytesLength(const char* key) { return 0; }
+    size_t getBytes(const char* key, void* buffer, size_t max_len) { return 0; }
+    size_t putBytes(const char* key, const void* value, size_t len) { return len; }
+    uint32_t getUInt(const char* key, uint32_t default_value = 0) { return default_value; }
+    size_t putUInt(const char* key, uint32_t value) { return sizeof(value); }
+    uint8_t getUChar(const char* key, uint8_t default_value = 0) { return default_value; }
+    size_t putUChar(const char* key, uint8_t value) { return sizeof(value); }
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,41 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+// =============================================================================
+// Native HAL Shim - FreeRTOS
+// =============================================================================
+// The native build is single threaded: critical sections are no-ops and task
+// notifications only count, so firmware modules run unchanged on the host.
+// =============================================================================
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* QueueHandle_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define portMAX_DELAY           0xFFFFFFFFu
+#define portTICK_PERIOD_MS      1
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define configMAX_PRIORITIES    25
+#define portYIELD_FROM_ISR(...)
+
+typedef struct {
+    volatile uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) {}
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) {}
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE* mux) {}
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE* mux) {}
+
+#endif // NATIVE_FREERTOS_H
@@ -0,0 +1,253 @@
+#include "hal_native.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "led_driver.h"
+#include "matrix_driver.h"
+#include <chrono>
+
+// =============================================================================
+// Clock
+// =============================================================================
+
+static const std::chrono::steady_clock::time_point boot_time = std::chrono::steady_clock::now();
+static bool clock_is_manual = false;
+static uint64_t manual_us = 0;
+
+static uint64_t host_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - boot_time).count();
+}
+
+static uint64_t now_us() {
+    return clock_is_manual ? manual_us : host_us();
+}
+
+void hal_clock_manual(bool manual) {
+    manual_us = now_us();
+    clock_is_manual = manual;
+}
+
+void hal_clock_advance_us(uint32_t us) {
+    manual_us += us;
+}
+
+uint32_t millis() { return (uint32_t)(now_us() / 1000); }
+uint32_t micros() { return (uint32_t)now_us(); }
+int64_t esp_timer_get_time() { return (int64_t)now_us(); }
+
+void delay(uint32_t ms) { delayMicroseconds(ms * 1000); }
+
+void delayMicroseconds(uint32_t us) {
+    if (clock_is_manual) {
+        manual_us += us;
+        return;
+    }
+    uint64_t end = host_us() + us;
+    while (host_us() < end) {
+    }
+}
+
+// =============================================================================
+// GPIO / LEDC
+// =============================================================================
+
+#define HAL_NUM_PINS        40
+#define HAL_NUM_LEDC        16
+
+static uint8_t pin_levels[HAL_NUM_PINS];
+static uint32_t ledc_duty[HAL_NUM_LEDC];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HAL_NUM_PINS && mode == INPUT_PULLUP) pin_levels[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin) { return pin < HAL_NUM_PINS ? pin_levels[pin] : LOW; }
+void digitalWrite(uint8_t pin, uint8_t value) { if (pin < HAL_NUM_PINS) pin_levels[pin] = value; }
+int analogRead(uint8_t pin) { return 0; }
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {}
+void detachInterrupt(uint8_t pin) {}
+int digitalPinToInterrupt(int pin) { return pin; }
+void hal_set_pin(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) { return freq; }
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+void ledcWrite(uint8_t channel, uint32_t duty) { if (channel < HAL_NUM_LEDC) ledc_duty[channel] = duty; }
+uint32_t hal_ledc_duty(uint8_t channel) { return channel < HAL_NUM_LEDC ? ledc_duty[channel] : 0; }
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+
+// =============================================================================
+// Serial
+// =============================================================================
+
+#define HAL_SERIAL_RX_SIZE  1024
+
+static uint8_t rx_ring[HAL_SERIAL_RX_SIZE];
+static size_t rx_head = 0;
+static size_t rx_tail = 0;
+static uint32_t tx_bytes = 0;
+static void (*rx_callback)(void) = NULL;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+
+size_t hal_serial_feed(const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t queued = 0;
+    while (queued < len && ((rx_head + 1) % HAL_SERIAL_RX_SIZE) != rx_tail) {
+        rx_ring[rx_head] = bytes[queued++];
+        rx_head = (rx_head + 1) % HAL_SERIAL_RX_SIZE;
+    }
+    if (queued > 0 && rx_callback != NULL) {
+        rx_callback();
+    }
+    return queued;
+}
+
+uint32_t hal_serial_tx_bytes() { return tx_bytes; }
+
+int HardwareSerial::available() {
+    return (int)((rx_head + HAL_SERIAL_RX_SIZE - rx_tail) % HAL_SERIAL_RX_SIZE);
+}
+
+int HardwareSerial::read() {
+    if (rx_head == rx_tail) return -1;
+    uint8_t c = rx_ring[rx_tail];
+    rx_tail = (rx_tail + 1) % HAL_SERIAL_RX_SIZE;
+    return c;
+}
+
+size_t HardwareSerial::readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length && available() > 0) {
+        buffer[n++] = (uint8_t)read();
+    }
+    return n;
+}
+
+void HardwareSerial::onReceive(void (*callback)(void), bool only_on_timeout) {
+    rx_callback = callback;
+}
+
+size_t Print::write(uint8_t c) { tx_bytes++; return 1; }
+size_t Print::write(const uint8_t* buffer, size_t size) { tx_bytes += size; return size; }
+size_t Print::print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t Print::println(const char* s) { return print(s) + println(); }
+size_t Print::println() { return write('\n'); }
+
+size_t Print::print(int value) {
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%d", value);
+    return write((const uint8_t*)buf, (size_t)n);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, min((size_t)n, sizeof(buf) - 1));
+}
+
+// =============================================================================
+// FreeRTOS (single threaded: notifications only count)
+// =============================================================================
+
+static uint32_t notify_count = 0;
+
+TickType_t xTaskGetTickCount() { return millis(); }
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t period) {
+    *previous_wake += period;
+    TickType_t now = millis();
+    if ((int32_t)(*previous_wake - now) > 0) delay(*previous_wake - now);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                                   void* params, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    if (handle != NULL) *handle = NULL;
+    return pdFALSE;
+}
+
+void vTaskDelete(TaskHandle_t task) {}
+TaskHandle_t xTaskGetCurrentTaskHandle() { return NULL; }
+BaseType_t xPortGetCoreID() { return 0; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 0; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) { notify_count++; return pdPASS; }
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) { notify_count++; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    uint32_t count = notify_count;
+    notify_count = clear_on_exit ? 0 : (count > 0 ? count - 1 : 0);
+    return count;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    notify_count++;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t* woken) {
+    notify_count++;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t* value, TickType_t ticks_to_wait) {
+    if (value != NULL) *value = notify_count;
+    BaseType_t got = notify_count > 0 ? pdTRUE : pdFALSE;
+    notify_count = 0;
+    return got;
+}
+
+// =============================================================================
+// LED driver (replaces led_driver.cpp: frames complete instantly)
+// =============================================================================
+
+static uint32_t frames_done[LED_DRIVER_MAX_CHANNELS];
+
+bool led_driver_init(uint8_t channel, uint8_t pin) {
+    return channel < LED_DRIVER_MAX_CHANNELS;
+}
+
+bool led_driver_write(uint8_t channel, const uint8_t* grb, size_t len) {
+    if (channel >= LED_DRIVER_MAX_CHANNELS || len > LED_DRIVER_MAX_PIXELS * 3) return false;
+    frames_done[channel]++;
+    return true;
+}
+
+bool led_driver_busy(uint8_t channel) { return false; }
+
+uint32_t led_driver_frames_done(uint8_t channel) {
+    return channel < LED_DRIVER_MAX_CHANNELS ? frames_done[channel] : 0;
+}
+
+// =============================================================================
+// MAX7219 driver (replaces matrix_driver.cpp: rows are sent instantly)
+// =============================================================================
+
+static uint32_t matrix_rows_sent = 0;
+
+bool matrix_driver_init(uint8_t brightness) { return true; }
+
+bool matrix_driver_write(const uint8_t rows[MATRIX_NUM_DEVICES][MATRIX_DIGITS], uint8_t digit_mask) {
+    matrix_rows_sent += __builtin_popcount(digit_mask);
+    return true;
+}
+
+void matrix_driver_set_intensity(uint8_t brightness) {}
+
+void matrix_driver_display_test(bool on) {}
+
+bool matrix_driver_busy() { return false; }
+
+uint32_t matrix_driver_rows_sent() { return matrix_rows_sent; }
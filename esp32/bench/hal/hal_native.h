@@ -0,0 +1,61 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// Native HAL Shim - host controls
+// =============================================================================
+// Hooks for host programs (benchmarks) to drive the shimmed hardware: feed
+// serial RX bytes, read back PWM duty, and choose between the real monotonic
+// clock and a manual one that only moves when told to.
+// =============================================================================
+
+/**
+ * Switch millis()/micros() between the host clock and a manual clock.
+ * The manual clock starts at the current time.
+ *
+ * @param manual True to freeze time until hal_clock_advance_us()
+ */
+void hal_clock_manual(bool manual);
+
+/**
+ * Move the manual clock forward.
+ *
+ * @param us Microseconds to advance
+ */
+void hal_clock_advance_us(uint32_t us);
+
+/**
+ * Queue bytes for Serial.read() and fire the onReceive callback.
+ *
+ * @param data Bytes the "Pi" sent
+ * @param len Number of bytes (dropped if the RX buffer is full)
+ * @return Number of bytes queued
+ */
+size_t hal_serial_feed(const void* data, size_t len);
+
+/**
+ * Total bytes the firmware wrote to Serial (output is discarded).
+ *
+ * @return Byte count since start
+ */
+uint32_t hal_serial_tx_bytes();
+
+/**
+ * Last duty value written to an LEDC channel.
+ *
+ * @param channel LEDC channel (0-15)
+ * @return Duty, 0 if never written
+ */
+uint32_t hal_ledc_duty(uint8_t channel);
+
+/**
+ * Set the level digitalRead() returns for a pin.
+ *
+ * @param pin GPIO number
+ * @param level HIGH or LOW
+ */
+void hal_set_pin(uint8_t pin, uint8_t level);
+
+#endif // HAL_NATIVE_H
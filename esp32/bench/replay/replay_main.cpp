@@ -0,0 +1,274 @@
+/**
+ * Trace replay against the host build (env:replay).
+ *
+ * Feeds the packets of a trace dump (rpi/src/tools/esp_trace.py dump) back
+ * through uart_receive() at their recorded times, on the manual clock, so
+ * timing-dependent paths ($TXN timeouts, $BDR fallback, delta telemetry
+ * pacing) see the same gaps the unit saw.
+ *
+ * Build & run:  pio run -e replay && .pio/build/replay/program unit.trc
+ *
+ * Options:
+ *   --gap-ms <ms>    Report RX gaps longer than this (default 100)
+ *   --unit <addr>    Bus address the unit had (unit_address), so packets for
+ *                    other units are ignored as they were on the bus
+ *   --verbose        Print every record, not just the notable ones
+ *
+ * Reports packets whose accept/reject differs from the unit (exit 1 if
+ * any), host time per packet, RX gaps, and the unit's task overruns and
+ * lock timeouts on the same timeline. Times are offsets from the first
+ * record, in milliseconds.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "hal_native.h"
+#include "config.h"
+#include "state.h"
+#include "uart_handler.h"
+#include "profiler.h"
+#include "param_store.h"
+#include "trace.h"
+
+// Hooks main.cpp normally provides to uart_handler
+TaskHandle_t g_comm_task_handle = NULL;
+void on_command_received() {}
+void on_leds_changed() {}
+void on_flash_write(bool active) {}
+bool is_test_active() { return false; }
+
+static const char* TASK_NAMES[PRF_TASK_COUNT] = {"comm", "animation", "control"};
+
+static DeviceState g_state;
+
+// One record of the loaded trace
+typedef struct {
+    uint32_t t_us;
+    uint8_t type;
+    uint8_t len;
+    const uint8_t* payload;
+} ReplayRecord;
+
+static uint32_t read_u32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static const char* task_name(uint8_t task) {
+    return task < PRF_TASK_COUNT ? TASK_NAMES[task] : "?";
+}
+
+// Printable form of a packet (binary frames as hex)
+static void print_packet(const ReplayRecord* r) {
+    const uint8_t* data = r->payload + 1;
+    size_t len = r->len - 1;
+
+    if (r->payload[0] & TRACE_RX_BINARY) {
+        printf("<bin ");
+        for (size_t i = 0; i < len; i++) printf("%02x", data[i]);
+        printf(">");
+    } else {
+        printf("%.*s", (int)len, (const char*)data);
+    }
+}
+
+/**
+ * Feed one packet and report whether the replayed firmware accepted it,
+ * read back from its own trace.
+ *
+ * @param r RX record from the unit
+ * @param host_ns Host time spent in uart_receive()
+ * @return True if the replay accepted the packet
+ */
+static bool replay_packet(const ReplayRecord* r, uint64_t* host_ns) {
+    static const uint8_t terminator_ascii = PACKET_END_MARKER;
+    static const uint8_t terminator_binary = PACKET_BINARY_DELIMITER;
+    bool binary = (r->payload[0] & TRACE_RX_BINARY) != 0;
+
+    trace_clear();
+    if (binary) {
+        // Only a delimiter arms binary framing, as on the wire
+        hal_serial_feed(&terminator_binary, 1);
+    }
+    hal_serial_feed(r->payload + 1, r->len - 1);
+    hal_serial_feed(binary ? &terminator_binary : &terminator_ascii, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    uart_receive(&g_state);
+    *host_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    uint8_t rec[TRACE_HEADER_SIZE + 1];
+    if (trace_read(0, rec, sizeof(rec)) < sizeof(rec) || rec[4] != TRACE_EV_RX) {
+        return false;
+    }
+    return (rec[TRACE_HEADER_SIZE] & TRACE_RX_ACCEPTED) != 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    double gap_ms = 100.0;
+    int unit = BUS_ADDR_NONE;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--gap-ms") == 0 && i + 1 < argc) {
+            gap_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--unit") == 0 && i + 1 < argc) {
+            unit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "usage: %s <trace file> [--gap-ms ms] [--unit addr] [--verbose]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+    static uint8_t data[1 << 20];
+    size_t size = fread(data, 1, sizeof(data), f);
+    fclose(f);
+
+    // The unit boots with its defaults and a live link
+    param_store_init();
+    if (!param_set(PARAM_UNIT_ADDRESS, unit * 10)) {
+        fprintf(stderr, "bad unit address %d\n", unit);
+        return 2;
+    }
+    state_init(&g_state);
+    uart_init();
+    g_state.command.connected = true;
+    hal_clock_manual(true);
+
+    uint32_t packets = 0, rejected = 0, mismatches = 0, statuses = 0, failsafes = 0;
+    uint32_t overruns[PRF_TASK_COUNT] = {0};
+    uint32_t lock_timeouts[PRF_TASK_COUNT] = {0};
+    uint64_t host_sum_ns = 0, host_max_ns = 0;
+    double host_max_at_ms = 0.0;
+    double last_rx_ms = -1.0;
+
+    bool first = true;
+    uint32_t t0 = 0, t_prev = 0;
+    size_t pos = 0;
+    while (pos + TRACE_HEADER_SIZE <= size) {
+        ReplayRecord r;
+        r.t_us = read_u32(&data[pos]);
+        r.type = data[pos + 4];
+        r.len = data[pos + 5];
+        r.payload = &data[pos + TRACE_HEADER_SIZE];
+        if (pos + TRACE_HEADER_SIZE + r.len > size) break;
+        pos += TRACE_HEADER_SIZE + r.len;
+
+        if (first) {
+            t0 = t_prev = r.t_us;
+            first = false;
+        }
+
+        // Records from the two cores can be a few us out of order
+        int32_t step = (int32_t)(r.t_us - t_prev);
+        if (step > 0) {
+            hal_clock_advance_us((uint32_t)step);
+            t_prev = r.t_us;
+        }
+        double t_ms = (uint32_t)(r.t_us - t0) / 1000.0;
+
+        switch (r.type) {
+            case TRACE_EV_RX: {
+                if (r.len < 1) break;
+                packets++;
+                bool accepted = (r.payload[0] & TRACE_RX_ACCEPTED) != 0;
+                rejected += accepted ? 0 : 1;
+
+                if (last_rx_ms >= 0.0 && t_ms - last_rx_ms > gap_ms) {
+                    printf("%10.3f  RX gap %.1f ms\n", t_ms, t_ms - last_rx_ms);
+                }
+                last_rx_ms = t_ms;
+
+                uint64_t ns;
+                bool replayed = replay_packet(&r, &ns);
+                host_sum_ns += ns;
+                if (ns > host_max_ns) {
+                    host_max_ns = ns;
+                    host_max_at_ms = t_ms;
+                }
+
+                if (replayed != accepted) {
+                    mismatches++;
+                    printf("%10.3f  MISMATCH unit %s, replay %s: ", t_ms,
+                           accepted ? "accepted" : "rejected", replayed ? "accepted" : "rejected");
+                    print_packet(&r);
+                    printf("\n");
+                } else if (verbose || !accepted) {
+                    printf("%10.3f  RX %s: ", t_ms, accepted ? "ok" : "rejected");
+                    print_packet(&r);
+                    printf("\n");
+                }
+                break;
+            }
+
+            case TRACE_EV_STATUS:
+                statuses++;
+                if (verbose && r.len >= 4) {
+                    uint16_t mask;
+                    memcpy(&mask, &r.payload[2], sizeof(mask));
+                    printf("%10.3f  status %s%s mask %03X\n", t_ms,
+                           r.payload[0] == TRACE_STATUS_FULL ? "full" : "delta",
+                           r.payload[1] ? " (binary)" : "", (unsigned)mask);
+                }
+                break;
+
+            case TRACE_EV_OVERRUN:
+            case TRACE_EV_LOCK_TIMEOUT:
+                if (r.len < 5) break;
+                if (r.payload[0] < PRF_TASK_COUNT) {
+                    uint32_t* counts = (r.type == TRACE_EV_OVERRUN) ? overruns : lock_timeouts;
+                    counts[r.payload[0]]++;
+                }
+                printf("%10.3f  %s task %s, %u us\n", t_ms,
+                       r.type == TRACE_EV_OVERRUN ? "overrun" : "lock timeout",
+                       task_name(r.payload[0]), (unsigned)read_u32(&r.payload[1]));
+                break;
+
+            case TRACE_EV_FAILSAFE:
+                if (r.len < 5) break;
+                failsafes++;
+                printf("%10.3f  FAILSAFE task %s stalled %u us, valve shut\n", t_ms,
+                       task_name(r.payload[0]), (unsigned)read_u32(&r.payload[1]));
+                break;
+
+            default:
+                printf("%10.3f  unknown record type %u\n", t_ms, (unsigned)r.type);
+                break;
+        }
+    }
+
+    if (pos != size) {
+        printf("trailing %zu bytes ignored (truncated record)\n", size - pos);
+    }
+
+    double span_ms = first ? 0.0 : (uint32_t)(t_prev - t0) / 1000.0;
+    printf("\n%.1f ms traced: %u packets (%u rejected), %u status\n",
+           span_ms, (unsigned)packets, (unsigned)rejected, (unsigned)statuses);
+    printf("host uart_receive: avg %.0f ns, max %llu ns at %.3f ms\n",
+           packets ? (double)host_sum_ns / packets : 0.0,
+           (unsigned long long)host_max_ns, host_max_at_ms);
+    for (uint8_t task = 0; task < PRF_TASK_COUNT; task++) {
+        printf("%-10s %u overruns, %u lock timeouts\n", task_name(task),
+               (unsigned)overruns[task], (unsigned)lock_timeouts[task]);
+    }
+    printf("%u control failsafes\n", (unsigned)failsafes);
+    printf("%u accept/reject mismatches\n", (unsigned)mismatches);
+
+    return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * On-target driver benchmarks (env:esp32bench).
+ *
+ * Replaces main.cpp: initializes the real drivers, times each call with the
+ * Xtensa CCOUNT cycle counter and prints one report, then repeats it every
+ * BENCH_REPEAT_MS so a monitor attached late still catches one.
+ *
+ * Build & flash:  pio run -e esp32bench -t upload
+ * Capture:        pio device monitor -e esp32bench | grep -a '^BENCH' > bench.csv
+ *
+ * Report lines are CSV, stable across versions so two captures can be diffed:
+ *   BENCH_BEGIN,<cpu_mhz>,<samples>
+ *   BENCH,<name>,<min_cycles>,<avg_cycles>,<max_cycles>,<avg_us>,<budget_pct>
+ *   BENCH_END
+ *
+ * budget_pct is the average cost as a share of the owning task's period
+ * (0 when the call isn't on a periodic task). The "critical/" entries are
+ * the code paths that hold a spinlock, i.e. time spent with interrupts
+ * masked on the calling core. $STS lines from uart_send_status are
+ * interleaved with the report and are filtered out by the grep.
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "pins.h"
+#include "state.h"
+#include "uart_handler.h"
+#include "servo_controller.h"
+#include "rgb_strip.h"
+#include "led_driver.h"
+#include "compositor.h"
+#include "neopixel_matrix.h"
+#include "neopixel_ring.h"
+#include "led_matrix.h"
+#include "matrix_driver.h"
+#include "scroll_store.h"
+#include "timeline.h"
+#include "param_store.h"
+
+#define BENCH_SAMPLES       200     // Timed calls per benchmark
+#define BENCH_REPEAT_MS     10000   // Delay between reports
+#define BENCH_WIRE_TIMEOUT_US 20000   // Give up waiting for a frame after this long
+
+// Hooks main.cpp normally provides to uart_handler
+TaskHandle_t g_comm_task_handle = NULL;
+void on_command_received() {}
+void on_leds_changed() {}
+void on_flash_write(bool active) {}
+bool is_test_active() { return false; }
+
+static DeviceState g_state;
+static NpmState g_npm_state;
+static NprState g_npr_state;
+static RgbState g_rgb_state;
+static MatrixScrollState g_matrix_state;
+
+// Cycle counter of the current core (wraps every ~18s at 240MHz; calls are far shorter)
+static inline uint32_t IRAM_ATTR ccount() {
+    uint32_t cycles;
+    asm volatile("rsr %0, ccount" : "=a"(cycles));
+    return cycles;
+}
+
+// Cost of an empty measurement, subtracted from every sample
+static uint32_t ccount_overhead = 0;
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} BenchStats;
+
+static void stats_reset(BenchStats* s) {
+    s->min = UINT32_MAX;
+    s->max = 0;
+    s->total = 0;
+}
+
+static void stats_add(BenchStats* s, uint32_t cycles) {
+    cycles = (cycles > ccount_overhead) ? cycles - ccount_overhead : 0;
+    if (cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->total += cycles;
+}
+
+/**
+ * Print one report line.
+ *
+ * @param name Benchmark name
+ * @param s Collected samples (BENCH_SAMPLES of them)
+ * @param period_ms Period of the task that makes this call, 0 for none
+ */
+static void report(const char* name, const BenchStats* s, uint32_t period_ms) {
+    uint32_t mhz = getCpuFrequencyMhz();
+    uint32_t avg = (uint32_t)(s->total / BENCH_SAMPLES);
+    float avg_us = (float)avg / mhz;
+    float budget_pct = period_ms ? avg_us * 100.0f / (period_ms * 1000.0f) : 0.0f;
+
+    Serial.printf("BENCH,%s,%u,%u,%u,%.2f,%.3f\n", name,
+                  (unsigned)s->min, (unsigned)avg, (unsigned)s->max, avg_us, budget_pct);
+}
+
+// Time `expr` BENCH_SAMPLES times (with `prep` run untimed before each call)
+#define BENCH_RUN(name, period_ms, prep, expr) do {     \
+        BenchStats s_;                                  \
+        stats_reset(&s_);                               \
+        for (int i_ = 0; i_ < BENCH_SAMPLES; i_++) {    \
+            prep;                                       \
+            uint32_t t0_ = ccount();                    \
+            expr;                                       \
+            stats_add(&s_, ccount() - t0_);             \
+        }                                               \
+        report(name, &s_, period_ms);                   \
+    } while (0)
+
+/**
+ * Wait for the channel's current frame to finish (tx-end interrupt).
+ */
+static void wait_wire(uint8_t channel) {
+    uint32_t start = micros();
+    while (led_driver_busy(channel) && micros() - start < BENCH_WIRE_TIMEOUT_US) {
+    }
+}
+
+/**
+ * Wait for the MAX7219 rows queued by the last frame to finish.
+ */
+static void wait_matrix() {
+    uint32_t start = micros();
+    while (matrix_driver_busy() && micros() - start < BENCH_WIRE_TIMEOUT_US) {
+    }
+}
+
+// Alternate colours so the compositor sees a changed frame every call
+static uint8_t flip(int i) {
+    return (i & 1) ? 40 : 10;
+}
+
+static void calibrate() {
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 16; i++) {
+        uint32_t t0 = ccount();
+        uint32_t t1 = ccount();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    ccount_overhead = best;
+}
+
+static void run_benchmarks() {
+    Serial.printf("BENCH_BEGIN,%u,%u\n", (unsigned)getCpuFrequencyMhz(), (unsigned)BENCH_SAMPLES);
+
+    // NeoPixel matrix drawing into the framebuffer
+    BENCH_RUN("npm_display_letter", 0, , npm_display_glyph(npm_letter_glyph('A' + (i_ % 26)), 0, 40, 20));
+    BENCH_RUN("npm_display_solid", 0, , npm_display_solid(flip(i_), 0, 0));
+    BENCH_RUN("npm_display_eye_open", 0, , npm_display_glyph(NPM_GLYPH_EYE_OPEN, 0, flip(i_), 0));
+    BENCH_RUN("npm_display_circle", 0, , npm_display_glyph(NPM_GLYPH_CIRCLE, 0, 0, flip(i_)));
+    BENCH_RUN("npm_display_x", 0, , npm_display_glyph(NPM_GLYPH_X, flip(i_), 0, 0));
+
+    // Full animation task frame work, against its period
+    npm_set_mode(&g_npm_state, NPM_MODE_RAINBOW, 'A', 0, 0, 0);
+    npr_set_mode(&g_npr_state, NPR_MODE_RAINBOW, 0, 0, 0);
+    BENCH_RUN("npm_update_rainbow", ANIMATION_TASK_PERIOD_MS, , npm_update(&g_npm_state));
+    BENCH_RUN("npr_update_rainbow", ANIMATION_TASK_PERIOD_MS, , npr_update(&g_npr_state));
+    npr_set_mode(&g_npr_state, NPR_MODE_GRADIENT, 255, 0, 0, 0, 0, 255, 10);
+    BENCH_RUN("npr_update_gradient", ANIMATION_TASK_PERIOD_MS, , npr_update(&g_npr_state));
+
+    // show(): queueing both strips vs. the RMT actually clocking a frame out
+    BENCH_RUN("compositor_show", ANIMATION_TASK_PERIOD_MS,
+              (wait_wire(LED_RMT_CHANNEL_NPM), wait_wire(LED_RMT_CHANNEL_NPR),
+               npm_display_solid(flip(i_), 0, 0), npr_display_solid(0, flip(i_), 0)),
+              compositor_show());
+    BENCH_RUN("led_wire_npm", 0,
+              (wait_wire(LED_RMT_CHANNEL_NPM), npm_display_solid(flip(i_), 0, 0), compositor_show()),
+              wait_wire(LED_RMT_CHANNEL_NPM));
+    npm_clear();
+    npr_clear();
+    compositor_show();
+
+    // MAX7219: render and queue a full changed frame (the SPI DMA runs on)
+    BENCH_RUN("led_matrix_update", ANIMATION_TASK_PERIOD_MS,
+              (wait_matrix(), led_matrix_set_patterns((i_ & 1) ? 1 : 2, (i_ & 1) ? 2 : 1)),
+              led_matrix_update(&g_matrix_state));
+    led_matrix_set_patterns(0, 0);
+
+    // LEDC PWM writes
+    BENCH_RUN("rgb_set_hsv", ANIMATION_TASK_PERIOD_MS, , rgb_set_hsv((i_ * 7) % 360));
+    BENCH_RUN("servo_set_angle", CONTROL_TASK_PERIOD_MS, , servo_set_angle(i_ % NUM_SERVOS, 60.0f + (i_ & 31)));
+    BENCH_RUN("servo_update_all", CONTROL_TASK_PERIOD_MS,
+              for (uint8_t s_ = 0; s_ < NUM_SERVOS; s_++) servo_set_target(s_, (i_ & 64) ? 45.0f : 135.0f),
+              for (uint8_t s_ = 0; s_ < NUM_SERVOS; s_++) servo_update(s_, CONTROL_TASK_PERIOD_MS / 1000.0f));
+    rgb_off();
+
+    // Seqlock publish of the command snapshot (comm task, every wake)
+    BENCH_RUN("state_publish_command", STATUS_TX_PERIOD_MS, , state_publish_command(&g_state.command));
+
+    // Status TX: a single line, and back-to-back lines once the TX FIFO is full
+    Serial.flush();
+    BENCH_RUN("uart_send_status", STATUS_TX_PERIOD_MS, Serial.flush(), uart_send_status(&g_state));
+    BENCH_RUN("uart_send_status_burst", 0, , uart_send_status(&g_state));
+    Serial.flush();
+
+    // Spinlock holders (interrupts masked for the whole call)
+    ScrollSlot slot;
+    TimelineKey keys[TIMELINE_DEV_COUNT];
+    BENCH_RUN("critical/scroll_store_read", 0, , scroll_store_read(0, &slot));
+    BENCH_RUN("critical/timeline_update", ANIMATION_TASK_PERIOD_MS, , timeline_update(millis(), keys));
+
+    Serial.println("BENCH_END");
+}
+
+void setup() {
+    Serial.begin(UART_BAUD_RATE);
+    delay(100);
+
+    param_store_init();
+    state_init(&g_state);
+    npm_state_init(&g_npm_state);
+    npr_state_init(&g_npr_state);
+    rgb_state_init(&g_rgb_state);
+    led_matrix_scroll_init(&g_matrix_state);
+
+    uart_init();
+    servo_init();
+    rgb_init();
+    npm_init(NPM_DATA_PIN);
+    npr_init(NPR_DATA_PIN);
+    led_matrix_init();
+    scroll_store_init();
+    timeline_init();
+
+    calibrate();
+}
+
+void loop() {
+    run_benchmarks();
+    delay(BENCH_REPEAT_MS);
+}
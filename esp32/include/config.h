@@ -8,20 +8,69 @@
 // UART Settings
 // =============================================================================
 
-#define UART_BAUD_RATE 115200
-#define UART_RX_BUFFER_SIZE 128
-#define UART_TX_BUFFER_SIZE 128
+#define UART_BAUD_RATE 115200        // Boot rate; the Pi negotiates a faster one with $BDR
+#define UART_RX_BUFFER_SIZE 128      // Longest packet accepted (one ASCII line)
+#define UART_TX_BUFFER_SIZE 128      // Longest packet formatted in one go
+
+// Link rate negotiation ($BDR): a new rate is dropped back to UART_BAUD_RATE
+// unless a valid packet arrives at it within UART_BAUD_CONFIRM_MS, and again
+// once the link has been silent for UART_BAUD_IDLE_MS (e.g. the Pi restarted)
+#define UART_BAUD_CONFIRM_MS 300
+#define UART_BAUD_IDLE_MS 1000
+
+// UART driver ring buffers, sized for ~20 ms of traffic at 921600 baud
+// (92 bytes/ms) so a late comm task wake never overruns them
+#define UART_DRIVER_RX_BUFFER_SIZE 2048
+#define UART_DRIVER_TX_BUFFER_SIZE 1024
+
+// RX idle timeout (in symbol times) before the driver reports a packet burst
+#define UART_RX_TIMEOUT_SYMBOLS 2
+
+// Transactions ($TXN): max sub-packets, and how long to wait for all of them
+#define TXN_MAX_COMMANDS 16
+#define TXN_TIMEOUT_MS 50
+
+// Why a transaction was dropped ($TXA reply)
+#define TXN_ABORT_INVALID 0          // A sub-packet failed to parse or apply
+#define TXN_ABORT_UNSTAGED 1         // A sub-packet that cannot be staged (not command state)
+#define TXN_ABORT_TIMEOUT 2          // Sub-packets missing after TXN_TIMEOUT_MS
+
+// Shared bus (several units on one RS-485 pair, see uart_protocol.md
+// "Addressing"): 1 talks through a transceiver on Serial2 (BUS_*_PIN)
+// instead of USB Serial. Each unit's address is the unit_address parameter
+#define BUS_ENABLED 0
+#define BUS_ADDR_NONE 0              // Standalone: answers everything, untagged
+#define BUS_ADDR_BROADCAST 255       // Accepted by every unit, never answered
+#define BUS_ADDR_MAX 254
+
+// Reply slot width after a $POL: unit n sends its status (n - 1) slots in,
+// so one slot must hold a full keyframe at the bus rate (~1.1 ms at 921600)
+#define BUS_SLOT_US 5000
 
 // =============================================================================
 // Servo Settings (3 servos)
 // =============================================================================
+// Travel and motion limits below are defaults: the tuned values live in
+// g_params (param_store.h, set with $PRM and saved in NVS)
 
 #define SERVO_MIN_ANGLE 0.0f
 #define SERVO_MAX_ANGLE 180.0f
 #define SERVO_CENTER_ANGLE 90.0f
 
-// Servo movement speed (degrees per update cycle)
-#define SERVO_SPEED 2.0f
+// Motion planner limits (trapezoidal velocity profile)
+#define SERVO_MAX_VELOCITY_DPS 360.0f  // Max speed (degrees/second)
+#define SERVO_MAX_ACCEL_DPS2 2400.0f   // Max acceleration (degrees/second^2)
+#define SERVO_SETTLE_DEG 0.1f          // Snap to target inside this band when slow
+
+// Feed-forward velocity from $SRV is dropped if no servo packet arrives for this long
+#define SERVO_FEEDFORWARD_TIMEOUT_MS 100
+
+// Target predictor for timestamped $SRV packets (see target_predictor.h)
+#define PREDICTOR_ALPHA 0.5f           // Position correction gain (0-1)
+#define PREDICTOR_BETA 0.2f            // Velocity correction gain (0-1)
+#define PREDICTOR_MAX_HORIZON_MS 150   // Never extrapolate further than this past a sample
+#define PREDICTOR_RESET_MS 250         // Sample gap that restarts the filter
+#define PREDICTOR_SEQ_RESTART 256      // Backwards seq jump treated as a Pi restart
 
 // PWM settings
 #define SERVO_PWM_FREQ 50 // 50 Hz standard servo frequency
@@ -40,6 +89,12 @@
 #define VALVE_SERVO_INDEX 2     // Servo index for valve control
 #define VALVE_CLOSED_ANGLE 0.0f // Valve closed position (default start)
 #define VALVE_OPEN_ANGLE 180.0f // Valve open position
+#define VALVE_MAX_VELOCITY_DPS 200.0f  // Valve servo speed (degrees/second)
+#define VALVE_MAX_ACCEL_DPS2 2000.0f   // Valve servo acceleration (degrees/second^2)
+
+// Flow meter on FLOW_SENSOR_PIN for metered pours (0 = integrate the flow
+// curve only, see dispense.h)
+#define FLOW_SENSOR_ENABLED 0
 
 // =============================================================================
 // RGB Strip Settings
@@ -67,6 +122,57 @@
 
 #define MATRIX_DEFAULT_BRIGHTNESS 8 // 0-15
 
+// Hardware SPI host for the MAX7219 chain (pins are routed through the GPIO
+// matrix, see pins.h). HSPI is free: nothing else in the firmware uses SPI.
+#define MATRIX_SPI_HOST HSPI_HOST
+
+// SPI clock (MAX7219 maximum is 10 MHz). A full 8-row frame for two modules
+// is 8 x 32 bits, about 32 us on the wire.
+#define MATRIX_SPI_CLOCK_HZ 8000000
+
+// Lamp test at boot: every LED on for this long (0 to skip)
+#define MATRIX_LAMP_TEST_MS 500
+
+// =============================================================================
+// NeoPixel Driver Settings (RMT)
+// =============================================================================
+
+// RMT channels used for NeoPixel output (one per strip, transmit concurrently)
+#define LED_RMT_CHANNEL_NPM 0
+#define LED_RMT_CHANNEL_NPR 1
+
+// RMT clock divider from the 80 MHz APB clock (2 -> 25 ns ticks)
+#define LED_RMT_CLK_DIV 2
+
+// Largest strip the driver can buffer (raise to chain longer strips)
+#define LED_DRIVER_MAX_PIXELS 64
+
+// =============================================================================
+// Color Pipeline Settings (see color_utils.h)
+// =============================================================================
+
+// Apply the gamma 2.2 table on output (NeoPixels and RGB strip)
+#define COLOR_GAMMA_ENABLED 1
+
+// Temporal dithering of the RGB strip's 8-bit PWM: the gamma table's
+// fractional bits are carried from frame to frame, so slow fades step
+// smoothly. Runs at the animation rate (static colors with a fractional duty
+// are rewritten every animation period) and can shimmer at the dimmest levels.
+#define RGB_DITHER_ENABLED 0
+
+// =============================================================================
+// Power Budget Settings (see compositor.h)
+// =============================================================================
+
+// Dim all LED outputs together when their estimated draw exceeds the budget
+#define POWER_LIMIT_ENABLED 1
+#define POWER_BUDGET_MA 1500                // Share of the 5V rail the LEDs may use
+
+// Current estimates at full duty (measure your own strip/pixels to tune)
+#define POWER_NEOPIXEL_MA_PER_CHANNEL 20    // One WS2812 color channel fully on
+#define POWER_NEOPIXEL_IDLE_MA 1            // Per pixel, even when dark
+#define POWER_RGB_MA_PER_CHANNEL 300        // One RGB strip channel at 100% PWM
+
 // =============================================================================
 // Limit Switch Settings
 // =============================================================================
@@ -76,9 +182,16 @@
 #define LIMIT_CW 1  // Clockwise limit
 #define LIMIT_CCW 2 // Counter-clockwise limit
 
-// Debounce time in milliseconds
+// Release debounce: the switch must read open with no edges for this long
 #define LIMIT_DEBOUNCE_MS 50
 
+// Servo that drives into the switch, and its motion sign toward the CW stop
+#define LIMIT_SERVO_INDEX 0
+#define LIMIT_CW_MOTION_SIGN 1  // Increasing angle runs into the CW stop
+
+// Stop LIMIT_SERVO_INDEX at a hit (0 = report only, e.g. switch wired as a button)
+#define LIMIT_FENCE_ENABLED 1
+
 // =============================================================================
 // Timing Settings
 // =============================================================================
@@ -91,6 +204,41 @@
 #define STATUS_TX_RATE_HZ 50
 #define STATUS_TX_PERIOD_MS (1000 / STATUS_TX_RATE_HZ)
 
+// RTOS task periods (defaults of the $PRM task period parameters)
+#define ANIMATION_TASK_PERIOD_MS 20     // 50Hz
+#define CONTROL_TASK_PERIOD_MS 10       // 100Hz, paced by an esp_timer
+
+// LED frame scheduling: each output gets its own next-frame deadline from
+// its effect, and the animation task sleeps until the earliest one (static
+// frames don't tick at all). ANIMATION_TASK_PERIOD_MS is the fastest frame
+// rate. The task also wakes at least every ANIMATION_IDLE_WAKE_MS to pick
+// up $PRM changes.
+#define ANIMATION_IDLE_WAKE_MS 250
+#define ANIMATION_WAIT_IDLE 0xFFFFFFFFu // Frame wait of an output with nothing due
+
+// Core the LED rendering (animation task) runs on. Core 0 shares it with the
+// notify-driven comm task and leaves Core 1 to the control loop; set to 1
+// for the old layout.
+#define LED_RENDER_CORE 0
+
+// Control loop supervision: the valve is forced closed if no control tick
+// completes for CONTROL_STALL_MS, and the task watchdog resets the board
+// after CONTROL_WDT_TIMEOUT_S. NVS writes stall every task while the flash
+// cache is off, so the check pauses during them ($PSV, $SLT). The failsafe
+// (STS_FLAG_FAILSAFE) clears after CONTROL_FAILSAFE_CLEAR_MS of on-time ticks.
+#define CONTROL_STALL_MS 50
+#define CONTROL_FAILSAFE_CLEAR_MS 500
+#define CONTROL_WDT_TIMEOUT_S 1
+#define CONTROL_MAX_CATCHUP_TICKS 5     // Missed ticks integrated in one step, at most
+
+// Delta telemetry ($TLM,1): full keyframe period and change thresholds
+#define TELEMETRY_KEYFRAME_PERIOD_MS 250
+#define TELEMETRY_SERVO_DEADBAND 5      // Tenths of a degree
+#define TELEMETRY_VALVE_MS_STEP 100     // Valve timer reporting step (ms)
+
+// Link latency report rate ($LAT)
+#define LATENCY_REPORT_PERIOD_MS 1000
+
 // Connection timeout (no commands received)
 #define CONNECTION_TIMEOUT_MS 500
 
@@ -102,15 +250,65 @@
 #define PACKET_END_MARKER '\n'
 #define PACKET_MAX_SIZE 64
 
+// Binary framed mode (negotiated with $BIN,1 - see binary_protocol.h)
+#define PACKET_BINARY_DELIMITER 0x00 // COBS frame delimiter
+
+// Unit address after an ASCII packet name: $SRV@3,... (see BUS_ENABLED)
+#define BUS_ADDRESS_MARKER '@'
+
 // Command flags (from Pi)
 #define CMD_FLAG_LED_TEST 0x01 // Bit 0: Trigger LED blink test
 
+// =============================================================================
+// Scroll Slot Settings
+// =============================================================================
+
+// Uploadable scroll slots ($TXT / $FRM / $SLT), persisted in NVS
+#define SCROLL_SLOT_COUNT 4
+#define SCROLL_SLOT_DATA_MAX 80    // Characters, or 5 bytes per frame (16 frames)
+#define SCROLL_UPLOAD_CHUNK_MAX 20 // Characters per $TXT chunk
+
+// User glyph slots for NPM_MODE_GLYPH ($GLY), held in RAM only
+#define NPM_USER_GLYPH_COUNT 8
+
+// =============================================================================
+// Timeline Settings
+// =============================================================================
+
+// Keyframe sequences uploaded with $KEY and started with $SEQ
+#define TIMELINE_SEQ_COUNT 4
+#define TIMELINE_SEQ_MAX_KEYS 16   // Keyframes per sequence (all devices)
+
 // =============================================================================
 // Test Settings
 // =============================================================================
 
 #define TEST_LED_DURATION_MS 500 // LED on for 0.5 seconds
 
+// =============================================================================
+// Profiler Settings
+// =============================================================================
+
+// Set to 0 to compile out all task timing instrumentation and $PRF reports
+#define PROFILER_ENABLED 1
+
+// Profiler report rate ($PRF, one packet per task)
+#define PROFILER_REPORT_PERIOD_MS 1000
+
+// =============================================================================
+// Trace Settings
+// =============================================================================
+
+// Set to 0 to compile out the trace recorder and $TRC
+#define TRACE_ENABLED 1
+
+// Trace ring size in bytes (power of two; about 10 s of 30 Hz commands and status)
+#define TRACE_BUFFER_SIZE 16384
+
+// Trace bytes per $TRD line, and lines per $TRC page
+#define TRACE_DUMP_LINE_BYTES 32
+#define TRACE_DUMP_PAGE_LINES 8
+
 // =============================================================================
 // Debug Settings
 // =============================================================================
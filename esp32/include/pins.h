@@ -24,6 +24,11 @@
 // -----------------------------------------------------------------------------
 #define LIMIT_SWITCH_PIN 33 // Input from limit switch (active LOW)
 
+// -----------------------------------------------------------------------------
+// Flow Meter (optional, FLOW_SENSOR_ENABLED in config.h)
+// -----------------------------------------------------------------------------
+#define FLOW_SENSOR_PIN 23 // Pulse input from a hall flow meter (open collector)
+
 // -----------------------------------------------------------------------------
 // Test/Status LED
 // -----------------------------------------------------------------------------
@@ -54,6 +59,14 @@
 // -----------------------------------------------------------------------------
 #define NPR_DATA_PIN 21 // Data pin for NeoPixel ring
 
+// -----------------------------------------------------------------------------
+// RS-485 Bus (optional, BUS_ENABLED in config.h)
+// -----------------------------------------------------------------------------
+#define BUS_RX_PIN 18 // Serial2 RX from the transceiver RO
+#define BUS_TX_PIN 19 // Serial2 TX to the transceiver DI
+#define BUS_DE_PIN 17 // Driver enable (DE and /RE tied), driven by the UART;
+                      // pull down so a resetting unit never drives the bus
+
 // =============================================================================
 // Pin Usage Summary
 // =============================================================================
@@ -68,6 +81,10 @@
 //   14   | RGB Red            | Output    | PWM (5kHz)
 //   15   | Servo 2 (Arm)      | Output    | 50Hz PWM signal
 //   16   | NeoPixel Ring      | Output    | 8-LED ring data
+//   17   | RS-485 DE          | Output    | High while transmitting, optional
+//   18   | RS-485 RX (RO)     | Input     | Serial2, optional
+//   19   | RS-485 TX (DI)     | Output    | Serial2, optional
+//   23   | Flow Meter         | Input     | Internal pullup, optional
 //   25   | Matrix Data (DIN)  | Output    | MAX7219 SPI MOSI
 //   26   | Matrix CS (Load)   | Output    | MAX7219 SPI chip select
 //   27   | RGB Green          | Output    | PWM (5kHz)
@@ -0,0 +1,122 @@
+#include "binary_protocol.h"
+
+uint16_t bin_crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+
+    // Table-free byte-wise form of the 0x1021 polynomial
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint8_t)(crc >> 8) | (uint16_t)(crc << 8);
+        crc ^= data[i];
+        crc ^= (uint8_t)(crc & 0xFF) >> 4;
+        crc ^= (uint16_t)(crc << 12);
+        crc ^= (uint16_t)((crc & 0xFF) << 5);
+    }
+
+    return crc;
+}
+
+size_t bin_cobs_encode(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t read_index = 0;
+    size_t write_index = 1;
+    size_t code_index = 0;
+    uint8_t code = 1;
+
+    while (read_index < len) {
+        if (src[read_index] == 0) {
+            dst[code_index] = code;
+            code = 1;
+            code_index = write_index++;
+            read_index++;
+        } else {
+            dst[write_index++] = src[read_index++];
+            code++;
+            if (code == 0xFF) {
+                dst[code_index] = code;
+                code = 1;
+                code_index = write_index++;
+            }
+        }
+    }
+
+    dst[code_index] = code;
+    return write_index;
+}
+
+size_t bin_cobs_decode(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_size) {
+    size_t read_index = 0;
+    size_t write_index = 0;
+
+    while (read_index < len) {
+        uint8_t code = src[read_index];
+
+        // Zero code bytes or runs past the end mean a corrupted frame
+        if (code == 0 || read_index + code > len) {
+            return 0;
+        }
+        read_index++;
+
+        for (uint8_t i = 1; i < code; i++) {
+            if (write_index >= dst_size) return 0;
+            dst[write_index++] = src[read_index++];
+        }
+
+        // Implicit zero between blocks (not after the last one)
+        if (code != 0xFF && read_index < len) {
+            if (write_index >= dst_size) return 0;
+            dst[write_index++] = 0;
+        }
+    }
+
+    return write_index;
+}
+
+size_t bin_build_frame(uint8_t type, const void* payload, uint8_t payload_len, uint8_t* out) {
+    uint8_t frame[BIN_FRAME_MAX_SIZE];
+    size_t frame_len = (size_t)payload_len + BIN_FRAME_OVERHEAD;
+
+    if (frame_len > BIN_FRAME_MAX_SIZE) {
+        return 0;
+    }
+
+    frame[0] = type;
+    frame[1] = payload_len;
+    memcpy(&frame[2], payload, payload_len);
+
+    uint16_t crc = bin_crc16(frame, payload_len + 2);
+    frame[payload_len + 2] = (uint8_t)(crc & 0xFF);
+    frame[payload_len + 3] = (uint8_t)(crc >> 8);
+
+    // Leading delimiter resynchronizes a receiver that lost a byte
+    out[0] = 0x00;
+    size_t encoded = bin_cobs_encode(frame, frame_len, &out[1]);
+    out[encoded + 1] = 0x00;
+
+    return encoded + 2;
+}
+
+size_t bin_build_addressed_frame(uint8_t type, uint8_t address, const void* payload,
+                                 uint8_t payload_len, uint8_t* out) {
+    uint8_t body[BIN_FRAME_MAX_SIZE - BIN_FRAME_OVERHEAD];
+
+    if ((size_t)payload_len + 1 > sizeof(body)) {
+        return 0;
+    }
+
+    body[0] = address;
+    memcpy(&body[1], payload, payload_len);
+    return bin_build_frame(type | BIN_TYPE_ADDRESSED, body, payload_len + 1, out);
+}
+
+bool bin_frame_valid(const uint8_t* frame, size_t len) {
+    if (len < BIN_FRAME_OVERHEAD) {
+        return false;
+    }
+
+    uint8_t payload_len = frame[1];
+    if ((size_t)payload_len + BIN_FRAME_OVERHEAD != len) {
+        return false;
+    }
+
+    uint16_t expected = (uint16_t)frame[len - 2] | ((uint16_t)frame[len - 1] << 8);
+    return bin_crc16(frame, len - 2) == expected;
+}
@@ -0,0 +1,326 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "timeline.h"
+
+// =============================================================================
+// Binary Framed Protocol
+// =============================================================================
+// Compact alternative to the ASCII `$XXX,...` packets, negotiated with $BIN,1.
+//
+// Frame (before COBS encoding):
+//   [type:1][len:1][payload:len][crc16:2]
+//
+// - type:    BIN_TYPE_* tag, used directly as a jump table index
+// - len:     payload length, must match the fixed size for the type
+// - payload: packed little-endian struct (see Bin*Payload below)
+// - crc16:   CRC-16/CCITT-FALSE over type+len+payload, little-endian
+//
+// On the wire every frame is COBS encoded and wrapped in 0x00 delimiters:
+//   0x00 <cobs bytes> 0x00
+//
+// Frames are kept short enough that the first COBS byte can never be '$',
+// so ASCII and binary packets can share one receive stream.
+//
+// On a shared bus a frame may carry a unit address: BIN_TYPE_ADDRESSED is
+// set in the type and the address is the first payload byte (counted in len):
+//   [type | 0x40:1][len + 1:1][address:1][payload:len][crc16:2]
+// =============================================================================
+
+// Frame types (Pi -> ESP32)
+#define BIN_TYPE_SRV        0x01    // Servo targets
+#define BIN_TYPE_LGT        0x02    // Light command
+#define BIN_TYPE_RGB        0x03    // RGB strip
+#define BIN_TYPE_MTX        0x04    // MAX7219 matrix patterns
+#define BIN_TYPE_NPM        0x05    // NeoPixel matrix
+#define BIN_TYPE_NPR        0x06    // NeoPixel ring
+#define BIN_TYPE_VLV        0x07    // Valve command
+#define BIN_TYPE_EST        0x08    // Emergency stop
+#define BIN_TYPE_FLG        0x09    // Command flags
+#define BIN_TYPE_MODE       0x0A    // Link mode (0 = back to ASCII status)
+#define BIN_TYPE_TXT        0x0B    // Scroll slot text chunk
+#define BIN_TYPE_FRM        0x0C    // Scroll slot 5x5 frame
+#define BIN_TYPE_SLT        0x0D    // Scroll slot commit / erase
+#define BIN_TYPE_KEY        0x0E    // Timeline keyframe
+#define BIN_TYPE_SEQ        0x0F    // Timeline trigger
+#define BIN_TYPE_SRVV       0x10    // Servo targets + feed-forward velocity
+#define BIN_TYPE_SRVT       0x11    // Timestamped servo targets (predictor input)
+#define BIN_TYPE_TLM        0x12    // Telemetry mode (0 = periodic, 1 = delta)
+#define BIN_TYPE_TXN        0x13    // Transaction header (next N frames commit together)
+#define BIN_TYPE_PNG        0x14    // Ping (answered at once with an ECHO frame)
+#define BIN_TYPE_GLY        0x15    // NeoPixel matrix user glyph
+#define BIN_TYPE_POR        0x16    // Metered pour
+#define BIN_TYPE_POL        0x17    // Bus poll (status in each unit's reply slot)
+#define BIN_TYPE_COUNT      0x18    // Size of the RX jump table
+
+// Frame types (ESP32 -> Pi)
+#define BIN_TYPE_STS        0x81    // Status
+#define BIN_TYPE_LAT        0x82    // Link latency report
+#define BIN_TYPE_PRF        0x83    // Task profiler report
+#define BIN_TYPE_STD        0x84    // Status delta (variable length, see STS_FIELD_*)
+#define BIN_TYPE_ECHO       0x85    // Ping reply (token echoed back)
+#define BIN_TYPE_BOT        0x86    // Boot report (reset reason, stage times)
+#define BIN_TYPE_PRD        0x87    // Pour done (target, poured, reason, duration)
+#define BIN_TYPE_SCH        0x88    // LED schedule (frame intervals, core load)
+#define BIN_TYPE_TXA        0x89    // Transaction aborted (TXN_ABORT_* reason)
+
+// Type flag: the first payload byte is a bus address (BUS_ADDR_*)
+#define BIN_TYPE_ADDRESSED  0x40
+
+// Frame overhead: type + len + crc16
+#define BIN_FRAME_OVERHEAD  4
+
+// Largest raw frame and its COBS-encoded size (one code byte per 254 data bytes)
+#define BIN_FRAME_MAX_SIZE  32
+#define BIN_COBS_MAX_SIZE   (BIN_FRAME_MAX_SIZE + 2)
+
+// The COBS code byte is at most frame length + 1; keeping it below '$'
+// lets the receiver tell an ASCII packet from a binary frame by its first byte.
+static_assert(BIN_FRAME_MAX_SIZE + 1 < PACKET_START_MARKER,
+              "Binary frames must not be able to start with the ASCII start marker");
+
+// Payload structures (all little-endian, no padding)
+// Angles are fixed-point tenths of a degree (0-1800).
+typedef struct __attribute__((packed)) {
+    int16_t s1, s2, s3;
+} BinServoPayload;
+
+typedef struct __attribute__((packed)) {
+    int16_t s1, s2, s3;
+    int16_t v1, v2, v3;         // Target velocity (tenths of a degree per second)
+} BinServoVelocityPayload;
+
+typedef struct __attribute__((packed)) {
+    int16_t s1, s2, s3;
+    int16_t v1, v2, v3;         // Target velocity (tenths of a degree per second)
+    uint16_t seq;               // Pi measurement sequence number
+    uint16_t age_ms;            // Age of the measurement when the Pi sent the frame
+} BinServoTimedPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t cmd;
+} BinLightPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t mode;
+    uint8_t r, g, b;
+    uint8_t r2, g2, b2;
+    uint8_t speed;
+} BinRgbPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t left, right;
+} BinMatrixPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t mode;
+    char letter;
+    uint8_t r, g, b;
+    uint8_t r2, g2, b2;
+    uint8_t speed;
+} BinNpmPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t mode;
+    uint8_t r, g, b;
+    uint8_t r2, g2, b2;
+    uint8_t speed;
+} BinNprPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t value;
+} BinBytePayload;               // VLV, EST, FLG, MODE, TLM, TXN, POL, TXA
+
+typedef struct __attribute__((packed)) {
+    uint32_t token;             // Opaque to the ESP32, echoed back unchanged
+} BinPingPayload;               // PNG, ECHO
+
+typedef struct __attribute__((packed)) {
+    uint16_t ml;                // Volume in tenths of a ml (0 = stop the pour)
+} BinPourPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t slot;
+    uint8_t offset;             // Character offset of this chunk
+    uint8_t len;                // Characters used in text[]
+    char text[SCROLL_UPLOAD_CHUNK_MAX];
+} BinTextPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t slot;
+    uint8_t index;              // Frame index within the slot
+    uint8_t rows[5];            // Row bitmaps, bit 4 = leftmost column
+} BinFramePayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t slot;               // User glyph slot
+    uint8_t rows[5];            // Row bitmaps, bit 4 = leftmost column
+} BinGlyphPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t slot;
+    uint8_t action;             // SCROLL_SLOT_ACTION_*
+} BinSlotPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t seq;
+    uint8_t index;              // Keyframe index within the sequence
+    TimelineKey key;
+} BinKeyPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t seq;
+    uint8_t action;             // TIMELINE_ACTION_*
+} BinSeqPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t limit;
+    int16_t s1, s2, s3;         // Servo positions (tenths of a degree)
+    uint8_t light;
+    uint8_t flags;
+    uint8_t test;
+    uint8_t valve_open;
+    uint8_t valve_enabled;
+    uint32_t valve_ms;
+    uint16_t chatter;           // Limit switch chatter edges (wraps)
+} BinStatusPayload;
+
+// Status flags (STS flags field)
+#define STS_FLAG_MOVING         0x01    // Any servo moving
+#define STS_FLAG_FAILSAFE       0x04    // Control loop stalled, valve held shut
+#define STS_FLAG_DELTA          0x80    // Delta telemetry active ($TLM,1 acknowledged)
+
+// Status delta (STD) field mask. A delta carries a uint16 mask followed by
+// only the selected fields, in this order and with their STS sizes.
+#define STS_FIELD_LIMIT         0x0001
+#define STS_FIELD_S1            0x0002
+#define STS_FIELD_S2            0x0004
+#define STS_FIELD_S3            0x0008
+#define STS_FIELD_LIGHT         0x0010
+#define STS_FIELD_FLAGS         0x0020
+#define STS_FIELD_TEST          0x0040
+#define STS_FIELD_VALVE_OPEN    0x0080
+#define STS_FIELD_VALVE_ENABLED 0x0100
+#define STS_FIELD_VALVE_MS      0x0200
+#define STS_FIELD_CHATTER       0x0400
+#define STS_FIELD_ALL           0x07FF
+
+typedef struct __attribute__((packed)) {
+    uint32_t last_us;           // Latest RX event -> servo target latency
+    uint32_t avg_us;            // Average over the report window
+    uint32_t max_us;            // Maximum over the report window
+    uint16_t count;             // Samples in the report window
+} BinLatencyPayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t reset_reason;       // esp_reset_reason() of this boot
+    uint32_t valve_us;          // Valve servo holding the closed pulse
+    uint32_t control_us;        // First control tick done
+    uint32_t link_us;           // UART link up
+    uint32_t leds_us;           // LED drivers initialized
+} BinBootPayload;
+
+typedef struct __attribute__((packed)) {
+    uint16_t target;            // Requested volume (tenths of a ml)
+    uint16_t poured;            // Volume poured (tenths of a ml)
+    uint8_t reason;             // DISPENSE_END_*
+    uint32_t duration_ms;       // Valve open to shut
+} BinPourReportPayload;
+
+typedef struct __attribute__((packed)) {
+    uint16_t npm_ms;            // NeoPixel matrix frame interval (0 = static)
+    uint16_t npr_ms;            // NeoPixel ring frame interval
+    uint16_t rgb_ms;            // RGB strip frame interval
+    uint16_t matrix_ms;         // MAX7219 frame interval
+    uint8_t render_core;        // Core the LED rendering runs on
+    uint16_t load_permille[2];  // Profiled busy time per core (0-1000)
+} BinSchedulePayload;
+
+typedef struct __attribute__((packed)) {
+    uint8_t task;               // PRF_TASK_* index
+    uint16_t loops;
+    uint32_t exec_min_us, exec_avg_us, exec_max_us;
+    uint16_t overruns;
+    uint16_t jitter_max_us;
+    uint16_t lock_wait_avg_us, lock_wait_max_us;
+    uint16_t lock_timeouts;
+    uint16_t stack_free;
+} BinProfilePayload;
+
+static_assert(sizeof(BinStatusPayload) + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "Status frame exceeds BIN_FRAME_MAX_SIZE");
+static_assert(sizeof(BinNpmPayload) + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "NPM frame exceeds BIN_FRAME_MAX_SIZE");
+static_assert(sizeof(BinTextPayload) + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "TXT frame exceeds BIN_FRAME_MAX_SIZE");
+static_assert(sizeof(BinKeyPayload) + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "KEY frame exceeds BIN_FRAME_MAX_SIZE");
+static_assert(sizeof(BinProfilePayload) + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "PRF frame exceeds BIN_FRAME_MAX_SIZE");
+
+/**
+ * Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ *
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @return CRC value
+ */
+uint16_t bin_crc16(const uint8_t* data, size_t len);
+
+/**
+ * COBS-encode a buffer.
+ *
+ * @param src Raw bytes
+ * @param len Number of raw bytes
+ * @param dst Output buffer (at least len + len/254 + 1 bytes)
+ * @return Number of encoded bytes (no delimiter)
+ */
+size_t bin_cobs_encode(const uint8_t* src, size_t len, uint8_t* dst);
+
+/**
+ * COBS-decode a buffer (delimiters already stripped).
+ *
+ * @param src Encoded bytes
+ * @param len Number of encoded bytes
+ * @param dst Output buffer (at least len bytes)
+ * @param dst_size Size of output buffer
+ * @return Number of decoded bytes, or 0 if the encoding is invalid
+ */
+size_t bin_cobs_decode(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_size);
+
+/**
+ * Build a complete wire frame (0x00 + COBS(frame) + 0x00).
+ *
+ * @param type Frame type (BIN_TYPE_*)
+ * @param payload Payload bytes
+ * @param payload_len Payload length
+ * @param out Output buffer (at least BIN_COBS_MAX_SIZE + 2 bytes)
+ * @return Number of bytes to transmit, or 0 if the payload is too large
+ */
+size_t bin_build_frame(uint8_t type, const void* payload, uint8_t payload_len, uint8_t* out);
+
+/**
+ * Build a complete wire frame tagged with a bus address.
+ *
+ * @param type Frame type (BIN_TYPE_*, without BIN_TYPE_ADDRESSED)
+ * @param address Unit address (BUS_ADDR_*)
+ * @param payload Payload bytes
+ * @param payload_len Payload length (without the address byte)
+ * @param out Output buffer (at least BIN_COBS_MAX_SIZE + 2 bytes)
+ * @return Number of bytes to transmit, or 0 if the payload is too large
+ */
+size_t bin_build_addressed_frame(uint8_t type, uint8_t address, const void* payload,
+                                 uint8_t payload_len, uint8_t* out);
+
+/**
+ * Validate a decoded frame's length field and CRC.
+ *
+ * @param frame Decoded frame bytes
+ * @param len Decoded frame length
+ * @return True if the frame is well formed
+ */
+bool bin_frame_valid(const uint8_t* frame, size_t len);
+
+#endif // BINARY_PROTOCOL_H
@@ -0,0 +1,84 @@
+#include "color_utils.h"
+
+// Generated offline: round(65280 * (i / 255)^2.2)
+const uint16_t color_gamma16[256] = {
+        0,     0,     2,     4,     7,    11,    17,    24,
+       32,    42,    53,    65,    78,    94,   110,   128,
+      148,   169,   191,   216,   241,   269,   298,   328,
+      360,   394,   430,   467,   506,   547,   589,   633,
+      679,   726,   776,   827,   880,   934,   991,  1049,
+     1109,  1171,  1235,  1300,  1368,  1437,  1508,  1581,
+     1656,  1733,  1812,  1893,  1975,  2060,  2146,  2235,
+     2325,  2417,  2512,  2608,  2706,  2806,  2908,  3013,
+     3119,  3227,  3337,  3450,  3564,  3680,  3798,  3919,
+     4041,  4166,  4292,  4421,  4552,  4685,  4819,  4956,
+     5096,  5237,  5380,  5525,  5673,  5823,  5974,  6128,
+     6284,  6442,  6603,  6765,  6930,  7097,  7266,  7437,
+     7610,  7786,  7963,  8143,  8325,  8509,  8696,  8885,
+     9075,  9268,  9464,  9661,  9861, 10063, 10267, 10474,
+    10682, 10893, 11107, 11322, 11540, 11760, 11982, 12207,
+    12433, 12663, 12894, 13128, 13363, 13602, 13842, 14085,
+    14330, 14578, 14827, 15080, 15334, 15591, 15850, 16111,
+    16375, 16641, 16909, 17180, 17453, 17729, 18006, 18287,
+    18569, 18854, 19141, 19431, 19723, 20017, 20314, 20613,
+    20915, 21218, 21525, 21833, 22144, 22458, 22774, 23092,
+    23413, 23736, 24062, 24390, 24720, 25053, 25388, 25726,
+    26066, 26408, 26753, 27101, 27451, 27803, 28158, 28515,
+    28875, 29237, 29602, 29969, 30338, 30710, 31085, 31462,
+    31841, 32223, 32608, 32995, 33384, 33776, 34170, 34567,
+    34967, 35369, 35773, 36180, 36589, 37001, 37416, 37833,
+    38252, 38674, 39099, 39526, 39956, 40388, 40823, 41260,
+    41700, 42142, 42587, 43034, 43484, 43937, 44392, 44849,
+    45310, 45772, 46238, 46706, 47176, 47649, 48125, 48603,
+    49084, 49567, 50053, 50542, 51033, 51526, 52023, 52522,
+    53023, 53527, 54034, 54543, 55055, 55570, 56087, 56607,
+    57129, 57654, 58182, 58712, 59245, 59780, 60318, 60859,
+    61402, 61948, 62497, 63048, 63602, 64159, 64718, 65280,
+};
+
+// Generated offline: six linear R/G/B ramps of 256/6 steps each, starting at red
+const uint32_t color_rainbow[256] = {
+    0xFF0000, 0xFF0600, 0xFF0C00, 0xFF1200, 0xFF1800, 0xFF1E00,
+    0xFF2400, 0xFF2A00, 0xFF3000, 0xFF3600, 0xFF3C00, 0xFF4200,
+    0xFF4800, 0xFF4E00, 0xFF5400, 0xFF5A00, 0xFF6000, 0xFF6600,
+    0xFF6C00, 0xFF7200, 0xFF7800, 0xFF7E00, 0xFF8300, 0xFF8900,
+    0xFF8F00, 0xFF9500, 0xFF9B00, 0xFFA100, 0xFFA700, 0xFFAD00,
+    0xFFB300, 0xFFB900, 0xFFBF00, 0xFFC500, 0xFFCB00, 0xFFD100,
+    0xFFD700, 0xFFDD00, 0xFFE300, 0xFFE900, 0xFFEF00, 0xFFF500,
+    0xFFFB00, 0xFDFF00, 0xF7FF00, 0xF1FF00, 0xEBFF00, 0xE5FF00,
+    0xDFFF00, 0xD9FF00, 0xD3FF00, 0xCDFF00, 0xC7FF00, 0xC1FF00,
+    0xBBFF00, 0xB5FF00, 0xAFFF00, 0xA9FF00, 0xA3FF00, 0x9DFF00,
+    0x97FF00, 0x91FF00, 0x8BFF00, 0x85FF00, 0x7FFF00, 0x7AFF00,
+    0x74FF00, 0x6EFF00, 0x68FF00, 0x62FF00, 0x5CFF00, 0x56FF00,
+    0x50FF00, 0x4AFF00, 0x44FF00, 0x3EFF00, 0x38FF00, 0x32FF00,
+    0x2CFF00, 0x26FF00, 0x20FF00, 0x1AFF00, 0x14FF00, 0x0EFF00,
+    0x08FF00, 0x02FF00, 0x00FF04, 0x00FF0A, 0x00FF10, 0x00FF16,
+    0x00FF1C, 0x00FF22, 0x00FF28, 0x00FF2E, 0x00FF34, 0x00FF3A,
+    0x00FF40, 0x00FF46, 0x00FF4C, 0x00FF52, 0x00FF58, 0x00FF5E,
+    0x00FF64, 0x00FF6A, 0x00FF70, 0x00FF76, 0x00FF7C, 0x00FF81,
+    0x00FF87, 0x00FF8D, 0x00FF93, 0x00FF99, 0x00FF9F, 0x00FFA5,
+    0x00FFAB, 0x00FFB1, 0x00FFB7, 0x00FFBD, 0x00FFC3, 0x00FFC9,
+    0x00FFCF, 0x00FFD5, 0x00FFDB, 0x00FFE1, 0x00FFE7, 0x00FFED,
+    0x00FFF3, 0x00FFF9, 0x00FFFF, 0x00F9FF, 0x00F3FF, 0x00EDFF,
+    0x00E7FF, 0x00E1FF, 0x00DBFF, 0x00D5FF, 0x00CFFF, 0x00C9FF,
+    0x00C3FF, 0x00BDFF, 0x00B7FF, 0x00B1FF, 0x00ABFF, 0x00A5FF,
+    0x009FFF, 0x0099FF, 0x0093FF, 0x008DFF, 0x0087FF, 0x0081FF,
+    0x007CFF, 0x0076FF, 0x0070FF, 0x006AFF, 0x0064FF, 0x005EFF,
+    0x0058FF, 0x0052FF, 0x004CFF, 0x0046FF, 0x0040FF, 0x003AFF,
+    0x0034FF, 0x002EFF, 0x0028FF, 0x0022FF, 0x001CFF, 0x0016FF,
+    0x0010FF, 0x000AFF, 0x0004FF, 0x0200FF, 0x0800FF, 0x0E00FF,
+    0x1400FF, 0x1A00FF, 0x2000FF, 0x2600FF, 0x2C00FF, 0x3200FF,
+    0x3800FF, 0x3E00FF, 0x4400FF, 0x4A00FF, 0x5000FF, 0x5600FF,
+    0x5C00FF, 0x6200FF, 0x6800FF, 0x6E00FF, 0x7400FF, 0x7A00FF,
+    0x8000FF, 0x8500FF, 0x8B00FF, 0x9100FF, 0x9700FF, 0x9D00FF,
+    0xA300FF, 0xA900FF, 0xAF00FF, 0xB500FF, 0xBB00FF, 0xC100FF,
+    0xC700FF, 0xCD00FF, 0xD300FF, 0xD900FF, 0xDF00FF, 0xE500FF,
+    0xEB00FF, 0xF100FF, 0xF700FF, 0xFD00FF, 0xFF00FB, 0xFF00F5,
+    0xFF00EF, 0xFF00E9, 0xFF00E3, 0xFF00DD, 0xFF00D7, 0xFF00D1,
+    0xFF00CB, 0xFF00C5, 0xFF00BF, 0xFF00B9, 0xFF00B3, 0xFF00AD,
+    0xFF00A7, 0xFF00A1, 0xFF009B, 0xFF0095, 0xFF008F, 0xFF0089,
+    0xFF0083, 0xFF007E, 0xFF0078, 0xFF0072, 0xFF006C, 0xFF0066,
+    0xFF0060, 0xFF005A, 0xFF0054, 0xFF004E, 0xFF0048, 0xFF0042,
+    0xFF003C, 0xFF0036, 0xFF0030, 0xFF002A, 0xFF0024, 0xFF001E,
+    0xFF0018, 0xFF0012, 0xFF000C, 0xFF0006,
+};
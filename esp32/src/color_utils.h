@@ -2,13 +2,24 @@
 #define COLOR_UTILS_H
 
 #include <Arduino.h>
+#include "config.h"
 
 // =============================================================================
 // Color Utility Functions
 // =============================================================================
-// Shared color interpolation functions for gradient animations.
+// Shared color pipeline for every LED driver: interpolation for gradient
+// animations, a 256-step rainbow table, and the gamma table the outputs
+// (compositor for the NeoPixels, rgb_strip for the PWM strip) apply last.
+// Animated modes work in linear 0-255 values; only output goes through gamma.
 // =============================================================================
 
+// Gamma 2.2 output curve, 8.8 fixed point (0-65280, i.e. 255 << 8 at full).
+// The fraction lets the 8-bit PWM strip dither between adjacent steps.
+extern const uint16_t color_gamma16[256];
+
+// Fully saturated rainbow, 256 hue steps per revolution (0x00RRGGBB)
+extern const uint32_t color_rainbow[256];
+
 /**
  * Linear interpolation between two 8-bit values.
  * @param a Start value
@@ -17,7 +28,8 @@
  * @return Interpolated value
  */
 inline uint8_t lerp8(uint8_t a, uint8_t b, uint8_t t) {
-    return a + (((int16_t)b - a) * t) >> 8;
+    // t + (t >> 7) maps 0-255 onto 0-256, so t = 255 lands exactly on b
+    return (uint8_t)(a + ((((int16_t)b - a) * (t + (t >> 7))) >> 8));
 }
 
 /**
@@ -71,4 +83,27 @@ inline uint8_t gradient_position_to_t(uint16_t position) {
     }
 }
 
+/**
+ * Gamma-correct a channel and scale it by a brightness in one step.
+ * @param value Linear channel value (0-255)
+ * @param brightness Brightness (0-255, 255 = full)
+ * @return Output channel value (0-255)
+ */
+inline uint8_t color_gamma_scale(uint8_t value, uint8_t brightness) {
+#if COLOR_GAMMA_ENABLED
+    return (uint8_t)(((uint32_t)color_gamma16[value] * (brightness + 1) + 0x8000) >> 16);
+#else
+    return (uint8_t)(((uint16_t)value * (brightness + 1)) >> 8);
+#endif
+}
+
+/**
+ * Look up a rainbow color by hue.
+ * @param hue Hue (0-255 = one full revolution)
+ * @return Color (0x00RRGGBB)
+ */
+inline uint32_t color_rainbow_at(uint8_t hue) {
+    return color_rainbow[hue];
+}
+
 #endif // COLOR_UTILS_H
@@ -0,0 +1,192 @@
+#include "compositor.h"
+#include "led_driver.h"
+#include "color_utils.h"
+
+// Per-device framebuffers
+typedef struct {
+    bool attached;
+    uint8_t rmt_channel;
+    uint8_t brightness;
+    uint16_t num_pixels;
+    uint32_t frame[COMPOSITOR_MAX_PIXELS];  // Frame being drawn this tick
+    uint32_t sent[COMPOSITOR_MAX_PIXELS];   // Last frame handed to the driver
+    bool invalid;                           // Push even if the frame is unchanged
+    uint8_t out[COMPOSITOR_MAX_PIXELS * 3]; // `frame` in wire order, before power scaling
+    uint32_t out_sum;                       // Sum of out[] (current estimate units)
+    uint16_t sent_scale;                    // Power scale the last push used
+} CompositorDevice;
+
+static CompositorDevice devices[COMPOSITOR_DEVICE_COUNT];
+
+// Power budget state (see compositor_set_external_load)
+static uint16_t external_load_ma = 0;
+static uint16_t power_scale = COMPOSITOR_POWER_SCALE_FULL;
+
+// Set by compositor_show() when a changed frame could not be pushed yet
+static bool frames_pending = false;
+
+bool compositor_attach(uint8_t device, uint8_t rmt_channel, uint8_t pin,
+                       uint16_t num_pixels, uint8_t brightness) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return false;
+
+    CompositorDevice* dev = &devices[device];
+    dev->rmt_channel = rmt_channel;
+    dev->brightness = brightness;
+    dev->num_pixels = min(num_pixels, (uint16_t)COMPOSITOR_MAX_PIXELS);
+    memset(dev->frame, 0, sizeof(dev->frame));
+    memset(dev->sent, 0, sizeof(dev->sent));
+    dev->invalid = true;  // Clear any random data in LED memory
+    dev->out_sum = 0;
+    dev->sent_scale = COMPOSITOR_POWER_SCALE_FULL;
+    dev->attached = led_driver_init(rmt_channel, pin);
+
+    return dev->attached;
+}
+
+void compositor_set_brightness(uint8_t device, uint8_t brightness) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return;
+
+    devices[device].brightness = brightness;
+    devices[device].invalid = true;
+}
+
+void compositor_set_pixel(uint8_t device, uint16_t index, uint32_t color) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return;
+
+    CompositorDevice* dev = &devices[device];
+    if (index < dev->num_pixels) {
+        dev->frame[index] = color;
+    }
+}
+
+void compositor_fill(uint8_t device, uint32_t color) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return;
+
+    CompositorDevice* dev = &devices[device];
+    for (uint16_t i = 0; i < dev->num_pixels; i++) {
+        dev->frame[i] = color;
+    }
+}
+
+void compositor_blit(uint8_t device, uint32_t mask, uint32_t color) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return;
+
+    // Branch-free: each bit becomes an all-ones or all-zeros color mask
+    CompositorDevice* dev = &devices[device];
+    for (uint16_t i = 0; i < dev->num_pixels; i++) {
+        uint32_t bit = (i < 32) ? (mask >> i) & 1u : 0u;
+        dev->frame[i] = color & (0u - bit);
+    }
+}
+
+void compositor_clear(uint8_t device) {
+    compositor_fill(device, 0);
+}
+
+void compositor_invalidate(uint8_t device) {
+    if (device >= COMPOSITOR_DEVICE_COUNT) return;
+    devices[device].invalid = true;
+}
+
+void compositor_set_external_load(uint16_t ma) {
+    external_load_ma = ma;
+}
+
+uint16_t compositor_power_scale() {
+    return power_scale;
+}
+
+/**
+ * Pick the global scale that keeps the estimated draw within POWER_BUDGET_MA.
+ * Pixel quiescent current can't be dimmed, so only the rest is scaled.
+ */
+static uint16_t compute_power_scale() {
+#if POWER_LIMIT_ENABLED
+    uint32_t units = 0;
+    uint32_t idle_ma = 0;
+    for (uint8_t d = 0; d < COMPOSITOR_DEVICE_COUNT; d++) {
+        if (!devices[d].attached) continue;
+        units += devices[d].out_sum;
+        idle_ma += devices[d].num_pixels * POWER_NEOPIXEL_IDLE_MA;
+    }
+
+    uint32_t dimmable_ma = units * POWER_NEOPIXEL_MA_PER_CHANNEL / 255 + external_load_ma;
+    if (idle_ma + dimmable_ma <= POWER_BUDGET_MA) {
+        return COMPOSITOR_POWER_SCALE_FULL;
+    }
+    if (idle_ma >= POWER_BUDGET_MA) {
+        return 0;
+    }
+    return (uint16_t)((POWER_BUDGET_MA - idle_ma) * COMPOSITOR_POWER_SCALE_FULL / dimmable_ma);
+#else
+    return COMPOSITOR_POWER_SCALE_FULL;
+#endif
+}
+
+uint8_t compositor_show() {
+    uint8_t pushed = 0;
+    frames_pending = false;
+    bool changed[COMPOSITOR_DEVICE_COUNT];
+
+    // Convert changed frames to wire order (GRB) with gamma and brightness
+    // applied, and keep each device's output sum for the current estimate
+    for (uint8_t d = 0; d < COMPOSITOR_DEVICE_COUNT; d++) {
+        CompositorDevice* dev = &devices[d];
+        changed[d] = false;
+        if (!dev->attached) continue;
+
+        size_t bytes = dev->num_pixels * sizeof(uint32_t);
+        changed[d] = dev->invalid || memcmp(dev->frame, dev->sent, bytes) != 0;
+        if (!changed[d]) continue;
+
+        uint32_t sum = 0;
+        for (uint16_t i = 0; i < dev->num_pixels; i++) {
+            uint32_t c = dev->frame[i];
+            dev->out[i * 3 + 0] = color_gamma_scale((uint8_t)(c >> 8), dev->brightness);
+            dev->out[i * 3 + 1] = color_gamma_scale((uint8_t)(c >> 16), dev->brightness);
+            dev->out[i * 3 + 2] = color_gamma_scale((uint8_t)c, dev->brightness);
+            sum += dev->out[i * 3 + 0] + dev->out[i * 3 + 1] + dev->out[i * 3 + 2];
+        }
+        dev->out_sum = sum;
+    }
+
+    // One scale for every output, so the supply budget holds across devices
+    power_scale = compute_power_scale();
+
+    for (uint8_t d = 0; d < COMPOSITOR_DEVICE_COUNT; d++) {
+        CompositorDevice* dev = &devices[d];
+        if (!dev->attached) continue;
+        if (!changed[d] && dev->sent_scale == power_scale) continue;
+
+        // Previous frame still on the wire - keep this one pending
+        if (led_driver_busy(dev->rmt_channel)) {
+            frames_pending = true;
+            continue;
+        }
+
+        uint8_t grb[COMPOSITOR_MAX_PIXELS * 3];
+        size_t len = dev->num_pixels * 3;
+        if (power_scale < COMPOSITOR_POWER_SCALE_FULL) {
+            for (size_t i = 0; i < len; i++) {
+                grb[i] = (uint8_t)((dev->out[i] * power_scale) >> 8);
+            }
+        } else {
+            memcpy(grb, dev->out, len);
+        }
+
+        if (led_driver_write(dev->rmt_channel, grb, len)) {
+            memcpy(dev->sent, dev->frame, dev->num_pixels * sizeof(uint32_t));
+            dev->invalid = false;
+            dev->sent_scale = power_scale;
+            pushed++;
+        } else {
+            frames_pending = true;
+        }
+    }
+
+    return pushed;
+}
+
+bool compositor_pending() {
+    return frames_pending;
+}
@@ -0,0 +1,140 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// LED Frame Compositor
+// =============================================================================
+// Owns one framebuffer per NeoPixel device. Effect modules draw into the
+// framebuffer every tick; compositor_show() diffs each frame against the last
+// one pushed and hands only changed frames to the RMT driver (led_driver.h),
+// which transmits them in the background.
+//
+// A device whose previous frame is still on the wire keeps its new frame
+// pending and is retried on the next tick.
+//
+// Power budget: each show estimates the 5V draw of every framebuffer plus
+// the load reported with compositor_set_external_load() (the RGB strip). If
+// it exceeds POWER_BUDGET_MA, all outputs are dimmed by one common scale,
+// which the external load's owner applies too (compositor_power_scale()).
+// =============================================================================
+
+// Devices
+#define COMPOSITOR_NPM          0       // NeoPixel 5x5 matrix
+#define COMPOSITOR_NPR          1       // NeoPixel ring
+#define COMPOSITOR_DEVICE_COUNT 2
+
+// Largest device (pixels per framebuffer)
+#define COMPOSITOR_MAX_PIXELS   25
+
+// Power scale for outputs within budget (scales are 0-256, applied as x * s >> 8)
+#define COMPOSITOR_POWER_SCALE_FULL 256
+
+static_assert(COMPOSITOR_MAX_PIXELS <= LED_DRIVER_MAX_PIXELS,
+              "Compositor frames must fit the LED driver buffer");
+
+/**
+ * Pack an RGB color for the framebuffer (0x00RRGGBB).
+ */
+inline uint32_t compositor_color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+/**
+ * Attach a compositor device to a NeoPixel strip on an RMT channel.
+ * The first compositor_show() pushes an all-off frame.
+ *
+ * @param device COMPOSITOR_* device
+ * @param rmt_channel RMT channel for the strip
+ * @param pin Data GPIO
+ * @param num_pixels Number of pixels (at most COMPOSITOR_MAX_PIXELS)
+ * @param brightness Global brightness (0-255)
+ * @return True if the LED driver channel was installed
+ */
+bool compositor_attach(uint8_t device, uint8_t rmt_channel, uint8_t pin,
+                       uint16_t num_pixels, uint8_t brightness);
+
+/**
+ * Set a device's global brightness (forces the next push).
+ *
+ * @param device COMPOSITOR_* device
+ * @param brightness Brightness (0-255)
+ */
+void compositor_set_brightness(uint8_t device, uint8_t brightness);
+
+/**
+ * Set one pixel in a device's framebuffer.
+ *
+ * @param device COMPOSITOR_* device
+ * @param index Pixel index
+ * @param color Packed color (compositor_color)
+ */
+void compositor_set_pixel(uint8_t device, uint16_t index, uint32_t color);
+
+/**
+ * Fill a device's framebuffer with one color.
+ *
+ * @param device COMPOSITOR_* device
+ * @param color Packed color (compositor_color)
+ */
+void compositor_fill(uint8_t device, uint32_t color);
+
+/**
+ * Draw a 1-bit mask over a device's whole framebuffer: pixel i takes the
+ * color if bit i is set and is turned off otherwise (pixels past 31 too).
+ *
+ * @param device COMPOSITOR_* device
+ * @param mask Pixel mask, bit i = pixel i
+ * @param color Packed color (compositor_color)
+ */
+void compositor_blit(uint8_t device, uint32_t mask, uint32_t color);
+
+/**
+ * Clear a device's framebuffer (all pixels off).
+ *
+ * @param device COMPOSITOR_* device
+ */
+void compositor_clear(uint8_t device);
+
+/**
+ * Force the next compositor_show() to push a device.
+ *
+ * @param device COMPOSITOR_* device
+ */
+void compositor_invalidate(uint8_t device);
+
+/**
+ * Start transmitting every device whose frame changed since the last push.
+ * Call once per animation tick, after all effects have drawn. Never waits
+ * for the LEDs.
+ *
+ * @return Number of devices pushed
+ */
+uint8_t compositor_show();
+
+/**
+ * Whether the last compositor_show() left a changed frame unsent (its
+ * device was still transmitting). Call compositor_show() again next tick.
+ *
+ * @return True if a frame is pending
+ */
+bool compositor_pending();
+
+/**
+ * Report current drawn by outputs outside the compositor, at their demanded
+ * (unscaled) levels. Used by the next compositor_show().
+ *
+ * @param ma Estimated current in mA
+ */
+void compositor_set_external_load(uint16_t ma);
+
+/**
+ * Global power scale chosen by the last compositor_show().
+ *
+ * @return Scale (0-COMPOSITOR_POWER_SCALE_FULL)
+ */
+uint16_t compositor_power_scale();
+
+#endif // COMPOSITOR_H
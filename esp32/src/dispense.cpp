@@ -0,0 +1,209 @@
+#include "dispense.h"
+#include "param_store.h"
+#include "pins.h"
+
+// Flow curve: fraction of full flow at evenly spaced valve angles, from
+// VALVE_CLOSED_ANGLE to VALVE_OPEN_ANGLE. Calibrate by timing pours at a few
+// fixed openings; PARAM_FLOW_ML_PER_S scales the whole curve.
+static const float FLOW_CURVE[] = {0.0f, 0.15f, 0.5f, 0.85f, 1.0f};
+#define FLOW_CURVE_POINTS (sizeof(FLOW_CURVE) / sizeof(FLOW_CURVE[0]))
+#define FLOW_CURVE_STEP ((VALVE_OPEN_ANGLE - VALVE_CLOSED_ANGLE) / (FLOW_CURVE_POINTS - 1))
+
+// Area under the curve from closed up to each point (fraction x degrees),
+// filled in by dispense_init()
+static float curve_area[FLOW_CURVE_POINTS];
+
+#if FLOW_SENSOR_ENABLED
+static volatile uint32_t flow_pulses = 0;
+
+static void IRAM_ATTR flow_sensor_isr() {
+    flow_pulses++;
+}
+#endif
+
+// Position on the curve: segment index and fraction into it
+static void curve_locate(float valve_angle, size_t* seg, float* frac) {
+    float x = (valve_angle - VALVE_CLOSED_ANGLE) / FLOW_CURVE_STEP;
+    if (x <= 0.0f) {
+        *seg = 0;
+        *frac = 0.0f;
+    } else if (x >= FLOW_CURVE_POINTS - 1) {
+        *seg = FLOW_CURVE_POINTS - 2;
+        *frac = 1.0f;
+    } else {
+        *seg = (size_t)x;
+        *frac = x - *seg;
+    }
+}
+
+static uint32_t pulse_count() {
+#if FLOW_SENSOR_ENABLED
+    return flow_pulses;
+#else
+    return 0;
+#endif
+}
+
+static bool metered() {
+    return FLOW_SENSOR_ENABLED && g_params.flow_pulses_per_l > 0;
+}
+
+static void finish(DispenseState* state, uint8_t reason) {
+    state->phase = DISPENSE_IDLE;
+    state->end_reason = reason;
+    state->duration_ms = (state->start_ms != 0) ? millis() - state->start_ms : 0;
+    state->seq++;
+
+    DEBUG_PRINTF("Pour done: %.1f of %.1f ml, reason %d\n",
+                 state->poured_ml, state->target_ml, reason);
+}
+
+// Close the valve and count the tail until it is shut
+static void begin_close(DispenseState* state, ValveState* valve, uint8_t reason) {
+    valve_safety_set_command(valve, false);
+    state->end_reason = reason;
+    state->phase = DISPENSE_CLOSING;
+}
+
+void dispense_init(DispenseState* state) {
+    state->phase = DISPENSE_IDLE;
+    state->end_reason = DISPENSE_END_TARGET;
+    state->seq = 0;
+    state->target_ml = 0.0f;
+    state->poured_ml = 0.0f;
+    state->start_ms = 0;
+    state->duration_ms = 0;
+    state->pulse_start = 0;
+    state->last_angle = VALVE_CLOSED_ANGLE;
+
+    // Trapezoid areas of the piecewise-linear curve
+    curve_area[0] = 0.0f;
+    for (size_t i = 1; i < FLOW_CURVE_POINTS; i++) {
+        curve_area[i] = curve_area[i - 1] +
+                        0.5f * (FLOW_CURVE[i - 1] + FLOW_CURVE[i]) * FLOW_CURVE_STEP;
+    }
+
+#if FLOW_SENSOR_ENABLED
+    // Open-collector hall meters pull the line low once per pulse
+    pinMode(FLOW_SENSOR_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(FLOW_SENSOR_PIN), flow_sensor_isr, FALLING);
+    DEBUG_PRINTLN("Flow sensor initialized");
+#endif
+}
+
+void dispense_start(DispenseState* state, ValveState* valve, float target_ml) {
+    if (target_ml > DISPENSE_MAX_ML) target_ml = DISPENSE_MAX_ML;
+
+    state->phase = DISPENSE_WAITING;
+    state->target_ml = target_ml;
+    state->poured_ml = 0.0f;
+    state->start_ms = 0;
+    state->pulse_start = pulse_count();
+
+    // Opens through the safety module, so the cooldown still holds it back
+    valve_safety_set_command(valve, true);
+
+    DEBUG_PRINTF("Pour: %.1f ml\n", target_ml);
+}
+
+void dispense_cancel(DispenseState* state, ValveState* valve) {
+    if (state->phase == DISPENSE_WAITING) {
+        // Never opened: nothing to drain
+        valve_safety_set_command(valve, false);
+        finish(state, DISPENSE_END_CANCEL);
+    } else if (state->phase == DISPENSE_POURING) {
+        begin_close(state, valve, DISPENSE_END_CANCEL);
+    } else if (state->phase == DISPENSE_CLOSING) {
+        // Already closing for its own reason: stop counting now, so flow
+        // from a manual reopen is not added to this pour
+        finish(state, state->end_reason);
+    }
+}
+
+bool dispense_update(DispenseState* state, ValveState* valve, float valve_angle,
+                     float dt, bool connected) {
+    if (state->phase == DISPENSE_IDLE) return false;
+
+    if (state->phase == DISPENSE_WAITING) {
+        if (!connected) {
+            // Do not leave the command latched for when the link comes back
+            valve_safety_set_command(valve, false);
+            finish(state, DISPENSE_END_LINK);
+            return true;
+        }
+        if (!valve->actual_open) return false;
+
+        state->phase = DISPENSE_POURING;
+        state->start_ms = millis();
+        state->last_angle = valve_angle;
+    }
+
+    // Still swinging open on a short pour: the close has to reverse it first
+    float opening_dps = (dt > 0.0f) ? (valve_angle - state->last_angle) / dt : 0.0f;
+    state->last_angle = valve_angle;
+
+    // Volume through the valve since the last tick
+    if (metered()) {
+        uint32_t pulses = pulse_count() - state->pulse_start;
+        state->poured_ml = pulses * 1000.0f / g_params.flow_pulses_per_l;
+    } else {
+        state->poured_ml += dispense_flow_ml_per_s(valve_angle) * dt;
+    }
+
+    if (state->phase == DISPENSE_POURING) {
+        if (!valve->actual_open) {
+            // valve_safety closed it: max-open timeout or connection loss
+            uint8_t reason = connected ? DISPENSE_END_SAFETY : DISPENSE_END_LINK;
+            begin_close(state, valve, reason);
+        } else if (!connected) {
+            begin_close(state, valve, DISPENSE_END_LINK);
+        } else if (state->poured_ml + dispense_close_ml(valve_angle, opening_dps) >=
+                   state->target_ml) {
+            begin_close(state, valve, DISPENSE_END_TARGET);
+        }
+        return false;
+    }
+
+    // DISPENSE_CLOSING: done once the valve is back on its seat
+    if (valve_angle <= VALVE_CLOSED_ANGLE) {
+        finish(state, state->end_reason);
+        return true;
+    }
+    return false;
+}
+
+bool dispense_is_active(const DispenseState* state) {
+    return state->phase != DISPENSE_IDLE;
+}
+
+float dispense_flow_ml_per_s(float valve_angle) {
+    size_t seg;
+    float frac;
+    curve_locate(valve_angle, &seg, &frac);
+
+    float fraction = FLOW_CURVE[seg] + (FLOW_CURVE[seg + 1] - FLOW_CURVE[seg]) * frac;
+    return fraction * g_params.flow_ml_per_s;
+}
+
+float dispense_close_ml(float valve_angle, float opening_dps) {
+    // An opening valve first brakes to a stop, flowing at about the current rate
+    float brake_ml = 0.0f;
+    if (opening_dps > 0.0f) {
+        float brake_s = opening_dps / VALVE_MAX_ACCEL_DPS2;
+        brake_ml = dispense_flow_ml_per_s(valve_angle) * brake_s;
+        valve_angle += 0.5f * opening_dps * brake_s;
+    }
+
+    size_t seg;
+    float frac;
+    curve_locate(valve_angle, &seg, &frac);
+
+    // Area from closed to the angle (fraction x degrees)
+    float f_angle = FLOW_CURVE[seg] + (FLOW_CURVE[seg + 1] - FLOW_CURVE[seg]) * frac;
+    float area = curve_area[seg] + 0.5f * (FLOW_CURVE[seg] + f_angle) * frac * FLOW_CURVE_STEP;
+
+    // Stroke at full closing speed, plus the time lost accelerating from rest
+    float stroke_s = area / VALVE_MAX_VELOCITY_DPS;
+    float spin_up_s = f_angle * VALVE_MAX_VELOCITY_DPS / (2.0f * VALVE_MAX_ACCEL_DPS2);
+    return brake_ml + (stroke_s + spin_up_s) * g_params.flow_ml_per_s;
+}
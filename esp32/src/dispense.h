@@ -0,0 +1,124 @@
+#ifndef DISPENSE_H
+#define DISPENSE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "valve_safety.h"
+
+// =============================================================================
+// Dispense Module
+// =============================================================================
+// Metered pours: the Pi asks for a volume ($POR), the control task opens the
+// valve and closes it locally once the poured volume reaches the target, so
+// pour accuracy no longer depends on Pi scheduling or UART latency.
+//
+// The poured volume is integrated every control tick from the valve servo's
+// actual angle through a calibrated flow curve (flow fraction against angle,
+// times PARAM_FLOW_ML_PER_S). With FLOW_SENSOR_ENABLED and a non-zero
+// PARAM_FLOW_PULSES_PER_L, the pulse count of a flow meter replaces the model.
+// The valve takes about a second to swing shut, so the close is issued early
+// by the volume the curve predicts for the closing stroke.
+//
+// The pour drives the valve through valve_safety, so the max-open auto-close,
+// cooldown and connection-loss close all still apply; they end the pour early
+// with DISPENSE_END_SAFETY / DISPENSE_END_LINK.
+// =============================================================================
+
+// Dispense settings (flow rate and meter calibration are the defaults of
+// PARAM_FLOW_ML_PER_S / PARAM_FLOW_PULSES_PER_L, see param_store.h)
+#define DISPENSE_FLOW_ML_PER_S 25.0f    // Flow with the valve fully open
+#define DISPENSE_PULSES_PER_L 0         // Flow meter pulses per litre (0 = use the curve)
+#define DISPENSE_MAX_ML 1000.0f         // Largest pour accepted
+
+// Pour phases
+#define DISPENSE_IDLE       0   // No pour
+#define DISPENSE_WAITING    1   // Valve commanded open, held by the cooldown
+#define DISPENSE_POURING    2   // Valve open, volume integrating
+#define DISPENSE_CLOSING    3   // Close issued, counting the tail until shut
+
+// Why a pour ended
+#define DISPENSE_END_TARGET 0   // Target volume reached
+#define DISPENSE_END_CANCEL 1   // $POR,0 or a $VLV took the valve over
+#define DISPENSE_END_SAFETY 2   // Max-open auto-close
+#define DISPENSE_END_LINK   3   // Pi connection lost
+
+// Pour state (control task only)
+typedef struct {
+    uint8_t phase;          // DISPENSE_*
+    uint8_t end_reason;     // DISPENSE_END_* of the last finished pour
+    uint8_t seq;            // Incremented when a pour finishes
+    float target_ml;        // Requested volume
+    float poured_ml;        // Volume so far (whole pour, including the tail)
+    uint32_t start_ms;      // When the valve opened for this pour
+    uint32_t duration_ms;   // Valve open to shut, of the last finished pour
+    uint32_t pulse_start;   // Flow meter count when the pour was requested
+    float last_angle;       // Valve angle at the previous update
+} DispenseState;
+
+/**
+ * Initialize the dispense module (and the flow meter input, if enabled).
+ *
+ * @param state Pointer to dispense state structure
+ */
+void dispense_init(DispenseState* state);
+
+/**
+ * Start a metered pour. Replaces any pour in progress.
+ *
+ * @param state Pointer to dispense state
+ * @param valve Valve the pour drives
+ * @param target_ml Volume to pour (clamped to DISPENSE_MAX_ML)
+ */
+void dispense_start(DispenseState* state, ValveState* valve, float target_ml);
+
+/**
+ * Stop the pour in progress: close the valve and finish with DISPENSE_END_CANCEL.
+ * A pour already closing finishes at once with its own end reason, without
+ * the tail still draining. No effect when no pour is active.
+ *
+ * @param state Pointer to dispense state
+ * @param valve Valve the pour drives
+ */
+void dispense_cancel(DispenseState* state, ValveState* valve);
+
+/**
+ * Integrate the last control step and close the valve when the target is due.
+ * Call every control tick before valve_safety_update(), so a close takes
+ * effect on the same tick.
+ *
+ * @param state Pointer to dispense state
+ * @param valve Valve the pour drives
+ * @param valve_angle Current valve servo angle (degrees)
+ * @param dt Time since the previous call (seconds)
+ * @param connected True if Pi connection is active
+ * @return True if a pour finished on this call
+ */
+bool dispense_update(DispenseState* state, ValveState* valve, float valve_angle,
+                     float dt, bool connected);
+
+/**
+ * Check if a pour is in progress.
+ *
+ * @param state Pointer to dispense state
+ * @return True unless idle
+ */
+bool dispense_is_active(const DispenseState* state);
+
+/**
+ * Flow predicted by the curve at a valve angle.
+ *
+ * @param valve_angle Valve servo angle (degrees)
+ * @return Flow in ml/s
+ */
+float dispense_flow_ml_per_s(float valve_angle);
+
+/**
+ * Volume the curve predicts for closing the valve from an angle.
+ *
+ * @param valve_angle Valve servo angle (degrees)
+ * @param opening_dps Valve speed toward open (degrees/second, 0 if not opening)
+ * @return Volume in ml
+ */
+float dispense_close_ml(float valve_angle, float opening_dps);
+
+#endif // DISPENSE_H
@@ -0,0 +1,68 @@
+#include "effects.h"
+
+// Restart every animation from its first frame
+static void fx_restart(FxState* fx) {
+    fx->gradient_position = 0;
+    fx->hue = 0;
+    fx->step = 0;
+    fx->last_step_ms = millis();
+    fx->breathe_level = 0;
+    fx->breathe_direction = 1;
+}
+
+void fx_state_init(FxState* fx, FxRenderFn render, void* owner) {
+    fx->render = render;
+    fx->owner = owner;
+    fx->r = 0;  // OFF - no color
+    fx->g = 0;
+    fx->b = 0;
+    fx->r2 = 0;
+    fx->g2 = 0;
+    fx->b2 = 0;
+    fx->gradient_speed = 10;
+    fx->dirty = true;
+    fx->frame_ms = FX_STATIC;
+    fx->next_frame_ms = 0;
+    fx_restart(fx);
+}
+
+void fx_select(FxState* fx, FxRenderFn render) {
+    if (fx->render == render) return;
+
+    fx->render = render;
+    fx->dirty = true;
+    fx_restart(fx);
+}
+
+void fx_set_colors(FxState* fx, uint8_t r, uint8_t g, uint8_t b,
+                   uint8_t r2, uint8_t g2, uint8_t b2, uint8_t speed) {
+    speed = (speed > 0) ? speed : 1;  // Ensure minimum speed of 1
+    if (r != fx->r || g != fx->g || b != fx->b ||
+        r2 != fx->r2 || g2 != fx->g2 || b2 != fx->b2 || speed != fx->gradient_speed) {
+        fx->dirty = true;
+    }
+
+    fx->r = r;
+    fx->g = g;
+    fx->b = b;
+    fx->r2 = r2;
+    fx->g2 = g2;
+    fx->b2 = b2;
+    fx->gradient_speed = speed;
+}
+
+void fx_render(FxState* fx, uint32_t now_ms) {
+    // Cleared first: a change made while this frame draws asks for another
+    fx->dirty = false;
+    fx->frame_ms = (fx->render != nullptr) ? fx->render(fx, now_ms) : FX_STATIC;
+    fx->next_frame_ms = now_ms + fx->frame_ms;
+}
+
+uint32_t fx_frame_wait_ms(const FxState* fx, uint32_t now_ms) {
+    if (fx->dirty) return 0;
+    if (fx->frame_ms == FX_STATIC) return ANIMATION_WAIT_IDLE;
+
+    // Signed, so a deadline already passed reads as due
+    int32_t wait = (int32_t)(fx->next_frame_ms - now_ms);
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
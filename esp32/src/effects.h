@@ -0,0 +1,268 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "color_utils.h"
+#include "compositor.h"
+#include "param_store.h"
+
+// =============================================================================
+// LED Effect Library
+// =============================================================================
+// Animated and static effects shared by every LED output (NeoPixel matrix,
+// ring and the PWM RGB strip). Each effect is a template on a device type
+// that supplies the pixel count and drawing calls at compile time:
+//
+//     struct MyDevice {
+//         static const uint16_t PIXELS = 8;
+//         static const uint16_t RAINBOW_STEP = 3 << 8;    // Hue steps per tick (8.8)
+//         static void fill(uint32_t color);
+//         static void set_pixel(uint16_t index, uint32_t color);
+//     };
+//
+// A device module lists fx_*<MyDevice> in a table indexed by its own mode
+// numbers and looks the mode up once, in its *_set_mode(). Every frame just
+// calls the selected FxRenderFn, so there is no per-frame mode switch and any
+// device can run any effect.
+//
+// Each render returns how long its frame stays current, which becomes the
+// device's next-frame deadline (fx_frame_wait_ms()): static effects return
+// FX_STATIC and are only redrawn when their mode or colors change, per-tick
+// animations return the animation period, timed ones the time to their next
+// step.
+//
+// Colors, gradient speed and all animation state live in one FxState per
+// device. Effects work in linear 0-255 values; output gamma is applied by
+// the compositor / rgb_strip as before.
+// =============================================================================
+
+// Animation timing (shared by every device)
+#define FX_BREATHE_STEP     10      // Breathe level change per tick
+#define FX_CHASE_STEP_MS    100     // Chase: ms per pixel
+#define FX_SPINNER_STEP_MS  50      // Spinner: ms per pixel
+
+// Smallest gradient step per frame: slower gradients take this step less
+// often instead of redrawing near-identical frames every tick
+#define FX_GRADIENT_MIN_STEP 3
+
+// Frame interval of a static effect (redrawn only when it changes)
+#define FX_STATIC           0
+
+struct FxState;
+
+/**
+ * Draw one frame of an effect.
+ *
+ * @param fx Effect state of the device
+ * @param now_ms Current time (millis())
+ * @return Milliseconds until the next frame is due, or FX_STATIC
+ */
+typedef uint16_t (*FxRenderFn)(FxState* fx, uint32_t now_ms);
+
+// Effect state (one per device)
+struct FxState {
+    FxRenderFn render;              // Selected effect (set by fx_select)
+    void* owner;                    // Device state, for device-specific effects
+
+    volatile bool dirty;            // Mode or colors changed since the last frame
+    uint16_t frame_ms;              // Interval the last frame asked for (FX_STATIC = none)
+    uint32_t next_frame_ms;         // Deadline of the next frame
+
+    uint8_t r, g, b;                // Primary color
+    uint8_t r2, g2, b2;             // Second color for gradient
+    uint8_t gradient_speed;         // Gradient step per tick (1-50)
+    uint16_t gradient_position;     // Gradient ping-pong position (0-510)
+
+    uint16_t hue;                   // Rainbow hue (8.8, 256 steps = one revolution)
+    uint16_t step;                  // Chase / spinner position
+    uint32_t last_step_ms;          // Chase / spinner timing
+    uint8_t breathe_level;          // Breathe level (0-255)
+    int8_t breathe_direction;       // 1 = brightening, -1 = dimming
+};
+
+/**
+ * Initialize an effect state (black, running the given effect).
+ *
+ * @param fx State to initialize
+ * @param render Initial effect
+ * @param owner Device state passed through to device-specific effects
+ */
+void fx_state_init(FxState* fx, FxRenderFn render, void* owner);
+
+/**
+ * Select an effect. Restarts the animation (and marks the state dirty) if
+ * it differs from the current one.
+ *
+ * @param fx Effect state
+ * @param render Effect to run (nullptr draws nothing)
+ */
+void fx_select(FxState* fx, FxRenderFn render);
+
+/**
+ * Set the effect colors and gradient speed (marks the state dirty if any
+ * of them changed).
+ *
+ * @param fx Effect state
+ * @param r,g,b Primary color
+ * @param r2,g2,b2 Gradient second color
+ * @param speed Gradient speed (0 is treated as 1)
+ */
+void fx_set_colors(FxState* fx, uint8_t r, uint8_t g, uint8_t b,
+                   uint8_t r2, uint8_t g2, uint8_t b2, uint8_t speed);
+
+/**
+ * Draw the selected effect now and set the next-frame deadline.
+ *
+ * @param fx Effect state
+ * @param now_ms Current time (millis())
+ */
+void fx_render(FxState* fx, uint32_t now_ms);
+
+/**
+ * Time until the next frame of an effect is due.
+ *
+ * @param fx Effect state
+ * @param now_ms Current time (millis())
+ * @return Milliseconds (0 = due now), or ANIMATION_WAIT_IDLE for a static
+ *         frame that is up to date
+ */
+uint32_t fx_frame_wait_ms(const FxState* fx, uint32_t now_ms);
+
+// Frame interval of the per-tick animations (the fastest frame rate)
+inline uint16_t fx_tick_ms() {
+    return g_params.animation_period_ms;
+}
+
+// Primary color, packed
+inline uint32_t fx_color(const FxState* fx) {
+    return compositor_color(fx->r, fx->g, fx->b);
+}
+
+/**
+ * Advance a timed step counter once its interval has passed.
+ *
+ * @return Milliseconds until the following step
+ */
+inline uint16_t fx_step(FxState* fx, uint32_t now_ms, uint16_t interval_ms) {
+    uint32_t elapsed = now_ms - fx->last_step_ms;
+    if (elapsed >= interval_ms) {
+        fx->last_step_ms = now_ms;
+        fx->step++;
+        return interval_ms;
+    }
+    return (uint16_t)(interval_ms - elapsed);
+}
+
+// =============================================================================
+// Effects
+// =============================================================================
+
+// All pixels off
+template <typename Device>
+uint16_t fx_off(FxState* fx, uint32_t now_ms) {
+    Device::fill(0);
+    return FX_STATIC;
+}
+
+// Primary color on every pixel
+template <typename Device>
+uint16_t fx_solid(FxState* fx, uint32_t now_ms) {
+    Device::fill(fx_color(fx));
+    return FX_STATIC;
+}
+
+// Ping-pong between the two colors at gradient_speed positions per tick.
+// Speeds below FX_GRADIENT_MIN_STEP take bigger steps at a lower frame rate.
+template <typename Device>
+uint16_t fx_gradient(FxState* fx, uint32_t now_ms) {
+    uint8_t t = gradient_position_to_t(fx->gradient_position);
+
+    uint8_t r, g, b;
+    gradient_color(t, fx->r, fx->g, fx->b, fx->r2, fx->g2, fx->b2, &r, &g, &b);
+    Device::fill(compositor_color(r, g, b));
+
+    // Nothing to animate between two equal colors
+    if (fx->r == fx->r2 && fx->g == fx->g2 && fx->b == fx->b2) return FX_STATIC;
+
+    uint8_t step = (fx->gradient_speed < FX_GRADIENT_MIN_STEP) ? FX_GRADIENT_MIN_STEP : fx->gradient_speed;
+    fx->gradient_position = gradient_advance_pingpong(fx->gradient_position, step);
+    return (uint16_t)((uint32_t)fx_tick_ms() * step / fx->gradient_speed);
+}
+
+// Rainbow spread over the pixels (one revolution), turning RAINBOW_STEP per tick
+template <typename Device>
+uint16_t fx_rainbow(FxState* fx, uint32_t now_ms) {
+    uint8_t base = (uint8_t)(fx->hue >> 8);
+    for (uint16_t i = 0; i < Device::PIXELS; i++) {
+        Device::set_pixel(i, color_rainbow_at((uint8_t)(base + i * 256 / Device::PIXELS)));
+    }
+    fx->hue += Device::RAINBOW_STEP;
+    return fx_tick_ms();
+}
+
+// Primary color fading in and out (linear ramp; output gamma makes it look even)
+template <typename Device>
+uint16_t fx_breathe(FxState* fx, uint32_t now_ms) {
+    // Step in int16 so the ramp can't wrap past 255
+    int16_t level = fx->breathe_level + fx->breathe_direction * FX_BREATHE_STEP;
+    if (level >= 255) {
+        level = 255;
+        fx->breathe_direction = -1;
+    } else if (level <= 0) {
+        level = 0;
+        fx->breathe_direction = 1;
+    }
+    fx->breathe_level = (uint8_t)level;
+
+    Device::fill(compositor_color((fx->r * fx->breathe_level) / 255,
+                                  (fx->g * fx->breathe_level) / 255,
+                                  (fx->b * fx->breathe_level) / 255));
+    return fx_tick_ms();
+}
+
+// One lit pixel stepping along the device
+template <typename Device>
+uint16_t fx_chase(FxState* fx, uint32_t now_ms) {
+    uint16_t wait = fx_step(fx, now_ms, FX_CHASE_STEP_MS);
+    Device::fill(0);
+    Device::set_pixel(fx->step % Device::PIXELS, fx_color(fx));
+    return wait;
+}
+
+// Two opposite lit pixels spinning around the device
+template <typename Device>
+uint16_t fx_spinner(FxState* fx, uint32_t now_ms) {
+    uint16_t wait = fx_step(fx, now_ms, FX_SPINNER_STEP_MS);
+    uint16_t pos = fx->step % Device::PIXELS;
+    uint32_t color = fx_color(fx);
+    Device::fill(0);
+    Device::set_pixel(pos, color);
+    Device::set_pixel((pos + Device::PIXELS / 2) % Device::PIXELS, color);
+    return wait;
+}
+
+// =============================================================================
+// Compositor Devices
+// =============================================================================
+
+/**
+ * Device type for a NeoPixel strip drawn through the compositor.
+ *
+ * @tparam DEVICE COMPOSITOR_* device
+ * @tparam NUM_PIXELS Pixels on the strip
+ * @tparam RAINBOW_HUE_STEP Rainbow speed (8.8 hue steps per tick)
+ */
+template <uint8_t DEVICE, uint16_t NUM_PIXELS, uint16_t RAINBOW_HUE_STEP>
+struct FxCompositorDevice {
+    static_assert(NUM_PIXELS > 0 && NUM_PIXELS <= COMPOSITOR_MAX_PIXELS,
+                  "Effect device does not fit a compositor framebuffer");
+
+    static const uint16_t PIXELS = NUM_PIXELS;
+    static const uint16_t RAINBOW_STEP = RAINBOW_HUE_STEP;
+
+    static void fill(uint32_t color) { compositor_fill(DEVICE, color); }
+    static void set_pixel(uint16_t index, uint32_t color) { compositor_set_pixel(DEVICE, index, color); }
+};
+
+#endif // EFFECTS_H
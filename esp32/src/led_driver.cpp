@@ -0,0 +1,119 @@
+#include "led_driver.h"
+#include "driver/rmt.h"
+
+// WS2812 bit timings in RMT ticks (25 ns at LED_RMT_CLK_DIV = 2)
+#define WS2812_T0H_NS   400
+#define WS2812_T0L_NS   850
+#define WS2812_T1H_NS   800
+#define WS2812_T1L_NS   450
+#define WS2812_TICK_NS  (LED_RMT_CLK_DIV * 1000 / 80)
+
+typedef struct {
+    bool installed;
+    volatile bool busy;
+    volatile uint32_t frames_done;
+    uint8_t buffer[LED_DRIVER_MAX_PIXELS * 3];  // Must stay valid while transmitting
+} LedChannel;
+
+static LedChannel channels[LED_DRIVER_MAX_CHANNELS];
+
+// RMT items for a 0 and a 1 bit, built once at init
+static rmt_item32_t ws2812_bit0;
+static rmt_item32_t ws2812_bit1;
+
+static bool callback_registered = false;
+
+// Translate pixel bytes to RMT items (runs in the RMT ISR while refilling)
+static void IRAM_ATTR ws2812_translate(const void* src, rmt_item32_t* dest, size_t src_size,
+                                       size_t wanted_num, size_t* translated_size, size_t* item_num) {
+    if (src == NULL || dest == NULL) {
+        *translated_size = 0;
+        *item_num = 0;
+        return;
+    }
+
+    const uint8_t* in = (const uint8_t*)src;
+    size_t size = 0;
+    size_t num = 0;
+
+    while (size < src_size && num + 8 <= wanted_num) {
+        uint8_t byte = in[size];
+        for (int bit = 7; bit >= 0; bit--) {
+            dest[num++].val = (byte & (1 << bit)) ? ws2812_bit1.val : ws2812_bit0.val;
+        }
+        size++;
+    }
+
+    *translated_size = size;
+    *item_num = num;
+}
+
+// Frame done (RMT tx-end interrupt)
+static void IRAM_ATTR ws2812_tx_end(rmt_channel_t channel, void* arg) {
+    if (channel < LED_DRIVER_MAX_CHANNELS) {
+        channels[channel].busy = false;
+        channels[channel].frames_done++;
+    }
+}
+
+bool led_driver_init(uint8_t channel, uint8_t pin) {
+    if (channel >= LED_DRIVER_MAX_CHANNELS) return false;
+
+    ws2812_bit0.duration0 = WS2812_T0H_NS / WS2812_TICK_NS;
+    ws2812_bit0.level0 = 1;
+    ws2812_bit0.duration1 = WS2812_T0L_NS / WS2812_TICK_NS;
+    ws2812_bit0.level1 = 0;
+    ws2812_bit1.duration0 = WS2812_T1H_NS / WS2812_TICK_NS;
+    ws2812_bit1.level0 = 1;
+    ws2812_bit1.duration1 = WS2812_T1L_NS / WS2812_TICK_NS;
+    ws2812_bit1.level1 = 0;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(pin, (rmt_channel_t)channel);
+    config.clk_div = LED_RMT_CLK_DIV;
+
+    if (rmt_config(&config) != ESP_OK ||
+        rmt_driver_install((rmt_channel_t)channel, 0, 0) != ESP_OK ||
+        rmt_translator_init((rmt_channel_t)channel, ws2812_translate) != ESP_OK) {
+        DEBUG_PRINTF("[LED] RMT channel %d init failed\n", channel);
+        return false;
+    }
+
+    // One tx-end callback serves every channel
+    if (!callback_registered) {
+        rmt_register_tx_end_callback(ws2812_tx_end, NULL);
+        callback_registered = true;
+    }
+
+    channels[channel].installed = true;
+    channels[channel].busy = false;
+    channels[channel].frames_done = 0;
+    return true;
+}
+
+bool led_driver_write(uint8_t channel, const uint8_t* grb, size_t len) {
+    if (channel >= LED_DRIVER_MAX_CHANNELS) return false;
+
+    LedChannel* ch = &channels[channel];
+    if (!ch->installed || ch->busy || len > sizeof(ch->buffer)) {
+        return false;
+    }
+
+    memcpy(ch->buffer, grb, len);
+    ch->busy = true;
+
+    if (rmt_write_sample((rmt_channel_t)channel, ch->buffer, len, false) != ESP_OK) {
+        ch->busy = false;
+        return false;
+    }
+    return true;
+}
+
+bool led_driver_busy(uint8_t channel) {
+    if (channel >= LED_DRIVER_MAX_CHANNELS) return false;
+    return channels[channel].busy;
+}
+
+uint32_t led_driver_frames_done(uint8_t channel) {
+    if (channel >= LED_DRIVER_MAX_CHANNELS) return 0;
+    return channels[channel].frames_done;
+}
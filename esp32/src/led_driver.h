@@ -0,0 +1,56 @@
+#ifndef LED_DRIVER_H
+#define LED_DRIVER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// NeoPixel RMT Driver
+// =============================================================================
+// Non-blocking WS2812 output on the ESP32 RMT peripheral, one RMT channel per
+// strip. led_driver_write() copies the frame into the channel's buffer and
+// returns immediately; the RMT hardware clocks it out while the CPU keeps
+// running, and channels transmit concurrently.
+//
+// The RMT tx-end interrupt marks the frame done. A channel is busy until
+// then, and a write to a busy channel is refused so a frame is never torn.
+// =============================================================================
+
+#define LED_DRIVER_MAX_CHANNELS 8       // RMT channels on the ESP32
+
+/**
+ * Install an RMT channel for a WS2812 strip.
+ *
+ * @param channel RMT channel (0-7)
+ * @param pin Data GPIO
+ * @return True if the channel was installed
+ */
+bool led_driver_init(uint8_t channel, uint8_t pin);
+
+/**
+ * Start transmitting a frame (returns without waiting).
+ *
+ * @param channel RMT channel
+ * @param grb Pixel bytes in wire order (G, R, B per pixel)
+ * @param len Number of bytes (at most LED_DRIVER_MAX_PIXELS * 3)
+ * @return True if the frame was queued, false if the channel is busy or invalid
+ */
+bool led_driver_write(uint8_t channel, const uint8_t* grb, size_t len);
+
+/**
+ * Check whether a channel is still transmitting its last frame.
+ *
+ * @param channel RMT channel
+ * @return True until the tx-end interrupt for the last frame fires
+ */
+bool led_driver_busy(uint8_t channel);
+
+/**
+ * Number of frames that finished transmitting on a channel.
+ *
+ * @param channel RMT channel
+ * @return Frame-done count since init
+ */
+uint32_t led_driver_frames_done(uint8_t channel);
+
+#endif // LED_DRIVER_H
@@ -1,207 +1,192 @@
 #include "led_matrix.h"
-#include "config.h"
+#include "matrix_driver.h"
+#include "param_store.h"
 #include "scroll_texts.h"
-#include <MD_MAX72XX.h>
 #include <string.h>
 
-// Matrix instance
-static MD_MAX72XX* mx = nullptr;
+// Framebuffer in MAX7219 layout: one segment byte per module and digit
+// (bit n = column n, digit 7 = top row), and the copy the modules show
+static uint8_t framebuffer[MATRIX_NUM_DEVICES][MATRIX_DIGITS];
+static uint8_t shown[MATRIX_NUM_DEVICES][MATRIX_DIGITS];
+static bool brightness_dirty = false;
 
 // Current patterns for each matrix (for pattern mode)
 static uint8_t current_left_pattern = MATRIX_SHAPE_OFF;
 static uint8_t current_right_pattern = MATRIX_SHAPE_OFF;
 
-// Total display width (2 matrices x 8 columns)
-#define DISPLAY_WIDTH (MATRIX_NUM_DEVICES * 8)
+// Latest $MTX request (left | right << 8), written by the control task
+static volatile uint16_t pattern_request = 0;
+static uint16_t applied_request = 0;
 
-// Scroll state - store text and position
-static char scroll_text_buffer[64];
+// Scroll state - text as glyph atlas indices, and its position
+static uint8_t scroll_glyphs[SCROLL_TEXT_MAX_LEN];
 static int scroll_text_len = 0;
 static int scroll_pos = 0;
-
-// Pattern definitions (8x8 bitmaps) for pattern mode
-static const uint8_t circle[8][8] = {
-    {0, 0, 1, 1, 1, 1, 0, 0},
-    {0, 1, 1, 0, 0, 1, 1, 0},
-    {1, 1, 0, 0, 0, 0, 1, 1},
-    {1, 0, 0, 0, 0, 0, 0, 1},
-    {1, 0, 0, 0, 0, 0, 0, 1},
-    {1, 1, 0, 0, 0, 0, 1, 1},
-    {0, 1, 1, 0, 0, 1, 1, 0},
-    {0, 0, 1, 1, 1, 1, 0, 0}
+static bool scroll_dirty = false;
+
+// Lines per character on the scroll axis (glyph plus one blank gap)
+#define SCROLL_PITCH (SCROLL_GLYPH_WIDTH + 1)
+
+// Pattern glyphs, pre-packed in digit order (digit 0 = bottom row first)
+static const uint8_t MATRIX_GLYPHS[MATRIX_SHAPE_COUNT][MATRIX_DIGITS] = {
+    // MATRIX_SHAPE_OFF
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // MATRIX_SHAPE_CIRCLE
+    {0x3C, 0x66, 0xC3, 0x81, 0x81, 0xC3, 0x66, 0x3C},
+    // MATRIX_SHAPE_X
+    {0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81},
 };
 
-static const uint8_t xShape[8][8] = {
-    {1, 0, 0, 0, 0, 0, 0, 1},
-    {0, 1, 0, 0, 0, 0, 1, 0},
-    {0, 0, 1, 0, 0, 1, 0, 0},
-    {0, 0, 0, 1, 1, 0, 0, 0},
-    {0, 0, 0, 1, 1, 0, 0, 0},
-    {0, 0, 1, 0, 0, 1, 0, 0},
-    {0, 1, 0, 0, 0, 0, 1, 0},
-    {1, 0, 0, 0, 0, 0, 0, 1}
-};
+// =============================================================================
+// Scroll Rotation Table
+// =============================================================================
+// Text runs along the chain rotated 90 degrees clockwise: a 5-bit glyph
+// column of the atlas becomes one digit byte, its top pixel on column 6 so
+// the 5 rows sit near the middle of the 8 columns.
+// =============================================================================
+
+typedef struct {
+    uint8_t rows[32];
+} MatrixRotationTable;
+
+constexpr MatrixRotationTable matrix_build_rotation_table() {
+    MatrixRotationTable table = {};
+    for (int column = 0; column < 32; column++) {
+        for (int bit = 0; bit < 5; bit++) {
+            if (column & (1 << bit)) {
+                table.rows[column] |= (uint8_t)(1 << (6 - bit));
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr MatrixRotationTable MATRIX_ROTATION = matrix_build_rotation_table();
+
+static_assert(MATRIX_ROTATION.rows[0b00001] == 0x40, "Matrix rotation table is wrong");
 
 /**
- * Get pattern array from pattern ID.
+ * Copy a pre-packed pattern onto one module.
  */
-static const uint8_t (*get_pattern_array(uint8_t pattern))[8] {
-    switch (pattern) {
-        case MATRIX_SHAPE_CIRCLE:
-            return circle;
-        case MATRIX_SHAPE_X:
-            return xShape;
-        default:
-            return nullptr;  // OFF or unknown
-    }
+static void draw_pattern(uint8_t device, uint8_t pattern) {
+    if (pattern >= MATRIX_SHAPE_COUNT) pattern = MATRIX_SHAPE_OFF;
+    memcpy(framebuffer[device], MATRIX_GLYPHS[pattern], MATRIX_DIGITS);
 }
 
 /**
- * Display a pattern on one matrix device.
+ * Render current scroll frame with 90° CW rotation.
+ * Line y of the scroll axis is digit 7 - (y % 8) of module y / 8.
  */
-static void display_on_device(uint8_t device, const uint8_t pattern[8][8]) {
-    if (!mx) return;
+static void render_scroll_frame() {
+    memset(framebuffer, 0, sizeof(framebuffer));
 
-    if (pattern == nullptr) {
-        for (uint8_t row = 0; row < 8; row++) {
-            mx->setRow(device, row, 0);
+    for (int i = 0; i < scroll_text_len; i++) {
+        int base = scroll_pos + i * SCROLL_PITCH;
+        if (base >= MATRIX_SCROLL_LINES) break;
+        if (base + SCROLL_GLYPH_WIDTH <= 0) continue;
+
+        const uint8_t* columns = SCROLL_GLYPH_ATLAS.columns[scroll_glyphs[i]];
+        for (int col = 0; col < SCROLL_GLYPH_WIDTH; col++) {
+            int line = base + col;
+            if (line < 0 || line >= MATRIX_SCROLL_LINES) continue;
+            framebuffer[line >> 3][7 - (line & 7)] = MATRIX_ROTATION.rows[columns[col]];
         }
-        return;
     }
 
-    for (uint8_t row = 0; row < 8; row++) {
-        uint8_t hwRow = 7 - row;
-        uint8_t rowBits = 0;
-
-        for (uint8_t col = 0; col < 8; col++) {
-            if (pattern[row][col]) {
-                rowBits |= (1 << col);
-            }
-        }
-
-        mx->setRow(device, hwRow, rowBits);
-    }
+    scroll_dirty = false;
 }
 
 /**
- * Reverse a string in place for proper scroll direction.
+ * Push the rows that changed since the last frame the modules accepted.
+ *
+ * @return Rows queued, 0 if nothing changed or the last frame is still in flight
  */
-static void reverse_string(char* str, int len) {
-    for (int i = 0; i < len / 2; i++) {
-        char tmp = str[i];
-        str[i] = str[len - 1 - i];
-        str[len - 1 - i] = tmp;
+static uint8_t flush_changed_rows() {
+    uint8_t digit_mask = 0;
+    for (uint8_t dev = 0; dev < MATRIX_NUM_DEVICES; dev++) {
+        for (uint8_t digit = 0; digit < MATRIX_DIGITS; digit++) {
+            if (framebuffer[dev][digit] != shown[dev][digit]) {
+                digit_mask |= (uint8_t)(1 << digit);
+            }
+        }
     }
+
+    if (digit_mask == 0 && !brightness_dirty) return 0;
+
+    // Refused while the previous frame is on the wire; the diff stays for next tick
+    if (!matrix_driver_write(framebuffer, digit_mask)) return 0;
+
+    memcpy(shown, framebuffer, sizeof(shown));
+    brightness_dirty = false;
+    return (uint8_t)__builtin_popcount(digit_mask);
 }
 
-/**
- * Render a single character rotated 90 degrees clockwise.
- * After rotation: text scrolls vertically, characters are 8 tall x charWidth wide
- * row_offset: vertical position (0 = top of display)
- */
-static void render_char_rotated(char c, int row_offset) {
-    if (!mx) return;
-
-    // Get character width and data from library
-    uint8_t charWidth = mx->getChar(c, sizeof(scroll_text_buffer), (uint8_t*)scroll_text_buffer);
-
-    // For 90° CW rotation:
-    // Original col -> becomes row (from bottom)
-    // Original row -> becomes col (from left)
-    // Physical display: 8 cols wide, MATRIX_NUM_DEVICES*8 rows tall
-
-    for (uint8_t srcCol = 0; srcCol < charWidth; srcCol++) {
-        uint8_t colData = mx->getColumn(srcCol);  // Get the column we just rendered
-
-        // This column becomes a row after 90° CW rotation
-        int destRow = row_offset + srcCol;
-
-        if (destRow >= 0 && destRow < DISPLAY_WIDTH) {
-            // Each bit in colData becomes a pixel in the rotated row
-            // Bit 0 (top) -> rightmost pixel (col 7)
-            // Bit 7 (bottom) -> leftmost pixel (col 0)
-            for (int bit = 0; bit < 8; bit++) {
-                if (colData & (1 << bit)) {
-                    int destCol = 7 - bit;  // Flip for CW rotation
-                    mx->setPoint(destRow, destCol, true);
-                }
-            }
+static void apply_patterns(MatrixScrollState* state, uint8_t left_pattern, uint8_t right_pattern) {
+    current_left_pattern = left_pattern;
+    current_right_pattern = right_pattern;
+
+    if (left_pattern == MATRIX_SHAPE_OFF && right_pattern == MATRIX_SHAPE_OFF) {
+        if (state->mode != MATRIX_MODE_SCROLL) {
+            led_matrix_set_scroll_mode(state, true);
         }
+        return;
     }
+
+    state->mode = MATRIX_MODE_PATTERN;
+    draw_pattern(0, left_pattern);
+    draw_pattern(1, right_pattern);
+
+    DEBUG_PRINTF("Matrix patterns set: left=%d, right=%d\n", left_pattern, right_pattern);
 }
 
-/**
- * Render current scroll frame with 90° CW rotation.
- * Text scrolls vertically through the rotated display.
- */
-static void render_scroll_frame() {
-    if (!mx) return;
+static void update_scroll(MatrixScrollState* state) {
+    uint32_t now = millis();
 
-    mx->clear();
+    // Initialize scroll text on first run with a random text
+    if (scroll_text_len == 0) {
+        uint8_t initial_text_id = random(0, SCROLL_TEXT_CUSTOM);
+        led_matrix_set_scroll_text(state, initial_text_id);
+        DEBUG_PRINTF("[MTX] Init scroll text id=%d\n", initial_text_id);
+    }
 
-    // With 90° CW rotation:
-    // - Display is 8 pixels wide, DISPLAY_WIDTH pixels tall
-    // - Text scrolls vertically (row position changes)
-    // - Each character is ~6-8 rows tall after rotation
+    // Catch up on every line that was due, so a late tick doesn't slow the scroll
+    uint32_t elapsed = now - state->scroll_last_update;
+    if (elapsed >= state->scroll_speed) {
+        uint32_t steps = elapsed / state->scroll_speed;
+        state->scroll_last_update += steps * state->scroll_speed;
+        scroll_pos += (int)steps;
+        scroll_dirty = true;
 
-    int row_pos = scroll_pos;
-    for (int i = 0; i < scroll_text_len; i++) {
-        char c = scroll_text_buffer[i];
-
-        // Get character width (which becomes height after rotation)
-        uint8_t charWidth = mx->getChar(c, 8, nullptr);
-        if (charWidth == 0) charWidth = 6;  // Default width
-
-        // Only render if character is visible
-        if (row_pos > -8 && row_pos < DISPLAY_WIDTH) {
-            // Render character directly with rotation
-            // Use setPoint for precise control
-            uint8_t buf[8];
-            mx->getChar(c, 8, buf);
-
-            for (uint8_t srcCol = 0; srcCol < charWidth && srcCol < 8; srcCol++) {
-                int destRow = row_pos + srcCol;
-                if (destRow >= 0 && destRow < DISPLAY_WIDTH) {
-                    for (int bit = 0; bit < 8; bit++) {
-                        if (buf[srcCol] & (1 << bit)) {
-                            int destCol = 7 - bit;
-                            mx->setPoint(destRow, destCol, true);
-                        }
-                    }
-                }
-            }
+        // Check for wrap - when text has scrolled off screen, pick new text
+        if (scroll_pos > MATRIX_SCROLL_LINES) {
+            uint8_t new_text_id = random(0, SCROLL_TEXT_CUSTOM);
+            led_matrix_set_scroll_text(state, new_text_id);
+            DEBUG_PRINTF("[MTX] New scroll text id=%d\n", new_text_id);
         }
+    }
 
-        row_pos += charWidth + 1;  // Move to next character position (with 1 pixel gap)
+    if (scroll_dirty) {
+        render_scroll_frame();
     }
 }
 
 void led_matrix_init() {
-    // Try different hardware types - GENERIC_HW is most compatible
-    // Other options: FC16_HW, PAROLA_HW, ICSTATION_HW
-    mx = new MD_MAX72XX(
-        MD_MAX72XX::GENERIC_HW,
-        MATRIX_DATA_PIN,
-        MATRIX_CLK_PIN,
-        MATRIX_CS_PIN,
-        MATRIX_NUM_DEVICES
-    );
-
-    mx->begin();
-    mx->control(MD_MAX72XX::INTENSITY, MATRIX_DEFAULT_BRIGHTNESS);
-    mx->clear();
+    memset(framebuffer, 0, sizeof(framebuffer));
+    memset(shown, 0, sizeof(shown));    // matrix_driver_init() clears the modules
 
-    // Quick test - display all LEDs on briefly to verify hardware works
-    Serial.printf("[MTX] Testing %d matrices (GENERIC_HW) - all LEDs on...\n", MATRIX_NUM_DEVICES);
-    for (int dev = 0; dev < MATRIX_NUM_DEVICES; dev++) {
-        for (int row = 0; row < 8; row++) {
-            mx->setRow(dev, row, 0xFF);
-        }
+    if (!matrix_driver_init(g_params.matrix_brightness)) {
+        return;
     }
-    delay(500);  // Show for 500ms
-    mx->clear();
 
-    Serial.println("[MTX] LED matrix initialized");
+#if MATRIX_LAMP_TEST_MS > 0
+    // Quick test - display all LEDs on briefly to verify hardware works
+    DEBUG_PRINTF("[MTX] Testing %d matrices - all LEDs on...\n", MATRIX_NUM_DEVICES);
+    matrix_driver_display_test(true);
+    delay(MATRIX_LAMP_TEST_MS);
+    matrix_driver_display_test(false);
+#endif
+
+    DEBUG_PRINTLN("[MTX] LED matrix initialized");
 }
 
 void led_matrix_scroll_init(MatrixScrollState* state) {
@@ -213,22 +198,11 @@ void led_matrix_scroll_init(MatrixScrollState* state) {
     // Reset static scroll variables
     scroll_text_len = 0;
     scroll_pos = 0;
-    scroll_text_buffer[0] = '\0';
+    scroll_dirty = false;
 }
 
 void led_matrix_set_patterns(uint8_t left_pattern, uint8_t right_pattern) {
-    if (!mx) return;
-
-    current_left_pattern = left_pattern;
-    current_right_pattern = right_pattern;
-
-    const uint8_t (*left_arr)[8] = get_pattern_array(left_pattern);
-    display_on_device(0, left_arr);
-
-    const uint8_t (*right_arr)[8] = get_pattern_array(right_pattern);
-    display_on_device(1, right_arr);
-
-    DEBUG_PRINTF("Matrix patterns set: left=%d, right=%d\n", left_pattern, right_pattern);
+    pattern_request = (uint16_t)(left_pattern | (right_pattern << 8));
 }
 
 void led_matrix_get_patterns(uint8_t* left_pattern, uint8_t* right_pattern) {
@@ -237,18 +211,15 @@ void led_matrix_get_patterns(uint8_t* left_pattern, uint8_t* right_pattern) {
 }
 
 void led_matrix_clear() {
-    if (mx) {
-        mx->clear();
-    }
+    memset(framebuffer, 0, sizeof(framebuffer));
     current_left_pattern = MATRIX_SHAPE_OFF;
     current_right_pattern = MATRIX_SHAPE_OFF;
 }
 
 void led_matrix_set_brightness(uint8_t brightness) {
-    if (!mx) return;
-
     if (brightness > 15) brightness = 15;
-    mx->control(MD_MAX72XX::INTENSITY, brightness);
+    matrix_driver_set_intensity(brightness);
+    brightness_dirty = true;
 
     DEBUG_PRINTF("Matrix brightness set to %d\n", brightness);
 }
@@ -262,64 +233,62 @@ void led_matrix_set_scroll_text(MatrixScrollState* state, uint8_t text_id) {
         text = "?";
     }
 
-    // Copy text (no reversal needed for rotated display)
+    // Resolve glyphs once so rendering is a table walk
     scroll_text_len = strlen(text);
-    if (scroll_text_len > 63) scroll_text_len = 63;
-
-    strncpy(scroll_text_buffer, text, scroll_text_len);
-    scroll_text_buffer[scroll_text_len] = '\0';
-
-    // Calculate total text height (in rotated space, ~7 pixels per char + 1 gap)
-    int text_height = scroll_text_len * 7;
+    if (scroll_text_len > SCROLL_TEXT_MAX_LEN) scroll_text_len = SCROLL_TEXT_MAX_LEN;
+    for (int i = 0; i < scroll_text_len; i++) {
+        scroll_glyphs[i] = scroll_glyph_index(text[i]);
+    }
 
     // Start position off screen (negative = above display)
-    scroll_pos = -text_height;
+    scroll_pos = -(scroll_text_len * SCROLL_PITCH);
+    scroll_dirty = true;
 
     state->scroll_last_update = millis();
     state->current_text_id = text_id;
 }
 
-void led_matrix_update_scroll(MatrixScrollState* state) {
-    if (!mx) {
-        return;
-    }
-    if (state->mode != MATRIX_MODE_SCROLL) {
-        return;
+uint8_t led_matrix_update(MatrixScrollState* state) {
+    uint16_t request = pattern_request;
+    if (request != applied_request) {
+        applied_request = request;
+        apply_patterns(state, (uint8_t)(request & 0xFF), (uint8_t)(request >> 8));
     }
 
-    uint32_t now = millis();
-
-    // Initialize scroll text on first run with a random text
-    if (scroll_text_len == 0) {
-        uint8_t initial_text_id = random(0, SCROLL_TEXT_COUNT);
-        led_matrix_set_scroll_text(state, initial_text_id);
-        Serial.printf("[MTX] Init scroll text id=%d: %s\n", initial_text_id, scroll_text_buffer);
+    if (state->mode == MATRIX_MODE_SCROLL) {
+        update_scroll(state);
     }
 
-    // Check if it's time to advance the scroll
-    if (now - state->scroll_last_update >= state->scroll_speed) {
-        state->scroll_last_update = now;
+    return flush_changed_rows();
+}
 
-        // Advance scroll position (scroll direction: left to right)
-        scroll_pos++;
+uint32_t led_matrix_frame_wait_ms(const MatrixScrollState* state, uint32_t now_ms) {
+    if (pattern_request != applied_request) return 0;
 
-        // Check for wrap - when text has scrolled off screen, pick new text
-        if (scroll_pos > DISPLAY_WIDTH) {
-            uint8_t new_text_id = random(0, SCROLL_TEXT_COUNT);
-            led_matrix_set_scroll_text(state, new_text_id);
-            Serial.printf("[MTX] New scroll text id=%d\n", new_text_id);
-        }
+    // Rows refused while the last frame was on the wire: retry next tick
+    if (brightness_dirty || memcmp(framebuffer, shown, sizeof(shown)) != 0) {
+        return g_params.animation_period_ms;
     }
 
-    // Render current frame
-    render_scroll_frame();
+    if (state->mode != MATRIX_MODE_SCROLL) return ANIMATION_WAIT_IDLE;
+
+    int32_t wait = (int32_t)(state->scroll_last_update + state->scroll_speed - now_ms);
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
+
+uint16_t led_matrix_frame_ms(const MatrixScrollState* state) {
+    return (state->mode == MATRIX_MODE_SCROLL) ? state->scroll_speed : 0;
 }
 
 void led_matrix_set_scroll_mode(MatrixScrollState* state, bool enabled) {
     state->mode = enabled ? MATRIX_MODE_SCROLL : MATRIX_MODE_PATTERN;
 
-    if (!enabled && mx) {
+    if (enabled) {
+        // Redraw the text where it left off, timed from now
+        state->scroll_last_update = millis();
+        scroll_dirty = true;
+    } else {
         // Clear display when switching to pattern mode
-        mx->clear();
+        memset(framebuffer, 0, sizeof(framebuffer));
     }
 }
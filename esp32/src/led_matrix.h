@@ -2,36 +2,48 @@
 #define LED_MATRIX_H
 
 #include <Arduino.h>
+#include "config.h"
+#include "pins.h"
 
 // =============================================================================
 // LED Matrix Module (MAX7219 8x8 x 2)
 // =============================================================================
-// Controls two chained MAX7219 8x8 LED matrices for displaying scrolling text
-// or static patterns.
+// Renders the two chained MAX7219 8x8 matrices from the animation task:
+// static patterns from $MTX, or scrolling text while no pattern is set.
+//
+// Drawing goes into a framebuffer of MAX7219 digit bytes; each frame only
+// the rows that differ from what the modules already show are pushed, over
+// SPI DMA (see matrix_driver.h). A scroll step therefore costs a few row
+// transactions and an idle display costs none.
 // =============================================================================
 
 // Pattern IDs for static display mode
 #define MATRIX_SHAPE_OFF        0   // All LEDs off
 #define MATRIX_SHAPE_CIRCLE     1   // Circle pattern
 #define MATRIX_SHAPE_X          2   // X pattern
+#define MATRIX_SHAPE_COUNT      3
 
 // Matrix modes
 #define MATRIX_MODE_PATTERN     0   // Display static patterns
 #define MATRIX_MODE_SCROLL      1   // Scroll text
 
 // Scroll configuration
-#define MATRIX_SCROLL_SPEED     100  // ms per column shift (like sample)
+#define MATRIX_SCROLL_SPEED     100  // ms per line shift (sets the matrix frame rate)
+
+// Scroll axis: the text is rotated 90 degrees and runs along both modules
+#define MATRIX_SCROLL_LINES     (MATRIX_NUM_DEVICES * 8)
 
 // Scroll state structure (simplified - text buffer is in cpp file)
 typedef struct {
     uint8_t mode;                   // MATRIX_MODE_PATTERN or MATRIX_MODE_SCROLL
     uint32_t scroll_last_update;    // Last update time (ms)
-    uint16_t scroll_speed;          // Speed (ms per column)
+    uint16_t scroll_speed;          // Speed (ms per line)
     uint8_t current_text_id;        // Current text ID for random selection
 } MatrixScrollState;
 
 /**
- * Initialize the LED matrix.
+ * Initialize the MAX7219 chain and run the boot lamp test.
+ * Call once from setup() before the tasks start.
  */
 void led_matrix_init();
 
@@ -41,7 +53,12 @@ void led_matrix_init();
 void led_matrix_scroll_init(MatrixScrollState* state);
 
 /**
- * Set the pattern for each matrix (static mode).
+ * Request the pattern for each matrix.
+ * Safe to call from another task: picked up by the next led_matrix_update().
+ * Any pattern other than OFF selects pattern mode; OFF on both resumes scrolling.
+ *
+ * @param left_pattern Left matrix pattern ID (MATRIX_SHAPE_*)
+ * @param right_pattern Right matrix pattern ID (MATRIX_SHAPE_*)
  */
 void led_matrix_set_patterns(uint8_t left_pattern, uint8_t right_pattern);
 
@@ -51,12 +68,14 @@ void led_matrix_set_patterns(uint8_t left_pattern, uint8_t right_pattern);
 void led_matrix_get_patterns(uint8_t* left_pattern, uint8_t* right_pattern);
 
 /**
- * Clear the matrix.
+ * Clear the framebuffer (pushed by the next led_matrix_update()).
  */
 void led_matrix_clear();
 
 /**
  * Set matrix brightness.
+ *
+ * @param brightness Intensity 0-15
  */
 void led_matrix_set_brightness(uint8_t brightness);
 
@@ -66,9 +85,31 @@ void led_matrix_set_brightness(uint8_t brightness);
 void led_matrix_set_scroll_text(MatrixScrollState* state, uint8_t text_id);
 
 /**
- * Update scroll animation (call periodically from animation task).
+ * Render the current frame and push the rows that changed.
+ * Call when led_matrix_frame_wait_ms() is 0.
+ *
+ * @param state Scroll state
+ * @return Number of rows queued for the modules this frame
+ */
+uint8_t led_matrix_update(MatrixScrollState* state);
+
+/**
+ * Time until the matrices need their next frame: a new pattern request, a
+ * refused row push or the next scroll line.
+ *
+ * @param state Scroll state
+ * @param now_ms Current time (millis())
+ * @return Milliseconds (0 = due now), or ANIMATION_WAIT_IDLE for a static pattern
+ */
+uint32_t led_matrix_frame_wait_ms(const MatrixScrollState* state, uint32_t now_ms);
+
+/**
+ * Frame interval of the current mode, for telemetry.
+ *
+ * @param state Scroll state
+ * @return Milliseconds per scroll line, 0 for a static pattern
  */
-void led_matrix_update_scroll(MatrixScrollState* state);
+uint16_t led_matrix_frame_ms(const MatrixScrollState* state);
 
 /**
  * Set scroll mode enabled/disabled.
@@ -1,63 +1,124 @@
 #include "limit_switch.h"
 #include "config.h"
+#include "servo_controller.h"
 
-// Debounce state
-static bool last_state = false;
-static bool stable_state = false;
-static uint32_t last_change_time = 0;
+// Shared with the edge interrupt
+static portMUX_TYPE limit_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool latched = false;           // Hit seen, not yet released
+static volatile int8_t hit_motion = 0;          // Servo motion sign at the hit (0 = unknown)
+static volatile uint32_t hit_us = 0;            // micros() at the triggering edge
+static volatile uint32_t last_edge_us = 0;      // micros() at the latest edge
+static volatile uint32_t edge_count = 0;        // Every edge seen by the interrupt
+
+// Control task only
+static uint8_t latched_direction = LIMIT_NONE;
+static uint32_t transitions = 0;                // Debounced state changes
+
+// Map a motion sign on LIMIT_SERVO_INDEX to the stop it runs into
+static uint8_t direction_from_motion(int8_t motion) {
+    return (motion == LIMIT_CW_MOTION_SIGN) ? LIMIT_CW : LIMIT_CCW;
+}
+
+// Block LIMIT_SERVO_INDEX from moving further toward the stop it hit
+static void IRAM_ATTR fence_servo(int8_t motion) {
+#if LIMIT_FENCE_ENABLED
+    servo_set_fence(LIMIT_SERVO_INDEX, motion);
+#else
+    (void)motion;
+#endif
+}
+
+static void IRAM_ATTR limit_switch_isr() {
+    uint32_t now = micros();
+    bool closed = digitalRead(LIMIT_SWITCH_PIN) == LOW;
+
+    portENTER_CRITICAL_ISR(&limit_mux);
+    edge_count++;
+    last_edge_us = now;
+    if (closed && !latched) {
+        // Stop the servo that drove into the switch before anything else runs
+        int8_t motion = servo_get_motion_dir(LIMIT_SERVO_INDEX);
+        if (motion != 0) {
+            fence_servo(motion);
+        }
+        latched = true;
+        hit_motion = motion;
+        hit_us = now;
+    }
+    portEXIT_CRITICAL_ISR(&limit_mux);
+}
 
 void limit_switch_init() {
     // Configure pin with internal pullup
     // Switch is active LOW (connects to GND when triggered)
     pinMode(LIMIT_SWITCH_PIN, INPUT_PULLUP);
 
-    // Initialize state
-    last_state = digitalRead(LIMIT_SWITCH_PIN) == LOW;
-    stable_state = last_state;
-    last_change_time = millis();
+    // Initialize state (a switch already closed at boot counts as a hit)
+    bool closed = digitalRead(LIMIT_SWITCH_PIN) == LOW;
+    latched = closed;
+    hit_motion = 0;
+    hit_us = micros();
+    last_edge_us = hit_us;
+    edge_count = closed ? 1 : 0;
+    transitions = 0;                // The first read counts the boot hit
+    latched_direction = LIMIT_NONE;
+
+    attachInterrupt(digitalPinToInterrupt(LIMIT_SWITCH_PIN), limit_switch_isr, CHANGE);
 
     DEBUG_PRINTLN("Limit switch initialized");
 }
 
 void limit_switch_read(bool* active, uint8_t* direction) {
-    // Read current state (active LOW)
-    bool current_state = digitalRead(LIMIT_SWITCH_PIN) == LOW;
+    portENTER_CRITICAL(&limit_mux);
+    bool is_latched = latched;
+    int8_t motion = hit_motion;
+    uint32_t quiet_us = micros() - last_edge_us;
+    portEXIT_CRITICAL(&limit_mux);
 
-    // Debounce logic
-    if (current_state != last_state) {
-        last_change_time = millis();
-        last_state = current_state;
+    if (is_latched && latched_direction == LIMIT_NONE) {
+        // New hit: the servo had never moved, so fall back to which half of its
+        // travel it is in (the interrupt could not fence it)
+        if (motion == 0) {
+            motion = (servo_get_angle(LIMIT_SERVO_INDEX) >= SERVO_CENTER_ANGLE) ? 1 : -1;
+            fence_servo(motion);
+        }
+        latched_direction = direction_from_motion(motion);
+        transitions++;
+        DEBUG_PRINTF("Limit switch TRIGGERED (%s)\n", latched_direction == LIMIT_CW ? "CW" : "CCW");
     }
 
-    // Update stable state after debounce period
-    if ((millis() - last_change_time) >= LIMIT_DEBOUNCE_MS) {
-        if (stable_state != last_state) {
-            stable_state = last_state;
-            DEBUG_PRINTF("Limit switch changed to %s\n", stable_state ? "TRIGGERED" : "CLEAR");
+    // Release only once the pin has been open and quiet for the debounce time
+    if (is_latched && quiet_us >= (uint32_t)LIMIT_DEBOUNCE_MS * 1000 &&
+        digitalRead(LIMIT_SWITCH_PIN) == HIGH) {
+        portENTER_CRITICAL(&limit_mux);
+        bool still_quiet = (micros() - last_edge_us) >= (uint32_t)LIMIT_DEBOUNCE_MS * 1000;
+        if (still_quiet) {
+            latched = false;
         }
-    }
+        portEXIT_CRITICAL(&limit_mux);
 
-    *active = stable_state;
-
-    // Determine direction based on current servo position
-    // TODO: This is a simplified implementation. In a real system,
-    // you might have separate CW and CCW limit switches, or
-    // determine direction based on servo movement direction.
-    //
-    // Current implementation assumes:
-    // - Single limit switch
-    // - Direction determined by which end of travel we're at
-    // - Default to CW limit (can be adjusted based on mechanical design)
-
-    if (stable_state) {
-        // For now, assume CW limit if servo angle > 90, CCW if < 90
-        // This should be refined based on actual mechanical setup
-        *direction = LIMIT_CW;  // Default assumption
-    } else {
-        *direction = LIMIT_NONE;
+        if (still_quiet) {
+            servo_set_fence(LIMIT_SERVO_INDEX, 0);
+            latched_direction = LIMIT_NONE;
+            transitions++;
+            is_latched = false;
+            DEBUG_PRINTLN("Limit switch CLEAR");
+        }
     }
+
+    *active = is_latched;
+    *direction = is_latched ? latched_direction : LIMIT_NONE;
 }
 
 bool limit_switch_is_triggered() {
-    return stable_state;
+    return latched;
+}
+
+uint32_t limit_switch_trigger_us() {
+    return hit_us;
+}
+
+uint16_t limit_switch_chatter() {
+    uint32_t edges = edge_count;
+    return (uint16_t)((edges > transitions) ? edges - transitions : 0);
 }
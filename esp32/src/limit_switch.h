@@ -3,15 +3,30 @@
 
 #include <Arduino.h>
 
+// =============================================================================
+// Limit Switch
+// =============================================================================
+// A GPIO edge interrupt reacts to the switch: the first closing edge is
+// time-stamped with micros() and immediately fences LIMIT_SERVO_INDEX against
+// the direction it was last moving in, so the base stops on its next update
+// instead of after a poll plus the debounce delay. The hit is latched at once;
+// only the release is debounced (LIMIT_DEBOUNCE_MS of stable open level).
+//
+// Every edge is counted. Edges beyond the ones needed for the debounced
+// transitions are reported as chatter, so a worn or noisy switch shows up in
+// telemetry.
+// =============================================================================
+
 /**
  * Initialize limit switch input.
  *
- * Configures GPIO pin with internal pullup.
+ * Configures GPIO pin with internal pullup and attaches the edge interrupt.
  */
 void limit_switch_init();
 
 /**
- * Read limit switch state with debouncing.
+ * Read the latched limit switch state and debounce its release.
+ * Call periodically from the control task.
  *
  * @param active Output: true if limit switch is triggered
  * @param direction Output: limit direction (LIMIT_CW or LIMIT_CCW)
@@ -19,10 +34,24 @@ void limit_switch_init();
 void limit_switch_read(bool* active, uint8_t* direction);
 
 /**
- * Check if limit switch is currently triggered (raw read).
+ * Check if limit switch is currently triggered (latched state).
  *
  * @return true if limit switch is active
  */
 bool limit_switch_is_triggered();
 
+/**
+ * Get the edge timestamp of the latest hit.
+ *
+ * @return micros() captured by the interrupt on the triggering edge
+ */
+uint32_t limit_switch_trigger_us();
+
+/**
+ * Get the number of switch edges that did not produce a state change.
+ *
+ * @return Chatter edge count since boot (wraps)
+ */
+uint16_t limit_switch_chatter();
+
 #endif // LIMIT_SWITCH_H
@@ -2,6 +2,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_task_wdt.h"
+#include "esp_system.h"
 #include "config.h"
 #include "state.h"
 #include "uart_handler.h"
@@ -9,8 +12,17 @@
 #include "rgb_strip.h"
 #include "limit_switch.h"
 #include "valve_safety.h"
+#include "dispense.h"
 #include "neopixel_matrix.h"
 #include "neopixel_ring.h"
+#include "led_matrix.h"
+#include "compositor.h"
+#include "profiler.h"
+#include "scroll_store.h"
+#include "timeline.h"
+#include "target_predictor.h"
+#include "param_store.h"
+#include "trace.h"
 
 // =============================================================================
 // RTOS Configuration
@@ -21,29 +33,64 @@
 
 #define TASK_COMM_PRIORITY        2
 #define TASK_ANIMATION_PRIORITY   1
-#define TASK_CONTROL_PRIORITY     2
+#define TASK_CONTROL_PRIORITY     5   // Above comm/animation: valve safety runs here
 
 #define TASK_COMM_CORE            0   // Communication on Core 0
-#define TASK_ANIMATION_CORE       1   // Animation on Core 1
+#define TASK_ANIMATION_CORE       LED_RENDER_CORE  // LED rendering (Core 0 by default)
 #define TASK_CONTROL_CORE         1   // Control on Core 1
 
-// Task periods in milliseconds
-#define COMM_TASK_PERIOD_MS       33  // ~30Hz
-#define ANIMATION_TASK_PERIOD_MS  20  // 50Hz
-#define CONTROL_TASK_PERIOD_MS    10  // 100Hz
+// Task periods come from g_params (defaults in config.h); the comm task
+// sleeps at most one status period between RX events, the animation task
+// until the next LED frame is due
 
 // =============================================================================
-// Global State (protected by mutex)
+// Global State
 // =============================================================================
+// g_state.command is owned by the comm task, g_state.input/output,
+// g_valve_state and g_dispense_state by the control task; other tasks read
+// published snapshots (see state_publish_command / state_publish_outputs).
 DeviceState g_state;
 ValveState g_valve_state;
+DispenseState g_dispense_state;
 NpmState g_npm_state;
 NprState g_npr_state;
+MatrixScrollState g_matrix_state;
 RgbState g_rgb_state;
 
-// Mutex for protecting shared state
+// Mutex for g_rgb_state (held by the animation task while it renders; the
+// control task hands RGB modes over through g_led_request)
 SemaphoreHandle_t g_state_mutex = NULL;
 
+// LED mode requests from the control task. Only the animation task touches
+// the LED effect state: it applies everything one control tick changed in
+// one go, before its next frame, so a $TXN never shows up split across
+// frames (see led_request_publish / led_request_take)
+#define LED_REQ_NPM     (1 << TIMELINE_DEV_NPM)
+#define LED_REQ_NPR     (1 << TIMELINE_DEV_NPR)
+#define LED_REQ_RGB     (1 << TIMELINE_DEV_RGB)
+#define LED_REQ_MATRIX  (1 << TIMELINE_DEV_COUNT)
+
+struct LedModeRequest {
+    uint8_t mode;
+    char letter;                // NPM only
+    uint8_t r, g, b;
+    uint8_t r2, g2, b2;
+    uint8_t speed;
+};
+
+struct LedRequest {
+    uint8_t changed;            // LED_REQ_* set for each part below
+    LedModeRequest npm;
+    LedModeRequest npr;
+    LedModeRequest rgb;
+    uint8_t matrix_left;
+    uint8_t matrix_right;
+};
+
+LedRequest g_led_request;
+uint32_t g_led_request_gen = 0;
+portMUX_TYPE g_led_request_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // Communication tracking (accessed by comm task)
 volatile uint32_t g_last_command_time = 0;
 volatile bool g_has_received_command = false;
@@ -57,13 +104,30 @@ TaskHandle_t g_comm_task_handle = NULL;
 TaskHandle_t g_animation_task_handle = NULL;
 TaskHandle_t g_control_task_handle = NULL;
 
+// Control loop clock and supervision (see control_timer_callback)
+esp_timer_handle_t g_control_timer = NULL;
+volatile uint32_t g_control_heartbeat_ms = 0;   // millis() at the end of the last control tick
+volatile bool g_control_failsafe = false;       // Set by the timer when the loop stalls, cleared by the loop
+volatile bool g_flash_write_active = false;     // NVS write in progress (comm task)
+volatile uint32_t g_flash_write_end_ms = 0;     // millis() when the last NVS write finished
+
+// Boot stage times (esp_timer microseconds since reset, 0 = not reached yet),
+// reported to the Pi with $BOT whenever the link comes up
+volatile uint32_t g_boot_valve_us = 0;      // Valve servo holding the closed pulse
+volatile uint32_t g_boot_control_us = 0;    // First control tick done
+volatile uint32_t g_boot_link_us = 0;       // UART link up
+volatile uint32_t g_boot_leds_us = 0;       // LED drivers initialized
+
 // =============================================================================
 // Helper Functions
 // =============================================================================
 
 // Lock the state mutex (with timeout)
 inline bool state_lock(TickType_t timeout = portMAX_DELAY) {
-    return xSemaphoreTake(g_state_mutex, timeout) == pdTRUE;
+    int64_t start = profiler_lock_begin();
+    bool acquired = xSemaphoreTake(g_state_mutex, timeout) == pdTRUE;
+    profiler_lock_end(start, acquired);
+    return acquired;
 }
 
 // Unlock the state mutex
@@ -71,70 +135,335 @@ inline void state_unlock() {
     xSemaphoreGive(g_state_mutex);
 }
 
+// Hand one control tick's LED changes to the animation task (control task).
+// Parts the animation task has not taken yet are kept, so a later tick that
+// changes another device does not drop them.
+static void led_request_publish(const LedRequest* request) {
+    portENTER_CRITICAL(&g_led_request_mux);
+    if (request->changed & LED_REQ_NPM) g_led_request.npm = request->npm;
+    if (request->changed & LED_REQ_NPR) g_led_request.npr = request->npr;
+    if (request->changed & LED_REQ_RGB) g_led_request.rgb = request->rgb;
+    if (request->changed & LED_REQ_MATRIX) {
+        g_led_request.matrix_left = request->matrix_left;
+        g_led_request.matrix_right = request->matrix_right;
+    }
+    g_led_request.changed |= request->changed;
+    g_led_request_gen++;
+    portEXIT_CRITICAL(&g_led_request_mux);
+}
+
+// Take the changes published since *applied_gen (animation task)
+static bool led_request_take(uint32_t* applied_gen, LedRequest* out) {
+    bool fresh = false;
+    portENTER_CRITICAL(&g_led_request_mux);
+    if (g_led_request_gen != *applied_gen) {
+        *out = g_led_request;
+        g_led_request.changed = 0;
+        *applied_gen = g_led_request_gen;
+        fresh = true;
+    }
+    portEXIT_CRITICAL(&g_led_request_mux);
+    return fresh;
+}
+
+// Time since reset for the boot stage marks
+inline uint32_t boot_us() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// Wake the animation task for LED state changed by another task (also
+// called by uart_handler for glyph uploads and timeline triggers)
+void on_leds_changed() {
+    if (g_animation_task_handle != NULL) {
+        xTaskNotifyGive(g_animation_task_handle);
+    }
+}
+
 // =============================================================================
 // Communication Task - UART RX/TX (Core 0)
 // =============================================================================
 void comm_task(void* pvParameters) {
-    TickType_t last_status_time = 0;
-    const TickType_t period = pdMS_TO_TICKS(COMM_TASK_PERIOD_MS);
-    const TickType_t status_interval = pdMS_TO_TICKS(STATUS_TX_PERIOD_MS);
+    TickType_t last_latency_time = 0;
+    const TickType_t latency_interval = pdMS_TO_TICKS(LATENCY_REPORT_PERIOD_MS);
+#if PROFILER_ENABLED
+    TickType_t last_profile_time = 0;
+    const TickType_t profile_interval = pdMS_TO_TICKS(PROFILER_REPORT_PERIOD_MS);
+#endif
+    bool was_connected = false;
+    bool boot_report_due = false;
+    uint8_t reported_pour_seq = 0;
+
+    // Bring the Pi link up here, so setup() never waits on it
+    // (driver buffers must be sized before begin())
+#if BUS_ENABLED
+    // RS-485 transceiver: the UART raises DE (its RTS line) around each write
+    Serial2.setRxBufferSize(UART_DRIVER_RX_BUFFER_SIZE);
+    Serial2.setTxBufferSize(UART_DRIVER_TX_BUFFER_SIZE);
+    Serial2.begin(UART_BAUD_RATE, SERIAL_8N1, BUS_RX_PIN, BUS_TX_PIN);
+    Serial2.setPins(BUS_RX_PIN, BUS_TX_PIN, -1, BUS_DE_PIN);
+    Serial2.setMode(UART_MODE_RS485_HALF_DUPLEX);
+#else
+    Serial.setRxBufferSize(UART_DRIVER_RX_BUFFER_SIZE);
+    Serial.setTxBufferSize(UART_DRIVER_TX_BUFFER_SIZE);
+    Serial.begin(UART_BAUD_RATE);
+#endif
+    uart_init();
+    g_boot_link_us = boot_us();
 
+    DEBUG_PRINTLN("=================================");
+    DEBUG_PRINTLN("ESP32 RTOS Firmware Starting...");
+    DEBUG_PRINTLN("=================================");
     DEBUG_PRINTF("[RTOS] Communication task started on Core %d\n", xPortGetCoreID());
 
     for (;;) {
-        TickType_t task_start = xTaskGetTickCount();
+        // Sleep until the UART RX callback signals data, the status period
+        // elapses, or (on a bus) this unit's reply slot comes up
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(uart_tx_wait_ms(g_params.status_period_ms)));
+        profiler_loop_begin(PRF_TASK_COMM);
 
-        // Receive and parse commands (locks mutex internally if needed)
-        if (state_lock(pdMS_TO_TICKS(10))) {
-            uart_receive(&g_state);
-            state_check_connection(&g_state, CONNECTION_TIMEOUT_MS);
-            state_unlock();
-        }
+        // Receive and parse commands into our own copy, then publish it
+        uart_receive(&g_state);
+        state_check_connection(&g_state, CONNECTION_TIMEOUT_MS);
+        state_publish_command(&g_state.command);
 
         // Send status if connected
         TickType_t now = xTaskGetTickCount();
         bool connected = g_has_received_command &&
                         ((now - g_last_command_time) < pdMS_TO_TICKS(1000));
 
-        if (connected && (now - last_status_time >= status_interval)) {
-            if (state_lock(pdMS_TO_TICKS(10))) {
-                uart_send_status(&g_state);
-                state_unlock();
+        // On a bus nothing unsolicited goes out outside this unit's reply slot
+        bool slot = uart_tx_slot_open() && connected;
+
+        // Tell the Pi how this boot went each time it (re)connects
+        if (connected && !was_connected) {
+            boot_report_due = true;
+        }
+        was_connected = connected;
+        if (slot && boot_report_due) {
+            uart_send_boot_report((uint8_t)esp_reset_reason(), g_boot_valve_us,
+                                  g_boot_control_us, g_boot_link_us, g_boot_leds_us);
+            boot_report_due = false;
+        }
+
+        if (slot) {
+            // Build the status from a snapshot - nothing is held during the UART write
+            DeviceState status;
+            status.command = g_state.command;
+            state_read_outputs(&status.input, &status.output);
+            uart_send_telemetry(&status);
+
+            // Pours that ended while the link was down are reported on reconnect
+            if (status.output.pour_seq != reported_pour_seq) {
+                reported_pour_seq = status.output.pour_seq;
+                uart_send_pour_report(status.output.pour_target_ml, status.output.pour_ml,
+                                      status.output.pour_end_reason,
+                                      status.output.pour_duration_ms);
             }
-            last_status_time = now;
         }
 
-        // Delay until next period
-        vTaskDelayUntil(&task_start, period);
+        if (slot && (now - last_latency_time >= latency_interval)) {
+            uart_send_latency();
+            last_latency_time = now;
+        }
+
+#if PROFILER_ENABLED
+        if (slot && (now - last_profile_time >= profile_interval)) {
+            uart_send_profile();
+            // Frame intervals are read without a lock: each is one 16-bit
+            // store by the animation task
+            uart_send_schedule(g_npm_state.fx.frame_ms, g_npr_state.fx.frame_ms,
+                               g_rgb_state.fx.frame_ms, led_matrix_frame_ms(&g_matrix_state),
+                               TASK_ANIMATION_CORE);
+            last_profile_time = now;
+        }
+#endif
+
+        profiler_loop_end(PRF_TASK_COMM);
     }
 }
 
 // =============================================================================
-// Animation Task - NeoPixel & RGB animations (Core 1)
+// Animation Task - NeoPixel, MAX7219 & RGB animations (LED_RENDER_CORE)
 // =============================================================================
+
+// Earlier of two frame waits
+static inline uint32_t earliest(uint32_t a, uint32_t b) {
+    return (a < b) ? a : b;
+}
+
 void animation_task(void* pvParameters) {
-    const TickType_t period = pdMS_TO_TICKS(ANIMATION_TASK_PERIOD_MS);
+    uint16_t period_ms = g_params.animation_period_ms;
+    uint32_t param_gen = param_generation();
+    uint32_t led_request_gen = 0;
+    LedModeRequest rgb_request;         // Taken, waiting for g_state_mutex
+    bool rgb_request_pending = false;
+    TimelineKey rgb_key;                // Keyframe target, waiting for g_state_mutex
+    bool rgb_key_pending = false;
+    uint32_t wait_ms = 0;
+
+    // LED drivers come up here, behind the control loop: the RMT channels,
+    // the MAX7219 chain (and its lamp test) and the RGB PWM
+    rgb_init();
+    npm_init(NPM_DATA_PIN);
+    npr_init(NPR_DATA_PIN);
+    led_matrix_init();
+    g_boot_leds_us = boot_us();
 
     DEBUG_PRINTF("[RTOS] Animation task started on Core %d\n", xPortGetCoreID());
 
     for (;;) {
-        TickType_t task_start = xTaskGetTickCount();
+        // Sleep until the earliest output is due. Mode, glyph and timeline
+        // changes from the other tasks notify, so a new static frame does
+        // not wait for the idle wake.
+        if (wait_ms > 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+        }
+        profiler_loop_begin(PRF_TASK_ANIMATION);
+
+        // Re-apply tuned brightness and period after a $PRM change (the
+        // period is the fastest frame interval and the overrun budget)
+        uint32_t gen = param_generation();
+        if (gen != param_gen) {
+            param_gen = gen;
+            npm_set_brightness(g_params.npm_brightness);
+            npr_set_brightness(g_params.npr_brightness);
+            led_matrix_set_brightness(g_params.matrix_brightness);
+            if (g_params.animation_period_ms != period_ms) {
+                period_ms = g_params.animation_period_ms;
+                profiler_register_task(PRF_TASK_ANIMATION, g_animation_task_handle, period_ms, false);
+            }
+        }
+
+        // Apply everything the control task (Core 1) changed in one tick
+        // together, before any of it is drawn
+        LedRequest request;
+        if (led_request_take(&led_request_gen, &request)) {
+            if (request.changed & LED_REQ_NPM) {
+                const LedModeRequest* m = &request.npm;
+                npm_set_mode(&g_npm_state, m->mode, m->letter, m->r, m->g, m->b,
+                             m->r2, m->g2, m->b2, m->speed);
+            }
+            if (request.changed & LED_REQ_NPR) {
+                const LedModeRequest* m = &request.npr;
+                npr_set_mode(&g_npr_state, m->mode, m->r, m->g, m->b,
+                             m->r2, m->g2, m->b2, m->speed);
+            }
+            if (request.changed & LED_REQ_MATRIX) {
+                led_matrix_set_patterns(request.matrix_left, request.matrix_right);
+            }
+            if (request.changed & LED_REQ_RGB) {
+                rgb_request = request.rgb;
+                rgb_request_pending = true;
+            }
+        }
+
+        // Apply the playing keyframe sequence (if any) before drawing
+        uint32_t now_ms = millis();
+        TimelineKey frames[TIMELINE_DEV_COUNT];
+        uint8_t timeline_changed = timeline_update(now_ms, frames);
 
-        // Update NeoPixel matrix (no mutex needed - state is simple)
-        npm_update(&g_npm_state);
+        // timeline_update reports each target once, so keep the RGB one
+        // until the locked section below has applied it
+        if (timeline_changed & (1 << TIMELINE_DEV_RGB)) {
+            rgb_key = frames[TIMELINE_DEV_RGB];
+            rgb_key_pending = true;
+        }
 
-        // Update NeoPixel ring animation (no mutex needed - state is simple)
-        npr_update(&g_npr_state);
+        if (timeline_changed & (1 << TIMELINE_DEV_NPM)) {
+            const TimelineKey* k = &frames[TIMELINE_DEV_NPM];
+            npm_set_mode(&g_npm_state, k->mode, k->letter, k->r, k->g, k->b,
+                         k->r2, k->g2, k->b2, k->speed);
+        }
+        if (timeline_changed & (1 << TIMELINE_DEV_NPR)) {
+            const TimelineKey* k = &frames[TIMELINE_DEV_NPR];
+            npr_set_mode(&g_npr_state, k->mode, k->r, k->g, k->b,
+                         k->r2, k->g2, k->b2, k->speed);
+        }
 
-        // Update RGB strip animation with mutex protection
-        // (consistent with how control_task sets the state)
+        // Draw only the outputs whose frame is due (the NeoPixel and MAX7219
+        // state belongs to this task; other tasks only post requests)
+        if (npm_frame_wait_ms(&g_npm_state, now_ms) == 0) {
+            npm_update(&g_npm_state);
+        }
+        if (npr_frame_wait_ms(&g_npr_state, now_ms) == 0) {
+            npr_update(&g_npr_state);
+        }
+
+        // Render the MAX7219 matrices and queue their changed rows (SPI DMA)
+        if (led_matrix_frame_wait_ms(&g_matrix_state, now_ms) == 0) {
+            led_matrix_update(&g_matrix_state);
+        }
+
+        // Update RGB strip animation with mutex protection (a requested mode
+        // or keyframe that misses the lock is applied on the next pass)
+        uint32_t rgb_wait_ms = period_ms;   // Retry if the lock times out
         if (state_lock(pdMS_TO_TICKS(5))) {
-            rgb_update(&g_rgb_state);
+            if (rgb_request_pending) {
+                const LedModeRequest* m = &rgb_request;
+                rgb_set_mode(&g_rgb_state, m->mode, m->r, m->g, m->b,
+                             m->r2, m->g2, m->b2, m->speed);
+                rgb_request_pending = false;
+            }
+            if (rgb_key_pending) {
+                const TimelineKey* k = &rgb_key;
+                rgb_set_mode(&g_rgb_state, k->mode, k->r, k->g, k->b,
+                             k->r2, k->g2, k->b2, k->speed);
+                rgb_key_pending = false;
+            }
+            if (rgb_frame_wait_ms(&g_rgb_state, now_ms) == 0) {
+                rgb_update(&g_rgb_state);
+            } else if (rgb_dither_active()) {
+                rgb_dither_frame();
+            }
+            rgb_wait_ms = rgb_frame_wait_ms(&g_rgb_state, now_ms);
+            if (rgb_dither_active()) {
+                rgb_wait_ms = earliest(rgb_wait_ms, period_ms);
+            }
             state_unlock();
         }
 
-        // Delay until next period
-        vTaskDelayUntil(&task_start, period);
+        // Push only the NeoPixel frames that changed, dimming every output
+        // together if the frame would exceed the power budget
+        compositor_set_external_load(rgb_load_ma());
+        compositor_show();
+        rgb_set_power_scale(compositor_power_scale());
+
+        // Next wake: the earliest output deadline, at most one animation
+        // period away while a timeline plays or a frame waits for its
+        // driver, and never later than the idle wake (picks up $PRM)
+        wait_ms = earliest(npm_frame_wait_ms(&g_npm_state, now_ms),
+                           npr_frame_wait_ms(&g_npr_state, now_ms));
+        wait_ms = earliest(wait_ms, led_matrix_frame_wait_ms(&g_matrix_state, now_ms));
+        wait_ms = earliest(wait_ms, rgb_wait_ms);
+        if (timeline_active() || compositor_pending()) {
+            wait_ms = earliest(wait_ms, period_ms);
+        }
+        wait_ms = earliest(wait_ms, ANIMATION_IDLE_WAKE_MS);
+
+        profiler_loop_end(PRF_TASK_ANIMATION);
+    }
+}
+
+// =============================================================================
+// Control Timer - paces and supervises the control task (esp_timer task, Core 0)
+// =============================================================================
+void control_timer_callback(void* arg) {
+    if (g_control_task_handle != NULL) {
+        xTaskNotifyGive(g_control_task_handle);
+    }
+
+    // Runs on the other core, so it still fires when Core 1 is wedged.
+    // Only the valve PWM is forced shut here - the planner state belongs to
+    // the control task, which takes the valve over when it runs again. The
+    // task watchdog resets the board if the loop stays hung.
+    // An NVS write freezes every task (this one included) while the flash
+    // cache is off: a heartbeat gone stale across one is not a stall.
+    uint32_t heartbeat = g_control_heartbeat_ms;
+    uint32_t now = millis();
+    if (!g_control_failsafe && heartbeat != 0 && !g_flash_write_active &&
+        now - heartbeat > CONTROL_STALL_MS && now - g_flash_write_end_ms > CONTROL_STALL_MS) {
+        g_control_failsafe = true;
+        servo_force_pwm(VALVE_SERVO_INDEX, VALVE_CLOSED_ANGLE);
     }
 }
 
@@ -142,7 +471,12 @@ void animation_task(void* pvParameters) {
 // Control Task - Servos, sensors, valve (Core 1)
 // =============================================================================
 void control_task(void* pvParameters) {
-    const TickType_t period = pdMS_TO_TICKS(CONTROL_TASK_PERIOD_MS);
+    // Timer ticks normally wake us; the timeout only keeps the loop (and the
+    // valve logic) alive if the timer could not be started. The period is
+    // read once, like the timer's: PARAM_CONTROL_PERIOD_MS applies after a reset
+    const uint32_t period_ms = g_params.control_period_ms;
+    const TickType_t tick_timeout = pdMS_TO_TICKS(period_ms * 2);
+    uint32_t param_gen = param_generation();
 
     // Track previous values for change detection
     uint8_t prev_rgb_mode = 255;
@@ -155,143 +489,298 @@ void control_task(void* pvParameters) {
     // NPR tracking
     uint8_t prev_npr_mode = 255;
     uint8_t prev_npr_r = 255, prev_npr_g = 255, prev_npr_b = 255;
+    // MAX7219 matrix tracking
+    uint8_t prev_matrix_left = 255, prev_matrix_right = 255;
+    // One-shot command tracking (see CommandState::valve_seq / flags_seq)
+    uint8_t prev_valve_seq = 0;
+    uint8_t prev_flags_seq = 0;
+    uint8_t prev_pour_seq = 0;
+    bool test_pending = false;
+    // Telemetry event tracking (edges wake the comm task immediately)
+    uint8_t prev_limit_dir = LIMIT_NONE;
+    bool prev_valve_open = false;
+    bool prev_valve_enabled = true;
+    // Failsafe handling (see control_timer_callback)
+    uint32_t failsafe_ok_since_ms = 0;
 
     DEBUG_PRINTF("[RTOS] Control task started on Core %d\n", xPortGetCoreID());
 
+    // A hung loop stops feeding the watchdog -> panic reset (valve boots closed)
+    esp_task_wdt_add(NULL);
+
     for (;;) {
-        TickType_t task_start = xTaskGetTickCount();
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, tick_timeout);
+        esp_task_wdt_reset();
+        profiler_loop_begin(PRF_TASK_CONTROL);
+
+        // Fixed step per timer tick; missed ticks are caught up in one step
+        uint32_t step_ms = (ticks > 0)
+            ? min(ticks, (uint32_t)CONTROL_MAX_CATCHUP_TICKS) * period_ms
+            : period_ms * 2;
+
+        // Re-apply tuned motion limits after a $PRM change (valve keeps its own)
+        uint32_t gen = param_generation();
+        if (gen != param_gen) {
+            param_gen = gen;
+            for (int i = 0; i < NUM_SERVOS; i++) {
+                if (i != VALVE_SERVO_INDEX) {
+                    servo_set_limits(i, g_params.servo_max_velocity, g_params.servo_max_accel);
+                }
+            }
+        }
 
-        // Read limit switch (no mutex needed - atomic operation)
+        // The timer shut the valve PWM while this loop was stalled: bring the
+        // planner in line and drop the open command and any pour, so the
+        // valve only reopens when the Pi asks again. Reported until the loop
+        // has run on time for CONTROL_FAILSAFE_CLEAR_MS.
+        bool failsafe_edge = false;
+        if (g_control_failsafe) {
+            uint32_t now_ms = millis();
+            uint32_t stall_ms = now_ms - g_control_heartbeat_ms;
+            if (!g_state.output.control_failsafe) {
+                servo_set_angle(VALVE_SERVO_INDEX, VALVE_CLOSED_ANGLE);
+                dispense_cancel(&g_dispense_state, &g_valve_state);
+                valve_safety_set_command(&g_valve_state, false);
+                g_state.output.control_failsafe = true;
+                failsafe_edge = true;
+                trace_task_event(TRACE_EV_FAILSAFE, PRF_TASK_CONTROL, stall_ms * 1000);
+                DEBUG_PRINTF("[CONTROL] Failsafe: loop stalled %u ms, valve shut\n", (unsigned)stall_ms);
+            }
+            if (failsafe_edge || stall_ms > CONTROL_STALL_MS) {
+                failsafe_ok_since_ms = now_ms;
+            } else if (now_ms - failsafe_ok_since_ms >= CONTROL_FAILSAFE_CLEAR_MS) {
+                g_state.output.control_failsafe = false;
+                failsafe_edge = true;
+                g_control_failsafe = false;
+            }
+        }
+
+        // Limit switch (the edge interrupt has already fenced the base servo)
         bool limit_active;
         uint8_t limit_dir;
         limit_switch_read(&limit_active, &limit_dir);
 
-        if (state_lock(pdMS_TO_TICKS(10))) {
-            // Update limit switch state
-            state_update_limit(&g_state, limit_active, limit_dir);
+        // Snapshot the latest commands; never blocks on the comm task
+        CommandState cmd;
+        state_read_command(&cmd);
+
+        // Update limit switch state
+        state_update_limit(&g_state, limit_active, limit_dir,
+                           limit_switch_trigger_us(), limit_switch_chatter());
 
-            // Check for test command
-            if ((g_state.command.flags & CMD_FLAG_LED_TEST) && !g_test_led_on) {
-                g_test_led_on = true;
-                g_test_triggered_time = xTaskGetTickCount();
-                digitalWrite(TEST_LED_PIN, HIGH);
-                g_state.command.flags &= ~CMD_FLAG_LED_TEST;
+        // Check for test command (latched until the LED is free)
+        if (cmd.flags_seq != prev_flags_seq) {
+            prev_flags_seq = cmd.flags_seq;
+            if (cmd.flags & CMD_FLAG_LED_TEST) {
+                test_pending = true;
             }
+        }
+        if (test_pending && !g_test_led_on) {
+            g_test_led_on = true;
+            g_test_triggered_time = xTaskGetTickCount();
+            digitalWrite(TEST_LED_PIN, HIGH);
+            test_pending = false;
+        }
 
-            // Update valve (command is set by uart_handler when $VLV received, not here)
-            // valve_safety_set_command is called in uart_handler, not every tick
-            bool valve_should_open = valve_safety_update(&g_valve_state, g_state.command.connected);
-            g_state.command.target_servo_angles[VALVE_SERVO_INDEX] =
-                valve_should_open ? VALVE_OPEN_ANGLE : VALVE_CLOSED_ANGLE;
+        // Hand each new $VLV to the safety module once, so an auto-close sticks.
+        // A plain open/close takes the valve over from a metered pour.
+        if (cmd.valve_seq != prev_valve_seq) {
+            prev_valve_seq = cmd.valve_seq;
+            dispense_cancel(&g_dispense_state, &g_valve_state);
+            valve_safety_set_command(&g_valve_state, cmd.valve_open);
+        }
 
-            // Update servos
-            for (int i = 0; i < NUM_SERVOS; i++) {
-                float target = g_state.command.target_servo_angles[i];
-                float current = g_state.output.servo_angles[i];
-                float new_angle = servo_move_toward(i, current, target, SERVO_SPEED);
-                bool moving = (abs(new_angle - target) > 0.1f);
-                state_update_servo(&g_state, i, new_angle, moving);
+        if (cmd.pour_seq != prev_pour_seq) {
+            prev_pour_seq = cmd.pour_seq;
+            if (cmd.pour_ml > 0.0f) {
+                dispense_start(&g_dispense_state, &g_valve_state, cmd.pour_ml);
+            } else {
+                dispense_cancel(&g_dispense_state, &g_valve_state);
             }
+        }
+
+        // Meter the pour over the last step; a close it issues applies below
+        bool pour_finished = dispense_update(&g_dispense_state, &g_valve_state,
+                                             servo_get_angle(VALVE_SERVO_INDEX),
+                                             step_ms / 1000.0f, cmd.connected);
 
-            // Update RGB strip mode (animations handled in animation task)
-            uint8_t mode = g_state.command.rgb_mode;
-            uint8_t r = g_state.command.rgb_r;
-            uint8_t g = g_state.command.rgb_g;
-            uint8_t b = g_state.command.rgb_b;
-            uint8_t r2 = g_state.command.rgb_r2;
-            uint8_t g2 = g_state.command.rgb_g2;
-            uint8_t b2 = g_state.command.rgb_b2;
-            uint8_t rgb_speed = g_state.command.rgb_gradient_speed;
-            uint8_t light_cmd = g_state.command.light_command;
-
-            bool should_be_on = false;
-            switch (light_cmd) {
-                case LIGHT_CMD_OFF: should_be_on = false; break;
-                case LIGHT_CMD_ON:  should_be_on = true;  break;
-                case LIGHT_CMD_AUTO:
-                    // Mode 1=rainbow, 2=gradient are animated, or any color set
-                    should_be_on = (mode >= RGB_MODE_RAINBOW) || (r > 0 || g > 0 || b > 0);
-                    break;
+        bool valve_should_open = valve_safety_update(&g_valve_state, cmd.connected);
+        if (g_state.output.control_failsafe) {
+            // Recovering from a stall: keep the valve shut
+            valve_should_open = false;
+        }
+        cmd.target_servo_angles[VALVE_SERVO_INDEX] =
+            valve_should_open ? VALVE_OPEN_ANGLE : VALVE_CLOSED_ANGLE;
+
+        g_state.output.valve_open = g_valve_state.actual_open;
+        g_state.output.valve_enabled = g_valve_state.enabled;
+        g_state.output.valve_open_ms = valve_safety_get_open_ms(&g_valve_state);
+        g_state.output.pour_phase = g_dispense_state.phase;
+        g_state.output.pour_seq = g_dispense_state.seq;
+        g_state.output.pour_end_reason = g_dispense_state.end_reason;
+        g_state.output.pour_target_ml = g_dispense_state.target_ml;
+        g_state.output.pour_ml = g_dispense_state.poured_ml;
+        g_state.output.pour_duration_ms = g_dispense_state.duration_ms;
+
+        // Update servos (feed-forward only while servo packets keep arriving)
+        uint32_t now_ms = millis();
+        bool feedforward_fresh = cmd.connected &&
+            (now_ms - cmd.last_command_time < SERVO_FEEDFORWARD_TIMEOUT_MS);
+        for (int i = 0; i < NUM_SERVOS; i++) {
+            float target = cmd.target_servo_angles[i];
+            float feedforward = (feedforward_fresh && i != VALVE_SERVO_INDEX)
+                ? cmd.target_servo_velocity[i] : 0.0f;
+
+            // Timestamped targets: extrapolate from capture time to this tick
+            if (i != VALVE_SERVO_INDEX && cmd.target_timed && cmd.connected) {
+                predictor_sample(i, cmd.target_servo_angles[i], cmd.target_servo_velocity[i],
+                                 cmd.target_capture_ms, cmd.target_seq);
+                target = predictor_predict(i, now_ms, &feedforward);
+            } else if (predictor_valid(i)) {
+                predictor_reset(i);
             }
 
-            // Only update RGB state when something actually changed
-            // This prevents control_task from interfering with animation_task's gradient animation
-            bool rgb_changed = (should_be_on != g_state.output.light_on) ||
-                               (mode != prev_rgb_mode) ||
-                               (r != prev_rgb_r) || (g != prev_rgb_g) || (b != prev_rgb_b);
-
-            if (rgb_changed) {
-                if (!should_be_on) {
-                    // Turn off - set to solid black
-                    rgb_set_mode(&g_rgb_state, RGB_MODE_SOLID, 0, 0, 0, 0, 0, 0, 10);
-                    prev_rgb_r = 0;
-                    prev_rgb_g = 0;
-                    prev_rgb_b = 0;
-                } else {
-                    // Use default white if solid mode with no color set
-                    if (mode == RGB_MODE_SOLID && r == 0 && g == 0 && b == 0) {
-                        r = g = b = 255;
-                    }
-                    rgb_set_mode(&g_rgb_state, mode, r, g, b, r2, g2, b2, rgb_speed);
-                    prev_rgb_r = r;
-                    prev_rgb_g = g;
-                    prev_rgb_b = b;
+            servo_set_target(i, target, feedforward);
+            float new_angle = servo_update(i, step_ms / 1000.0f);
+            state_update_servo(&g_state, i, new_angle, servo_is_moving(i));
+        }
+
+        // LED changes handed to the animation task together this tick
+        LedRequest leds;
+        leds.changed = 0;
+
+        // Update RGB strip mode (animations handled in animation task)
+        uint8_t mode = cmd.rgb_mode;
+        uint8_t r = cmd.rgb_r;
+        uint8_t g = cmd.rgb_g;
+        uint8_t b = cmd.rgb_b;
+        uint8_t r2 = cmd.rgb_r2;
+        uint8_t g2 = cmd.rgb_g2;
+        uint8_t b2 = cmd.rgb_b2;
+        uint8_t rgb_speed = cmd.rgb_gradient_speed;
+        uint8_t light_cmd = cmd.light_command;
+
+        bool should_be_on = false;
+        switch (light_cmd) {
+            case LIGHT_CMD_OFF: should_be_on = false; break;
+            case LIGHT_CMD_ON:  should_be_on = true;  break;
+            case LIGHT_CMD_AUTO:
+                // Mode 1=rainbow, 2=gradient are animated, or any color set
+                should_be_on = (mode >= RGB_MODE_RAINBOW) || (r > 0 || g > 0 || b > 0);
+                break;
+        }
+
+        // Only update RGB state when something actually changed
+        // This prevents control_task from interfering with animation_task's gradient animation
+        bool rgb_changed = (should_be_on != g_state.output.light_on) ||
+                           (mode != prev_rgb_mode) ||
+                           (r != prev_rgb_r) || (g != prev_rgb_g) || (b != prev_rgb_b);
+
+        if (rgb_changed) {
+            if (!should_be_on) {
+                // Turn off - set to solid black
+                leds.rgb = { RGB_MODE_SOLID, 0, 0, 0, 0, 0, 0, 0, 10 };
+                prev_rgb_r = 0;
+                prev_rgb_g = 0;
+                prev_rgb_b = 0;
+            } else {
+                // Use default white if solid mode with no color set
+                if (mode == RGB_MODE_SOLID && r == 0 && g == 0 && b == 0) {
+                    r = g = b = 255;
                 }
+                leds.rgb = { mode, 0, r, g, b, r2, g2, b2, rgb_speed };
+                prev_rgb_r = r;
+                prev_rgb_g = g;
+                prev_rgb_b = b;
             }
+            leds.changed |= LED_REQ_RGB;
 
-            prev_light_cmd = light_cmd;
             prev_rgb_mode = mode;
             state_update_light(&g_state, should_be_on);
+        }
 
-            // Update NeoPixel matrix only when values change (prevents gradient flicker)
-            {
-                uint8_t npm_mode = g_state.command.npm_mode;
-                char npm_letter = g_state.command.npm_letter;
-                uint8_t npm_r = g_state.command.npm_r;
-                uint8_t npm_g = g_state.command.npm_g;
-                uint8_t npm_b = g_state.command.npm_b;
-
-                bool npm_changed = (npm_mode != prev_npm_mode) ||
-                                   (npm_letter != prev_npm_letter) ||
-                                   (npm_r != prev_npm_r) || (npm_g != prev_npm_g) || (npm_b != prev_npm_b);
-
-                if (npm_changed) {
-                    npm_set_mode(&g_npm_state, npm_mode, npm_letter, npm_r, npm_g, npm_b,
-                                g_state.command.npm_r2, g_state.command.npm_g2,
-                                g_state.command.npm_b2, g_state.command.npm_gradient_speed);
-                    prev_npm_mode = npm_mode;
-                    prev_npm_letter = npm_letter;
-                    prev_npm_r = npm_r;
-                    prev_npm_g = npm_g;
-                    prev_npm_b = npm_b;
-                }
+        prev_light_cmd = light_cmd;
+
+        // Request a NeoPixel matrix mode only when values change (prevents gradient flicker)
+        {
+            uint8_t npm_mode = cmd.npm_mode;
+            char npm_letter = cmd.npm_letter;
+            uint8_t npm_r = cmd.npm_r;
+            uint8_t npm_g = cmd.npm_g;
+            uint8_t npm_b = cmd.npm_b;
+
+            bool npm_changed = (npm_mode != prev_npm_mode) ||
+                               (npm_letter != prev_npm_letter) ||
+                               (npm_r != prev_npm_r) || (npm_g != prev_npm_g) || (npm_b != prev_npm_b);
+
+            if (npm_changed) {
+                leds.npm = { npm_mode, npm_letter, npm_r, npm_g, npm_b,
+                             cmd.npm_r2, cmd.npm_g2, cmd.npm_b2, cmd.npm_gradient_speed };
+                leds.changed |= LED_REQ_NPM;
+                prev_npm_mode = npm_mode;
+                prev_npm_letter = npm_letter;
+                prev_npm_r = npm_r;
+                prev_npm_g = npm_g;
+                prev_npm_b = npm_b;
             }
+        }
 
-            // Update NeoPixel ring only when values change (prevents gradient flicker)
-            {
-                uint8_t npr_mode = g_state.command.npr_mode;
-                uint8_t npr_r = g_state.command.npr_r;
-                uint8_t npr_g = g_state.command.npr_g;
-                uint8_t npr_b = g_state.command.npr_b;
-
-                bool npr_changed = (npr_mode != prev_npr_mode) ||
-                                   (npr_r != prev_npr_r) || (npr_g != prev_npr_g) || (npr_b != prev_npr_b);
-
-                if (npr_changed) {
-                    npr_set_mode(&g_npr_state, npr_mode, npr_r, npr_g, npr_b,
-                                g_state.command.npr_r2, g_state.command.npr_g2,
-                                g_state.command.npr_b2, g_state.command.npr_gradient_speed);
-                    prev_npr_mode = npr_mode;
-                    prev_npr_r = npr_r;
-                    prev_npr_g = npr_g;
-                    prev_npr_b = npr_b;
-                }
+        // Request a NeoPixel ring mode only when values change (prevents gradient flicker)
+        {
+            uint8_t npr_mode = cmd.npr_mode;
+            uint8_t npr_r = cmd.npr_r;
+            uint8_t npr_g = cmd.npr_g;
+            uint8_t npr_b = cmd.npr_b;
+
+            bool npr_changed = (npr_mode != prev_npr_mode) ||
+                               (npr_r != prev_npr_r) || (npr_g != prev_npr_g) || (npr_b != prev_npr_b);
+
+            if (npr_changed) {
+                leds.npr = { npr_mode, 0, npr_r, npr_g, npr_b,
+                             cmd.npr_r2, cmd.npr_g2, cmd.npr_b2, cmd.npr_gradient_speed };
+                leds.changed |= LED_REQ_NPR;
+                prev_npr_mode = npr_mode;
+                prev_npr_r = npr_r;
+                prev_npr_g = npr_g;
+                prev_npr_b = npr_b;
             }
+        }
 
-            state_unlock();
+        // Request MAX7219 pattern changes
+        if (cmd.matrix_left != prev_matrix_left || cmd.matrix_right != prev_matrix_right) {
+            leds.matrix_left = cmd.matrix_left;
+            leds.matrix_right = cmd.matrix_right;
+            leds.changed |= LED_REQ_MATRIX;
+            prev_matrix_left = cmd.matrix_left;
+            prev_matrix_right = cmd.matrix_right;
+        }
+
+        // Publish this tick's LED changes as one request and draw them now
+        // rather than at the animation task's next deadline (a static frame
+        // has none)
+        if (leds.changed) {
+            led_request_publish(&leds);
+            on_leds_changed();
+        }
+
+        // Publish for telemetry (comm task reads this without blocking us)
+        state_publish_outputs(&g_state.input, &g_state.output);
+
+        // Limit and valve edges and pour results should not wait for the
+        // next status period
+        if (g_state.input.limit_direction != prev_limit_dir ||
+            g_state.output.valve_open != prev_valve_open ||
+            g_state.output.valve_enabled != prev_valve_enabled || pour_finished ||
+            failsafe_edge) {
+            prev_limit_dir = g_state.input.limit_direction;
+            prev_valve_open = g_state.output.valve_open;
+            prev_valve_enabled = g_state.output.valve_enabled;
+            if (g_comm_task_handle != NULL) {
+                xTaskNotifyGive(g_comm_task_handle);
+            }
         }
 
-        // Update test LED (non-blocking, outside mutex)
+        // Update test LED (non-blocking)
         if (g_test_led_on) {
             if ((xTaskGetTickCount() - g_test_triggered_time) >= pdMS_TO_TICKS(TEST_LED_DURATION_MS)) {
                 digitalWrite(TEST_LED_PIN, LOW);
@@ -299,8 +788,11 @@ void control_task(void* pvParameters) {
             }
         }
 
-        // Delay until next period
-        vTaskDelayUntil(&task_start, period);
+        g_control_heartbeat_ms = millis();
+        if (g_boot_control_us == 0) {
+            g_boot_control_us = boot_us();
+        }
+        profiler_loop_end(PRF_TASK_CONTROL);
     }
 }
 
@@ -312,16 +804,11 @@ void on_command_received() {
     g_has_received_command = true;
 }
 
-bool get_valve_open() {
-    return g_valve_state.actual_open;
-}
-
-bool get_valve_enabled() {
-    return g_valve_state.enabled;
-}
-
-uint32_t get_valve_open_ms() {
-    return valve_safety_get_open_ms(&g_valve_state);
+void on_flash_write(bool active) {
+    if (!active) {
+        g_flash_write_end_ms = millis();
+    }
+    g_flash_write_active = active;
 }
 
 bool is_test_active() {
@@ -333,47 +820,78 @@ bool is_test_active() {
 // Setup & Loop
 // =============================================================================
 void setup() {
-    // Initialize USB serial for protocol communication
-    Serial.begin(115200);
-    delay(100);
+    // Staged boot: safety outputs first, then the control loop, then the
+    // Pi link and LEDs from their own tasks. After a brownout the valve pin
+    // carries the closed pulse within microseconds instead of floating
+    // through the serial and LED bring-up.
 
-    DEBUG_PRINTLN("=================================");
-    DEBUG_PRINTLN("ESP32 RTOS Firmware Starting...");
-    DEBUG_PRINTLN("=================================");
-
-    // Seed random number generator
-    randomSeed(analogRead(0) ^ micros());
+    // Stage 1 - valve closed and limit switch (need nothing else)
+    servo_init_valve();
+    limit_switch_init();
+    g_boot_valve_us = boot_us();
 
-    // Initialize test LED
     pinMode(TEST_LED_PIN, OUTPUT);
     digitalWrite(TEST_LED_PIN, LOW);
 
-    // Initialize state
+    // Stage 2 - control loop. Tuned parameters load before anything reads g_params
+    param_store_init();
+
     state_init(&g_state);
     valve_safety_init(&g_valve_state);
+    dispense_init(&g_dispense_state);
     npm_state_init(&g_npm_state);
     npr_state_init(&g_npr_state);
+    led_matrix_scroll_init(&g_matrix_state);
     rgb_state_init(&g_rgb_state);
+    state_publish_command(&g_state.command);
+    state_publish_outputs(&g_state.input, &g_state.output);
 
-    // Initialize hardware components
-    uart_init();
     servo_init();
-    rgb_init();
-    limit_switch_init();
-    npm_init(NPM_DATA_PIN);
-    npr_init(NPR_DATA_PIN);
+    predictor_init();
 
-    // Create mutex for state protection
+    // Mutex for g_rgb_state, shared by the control and animation tasks
     g_state_mutex = xSemaphoreCreateMutex();
     if (g_state_mutex == NULL) {
         DEBUG_PRINTLN("[ERROR] Failed to create state mutex!");
         while (1) { delay(1000); }
     }
 
-    // Create RTOS tasks
-    DEBUG_PRINTLN("[RTOS] Creating tasks...");
+    // Task watchdog for the control loop (panics -> resets on timeout);
+    // set up before the task subscribes to it
+    esp_task_wdt_init(CONTROL_WDT_TIMEOUT_S, true);
+
+    // Control task on Core 1 (preempts setup() as soon as it is created)
+    xTaskCreatePinnedToCore(
+        control_task,
+        "CtrlTask",
+        TASK_CONTROL_STACK_SIZE,
+        NULL,
+        TASK_CONTROL_PRIORITY,
+        &g_control_task_handle,
+        TASK_CONTROL_CORE
+    );
+    profiler_register_task(PRF_TASK_CONTROL, g_control_task_handle, g_params.control_period_ms);
+
+    // Hardware-timed control ticks, independent of the FreeRTOS tick rate
+    const esp_timer_create_args_t control_timer_args = {
+        .callback = control_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "control",
+    };
+    if (esp_timer_create(&control_timer_args, &g_control_timer) != ESP_OK ||
+        esp_timer_start_periodic(g_control_timer, (uint64_t)g_params.control_period_ms * 1000) != ESP_OK) {
+        DEBUG_PRINTLN("[ERROR] Failed to start control timer - falling back to task timeout");
+    }
+
+    // Stage 3 - everything else, while the control loop already runs.
+    // Uploaded scroll slots and timelines are restored before the tasks
+    // that use them start.
+    randomSeed(analogRead(0) ^ micros());
+    scroll_store_init();
+    timeline_init();
 
-    // Communication task on Core 0
+    // Communication task on Core 0 (starts the UART link)
     xTaskCreatePinnedToCore(
         comm_task,
         "CommTask",
@@ -383,8 +901,10 @@ void setup() {
         &g_comm_task_handle,
         TASK_COMM_CORE
     );
+    profiler_register_task(PRF_TASK_COMM, g_comm_task_handle, 0);
 
-    // Animation task on Core 1
+    // Animation task on LED_RENDER_CORE (initializes the LED drivers); it
+    // wakes at varying intervals, so only its overruns are profiled
     xTaskCreatePinnedToCore(
         animation_task,
         "AnimTask",
@@ -394,20 +914,10 @@ void setup() {
         &g_animation_task_handle,
         TASK_ANIMATION_CORE
     );
-
-    // Control task on Core 1
-    xTaskCreatePinnedToCore(
-        control_task,
-        "CtrlTask",
-        TASK_CONTROL_STACK_SIZE,
-        NULL,
-        TASK_CONTROL_PRIORITY,
-        &g_control_task_handle,
-        TASK_CONTROL_CORE
-    );
+    profiler_register_task(PRF_TASK_ANIMATION, g_animation_task_handle,
+                           g_params.animation_period_ms, false);
 
     DEBUG_PRINTLN("[RTOS] All tasks created successfully!");
-    DEBUG_PRINTLN("=================================");
 }
 
 void loop() {
@@ -0,0 +1,161 @@
+#include "matrix_driver.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+
+// MAX7219 register addresses
+#define MAX7219_REG_DIGIT0        0x01    // Digits 0-7 are registers 0x01-0x08
+#define MAX7219_REG_DECODE_MODE   0x09
+#define MAX7219_REG_INTENSITY     0x0A
+#define MAX7219_REG_SCAN_LIMIT    0x0B
+#define MAX7219_REG_SHUTDOWN      0x0C
+#define MAX7219_REG_DISPLAY_TEST  0x0F
+
+// One 16-bit word (register, data) per module, per transaction
+#define MATRIX_FRAME_BYTES  (MATRIX_NUM_DEVICES * 2)
+
+// Digit transactions plus one register write (intensity) per frame
+#define MATRIX_QUEUE_SIZE   (MATRIX_DIGITS + 1)
+
+static spi_device_handle_t device = NULL;
+
+// DMA reads these while transactions are in flight; only touched when idle
+static WORD_ALIGNED_ATTR uint8_t digit_tx[MATRIX_DIGITS][MATRIX_FRAME_BYTES];
+static WORD_ALIGNED_ATTR uint8_t reg_tx[MATRIX_FRAME_BYTES];
+static spi_transaction_t digit_trans[MATRIX_DIGITS];
+static spi_transaction_t reg_trans;
+
+static uint8_t in_flight = 0;
+static int16_t pending_intensity = -1;     // -1 = nothing to send
+static uint32_t rows_sent = 0;
+
+/**
+ * Fill a transaction buffer with the same register for every module.
+ * The first word shifted out ends up in the module farthest from DIN.
+ */
+static void fill_register(uint8_t* tx, uint8_t reg, uint8_t value) {
+    for (uint8_t dev = 0; dev < MATRIX_NUM_DEVICES; dev++) {
+        tx[dev * 2] = reg;
+        tx[dev * 2 + 1] = value;
+    }
+}
+
+// Collect finished transactions without waiting
+static void reap() {
+    spi_transaction_t* done;
+    while (in_flight > 0 && spi_device_get_trans_result(device, &done, 0) == ESP_OK) {
+        in_flight--;
+    }
+}
+
+/**
+ * Write one register on every module and wait for it (setup only).
+ */
+static bool write_register_blocking(uint8_t reg, uint8_t value) {
+    fill_register(reg_tx, reg, value);
+    memset(&reg_trans, 0, sizeof(reg_trans));
+    reg_trans.length = MATRIX_FRAME_BYTES * 8;
+    reg_trans.tx_buffer = reg_tx;
+    return spi_device_polling_transmit(device, &reg_trans) == ESP_OK;
+}
+
+static bool queue(spi_transaction_t* trans, const uint8_t* tx) {
+    memset(trans, 0, sizeof(*trans));
+    trans->length = MATRIX_FRAME_BYTES * 8;
+    trans->tx_buffer = tx;
+    if (spi_device_queue_trans(device, trans, 0) != ESP_OK) {
+        return false;
+    }
+    in_flight++;
+    return true;
+}
+
+bool matrix_driver_init(uint8_t brightness) {
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = MATRIX_DATA_PIN;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = MATRIX_CLK_PIN;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = MATRIX_FRAME_BYTES;
+
+    spi_device_interface_config_t dev = {};
+    dev.mode = 0;                          // MAX7219 samples DIN on the rising edge
+    dev.clock_speed_hz = MATRIX_SPI_CLOCK_HZ;
+    dev.spics_io_num = MATRIX_CS_PIN;      // LOAD latches on the rising edge of CS
+    dev.queue_size = MATRIX_QUEUE_SIZE;
+
+    if (spi_bus_initialize(MATRIX_SPI_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK ||
+        spi_bus_add_device(MATRIX_SPI_HOST, &dev, &device) != ESP_OK) {
+        DEBUG_PRINTLN("[MTX] SPI init failed");
+        device = NULL;
+        return false;
+    }
+
+    if (brightness > 15) brightness = 15;
+
+    bool ok = write_register_blocking(MAX7219_REG_DISPLAY_TEST, 0) &&
+              write_register_blocking(MAX7219_REG_DECODE_MODE, 0) &&
+              write_register_blocking(MAX7219_REG_SCAN_LIMIT, MATRIX_DIGITS - 1) &&
+              write_register_blocking(MAX7219_REG_INTENSITY, brightness);
+    for (uint8_t digit = 0; ok && digit < MATRIX_DIGITS; digit++) {
+        ok = write_register_blocking(MAX7219_REG_DIGIT0 + digit, 0);
+    }
+    ok = ok && write_register_blocking(MAX7219_REG_SHUTDOWN, 1);
+
+    if (!ok) {
+        DEBUG_PRINTLN("[MTX] MAX7219 setup failed");
+    }
+    return ok;
+}
+
+bool matrix_driver_write(const uint8_t rows[MATRIX_NUM_DEVICES][MATRIX_DIGITS], uint8_t digit_mask) {
+    if (device == NULL || matrix_driver_busy()) return false;
+
+    if (pending_intensity >= 0) {
+        fill_register(reg_tx, MAX7219_REG_INTENSITY, (uint8_t)pending_intensity);
+        if (!queue(&reg_trans, reg_tx)) return false;
+        pending_intensity = -1;
+    }
+
+    for (uint8_t digit = 0; digit < MATRIX_DIGITS; digit++) {
+        if (!(digit_mask & (1 << digit))) continue;
+
+        // Farthest module first: its word is shifted all the way down the chain
+        uint8_t* tx = digit_tx[digit];
+        for (uint8_t dev = 0; dev < MATRIX_NUM_DEVICES; dev++) {
+            uint8_t slot = MATRIX_NUM_DEVICES - 1 - dev;
+            tx[slot * 2] = MAX7219_REG_DIGIT0 + digit;
+            tx[slot * 2 + 1] = rows[dev][digit];
+        }
+
+        // Queue has room for a full frame, so this only fails on a driver error
+        if (!queue(&digit_trans[digit], tx)) return false;
+        rows_sent++;
+    }
+
+    return true;
+}
+
+void matrix_driver_set_intensity(uint8_t brightness) {
+    pending_intensity = (brightness > 15) ? 15 : brightness;
+}
+
+void matrix_driver_display_test(bool on) {
+    if (device == NULL) return;
+
+    // Let a queued frame finish first: polling and queued transactions can't overlap
+    while (matrix_driver_busy()) {
+    }
+    write_register_blocking(MAX7219_REG_DISPLAY_TEST, on ? 1 : 0);
+}
+
+bool matrix_driver_busy() {
+    if (device == NULL) return false;
+
+    reap();
+    return in_flight > 0;
+}
+
+uint32_t matrix_driver_rows_sent() {
+    return rows_sent;
+}
@@ -0,0 +1,73 @@
+#ifndef MATRIX_DRIVER_H
+#define MATRIX_DRIVER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "pins.h"
+
+// =============================================================================
+// MAX7219 SPI Driver
+// =============================================================================
+// Non-blocking output to the chained MAX7219 8x8 modules on a hardware SPI
+// host with DMA. matrix_driver_write() queues one transaction per digit
+// register that changed and returns immediately; the SPI peripheral clocks
+// them out while the CPU keeps running.
+//
+// A MAX7219 latches one register per LOAD (CS) pulse, so a digit is written
+// on every module of the chain in a single transaction. Queued buffers stay
+// owned by the driver until they finish, and a write while an earlier frame
+// is still in flight is refused so a frame is never torn.
+// =============================================================================
+
+#define MATRIX_DIGITS   8       // Digit registers (rows) per module
+
+/**
+ * Attach the modules to the SPI host and program the MAX7219 setup registers
+ * (no decode, 8-digit scan, display cleared, out of shutdown).
+ * Blocks for a few register writes - call from setup().
+ *
+ * @param brightness Intensity 0-15
+ * @return True if the SPI bus and device were installed
+ */
+bool matrix_driver_init(uint8_t brightness);
+
+/**
+ * Queue the changed digit registers of a frame (returns without waiting).
+ *
+ * @param rows Segment bytes per module and digit, module 0 closest to DIN
+ * @param digit_mask Bit n set = digit n changed on at least one module
+ * @return True if the digits were queued, false if a frame is still in flight
+ */
+bool matrix_driver_write(const uint8_t rows[MATRIX_NUM_DEVICES][MATRIX_DIGITS], uint8_t digit_mask);
+
+/**
+ * Set the intensity of every module.
+ * Applied with the next matrix_driver_write(), even one with no digits.
+ *
+ * @param brightness Intensity 0-15
+ */
+void matrix_driver_set_intensity(uint8_t brightness);
+
+/**
+ * Switch the MAX7219 display-test mode (every LED on at full intensity).
+ * Blocks for the register write - call from setup().
+ *
+ * @param on True to light everything, false to show the digit registers again
+ */
+void matrix_driver_display_test(bool on);
+
+/**
+ * Check whether the last queued frame is still being clocked out.
+ *
+ * @return True until every transaction of the last write has finished
+ */
+bool matrix_driver_busy();
+
+/**
+ * Number of digit registers pushed to the chain since init.
+ *
+ * @return Digit writes (one per changed row per frame)
+ */
+uint32_t matrix_driver_rows_sent();
+
+#endif // MATRIX_DRIVER_H
@@ -1,176 +1,175 @@
 #include "neopixel_matrix.h"
 #include "scroll_texts.h"
-#include "color_utils.h"
+#include "compositor.h"
+#include "param_store.h"
 #include <string.h>
 
-// NeoPixel strip object
-static Adafruit_NeoPixel* npm_strip = nullptr;
-
-// 5x5 font bitmaps for A-Z (each row is a 5-bit pattern)
-// Pixel mapping: Row 0: 0-4, Row 1: 5-9, Row 2: 10-14, Row 3: 15-19, Row 4: 20-24
-static const uint8_t font5x5[26][5] = {
-    {0b01110, 0b10001, 0b11111, 0b10001, 0b10001}, // A
-    {0b11110, 0b10001, 0b11110, 0b10001, 0b11110}, // B
-    {0b01111, 0b10000, 0b10000, 0b10000, 0b01111}, // C
-    {0b11110, 0b10001, 0b10001, 0b10001, 0b11110}, // D
-    {0b11111, 0b10000, 0b11110, 0b10000, 0b11111}, // E
-    {0b11111, 0b10000, 0b11110, 0b10000, 0b10000}, // F
-    {0b01110, 0b10000, 0b10111, 0b10001, 0b01110}, // G
-    {0b10001, 0b10001, 0b11111, 0b10001, 0b10001}, // H
-    {0b11111, 0b00100, 0b00100, 0b00100, 0b11111}, // I
-    {0b00111, 0b00001, 0b00001, 0b10001, 0b01110}, // J
-    {0b10001, 0b10010, 0b11100, 0b10010, 0b10001}, // K
-    {0b10000, 0b10000, 0b10000, 0b10000, 0b11111}, // L
-    {0b10001, 0b11011, 0b10101, 0b10001, 0b10001}, // M
-    {0b10001, 0b11001, 0b10101, 0b10011, 0b10001}, // N
-    {0b01110, 0b10001, 0b10001, 0b10001, 0b01110}, // O
-    {0b11110, 0b10001, 0b11110, 0b10000, 0b10000}, // P
-    {0b01110, 0b10001, 0b10101, 0b10010, 0b01101}, // Q
-    {0b11110, 0b10001, 0b11110, 0b10010, 0b10001}, // R
-    {0b01111, 0b10000, 0b01110, 0b00001, 0b11110}, // S
-    {0b11111, 0b00100, 0b00100, 0b00100, 0b00100}, // T
-    {0b10001, 0b10001, 0b10001, 0b10001, 0b01110}, // U
-    {0b10001, 0b10001, 0b10001, 0b01010, 0b00100}, // V
-    {0b10001, 0b10001, 0b10101, 0b11011, 0b10001}, // W
-    {0b10001, 0b01010, 0b00100, 0b01010, 0b10001}, // X
-    {0b10001, 0b01010, 0b00100, 0b00100, 0b00100}, // Y
-    {0b11111, 0b00010, 0b00100, 0b01000, 0b11111}  // Z
-};
+// Set once the compositor device is attached
+static bool npm_ready = false;
+
+// =============================================================================
+// Glyph Registry
+// =============================================================================
+// Built-in glyphs are packed at compile time into flash: the letters straight
+// from SCROLL_FONT_5X5, drawn as the old font5x5 table was (row bit n =
+// column n), then the icons. User glyphs follow in RAM.
+// =============================================================================
+
+// Pack five row bitmaps (bit n = column n)
+constexpr NpmGlyph npm_pack_rows(uint8_t r0, uint8_t r1, uint8_t r2, uint8_t r3, uint8_t r4) {
+    return (NpmGlyph)(r0 & 0x1F) | ((NpmGlyph)(r1 & 0x1F) << 5) | ((NpmGlyph)(r2 & 0x1F) << 10) |
+           ((NpmGlyph)(r3 & 0x1F) << 15) | ((NpmGlyph)(r4 & 0x1F) << 20);
+}
 
-// Eye closed pattern (horizontal line across middle - sleeping eye)
-// Note: Matrix is physically rotated 90°, so we light middle column
-static const uint8_t eye_closed_pattern[5] = {
-    0b00100,
-    0b00100,
-    0b00100,
-    0b00100,
-    0b00100
-};
+typedef struct {
+    NpmGlyph words[NPM_GLYPH_USER];
+} NpmGlyphTable;
 
-// Eye open pattern (circle/dot in center - alert eye)
-static const uint8_t eye_open_pattern[5] = {
-    0b01110,
-    0b10001,
-    0b10101,  // Center pixel lit
-    0b10001,
-    0b01110
-};
+constexpr NpmGlyphTable npm_build_glyph_table() {
+    NpmGlyphTable table = {};
+    for (int g = 0; g < 26; g++) {
+        const uint8_t* rows = SCROLL_FONT_5X5[g];
+        table.words[NPM_GLYPH_LETTER_A + g] = npm_pack_rows(rows[0], rows[1], rows[2], rows[3], rows[4]);
+    }
+    // NPM_GLYPH_BLANK stays 0
+
+    // Closed eye (matrix is physically rotated 90°, so the middle column is lit)
+    table.words[NPM_GLYPH_EYE_CLOSED] = npm_pack_rows(0b00100, 0b00100, 0b00100, 0b00100, 0b00100);
+    // Open eye (ring with the center pixel lit)
+    table.words[NPM_GLYPH_EYE_OPEN] = npm_pack_rows(0b01110, 0b10001, 0b10101, 0b10001, 0b01110);
+    // Filled circle (ALIVE)
+    table.words[NPM_GLYPH_CIRCLE] = npm_pack_rows(0b01110, 0b11111, 0b11111, 0b11111, 0b01110);
+    // X (DEAD)
+    table.words[NPM_GLYPH_X] = npm_pack_rows(0b10001, 0b01010, 0b00100, 0b01010, 0b10001);
+    return table;
+}
 
-// Circle pattern (for ALIVE state - filled circle)
-static const uint8_t circle_pattern[5] = {
-    0b01110,
-    0b11111,
-    0b11111,
-    0b11111,
-    0b01110
+static constexpr NpmGlyphTable NPM_BUILTIN_GLYPHS = npm_build_glyph_table();
+
+// Spot-check the packing: 'A' has its top row 0b01110 in pixels 1-3
+static_assert((NPM_BUILTIN_GLYPHS.words[0] & 0x1F) == 0b01110, "Glyph registry packing is wrong");
+
+// Uploaded user glyphs (word stores are atomic, so no lock is needed)
+static volatile NpmGlyph user_glyphs[NPM_USER_GLYPH_COUNT];
+
+// Set by a user glyph upload (comm task), so a glyph on display is redrawn
+static volatile bool user_glyphs_changed = false;
+
+// Glyph each mode draws; letter and user glyph modes are resolved from the letter
+static const uint8_t NPM_MODE_GLYPHS[NPM_MODE_COUNT] = {
+    NPM_GLYPH_BLANK,        // NPM_MODE_OFF
+    NPM_GLYPH_NONE,         // NPM_MODE_LETTER
+    NPM_GLYPH_NONE,         // NPM_MODE_SCROLL
+    NPM_GLYPH_NONE,         // NPM_MODE_RAINBOW
+    NPM_GLYPH_NONE,         // NPM_MODE_SOLID
+    NPM_GLYPH_EYE_CLOSED,   // NPM_MODE_EYE_CLOSED
+    NPM_GLYPH_EYE_OPEN,     // NPM_MODE_EYE_OPEN
+    NPM_GLYPH_CIRCLE,       // NPM_MODE_CIRCLE
+    NPM_GLYPH_X,            // NPM_MODE_X
+    NPM_GLYPH_NONE,         // NPM_MODE_GRADIENT
+    NPM_GLYPH_NONE,         // NPM_MODE_GLYPH
+    NPM_GLYPH_NONE,         // NPM_MODE_BREATHE
+    NPM_GLYPH_NONE,         // NPM_MODE_CHASE
+    NPM_GLYPH_NONE,         // NPM_MODE_SPINNER
 };
 
-// X pattern (for DEAD state)
-static const uint8_t x_pattern[5] = {
-    0b10001,
-    0b01010,
-    0b00100,
-    0b01010,
-    0b10001
-};
+// Spread a 5-bit scroll column (bit n = row n) onto column 0 of a glyph word
+typedef struct {
+    NpmGlyph words[32];
+} NpmColumnTable;
 
-// Convert HSV to RGB color
-static uint32_t hsvToColor(uint16_t hue, uint8_t sat, uint8_t val) {
-    uint8_t r, g, b;
-    uint8_t region = hue / 43;
-    uint8_t remainder = (hue - (region * 43)) * 6;
-
-    uint8_t p = (val * (255 - sat)) >> 8;
-    uint8_t q = (val * (255 - ((sat * remainder) >> 8))) >> 8;
-    uint8_t t = (val * (255 - ((sat * (255 - remainder)) >> 8))) >> 8;
-
-    switch (region) {
-        case 0:  r = val; g = t;   b = p;   break;
-        case 1:  r = q;   g = val; b = p;   break;
-        case 2:  r = p;   g = val; b = t;   break;
-        case 3:  r = p;   g = q;   b = val; break;
-        case 4:  r = t;   g = p;   b = val; break;
-        default: r = val; g = p;   b = q;   break;
+constexpr NpmColumnTable npm_build_column_table() {
+    NpmColumnTable table = {};
+    for (int column = 0; column < 32; column++) {
+        for (int row = 0; row < 5; row++) {
+            if (column & (1 << row)) {
+                table.words[column] |= (NpmGlyph)1 << (row * 5);
+            }
+        }
     }
+    return table;
+}
+
+static constexpr NpmColumnTable NPM_COLUMN_SPREAD = npm_build_column_table();
+
+// =============================================================================
+// Effects
+// =============================================================================
+
+typedef FxCompositorDevice<COMPOSITOR_NPM, NPM_NUM_PIXELS, NPM_RAINBOW_SPEED << 8> NpmFx;
+
+// Static registry glyph in the primary color (redrawn when the mode,
+// colors or a user glyph change)
+static uint16_t npm_fx_glyph(FxState* fx, uint32_t now_ms) {
+    const NpmState* state = (const NpmState*)fx->owner;
+    compositor_blit(COMPOSITOR_NPM, npm_glyph(state->glyph), fx_color(fx));
+    return FX_STATIC;
+}
 
-    return npm_strip->Color(r, g, b);
+static uint16_t npm_fx_scroll(FxState* fx, uint32_t now_ms) {
+    return npm_update_scroll((NpmState*)fx->owner);
 }
 
+// Effect each mode runs
+static const FxRenderFn NPM_MODE_EFFECTS[NPM_MODE_COUNT] = {
+    fx_off<NpmFx>,          // NPM_MODE_OFF
+    npm_fx_glyph,           // NPM_MODE_LETTER
+    npm_fx_scroll,          // NPM_MODE_SCROLL
+    fx_rainbow<NpmFx>,      // NPM_MODE_RAINBOW
+    fx_solid<NpmFx>,        // NPM_MODE_SOLID
+    npm_fx_glyph,           // NPM_MODE_EYE_CLOSED
+    npm_fx_glyph,           // NPM_MODE_EYE_OPEN
+    npm_fx_glyph,           // NPM_MODE_CIRCLE
+    npm_fx_glyph,           // NPM_MODE_X
+    fx_gradient<NpmFx>,     // NPM_MODE_GRADIENT
+    npm_fx_glyph,           // NPM_MODE_GLYPH
+    fx_breathe<NpmFx>,      // NPM_MODE_BREATHE
+    fx_chase<NpmFx>,        // NPM_MODE_CHASE
+    fx_spinner<NpmFx>,      // NPM_MODE_SPINNER
+};
+
 void npm_init(uint8_t pin) {
-    if (npm_strip != nullptr) {
-        delete npm_strip;
-    }
-    npm_strip = new Adafruit_NeoPixel(NPM_NUM_PIXELS, pin, NEO_GRB + NEO_KHZ800);
-    npm_strip->begin();
-    npm_strip->setBrightness(NPM_BRIGHTNESS);
-    npm_strip->clear();  // Clear any random data in LED memory
-    npm_strip->show();
+    npm_ready = compositor_attach(COMPOSITOR_NPM, LED_RMT_CHANNEL_NPM, pin,
+                                  NPM_NUM_PIXELS, g_params.npm_brightness);
 }
 
 void npm_state_init(NpmState* state) {
     state->mode = NPM_MODE_OFF;  // Default to OFF
     state->letter = 'A';
-    state->r = 0;
-    state->g = 0;
-    state->b = 0;
-    state->prev_mode = 255;  // Force initial update
-    state->prev_letter = 0;
-    state->prev_r = 0;
-    state->prev_g = 0;
-    state->prev_b = 0;
-    state->rainbow_offset = 0;
-    state->needs_update = true;
+    state->glyph = NPM_GLYPH_BLANK;
+    fx_state_init(&state->fx, NPM_MODE_EFFECTS[NPM_MODE_OFF], state);
 
     // Initialize scroll state
     state->scroll_text_id = 0;
-    state->scroll_buffer_len = 0;
+    state->scroll_restart = true;   // Pick the first text on first run
+    state->scroll_text = "";
+    state->scroll_glyphs = nullptr;
+    state->scroll_text_len = 0;
+    memset(&state->scroll_slot, 0, sizeof(state->scroll_slot));
+    state->scroll_length = 0;
     state->scroll_position = 0;
     state->scroll_last_update = 0;
     state->scroll_speed = NPM_SCROLL_SPEED;
     state->scroll_looping = true;
-    state->prev_scroll_text_id = 255;
-    memset(state->scroll_buffer, 0, sizeof(state->scroll_buffer));
-
-    // Initialize gradient state
-    state->r2 = 0;
-    state->g2 = 0;
-    state->b2 = 0;
-    state->gradient_speed = 10;
-    state->gradient_position = 0;
+    memset(state->scroll_window, 0, sizeof(state->scroll_window));
+    state->scroll_window_head = 0;
 }
 
 void npm_set_mode(NpmState* state, uint8_t mode, char letter, uint8_t r, uint8_t g, uint8_t b,
                   uint8_t r2, uint8_t g2, uint8_t b2, uint8_t speed) {
-    // Check if anything changed
-    if (state->mode != mode ||
-        state->letter != letter ||
-        state->r != r ||
-        state->g != g ||
-        state->b != b ||
-        state->r2 != r2 ||
-        state->g2 != g2 ||
-        state->b2 != b2 ||
-        state->gradient_speed != speed) {
-        state->needs_update = true;
-
-        // Reset gradient animation on mode change
-        if (state->mode != mode) {
-            state->gradient_position = 0;
-        }
-    }
+    // Unknown modes show nothing; a new effect restarts its animation
+    uint8_t glyph = npm_mode_glyph(mode, letter);
+    if (glyph != state->glyph) state->fx.dirty = true;
 
     state->mode = mode;
     state->letter = letter;
-    state->r = r;
-    state->g = g;
-    state->b = b;
-    state->r2 = r2;
-    state->g2 = g2;
-    state->b2 = b2;
-    state->gradient_speed = (speed > 0) ? speed : 1;  // Ensure minimum speed of 1
+    state->glyph = glyph;
+    fx_select(&state->fx, NPM_MODE_EFFECTS[(mode < NPM_MODE_COUNT) ? mode : NPM_MODE_OFF]);
+    fx_set_colors(&state->fx, r, g, b, r2, g2, b2, speed);
 
     // For scroll mode, interpret letter as text ID
     // '0'-'9' maps to text IDs 0-9, 'A'-'Z' maps to 0-25 as fallback
+    // ('K'-'N' select uploaded slots 0-3)
     if (mode == NPM_MODE_SCROLL) {
         uint8_t text_id = 0;
         if (letter >= '0' && letter <= '9') {
@@ -180,283 +179,154 @@ void npm_set_mode(NpmState* state, uint8_t mode, char letter, uint8_t r, uint8_t
         } else if (letter >= 'a' && letter <= 'z') {
             text_id = letter - 'a';
         }
+        // Restart the scroll when a different text is selected. Only the
+        // renderer swaps the text, so it never reads a stale pointer.
+        if (text_id != state->scroll_text_id) {
+            state->scroll_restart = true;
+            state->fx.dirty = true;
+        }
         state->scroll_text_id = text_id;
     }
 }
 
 void npm_update(NpmState* state) {
-    if (npm_strip == nullptr) return;
-
-    // Check if mode changed
-    bool mode_changed = (state->mode != state->prev_mode);
+    if (!npm_ready) return;
 
-    switch (state->mode) {
-        case NPM_MODE_OFF:
-            if (mode_changed || state->needs_update) {
-                npm_clear();
-            }
-            break;
-
-        case NPM_MODE_LETTER:
-            if (mode_changed || state->needs_update ||
-                state->letter != state->prev_letter ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_letter(state->letter, state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_SCROLL:
-            npm_update_scroll(state);
-            break;
-
-        case NPM_MODE_RAINBOW:
-            npm_update_rainbow(state);
-            break;
-
-        case NPM_MODE_SOLID:
-            if (mode_changed || state->needs_update ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_solid(state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_EYE_CLOSED:
-            if (mode_changed || state->needs_update ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_eye_closed(state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_EYE_OPEN:
-            if (mode_changed || state->needs_update ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_eye_open(state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_CIRCLE:
-            if (mode_changed || state->needs_update ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_circle(state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_X:
-            if (mode_changed || state->needs_update ||
-                state->r != state->prev_r || state->g != state->prev_g || state->b != state->prev_b) {
-                npm_display_x(state->r, state->g, state->b);
-            }
-            break;
-
-        case NPM_MODE_GRADIENT: {
-            // Ping-pong gradient between two colors
-            uint8_t t = gradient_position_to_t(state->gradient_position);
-
-            uint8_t r, g, b;
-            gradient_color(t, state->r, state->g, state->b,
-                          state->r2, state->g2, state->b2, &r, &g, &b);
-
-            // Skip update if lerp produced black (edge case bug workaround)
-            if (r == 0 && g == 0 && b == 0) {
-                state->gradient_position = gradient_advance_pingpong(
-                    state->gradient_position, state->gradient_speed);
-                return;
-            }
-
-            uint32_t color = npm_strip->Color(r, g, b);
-            for (int i = 0; i < NPM_NUM_PIXELS; i++) {
-                npm_strip->setPixelColor(i, color);
-            }
-            npm_strip->show();
-
-            state->gradient_position = gradient_advance_pingpong(
-                state->gradient_position, state->gradient_speed);
-            state->prev_mode = state->mode;
-            return;
-        }
+    // The compositor only pushes the frame to the strip when it differs
+    // from the last one sent
+    user_glyphs_changed = false;
+    fx_render(&state->fx, millis());
+}
 
-        default:
-            npm_clear();
-            break;
+uint32_t npm_frame_wait_ms(const NpmState* state, uint32_t now_ms) {
+    if (!npm_ready) return ANIMATION_WAIT_IDLE;
+    if (user_glyphs_changed && state->glyph >= NPM_GLYPH_USER && state->glyph < NPM_GLYPH_COUNT) {
+        return 0;
     }
-
-    // Update previous state
-    state->prev_mode = state->mode;
-    state->prev_letter = state->letter;
-    state->prev_r = state->r;
-    state->prev_g = state->g;
-    state->prev_b = state->b;
-    state->needs_update = false;
+    return fx_frame_wait_ms(&state->fx, now_ms);
 }
 
 void npm_set_brightness(uint8_t brightness) {
-    if (npm_strip != nullptr) {
-        npm_strip->setBrightness(brightness);
-    }
+    compositor_set_brightness(COMPOSITOR_NPM, brightness);
 }
 
 void npm_clear(void) {
-    if (npm_strip != nullptr) {
-        npm_strip->clear();
-        npm_strip->show();
-    }
+    compositor_clear(COMPOSITOR_NPM);
 }
 
-void npm_display_letter(char letter, uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
-
-    npm_strip->clear();
-
-    // Convert to uppercase and validate
-    if (letter >= 'a' && letter <= 'z') {
-        letter = letter - 'a' + 'A';
-    }
-    if (letter < 'A' || letter > 'Z') {
-        npm_strip->show();
-        return;
-    }
-
-    int index = letter - 'A';
-    uint32_t color = npm_strip->Color(r, g, b);
+void npm_display_glyph(uint8_t glyph, uint8_t r, uint8_t g, uint8_t b) {
+    if (!npm_ready) return;
 
-    // Draw the letter from bitmap (same bit order as sample)
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (font5x5[index][row] & (0b00001 << col)) {
-                int pixel = row * 5 + col;
-                npm_strip->setPixelColor(pixel, color);
-            }
-        }
-    }
-    npm_strip->show();
+    compositor_blit(COMPOSITOR_NPM, npm_glyph(glyph), compositor_color(r, g, b));
 }
 
 void npm_display_solid(uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
+    if (!npm_ready) return;
 
-    uint32_t color = npm_strip->Color(r, g, b);
-    for (int i = 0; i < NPM_NUM_PIXELS; i++) {
-        npm_strip->setPixelColor(i, color);
-    }
-    npm_strip->show();
+    compositor_fill(COMPOSITOR_NPM, compositor_color(r, g, b));
 }
 
-void npm_display_eye_closed(uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
-
-    npm_strip->clear();
-    uint32_t color = npm_strip->Color(r, g, b);
-
-    // Draw closed eye pattern (same bit order as sample)
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (eye_closed_pattern[row] & (0b00001 << col)) {
-                int pixel = row * 5 + col;
-                npm_strip->setPixelColor(pixel, color);
-            }
-        }
-    }
-    npm_strip->show();
+uint8_t npm_letter_glyph(char letter) {
+    if (letter >= 'a' && letter <= 'z') return NPM_GLYPH_LETTER_A + (letter - 'a');
+    if (letter >= 'A' && letter <= 'Z') return NPM_GLYPH_LETTER_A + (letter - 'A');
+    return NPM_GLYPH_BLANK;
 }
 
-void npm_display_eye_open(uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
-
-    npm_strip->clear();
-    uint32_t color = npm_strip->Color(r, g, b);
-
-    // Draw open eye pattern (same bit order as sample)
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (eye_open_pattern[row] & (0b00001 << col)) {
-                int pixel = row * 5 + col;
-                npm_strip->setPixelColor(pixel, color);
-            }
-        }
+uint8_t npm_mode_glyph(uint8_t mode, char letter) {
+    if (mode == NPM_MODE_LETTER) {
+        return npm_letter_glyph(letter);
+    }
+    if (mode == NPM_MODE_GLYPH) {
+        uint8_t slot = (uint8_t)(letter - '0');
+        return (slot < NPM_USER_GLYPH_COUNT) ? (uint8_t)(NPM_GLYPH_USER + slot) : (uint8_t)NPM_GLYPH_BLANK;
     }
-    npm_strip->show();
+    // Unknown modes show nothing
+    return (mode < NPM_MODE_COUNT) ? NPM_MODE_GLYPHS[mode] : (uint8_t)NPM_GLYPH_BLANK;
 }
 
-void npm_display_circle(uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
+NpmGlyph npm_glyph(uint8_t glyph) {
+    if (glyph < NPM_GLYPH_USER) return NPM_BUILTIN_GLYPHS.words[glyph];
+    if (glyph < NPM_GLYPH_COUNT) return user_glyphs[glyph - NPM_GLYPH_USER];
+    return 0;
+}
 
-    npm_strip->clear();
-    uint32_t color = npm_strip->Color(r, g, b);
+bool npm_set_user_glyph(uint8_t slot, const uint8_t rows[5]) {
+    if (slot >= NPM_USER_GLYPH_COUNT) return false;
 
-    // Draw circle pattern
+    // Row bit 4 is the leftmost column, as in $FRM frames
+    NpmGlyph word = 0;
     for (int row = 0; row < 5; row++) {
         for (int col = 0; col < 5; col++) {
-            if (circle_pattern[row] & (0b00001 << col)) {
-                int pixel = row * 5 + col;
-                npm_strip->setPixelColor(pixel, color);
+            if (rows[row] & (1 << (4 - col))) {
+                word |= (NpmGlyph)1 << (row * 5 + col);
             }
         }
     }
-    npm_strip->show();
+    user_glyphs[slot] = word;
+    user_glyphs_changed = true;
+    return true;
 }
 
-void npm_display_x(uint8_t r, uint8_t g, uint8_t b) {
-    if (npm_strip == nullptr) return;
+// Column of the scroll stream: blank lead-in, glyphs separated by one gap
+// column, blank lead-out. Each column is a single atlas lookup.
+static uint8_t scroll_column(const NpmState* state, uint32_t index) {
+    if (index < NPM_SCROLL_WINDOW) return 0;
+    index -= NPM_SCROLL_WINDOW;
 
-    npm_strip->clear();
-    uint32_t color = npm_strip->Color(r, g, b);
+    uint32_t ch = index / (SCROLL_GLYPH_WIDTH + 1);
+    uint8_t col = index % (SCROLL_GLYPH_WIDTH + 1);
+    if (ch >= state->scroll_text_len || col == SCROLL_GLYPH_WIDTH) return 0;
 
-    // Draw X pattern
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (x_pattern[row] & (0b00001 << col)) {
-                int pixel = row * 5 + col;
-                npm_strip->setPixelColor(pixel, color);
-            }
-        }
+    if (state->scroll_glyphs != nullptr) {
+        return state->scroll_glyphs[ch * SCROLL_GLYPH_WIDTH + col];
     }
-    npm_strip->show();
+    return SCROLL_GLYPH_ATLAS.columns[scroll_glyph_index(state->scroll_text[ch])][col];
 }
 
-void npm_update_rainbow(NpmState* state) {
-    if (npm_strip == nullptr) return;
-
-    // Create rainbow across all pixels
-    for (int i = 0; i < NPM_NUM_PIXELS; i++) {
-        uint16_t hue = (state->rainbow_offset + (i * 256 / NPM_NUM_PIXELS)) & 0xFF;
-        npm_strip->setPixelColor(i, hsvToColor(hue, 255, 255));
+// Start scrolling either a text or a run of column glyphs
+static void start_scroll(NpmState* state, const char* text, const uint8_t* glyphs, uint16_t len,
+                         uint8_t r, uint8_t g, uint8_t b) {
+    state->scroll_restart = false;
+    state->scroll_text = text;
+    state->scroll_glyphs = glyphs;
+    state->scroll_text_len = len;
+
+    // Lead-in + (glyph + gap) per character + lead-out
+    state->scroll_length = 2 * NPM_SCROLL_WINDOW +
+                           (uint32_t)state->scroll_text_len * (SCROLL_GLYPH_WIDTH + 1);
+
+    // Prime the window with the first visible columns (the blank lead-in)
+    for (int i = 0; i < NPM_SCROLL_WINDOW; i++) {
+        state->scroll_window[i] = scroll_column(state, i);
     }
-    npm_strip->show();
+    state->scroll_window_head = 0;
 
-    // Advance animation
-    state->rainbow_offset = (state->rainbow_offset + NPM_RAINBOW_SPEED) & 0xFF;
+    state->scroll_position = 0;
+    state->scroll_last_update = millis();
+    state->fx.r = r;
+    state->fx.g = g;
+    state->fx.b = b;
 }
 
-// Helper: Get column data for a character (5 rows packed into a byte)
-static uint8_t get_char_column(char c, int col) {
-    if (c >= 'A' && c <= 'Z') {
-        // Convert row-based font to column
-        int idx = c - 'A';
-        uint8_t column = 0;
-        for (int row = 0; row < 5; row++) {
-            // Check if this row has a pixel in this column
-            if (SCROLL_FONT_5X5[idx][row] & (1 << (4 - col))) {
-                column |= (1 << row);
-            }
-        }
-        return column;
-    } else if (c >= 'a' && c <= 'z') {
-        return get_char_column(c - 'a' + 'A', col);
-    } else if (c == ' ') {
-        return 0;  // Empty column
-    } else if (c == '?') {
-        uint8_t column = 0;
-        for (int row = 0; row < 5; row++) {
-            if (SCROLL_FONT_QUESTION[row] & (1 << (4 - col))) {
-                column |= (1 << row);
-            }
-        }
-        return column;
-    }
-    return 0;  // Unknown character
+void npm_set_scroll_string(NpmState* state, const char* text, uint8_t r, uint8_t g, uint8_t b) {
+    start_scroll(state, text, nullptr, strlen(text), r, g, b);
 }
 
 void npm_set_scroll_text(NpmState* state, uint8_t text_id, uint8_t r, uint8_t g, uint8_t b) {
+    state->scroll_text_id = text_id;
+
+    // Uploaded slot - scroll a private copy so a new upload can't tear it
+    if (text_id >= SCROLL_TEXT_CUSTOM && text_id < SCROLL_TEXT_CUSTOM + SCROLL_SLOT_COUNT &&
+        scroll_store_read(text_id - SCROLL_TEXT_CUSTOM, &state->scroll_slot)) {
+        ScrollSlot* slot = &state->scroll_slot;
+        if (slot->type == SCROLL_SLOT_FRAMES) {
+            start_scroll(state, "", slot->data, slot->len, r, g, b);
+        } else {
+            start_scroll(state, (const char*)slot->data, nullptr, slot->len, r, g, b);
+        }
+        return;
+    }
+
     // Get text string
     const char* text = nullptr;
     if (text_id < SCROLL_TEXT_COUNT) {
@@ -465,51 +335,26 @@ void npm_set_scroll_text(NpmState* state, uint8_t text_id, uint8_t r, uint8_t g,
         text = "?";  // Fallback
     }
 
-    // Build scroll buffer: each character is 5 columns + 1 gap column
-    // Add 5 blank columns at start and end for smooth scroll on/off
-    uint16_t buf_pos = 0;
-
-    // Leading blank columns (matrix width)
-    for (int i = 0; i < 5 && buf_pos < NPM_SCROLL_BUFFER_SIZE; i++) {
-        state->scroll_buffer[buf_pos++] = 0;
-    }
-
-    // Add each character
-    for (int i = 0; text[i] != '\0' && buf_pos < NPM_SCROLL_BUFFER_SIZE - 6; i++) {
-        char c = text[i];
-
-        // Add 5 columns for this character
-        for (int col = 0; col < 5; col++) {
-            state->scroll_buffer[buf_pos++] = get_char_column(c, col);
-        }
-
-        // Add gap column between characters
-        state->scroll_buffer[buf_pos++] = 0;
-    }
+    npm_set_scroll_string(state, text, r, g, b);
+}
 
-    // Trailing blank columns (matrix width)
-    for (int i = 0; i < 5 && buf_pos < NPM_SCROLL_BUFFER_SIZE; i++) {
-        state->scroll_buffer[buf_pos++] = 0;
+// Uploaded slots loop; predefined texts rotate randomly
+static uint8_t next_scroll_text_id(const NpmState* state) {
+    if (state->scroll_text_id >= SCROLL_TEXT_CUSTOM &&
+        state->scroll_text_id < SCROLL_TEXT_CUSTOM + SCROLL_SLOT_COUNT) {
+        return state->scroll_text_id;
     }
-
-    state->scroll_buffer_len = buf_pos;
-    state->scroll_position = 0;
-    state->scroll_last_update = millis();
-    state->scroll_text_id = text_id;
-    state->r = r;
-    state->g = g;
-    state->b = b;
+    return random(0, SCROLL_TEXT_CUSTOM);
 }
 
-void npm_update_scroll(NpmState* state) {
-    if (npm_strip == nullptr) return;
+uint16_t npm_update_scroll(NpmState* state) {
+    if (!npm_ready) return FX_STATIC;
 
     uint32_t now = millis();
 
-    // Initialize scroll buffer on first run with a random text
-    if (state->scroll_buffer_len == 0) {
-        uint8_t initial_text_id = random(0, SCROLL_TEXT_COUNT);
-        npm_set_scroll_text(state, initial_text_id, state->r, state->g, state->b);
+    // Pick the first text on first run (or after a new selection)
+    if (state->scroll_restart) {
+        npm_set_scroll_text(state, next_scroll_text_id(state), state->fx.r, state->fx.g, state->fx.b);
     }
 
     // Check if it's time to advance the scroll
@@ -517,36 +362,28 @@ void npm_update_scroll(NpmState* state) {
         state->scroll_last_update = now;
         state->scroll_position++;
 
-        // Check for wrap - pick a new random text
-        if (state->scroll_position >= state->scroll_buffer_len) {
-            uint8_t new_text_id = random(0, SCROLL_TEXT_COUNT);
-            npm_set_scroll_text(state, new_text_id, state->r, state->g, state->b);
-            state->scroll_position = 0;
+        // Check for wrap - pick the next text (re-reads an uploaded slot)
+        if (state->scroll_position >= state->scroll_length) {
+            npm_set_scroll_text(state, next_scroll_text_id(state), state->fx.r, state->fx.g, state->fx.b);
+        } else {
+            // Stream the column entering on the right over the one leaving on the left
+            state->scroll_window[state->scroll_window_head] =
+                scroll_column(state, state->scroll_position + NPM_SCROLL_WINDOW - 1);
+            state->scroll_window_head = (state->scroll_window_head + 1) % NPM_SCROLL_WINDOW;
         }
     }
 
-    // Render current 5 columns to the matrix
-    npm_strip->clear();
-    uint32_t color = npm_strip->Color(state->r, state->g, state->b);
-
-    for (int display_col = 0; display_col < 5; display_col++) {
-        // Get column from buffer (with wrapping)
-        uint16_t buf_col = state->scroll_position + display_col;
-        if (buf_col >= state->scroll_buffer_len) {
-            buf_col = buf_col % state->scroll_buffer_len;
-        }
-
-        uint8_t column_data = state->scroll_buffer[buf_col];
-
-        // Render this column (5 rows)
-        for (int row = 0; row < 5; row++) {
-            if (column_data & (1 << row)) {
-                // Calculate pixel index (row * 5 + col)
-                int pixel = row * 5 + display_col;
-                npm_strip->setPixelColor(pixel, color);
-            }
-        }
+    // Render current 5 columns to the matrix as one glyph word
+    NpmGlyph frame = 0;
+    for (int display_col = 0; display_col < NPM_SCROLL_WINDOW; display_col++) {
+        uint8_t column_data =
+            state->scroll_window[(state->scroll_window_head + display_col) % NPM_SCROLL_WINDOW];
+        frame |= NPM_COLUMN_SPREAD.words[column_data & 0x1F] << display_col;
     }
 
-    npm_strip->show();
+    compositor_blit(COMPOSITOR_NPM, frame, fx_color(&state->fx));
+
+    // Next column shift (at least 1 ms: 0 would read as a static frame)
+    int32_t wait = (int32_t)(state->scroll_last_update + state->scroll_speed - now);
+    return (wait > 0) ? (uint16_t)wait : 1;
 }
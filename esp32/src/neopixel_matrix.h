@@ -2,13 +2,21 @@
 #define NEOPIXEL_MATRIX_H
 
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
 #include "config.h"
+#include "scroll_store.h"
+#include "effects.h"
 
 // =============================================================================
 // NeoPixel 5x5 Matrix Module
 // =============================================================================
 // Controls a 5x5 NeoPixel matrix for displaying letters, patterns, and effects.
+//
+// Every static frame (letters, icons, uploaded user glyphs) is one entry of a
+// glyph registry: a 25-bit word, bit row * 5 + col = pixel row * 5 + col.
+// Drawing one is a single compositor_blit() of the word.
+//
+// Glyph and scroll modes are matrix effects; the others run the shared
+// effect library (effects.h).
 // =============================================================================
 
 // Matrix configuration
@@ -26,39 +34,56 @@
 #define NPM_MODE_CIRCLE     7       // Circle icon (for ALIVE state)
 #define NPM_MODE_X          8       // X icon (for DEAD state)
 #define NPM_MODE_GRADIENT   9       // Ping-pong gradient between 2 colors
+#define NPM_MODE_GLYPH      10      // Uploaded user glyph ('0'-'7' selects the slot)
+#define NPM_MODE_BREATHE    11      // Breathing/pulse effect
+#define NPM_MODE_CHASE      12      // Single LED chase animation
+#define NPM_MODE_SPINNER    13      // Spinning dot animation
+#define NPM_MODE_COUNT      14
+
+// Glyph registry indices
+#define NPM_GLYPH_LETTER_A      0       // 'A'-'Z' = 0-25
+#define NPM_GLYPH_BLANK         26
+#define NPM_GLYPH_EYE_CLOSED    27
+#define NPM_GLYPH_EYE_OPEN      28
+#define NPM_GLYPH_CIRCLE        29
+#define NPM_GLYPH_X             30
+#define NPM_GLYPH_USER          31      // First user glyph slot (see npm_set_user_glyph)
+#define NPM_GLYPH_COUNT         (NPM_GLYPH_USER + NPM_USER_GLYPH_COUNT)
+
+// Mode without a static glyph (animated, or drawn some other way)
+#define NPM_GLYPH_NONE          0xFF
+
+// Packed 5x5 frame, bit row * 5 + col = pixel row * 5 + col
+typedef uint32_t NpmGlyph;
 
 // Animation speeds
-#define NPM_RAINBOW_SPEED   10      // Rainbow color cycling speed
+#define NPM_RAINBOW_SPEED   10      // Rainbow color cycling speed (hue steps per tick)
 #define NPM_SCROLL_SPEED    100     // Scroll speed (ms per column shift)
 
-// Maximum scroll buffer size
-#define NPM_SCROLL_BUFFER_SIZE  128  // Max columns in scroll buffer
+// Scroll window (visible columns = matrix width)
+#define NPM_SCROLL_WINDOW   5
 
 // Matrix state structure
 typedef struct {
     uint8_t mode;
     char letter;
-    uint8_t r, g, b;
-    uint8_t prev_mode;
-    char prev_letter;
-    uint8_t prev_r, prev_g, prev_b;
-    uint16_t rainbow_offset;        // For rainbow animation
-    bool needs_update;
+    uint8_t glyph;                  // Registry glyph of a static mode (npm_mode_glyph)
+    FxState fx;                     // Colors and animation state of the selected effect
 
     // Scroll state
     uint8_t scroll_text_id;         // Current scroll text ID
-    uint8_t scroll_buffer[NPM_SCROLL_BUFFER_SIZE];  // Column data for scrolling
-    uint16_t scroll_buffer_len;     // Length of scroll buffer in columns
-    uint16_t scroll_position;       // Current scroll position (column offset)
+    volatile bool scroll_restart;   // New text selected: the renderer starts it next frame
+    const char* scroll_text;        // Text being scrolled (must outlive the scroll, never null)
+    const uint8_t* scroll_glyphs;   // Column data of uploaded frames (replaces text when set)
+    uint16_t scroll_text_len;       // Characters in scroll_text, or frames in scroll_glyphs
+    ScrollSlot scroll_slot;         // Private copy of the uploaded slot being scrolled
+    uint32_t scroll_length;         // Total stream length in columns
+    uint32_t scroll_position;       // Current scroll position (column offset)
+    uint8_t scroll_window[NPM_SCROLL_WINDOW];  // Ring of visible columns
+    uint8_t scroll_window_head;     // Ring index of the leftmost visible column
     uint32_t scroll_last_update;    // Last scroll update time (ms)
     uint16_t scroll_speed;          // Scroll speed (ms per column shift)
     bool scroll_looping;            // Whether to loop the scroll
-    uint8_t prev_scroll_text_id;    // Previous text ID for change detection
-
-    // Gradient mode fields
-    uint8_t r2, g2, b2;             // Second color for gradient
-    uint8_t gradient_speed;         // Animation speed (1-50)
-    uint16_t gradient_position;     // Current position (0-510 for ping-pong)
 } NpmState;
 
 /**
@@ -93,13 +118,23 @@ void npm_set_mode(NpmState* state, uint8_t mode, char letter, uint8_t r, uint8_t
                   uint8_t r2 = 0, uint8_t g2 = 0, uint8_t b2 = 0, uint8_t speed = 10);
 
 /**
- * Update the matrix display (call from animation loop).
- * Handles state changes and animations.
+ * Update the matrix display (call from animation loop when npm_frame_wait_ms() is 0).
+ * Draws the effect selected by npm_set_mode() into the compositor framebuffer; compositor_show()
+ * pushes it to the strip only if it changed.
  *
  * @param state Pointer to state structure
  */
 void npm_update(NpmState* state);
 
+/**
+ * Time until the matrix needs its next frame.
+ *
+ * @param state Pointer to state structure
+ * @param now_ms Current time (millis())
+ * @return Milliseconds (0 = due now), or ANIMATION_WAIT_IDLE for an up-to-date static frame
+ */
+uint32_t npm_frame_wait_ms(const NpmState* state, uint32_t now_ms);
+
 /**
  * Set matrix brightness.
  *
@@ -113,14 +148,14 @@ void npm_set_brightness(uint8_t brightness);
 void npm_clear(void);
 
 /**
- * Display a letter on the matrix.
+ * Draw a registry glyph in one color (all other pixels off).
  *
- * @param letter Letter to display (A-Z)
+ * @param glyph Registry index (NPM_GLYPH_*, out of range draws blank)
  * @param r Red value (0-255)
  * @param g Green value (0-255)
  * @param b Blue value (0-255)
  */
-void npm_display_letter(char letter, uint8_t r, uint8_t g, uint8_t b);
+void npm_display_glyph(uint8_t glyph, uint8_t r, uint8_t g, uint8_t b);
 
 /**
  * Display solid color on all pixels.
@@ -132,51 +167,56 @@ void npm_display_letter(char letter, uint8_t r, uint8_t g, uint8_t b);
 void npm_display_solid(uint8_t r, uint8_t g, uint8_t b);
 
 /**
- * Display closed eye pattern.
+ * Registry glyph for a letter (case-insensitive).
  *
- * @param r Red value (0-255)
- * @param g Green value (0-255)
- * @param b Blue value (0-255)
+ * @param letter Letter (A-Z)
+ * @return NPM_GLYPH_LETTER_A + n, or NPM_GLYPH_BLANK for anything else
  */
-void npm_display_eye_closed(uint8_t r, uint8_t g, uint8_t b);
+uint8_t npm_letter_glyph(char letter);
 
 /**
- * Display open eye pattern.
+ * Registry glyph a mode draws, if it is a static frame.
  *
- * @param r Red value (0-255)
- * @param g Green value (0-255)
- * @param b Blue value (0-255)
+ * @param mode Display mode (NPM_MODE_*)
+ * @param letter Mode's letter field (letter, or user glyph slot '0'-'7')
+ * @return Registry index, or NPM_GLYPH_NONE for animated modes
  */
-void npm_display_eye_open(uint8_t r, uint8_t g, uint8_t b);
+uint8_t npm_mode_glyph(uint8_t mode, char letter);
 
 /**
- * Display circle icon (for ALIVE state).
+ * Read a registry entry.
  *
- * @param r Red value (0-255)
- * @param g Green value (0-255)
- * @param b Blue value (0-255)
+ * @param glyph Registry index
+ * @return Packed frame (0 if out of range)
  */
-void npm_display_circle(uint8_t r, uint8_t g, uint8_t b);
+NpmGlyph npm_glyph(uint8_t glyph);
 
 /**
- * Display X icon (for DEAD state).
+ * Replace a user glyph slot (RAM only, blank after reboot).
+ * Safe to call from the comm task while the animation task draws.
  *
- * @param r Red value (0-255)
- * @param g Green value (0-255)
- * @param b Blue value (0-255)
+ * @param slot User slot (0 to NPM_USER_GLYPH_COUNT-1)
+ * @param rows Five row bytes, bit 4 = leftmost column (same as $FRM)
+ * @return True if the slot index is valid
  */
-void npm_display_x(uint8_t r, uint8_t g, uint8_t b);
+bool npm_set_user_glyph(uint8_t slot, const uint8_t rows[5]);
 
 /**
- * Update rainbow animation (call periodically).
+ * Scroll an arbitrary string (any length, constant memory).
+ * Columns are streamed from the glyph atlas as they scroll into view.
  *
  * @param state Pointer to state structure
+ * @param text Text to scroll (not copied - must stay valid while scrolling)
+ * @param r Red value (0-255)
+ * @param g Green value (0-255)
+ * @param b Blue value (0-255)
  */
-void npm_update_rainbow(NpmState* state);
+void npm_set_scroll_string(NpmState* state, const char* text, uint8_t r, uint8_t g, uint8_t b);
 
 /**
  * Set scroll text by ID.
- * Builds the scroll buffer from predefined text.
+ * IDs below SCROLL_TEXT_CUSTOM scroll a predefined text; the next
+ * SCROLL_SLOT_COUNT IDs scroll an uploaded slot (falls back to "?" if empty).
  *
  * @param state Pointer to state structure
  * @param text_id Scroll text ID (see scroll_texts.h)
@@ -190,7 +230,8 @@ void npm_set_scroll_text(NpmState* state, uint8_t text_id, uint8_t r, uint8_t g,
  * Update scroll animation (call periodically).
  *
  * @param state Pointer to state structure
+ * @return Milliseconds until the next column shift
  */
-void npm_update_scroll(NpmState* state);
+uint16_t npm_update_scroll(NpmState* state);
 
 #endif // NEOPIXEL_MATRIX_H
@@ -2,13 +2,14 @@
 #define NEOPIXEL_RING_H
 
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
 #include "config.h"
+#include "effects.h"
 
 // =============================================================================
 // NeoPixel Ring Module
 // =============================================================================
-// Controls a NeoPixel ring (8 LEDs) with various animation modes.
+// Controls a NeoPixel ring (8 LEDs) with various animation modes. Modes map
+// onto the shared effect library (effects.h).
 // =============================================================================
 
 // Ring configuration
@@ -23,28 +24,15 @@
 #define NPR_MODE_BREATHE    4       // Breathing/pulse effect
 #define NPR_MODE_SPINNER    5       // Spinning dot animation
 #define NPR_MODE_GRADIENT   6       // Ping-pong gradient between 2 colors
+#define NPR_MODE_COUNT      7
 
 // Animation speeds
-#define NPR_RAINBOW_SPEED   3       // Rainbow cycling speed
-#define NPR_CHASE_SPEED     100     // Chase update interval (ms)
-#define NPR_BREATHE_SPEED   10      // Breathe cycle speed
-#define NPR_SPINNER_SPEED   50      // Spinner update interval (ms)
+#define NPR_RAINBOW_SPEED   3       // Rainbow cycling speed (hue steps per tick)
 
 // Ring state structure
 typedef struct {
     uint8_t mode;
-    uint8_t r, g, b;
-    uint8_t prev_mode;
-    uint8_t prev_r, prev_g, prev_b;
-    uint16_t animation_offset;      // For animations
-    uint8_t breathe_value;          // For breathe effect
-    int8_t breathe_direction;       // 1 = increasing, -1 = decreasing
-    uint32_t last_update;           // For timing
-    bool needs_update;
-    // Gradient mode fields
-    uint8_t r2, g2, b2;             // Second color for gradient
-    uint8_t gradient_speed;         // Animation speed (1-50)
-    uint16_t gradient_position;     // Current position (0-510 for ping-pong)
+    FxState fx;                     // Colors and animation state of the selected effect
 } NprState;
 
 /**
@@ -78,13 +66,23 @@ void npr_set_mode(NprState* state, uint8_t mode, uint8_t r, uint8_t g, uint8_t b
                   uint8_t r2 = 0, uint8_t g2 = 0, uint8_t b2 = 0, uint8_t speed = 10);
 
 /**
- * Update the ring display (call from animation loop).
- * Handles state changes and animations.
+ * Update the ring display (call from animation loop when npr_frame_wait_ms() is 0).
+ * Draws the effect selected by npr_set_mode() into the compositor framebuffer; compositor_show()
+ * pushes it to the strip only if it changed.
  *
  * @param state Pointer to state structure
  */
 void npr_update(NprState* state);
 
+/**
+ * Time until the ring needs its next frame.
+ *
+ * @param state Pointer to state structure
+ * @param now_ms Current time (millis())
+ * @return Milliseconds (0 = due now), or ANIMATION_WAIT_IDLE for an up-to-date static frame
+ */
+uint32_t npr_frame_wait_ms(const NprState* state, uint32_t now_ms);
+
 /**
  * Set ring brightness.
  *
@@ -0,0 +1,94 @@
+#include "packet_fields.h"
+
+// Largest magnitude accepted before a field is treated as malformed
+#define PACKET_FIELD_LIMIT 100000000L
+
+/**
+ * Parse an optionally signed integer, with an optional fraction when
+ * tenths is set (rounded to one decimal place).
+ *
+ * @return Pointer past the number, or nullptr if no digits were found
+ */
+static const char* parse_number(const char* p, bool tenths, int32_t* out) {
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    int32_t value = 0;
+    bool digits = false;
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > PACKET_FIELD_LIMIT) return nullptr;
+        digits = true;
+        p++;
+    }
+
+    if (tenths) {
+        value *= 10;
+        if (*p == '.') {
+            p++;
+            if (*p >= '0' && *p <= '9') {
+                value += *p - '0';
+                digits = true;
+                p++;
+                // Round on the hundredths digit, skip the rest
+                if (*p >= '5' && *p <= '9') value++;
+                while (*p >= '0' && *p <= '9') p++;
+            }
+        }
+    }
+
+    if (!digits) return nullptr;
+    *out = negative ? -value : value;
+    return p;
+}
+
+uint8_t packet_fields_parse(const char* text, const char* schema, PacketFields* out) {
+    const char* p = text;
+    out->count = 0;
+    out->rest = nullptr;
+
+    for (; *schema != '\0' && out->count < PACKET_MAX_FIELDS; schema++) {
+        int32_t value = 0;
+
+        switch (*schema) {
+            case 'i':
+            case 't':
+                p = parse_number(p, *schema == 't', &value);
+                break;
+
+            case 'c':
+                if (*p == '\0') {
+                    p = nullptr;
+                } else {
+                    value = (uint8_t)*p++;
+                }
+                break;
+
+            case 's':
+                // Takes the remainder verbatim; always the last field
+                out->rest = p;
+                out->count++;
+                return out->count;
+
+            default:
+                p = nullptr;
+                break;
+        }
+
+        // A field must end at a separator or at the end of the packet
+        if (p == nullptr || (*p != ',' && *p != '\0')) {
+            return out->count;
+        }
+
+        out->value[out->count++] = value;
+        if (*p == '\0') {
+            return out->count;
+        }
+        p++;  // Skip ','
+    }
+
+    return out->count;
+}
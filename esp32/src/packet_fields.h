@@ -0,0 +1,41 @@
+#ifndef PACKET_FIELDS_H
+#define PACKET_FIELDS_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// ASCII Packet Field Tokenizer
+// =============================================================================
+// Single-pass, allocation-free replacement for sscanf on `$XXX,...` packets.
+// A schema string lists the expected field kinds in order; fields are split
+// on ',' and converted as they are scanned. Like sscanf, parsing stops at the
+// first field that is missing or malformed and the number of fields converted
+// so far is returned, so optional trailing fields work the same way.
+//
+// Field kinds:
+//   'i'  signed decimal integer               "-12"   -> -12
+//   't'  fixed-point decimal, in tenths       "87.5"  -> 875 ("90" -> 900)
+//   'c'  single character                     "A"     -> 'A'
+//   's'  rest of the packet, commas included  (pointer in PacketFields::rest)
+// =============================================================================
+
+// Most fields in any packet ($KEY)
+#define PACKET_MAX_FIELDS 14
+
+typedef struct {
+    int32_t value[PACKET_MAX_FIELDS];   // Converted fields in schema order
+    const char* rest;                   // Start of the 's' field, if parsed
+    uint8_t count;                      // Number of fields converted
+} PacketFields;
+
+/**
+ * Split and convert the fields of a packet.
+ *
+ * @param text Field text after the "$XXX," header (null terminated)
+ * @param schema Field kinds, one character per field (see above)
+ * @param out Converted fields
+ * @return Number of fields converted (out->count)
+ */
+uint8_t packet_fields_parse(const char* text, const char* schema, PacketFields* out);
+
+#endif // PACKET_FIELDS_H
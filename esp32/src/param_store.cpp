@@ -0,0 +1,208 @@
+#include "param_store.h"
+#include "valve_safety.h"
+#include "dispense.h"
+#include "neopixel_matrix.h"
+#include "neopixel_ring.h"
+#include <Preferences.h>
+#include <stddef.h>
+
+// NVS namespace and key of the saved blob
+#define PARAM_STORE_NAMESPACE   "params"
+#define PARAM_STORE_KEY         "table"
+
+// Value storage types
+#define PARAM_TYPE_F32  0
+#define PARAM_TYPE_U32  1
+#define PARAM_TYPE_U16  2
+#define PARAM_TYPE_U8   3
+
+// Tenths of a compile-time default
+#define TENTHS(x) ((int32_t)((x) * 10))
+
+typedef struct {
+    uint8_t type;           // PARAM_TYPE_*
+    uint8_t flags;          // PARAM_FLAG_*
+    uint16_t offset;        // Field in Params
+    int32_t min;            // Range and default, in tenths
+    int32_t max;
+    int32_t def;
+} ParamDesc;
+
+// Indexed by parameter id; defaults are the config.h / module settings
+static const ParamDesc PARAMS[PARAM_COUNT] = {
+    {PARAM_TYPE_F32, 0, offsetof(Params, servo_min_angle),
+     TENTHS(SERVO_MIN_ANGLE), TENTHS(SERVO_MAX_ANGLE), TENTHS(SERVO_MIN_ANGLE)},
+    {PARAM_TYPE_F32, 0, offsetof(Params, servo_max_angle),
+     TENTHS(SERVO_MIN_ANGLE), TENTHS(SERVO_MAX_ANGLE), TENTHS(SERVO_MAX_ANGLE)},
+    {PARAM_TYPE_F32, 0, offsetof(Params, servo_max_velocity),
+     TENTHS(10), TENTHS(2000), TENTHS(SERVO_MAX_VELOCITY_DPS)},
+    {PARAM_TYPE_F32, 0, offsetof(Params, servo_max_accel),
+     TENTHS(10), TENTHS(20000), TENTHS(SERVO_MAX_ACCEL_DPS2)},
+    {PARAM_TYPE_U32, 0, offsetof(Params, valve_max_open_ms),
+     TENTHS(VALVE_PULSE_MIN_MS), TENTHS(30000), TENTHS(VALVE_MAX_OPEN_MS)},
+    {PARAM_TYPE_U32, 0, offsetof(Params, valve_cooldown_ms),
+     TENTHS(0), TENTHS(10000), TENTHS(VALVE_COOLDOWN_MS)},
+    {PARAM_TYPE_U8, 0, offsetof(Params, npm_brightness),
+     TENTHS(0), TENTHS(255), TENTHS(NPM_BRIGHTNESS)},
+    {PARAM_TYPE_U8, 0, offsetof(Params, npr_brightness),
+     TENTHS(0), TENTHS(255), TENTHS(NPR_BRIGHTNESS)},
+    {PARAM_TYPE_U8, 0, offsetof(Params, matrix_brightness),
+     TENTHS(0), TENTHS(15), TENTHS(MATRIX_DEFAULT_BRIGHTNESS)},
+    {PARAM_TYPE_U16, 0, offsetof(Params, animation_period_ms),
+     TENTHS(10), TENTHS(100), TENTHS(ANIMATION_TASK_PERIOD_MS)},
+    // Bounded so CONTROL_STALL_MS still spans several ticks
+    {PARAM_TYPE_U16, PARAM_FLAG_REBOOT, offsetof(Params, control_period_ms),
+     TENTHS(5), TENTHS(20), TENTHS(CONTROL_TASK_PERIOD_MS)},
+    {PARAM_TYPE_U16, 0, offsetof(Params, status_period_ms),
+     TENTHS(10), TENTHS(1000), TENTHS(STATUS_TX_PERIOD_MS)},
+    {PARAM_TYPE_F32, 0, offsetof(Params, flow_ml_per_s),
+     TENTHS(1), TENTHS(500), TENTHS(DISPENSE_FLOW_ML_PER_S)},
+    {PARAM_TYPE_U16, 0, offsetof(Params, flow_pulses_per_l),
+     TENTHS(0), TENTHS(10000), TENTHS(DISPENSE_PULSES_PER_L)},
+    {PARAM_TYPE_U8, 0, offsetof(Params, unit_address),
+     TENTHS(BUS_ADDR_NONE), TENTHS(BUS_ADDR_MAX), TENTHS(BUS_ADDR_NONE)},
+};
+
+// Saved form: every value in tenths, in id order
+typedef struct {
+    uint16_t schema;
+    uint16_t count;
+    int32_t tenths[PARAM_COUNT];
+} ParamBlob;
+
+#define PARAM_BLOB_HEADER_SIZE offsetof(ParamBlob, tenths)
+
+Params g_params;
+static volatile uint32_t generation = 0;
+
+static bool in_range(const ParamDesc* d, int32_t tenths) {
+    if (tenths < d->min || tenths > d->max) return false;
+    return d->type == PARAM_TYPE_F32 || tenths % 10 == 0;
+}
+
+static void store(const ParamDesc* d, int32_t tenths) {
+    uint8_t* field = (uint8_t*)&g_params + d->offset;
+    switch (d->type) {
+        case PARAM_TYPE_F32: *(float*)field = tenths * 0.1f; break;
+        case PARAM_TYPE_U32: *(uint32_t*)field = (uint32_t)(tenths / 10); break;
+        case PARAM_TYPE_U16: *(uint16_t*)field = (uint16_t)(tenths / 10); break;
+        case PARAM_TYPE_U8:  *(uint8_t*)field = (uint8_t)(tenths / 10); break;
+    }
+}
+
+static int32_t load(const ParamDesc* d) {
+    const uint8_t* field = (const uint8_t*)&g_params + d->offset;
+    switch (d->type) {
+        case PARAM_TYPE_F32: return (int32_t)lroundf(*(const float*)field * 10.0f);
+        case PARAM_TYPE_U32: return (int32_t)*(const uint32_t*)field * 10;
+        case PARAM_TYPE_U16: return (int32_t)*(const uint16_t*)field * 10;
+        case PARAM_TYPE_U8:  return (int32_t)*(const uint8_t*)field * 10;
+    }
+    return 0;
+}
+
+static void load_defaults() {
+    for (uint8_t id = 0; id < PARAM_COUNT; id++) {
+        store(&PARAMS[id], PARAMS[id].def);
+    }
+}
+
+// Travel limits are set one at a time, so each must stay on its side of the other
+static bool consistent(uint8_t id, int32_t tenths) {
+    if (id == PARAM_SERVO_MIN_ANGLE) return tenths <= load(&PARAMS[PARAM_SERVO_MAX_ANGLE]);
+    if (id == PARAM_SERVO_MAX_ANGLE) return tenths >= load(&PARAMS[PARAM_SERVO_MIN_ANGLE]);
+    return true;
+}
+
+void param_store_init() {
+    load_defaults();
+
+    Preferences prefs;
+    if (!prefs.begin(PARAM_STORE_NAMESPACE, true)) {
+        DEBUG_PRINTLN("Param store: no saved parameters");
+        return;
+    }
+
+    ParamBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    size_t n = prefs.getBytes(PARAM_STORE_KEY, &blob, sizeof(blob));
+    prefs.end();
+
+    if (n < PARAM_BLOB_HEADER_SIZE || blob.schema != PARAM_SCHEMA_VERSION) {
+        DEBUG_PRINTF("Param store: no blob for schema %d, using defaults\n", PARAM_SCHEMA_VERSION);
+        return;
+    }
+
+    // Older firmware saved fewer ids; a blob from newer firmware may hold more
+    size_t count = min((size_t)blob.count, (n - PARAM_BLOB_HEADER_SIZE) / sizeof(int32_t));
+    count = min(count, (size_t)PARAM_COUNT);
+
+    for (uint8_t id = 0; id < count; id++) {
+        if (in_range(&PARAMS[id], blob.tenths[id]) && consistent(id, blob.tenths[id])) {
+            store(&PARAMS[id], blob.tenths[id]);
+        } else {
+            DEBUG_PRINTF("Param store: param %d out of range, default kept\n", id);
+        }
+    }
+
+    DEBUG_PRINTF("Param store: %d parameters loaded\n", (int)count);
+}
+
+bool param_get(uint8_t id, int32_t* tenths) {
+    if (id >= PARAM_COUNT) return false;
+
+    *tenths = load(&PARAMS[id]);
+    return true;
+}
+
+bool param_set(uint8_t id, int32_t tenths) {
+    if (id >= PARAM_COUNT || !in_range(&PARAMS[id], tenths) || !consistent(id, tenths)) {
+        return false;
+    }
+
+    store(&PARAMS[id], tenths);
+    generation++;
+    return true;
+}
+
+uint8_t param_flags(uint8_t id) {
+    return (id < PARAM_COUNT) ? PARAMS[id].flags : 0;
+}
+
+bool param_store_save() {
+    ParamBlob blob;
+    blob.schema = PARAM_SCHEMA_VERSION;
+    blob.count = PARAM_COUNT;
+    for (uint8_t id = 0; id < PARAM_COUNT; id++) {
+        blob.tenths[id] = load(&PARAMS[id]);
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(PARAM_STORE_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putBytes(PARAM_STORE_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    DEBUG_PRINTF("Param store: saved (%s)\n", ok ? "ok" : "failed");
+    return ok;
+}
+
+bool param_store_reset() {
+    load_defaults();
+    generation++;
+
+    Preferences prefs;
+    if (!prefs.begin(PARAM_STORE_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.clear();
+    prefs.end();
+
+    DEBUG_PRINTLN("Param store: defaults restored");
+    return ok;
+}
+
+uint32_t param_generation() {
+    return generation;
+}
@@ -0,0 +1,127 @@
+#ifndef PARAM_STORE_H
+#define PARAM_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// Parameter Store
+// =============================================================================
+// Field-tunable settings (servo travel and motion limits, valve timing and
+// pour calibration, brightness, task periods) in one typed table, persisted
+// to NVS.
+//
+// param_store_init() loads the saved values once in setup() into g_params,
+// which the tasks read directly, so a tuned unit boots with its settings and
+// the Pi only has to send what it wants changed. Values travel over UART in
+// tenths (like $SRV angles) whatever their type: $PRM reads and sets them,
+// $PSV saves to NVS or restores the defaults (see protocol/uart_protocol.md).
+//
+// The saved blob carries PARAM_SCHEMA_VERSION. A blob from another schema is
+// ignored (defaults are used), and any saved value outside its range falls
+// back to its default, so a reflash never boots with a bad setting.
+// =============================================================================
+
+// Bump whenever a parameter's meaning, unit or range changes. Appending ids
+// does not need a bump: missing entries just keep their defaults.
+#define PARAM_SCHEMA_VERSION    1
+
+// Parameter ids (wire order - append only)
+#define PARAM_SERVO_MIN_ANGLE       0   // Aim servo travel, low end (degrees)
+#define PARAM_SERVO_MAX_ANGLE       1   // Aim servo travel, high end (degrees)
+#define PARAM_SERVO_MAX_VELOCITY    2   // Aim servo speed limit (degrees/second)
+#define PARAM_SERVO_MAX_ACCEL       3   // Aim servo acceleration limit (degrees/second^2)
+#define PARAM_VALVE_MAX_OPEN_MS     4   // Valve auto-close time
+#define PARAM_VALVE_COOLDOWN_MS     5   // Minimum time between pours
+#define PARAM_NPM_BRIGHTNESS        6   // NeoPixel matrix brightness (0-255)
+#define PARAM_NPR_BRIGHTNESS        7   // NeoPixel ring brightness (0-255)
+#define PARAM_MATRIX_BRIGHTNESS     8   // MAX7219 intensity (0-15)
+#define PARAM_ANIMATION_PERIOD_MS   9   // Animation task period
+#define PARAM_CONTROL_PERIOD_MS     10  // Control task period (applied at boot)
+#define PARAM_STATUS_PERIOD_MS      11  // Status telemetry period
+#define PARAM_FLOW_ML_PER_S         12  // Pour flow with the valve fully open (ml/second)
+#define PARAM_FLOW_PULSES_PER_L     13  // Flow meter calibration (0 = flow curve only)
+#define PARAM_UNIT_ADDRESS          14  // Bus address (0 = standalone, 1-254 on a shared bus)
+#define PARAM_COUNT                 15
+
+// Parameter flags
+#define PARAM_FLAG_REBOOT   0x01    // Read once at boot: save, then reset to apply
+
+// Live values, read by every task (written only by the comm task)
+typedef struct {
+    float servo_min_angle;
+    float servo_max_angle;
+    float servo_max_velocity;
+    float servo_max_accel;
+    uint32_t valve_max_open_ms;
+    uint32_t valve_cooldown_ms;
+    uint8_t npm_brightness;
+    uint8_t npr_brightness;
+    uint8_t matrix_brightness;
+    uint16_t animation_period_ms;
+    uint16_t control_period_ms;
+    uint16_t status_period_ms;
+    float flow_ml_per_s;
+    uint16_t flow_pulses_per_l;
+    uint8_t unit_address;
+} Params;
+
+extern Params g_params;
+
+/**
+ * Load the defaults, then any saved values from NVS.
+ * Call once from setup() before the modules that read g_params are initialized.
+ */
+void param_store_init();
+
+/**
+ * Read a parameter.
+ *
+ * @param id Parameter id (PARAM_*)
+ * @param tenths Value in tenths of its unit
+ * @return True if the id is valid
+ */
+bool param_get(uint8_t id, int32_t* tenths);
+
+/**
+ * Set a parameter in g_params (not saved until param_store_save()).
+ * Out-of-range values are refused, as is a servo travel low end above the
+ * high end. Integer parameters take whole values only.
+ *
+ * @param id Parameter id (PARAM_*)
+ * @param tenths New value in tenths of its unit
+ * @return True if the value was applied
+ */
+bool param_set(uint8_t id, int32_t tenths);
+
+/**
+ * Get a parameter's flags (PARAM_FLAG_*).
+ *
+ * @param id Parameter id (PARAM_*)
+ * @return Flags, 0 for an invalid id
+ */
+uint8_t param_flags(uint8_t id);
+
+/**
+ * Write every parameter to NVS. Blocks on the flash write - comm task only.
+ *
+ * @return True if the blob was written
+ */
+bool param_store_save();
+
+/**
+ * Restore every default in g_params and erase the saved blob.
+ *
+ * @return True if NVS was cleared
+ */
+bool param_store_reset();
+
+/**
+ * Counter bumped after every change to g_params, so tasks can re-apply
+ * settings they copied into their own modules.
+ *
+ * @return Change generation
+ */
+uint32_t param_generation();
+
+#endif // PARAM_STORE_H
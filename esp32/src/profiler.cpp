@@ -0,0 +1,179 @@
+#include "profiler.h"
+#include "trace.h"
+
+#if PROFILER_ENABLED
+
+#include "esp_timer.h"
+
+// Per-task accumulators for the current report window
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t period_us;
+    bool fixed_rate;            // Wakes once per period (jitter is tracked)
+    int64_t last_begin_us;      // Start of the previous iteration (for jitter)
+    int64_t begin_us;           // Start of the current iteration
+
+    uint32_t loops;
+    uint32_t exec_min_us;
+    uint32_t exec_max_us;
+    uint64_t exec_sum_us;
+    uint32_t overruns;
+    uint32_t jitter_max_us;
+
+    uint32_t locks;
+    uint32_t lock_wait_max_us;
+    uint64_t lock_wait_sum_us;
+    uint32_t lock_timeouts;
+} ProfilerSlot;
+
+static ProfilerSlot slots[PRF_TASK_COUNT];
+
+// Busy time per core since the last profiler_take_core_load()
+static uint64_t core_busy_us[PRF_CORE_COUNT];
+static int64_t core_window_start_us = 0;
+
+// Guards window reset (comm task) against updates from the other core
+static portMUX_TYPE profiler_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void reset_window(ProfilerSlot* slot) {
+    slot->loops = 0;
+    slot->exec_min_us = UINT32_MAX;
+    slot->exec_max_us = 0;
+    slot->exec_sum_us = 0;
+    slot->overruns = 0;
+    slot->jitter_max_us = 0;
+    slot->locks = 0;
+    slot->lock_wait_max_us = 0;
+    slot->lock_wait_sum_us = 0;
+    slot->lock_timeouts = 0;
+}
+
+static uint16_t clamp16(uint32_t value) {
+    return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+// Map the calling task to its slot (NULL for unregistered tasks)
+static ProfilerSlot* current_slot() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < PRF_TASK_COUNT; i++) {
+        if (slots[i].handle == self) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+void profiler_register_task(uint8_t task, TaskHandle_t handle, uint32_t period_ms,
+                            bool fixed_rate) {
+    if (task >= PRF_TASK_COUNT) return;
+
+    portENTER_CRITICAL(&profiler_mux);
+    slots[task].handle = handle;
+    slots[task].period_us = period_ms * 1000;
+    slots[task].fixed_rate = fixed_rate;
+    slots[task].last_begin_us = 0;
+    slots[task].begin_us = 0;
+    reset_window(&slots[task]);
+    portEXIT_CRITICAL(&profiler_mux);
+}
+
+void profiler_loop_begin(uint8_t task) {
+    ProfilerSlot* slot = &slots[task];
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&profiler_mux);
+    if (slot->period_us > 0 && slot->fixed_rate && slot->last_begin_us > 0) {
+        int64_t interval = now - slot->last_begin_us;
+        int64_t deviation = interval - (int64_t)slot->period_us;
+        uint32_t jitter = (uint32_t)(deviation < 0 ? -deviation : deviation);
+        if (jitter > slot->jitter_max_us) {
+            slot->jitter_max_us = jitter;
+        }
+    }
+    slot->last_begin_us = now;
+    slot->begin_us = now;
+    portEXIT_CRITICAL(&profiler_mux);
+}
+
+void profiler_loop_end(uint8_t task) {
+    ProfilerSlot* slot = &slots[task];
+    int64_t now = esp_timer_get_time();
+    BaseType_t core = xPortGetCoreID();
+
+    portENTER_CRITICAL(&profiler_mux);
+    uint32_t exec = (uint32_t)(now - slot->begin_us);
+    if (core < PRF_CORE_COUNT) core_busy_us[core] += exec;
+    slot->loops++;
+    slot->exec_sum_us += exec;
+    if (exec < slot->exec_min_us) slot->exec_min_us = exec;
+    if (exec > slot->exec_max_us) slot->exec_max_us = exec;
+    bool overrun = (slot->period_us > 0 && exec > slot->period_us);
+    if (overrun) {
+        slot->overruns++;
+    }
+    portEXIT_CRITICAL(&profiler_mux);
+
+    if (overrun) {
+        trace_task_event(TRACE_EV_OVERRUN, task, exec);
+    }
+}
+
+int64_t profiler_lock_begin() {
+    return esp_timer_get_time();
+}
+
+void profiler_lock_end(int64_t start, bool acquired) {
+    ProfilerSlot* slot = current_slot();
+    if (slot == NULL) return;
+
+    uint32_t wait = (uint32_t)(esp_timer_get_time() - start);
+
+    portENTER_CRITICAL(&profiler_mux);
+    slot->locks++;
+    slot->lock_wait_sum_us += wait;
+    if (wait > slot->lock_wait_max_us) slot->lock_wait_max_us = wait;
+    if (!acquired) slot->lock_timeouts++;
+    portEXIT_CRITICAL(&profiler_mux);
+
+    if (!acquired) {
+        trace_task_event(TRACE_EV_LOCK_TIMEOUT, (uint8_t)(slot - slots), wait);
+    }
+}
+
+void profiler_take_report(uint8_t task, ProfilerReport* report) {
+    if (task >= PRF_TASK_COUNT) return;
+    ProfilerSlot* slot = &slots[task];
+
+    portENTER_CRITICAL(&profiler_mux);
+    report->loops = clamp16(slot->loops);
+    report->exec_min_us = slot->loops ? slot->exec_min_us : 0;
+    report->exec_avg_us = slot->loops ? (uint32_t)(slot->exec_sum_us / slot->loops) : 0;
+    report->exec_max_us = slot->exec_max_us;
+    report->overruns = clamp16(slot->overruns);
+    report->jitter_max_us = clamp16(slot->jitter_max_us);
+    report->lock_wait_avg_us = slot->locks ? clamp16((uint32_t)(slot->lock_wait_sum_us / slot->locks)) : 0;
+    report->lock_wait_max_us = clamp16(slot->lock_wait_max_us);
+    report->lock_timeouts = clamp16(slot->lock_timeouts);
+    reset_window(slot);
+    TaskHandle_t handle = slot->handle;
+    portEXIT_CRITICAL(&profiler_mux);
+
+    // ESP-IDF reports the high-water mark in bytes
+    report->stack_free = handle ? clamp16(uxTaskGetStackHighWaterMark(handle)) : 0;
+}
+
+void profiler_take_core_load(uint16_t load_permille[PRF_CORE_COUNT]) {
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&profiler_mux);
+    int64_t window_us = now - core_window_start_us;
+    for (int core = 0; core < PRF_CORE_COUNT; core++) {
+        uint64_t load = (window_us > 0) ? core_busy_us[core] * 1000 / (uint64_t)window_us : 0;
+        load_permille[core] = (uint16_t)(load > 1000 ? 1000 : load);
+        core_busy_us[core] = 0;
+    }
+    core_window_start_us = now;
+    portEXIT_CRITICAL(&profiler_mux);
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,120 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "config.h"
+
+// =============================================================================
+// Task Profiler
+// =============================================================================
+// Per-task loop timing built on esp_timer_get_time():
+// - Execution time min/avg/max per loop iteration
+// - Deadline overruns and wake-up jitter against the task period
+// - State mutex wait time and lock-timeout counts
+// - Stack high-water mark
+// - Per-core load: busy time of the profiled tasks on each core
+//
+// Each task writes only its own slot; the comm task takes a snapshot and
+// resets the window once per PROFILER_REPORT_PERIOD_MS and sends it as $PRF
+// (core load goes out with the LED schedule, $SCH).
+//
+// With PROFILER_ENABLED set to 0 every hook below is an empty inline.
+// =============================================================================
+
+// Profiled tasks
+#define PRF_TASK_COMM       0
+#define PRF_TASK_ANIMATION  1
+#define PRF_TASK_CONTROL    2
+#define PRF_TASK_COUNT      3
+
+// Cores with a load figure
+#define PRF_CORE_COUNT      2
+
+// Snapshot of one task's report window
+typedef struct {
+    uint16_t loops;             // Loop iterations in the window
+    uint32_t exec_min_us;       // Shortest iteration
+    uint32_t exec_avg_us;       // Average iteration
+    uint32_t exec_max_us;       // Longest iteration
+    uint16_t overruns;          // Iterations longer than the task period
+    uint16_t jitter_max_us;     // Worst wake-up deviation from the period
+    uint16_t lock_wait_avg_us;  // Average state_lock() wait
+    uint16_t lock_wait_max_us;  // Longest state_lock() wait
+    uint16_t lock_timeouts;     // state_lock() calls that timed out
+    uint16_t stack_free;        // Stack high-water mark (bytes never used)
+} ProfilerReport;
+
+#if PROFILER_ENABLED
+
+/**
+ * Register a task with the profiler (call once from setup after creating it).
+ *
+ * @param task PRF_TASK_* index
+ * @param handle Task handle (for stack high-water mark and lock attribution)
+ * @param period_ms Task period, or 0 for event-driven tasks (no overrun/jitter)
+ * @param fixed_rate False if the task wakes at varying intervals: period_ms
+ *                   is then only the overrun budget and jitter is not tracked
+ */
+void profiler_register_task(uint8_t task, TaskHandle_t handle, uint32_t period_ms,
+                            bool fixed_rate = true);
+
+/**
+ * Mark the start of a loop iteration (after the task wakes).
+ *
+ * @param task PRF_TASK_* index
+ */
+void profiler_loop_begin(uint8_t task);
+
+/**
+ * Mark the end of a loop iteration (before the task sleeps).
+ *
+ * @param task PRF_TASK_* index
+ */
+void profiler_loop_end(uint8_t task);
+
+/**
+ * Get a timestamp to pass to profiler_lock_end().
+ *
+ * @return Current time in microseconds
+ */
+int64_t profiler_lock_begin();
+
+/**
+ * Record a state_lock() attempt for the calling task.
+ *
+ * @param start Timestamp from profiler_lock_begin()
+ * @param acquired True if the lock was taken, false on timeout
+ */
+void profiler_lock_end(int64_t start, bool acquired);
+
+/**
+ * Copy one task's statistics and start a new report window.
+ *
+ * @param task PRF_TASK_* index
+ * @param report Destination for the snapshot
+ */
+void profiler_take_report(uint8_t task, ProfilerReport* report);
+
+/**
+ * Share of each core spent in profiled loop iterations since the last call.
+ * An iteration preempted by another profiled task on its core counts the
+ * preempted time too, so this is an upper bound.
+ *
+ * @param load_permille Destination, per core (0-1000)
+ */
+void profiler_take_core_load(uint16_t load_permille[PRF_CORE_COUNT]);
+
+#else
+
+inline void profiler_register_task(uint8_t task, TaskHandle_t handle, uint32_t period_ms,
+                                   bool fixed_rate = true) {}
+inline void profiler_loop_begin(uint8_t task) {}
+inline void profiler_loop_end(uint8_t task) {}
+inline int64_t profiler_lock_begin() { return 0; }
+inline void profiler_lock_end(int64_t start, bool acquired) {}
+
+#endif // PROFILER_ENABLED
+
+#endif // PROFILER_H
@@ -1,117 +1,120 @@
 #include "rgb_strip.h"
 #include "config.h"
 #include "color_utils.h"
+#include "compositor.h"
 
 // Current RGB state
 static uint8_t current_r = 0;
 static uint8_t current_g = 0;
 static uint8_t current_b = 0;
 
-void rgb_state_init(RgbState* state) {
-    state->mode = RGB_MODE_SOLID;
-    state->r = 0;
-    state->g = 0;
-    state->b = 0;
-    state->r2 = 0;
-    state->g2 = 0;
-    state->b2 = 0;
-    state->gradient_speed = 10;
-    state->gradient_position = 0;
-    state->rainbow_hue = 0;
-    state->prev_mode = 255;  // Force initial update
-    state->prev_r = 0;
-    state->prev_g = 0;
-    state->prev_b = 0;
-    state->needs_update = true;
+#if RGB_DITHER_ENABLED
+// Fractional duty carried to the next frame, per channel (8.8 fixed point)
+static uint8_t dither_error[3] = {0, 0, 0};
+#endif
+
+/**
+ * Gamma-correct a linear channel value into an 8-bit PWM duty.
+ * With dithering the table's fractional bits accumulate across frames and
+ * bump the duty by one step whenever they carry.
+ */
+static uint8_t channel_duty(uint8_t channel, uint8_t value) {
+#if COLOR_GAMMA_ENABLED
+    uint16_t level = color_gamma16[value];
+#else
+    uint16_t level = (uint16_t)value << 8;
+#endif
+#if RGB_DITHER_ENABLED
+    uint16_t sum = dither_error[channel] + (level & 0xFF);
+    dither_error[channel] = (uint8_t)sum;
+    return (uint8_t)min((level >> 8) + (sum >> 8), 255);
+#else
+    return (uint8_t)min((level + 0x80) >> 8, 255);
+#endif
 }
 
-void rgb_set_mode(RgbState* state, uint8_t mode, uint8_t r, uint8_t g, uint8_t b,
-                  uint8_t r2, uint8_t g2, uint8_t b2, uint8_t speed) {
-    // Check if anything changed
-    if (state->mode != mode ||
-        state->r != r ||
-        state->g != g ||
-        state->b != b ||
-        state->r2 != r2 ||
-        state->g2 != g2 ||
-        state->b2 != b2 ||
-        state->gradient_speed != speed) {
-        state->needs_update = true;
-
-        // Reset gradient animation on mode change
-        if (state->mode != mode) {
-            state->gradient_position = 0;
+// Global LED power scale from the compositor, and the unscaled duty sum it is based on
+static uint16_t power_scale = COMPOSITOR_POWER_SCALE_FULL;
+static uint16_t demand_duty_sum = 0;
+
+// Duty last written per channel (-1 forces the first write)
+static int16_t written_duty[3] = {-1, -1, -1};
+
+// Push current_r/g/b to the PWM channels (only the channels that changed)
+static void rgb_write() {
+    uint8_t duty[3] = {
+        channel_duty(0, current_r),
+        channel_duty(1, current_g),
+        channel_duty(2, current_b),
+    };
+    demand_duty_sum = duty[0] + duty[1] + duty[2];
+
+    if (power_scale < COMPOSITOR_POWER_SCALE_FULL) {
+        for (int i = 0; i < 3; i++) {
+            duty[i] = (uint8_t)((duty[i] * power_scale) >> 8);
         }
     }
 
-    state->mode = mode;
-    state->r = r;
-    state->g = g;
-    state->b = b;
-    state->r2 = r2;
-    state->g2 = g2;
-    state->b2 = b2;
-    state->gradient_speed = (speed > 0) ? speed : 1;  // Ensure minimum speed of 1
-}
-
-void rgb_update(RgbState* state) {
-    // Handle animated modes
-    switch (state->mode) {
-        case RGB_MODE_RAINBOW: {
-            // Rainbow cycle through hue
-            rgb_set_hsv(state->rainbow_hue);
-            state->rainbow_hue = (state->rainbow_hue + 2) % 360;
-            state->prev_mode = state->mode;
-            return;
+    static const uint8_t channels[3] = {RGB_CH_R, RGB_CH_G, RGB_CH_B};
+    for (int i = 0; i < 3; i++) {
+        if (duty[i] != written_duty[i]) {
+            ledcWrite(channels[i], duty[i]);
+            written_duty[i] = duty[i];
         }
+    }
+}
 
-        case RGB_MODE_GRADIENT: {
-            // Ping-pong gradient between two colors
-            uint8_t t = gradient_position_to_t(state->gradient_position);
-
-            uint8_t r, g, b;
-            gradient_color(t, state->r, state->g, state->b,
-                          state->r2, state->g2, state->b2, &r, &g, &b);
+// Effect device for the strip: one pixel, written straight to the PWM
+struct RgbFx {
+    static const uint16_t PIXELS = 1;
+    static const uint16_t RAINBOW_STEP = RGB_RAINBOW_SPEED;
 
-            // Skip update if lerp produced black (edge case bug workaround)
-            if (r == 0 && g == 0 && b == 0) {
-                state->gradient_position = gradient_advance_pingpong(
-                    state->gradient_position, state->gradient_speed);
-                return;
-            }
+    static void fill(uint32_t color) {
+        rgb_set((uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color);
+    }
+    static void set_pixel(uint16_t index, uint32_t color) { fill(color); }
+};
 
-            rgb_set(r, g, b);
+// Effect each mode runs
+static const FxRenderFn RGB_MODE_EFFECTS[RGB_MODE_COUNT] = {
+    fx_solid<RgbFx>,        // RGB_MODE_SOLID
+    fx_rainbow<RgbFx>,      // RGB_MODE_RAINBOW
+    fx_gradient<RgbFx>,     // RGB_MODE_GRADIENT
+    fx_breathe<RgbFx>,      // RGB_MODE_BREATHE
+};
 
-            state->gradient_position = gradient_advance_pingpong(
-                state->gradient_position, state->gradient_speed);
-            state->prev_mode = state->mode;
-            return;
-        }
+void rgb_state_init(RgbState* state) {
+    state->mode = RGB_MODE_SOLID;
+    fx_state_init(&state->fx, RGB_MODE_EFFECTS[RGB_MODE_SOLID], state);
+}
 
-        default:
-            break;
-    }
+void rgb_set_mode(RgbState* state, uint8_t mode, uint8_t r, uint8_t g, uint8_t b,
+                  uint8_t r2, uint8_t g2, uint8_t b2, uint8_t speed) {
+    // Unknown modes fall back to solid; a new effect restarts its animation
+    state->mode = mode;
+    fx_select(&state->fx, RGB_MODE_EFFECTS[(mode < RGB_MODE_COUNT) ? mode : RGB_MODE_SOLID]);
+    fx_set_colors(&state->fx, r, g, b, r2, g2, b2, speed);
+}
 
-    // Check if non-animated state changed
-    bool changed = state->needs_update ||
-                   state->mode != state->prev_mode ||
-                   state->r != state->prev_r ||
-                   state->g != state->prev_g ||
-                   state->b != state->prev_b;
+void rgb_update(RgbState* state) {
+    fx_render(&state->fx, millis());
+}
 
-    if (!changed) return;
+uint32_t rgb_frame_wait_ms(const RgbState* state, uint32_t now_ms) {
+    return fx_frame_wait_ms(&state->fx, now_ms);
+}
 
-    // Handle static modes (RGB_MODE_SOLID is 0)
-    if (state->mode == RGB_MODE_SOLID) {
-        rgb_set(state->r, state->g, state->b);
-    }
+bool rgb_dither_active() {
+#if RGB_DITHER_ENABLED && COLOR_GAMMA_ENABLED
+    return ((color_gamma16[current_r] | color_gamma16[current_g] |
+             color_gamma16[current_b]) & 0xFF) != 0;
+#else
+    return false;
+#endif
+}
 
-    // Update previous state
-    state->prev_mode = state->mode;
-    state->prev_r = state->r;
-    state->prev_g = state->g;
-    state->prev_b = state->b;
-    state->needs_update = false;
+void rgb_dither_frame() {
+    rgb_write();
 }
 
 void rgb_init()
@@ -138,58 +141,28 @@ void rgb_set(uint8_t r, uint8_t g, uint8_t b)
     current_g = g;
     current_b = b;
 
-    ledcWrite(RGB_CH_R, r);
-    ledcWrite(RGB_CH_G, g);
-    ledcWrite(RGB_CH_B, b);
+    rgb_write();
 }
 
 void rgb_set_hsv(uint16_t hue)
 {
-    // HSV to RGB conversion (S=1, V=1)
-    float h = hue / 60.0f;
-    int i = (int)h;
-    float f = h - i;
-
-    float r, g, b;
-
-    switch (i % 6)
-    {
-    case 0:
-        r = 1;
-        g = f;
-        b = 0;
-        break;
-    case 1:
-        r = 1 - f;
-        g = 1;
-        b = 0;
-        break;
-    case 2:
-        r = 0;
-        g = 1;
-        b = f;
-        break;
-    case 3:
-        r = 0;
-        g = 1 - f;
-        b = 1;
-        break;
-    case 4:
-        r = f;
-        g = 0;
-        b = 1;
-        break;
-    default:
-        r = 1;
-        g = 0;
-        b = 1 - f;
-        break;
-    }
+    // Degrees to rainbow table steps (182 / 256 ~= 256 / 360)
+    uint32_t c = color_rainbow_at((uint8_t)(((hue % 360) * 182) >> 8));
+    rgb_set((uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+uint16_t rgb_load_ma()
+{
+    return (uint16_t)((uint32_t)demand_duty_sum * POWER_RGB_MA_PER_CHANNEL / 255);
+}
+
+void rgb_set_power_scale(uint16_t scale)
+{
+    if (scale == power_scale)
+        return;
 
-    rgb_set(
-        (uint8_t)(r * 255),
-        (uint8_t)(g * 255),
-        (uint8_t)(b * 255));
+    power_scale = scale;
+    rgb_write();
 }
 
 void rgb_off()
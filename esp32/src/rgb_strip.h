@@ -2,29 +2,29 @@
 #define RGB_STRIP_H
 
 #include <Arduino.h>
+#include "effects.h"
 
 // =============================================================================
 // RGB LED Strip Module
 // =============================================================================
-// Controls a PWM-based RGB LED strip with various modes.
+// Controls a PWM-based RGB LED strip with various modes. The strip is a
+// one-pixel device of the shared effect library (effects.h).
 // =============================================================================
 
 // RGB modes (matches original protocol)
 #define RGB_MODE_SOLID      0       // Solid color (default)
 #define RGB_MODE_RAINBOW    1       // Rainbow animation
 #define RGB_MODE_GRADIENT   2       // Ping-pong gradient between 2 colors
+#define RGB_MODE_BREATHE    3       // Breathing/pulse effect
+#define RGB_MODE_COUNT      4
+
+// Rainbow speed: 2 degrees per tick (8.8 hue steps, 256 steps = 360 degrees)
+#define RGB_RAINBOW_SPEED   364
 
 // RGB state structure
 typedef struct {
     uint8_t mode;
-    uint8_t r, g, b;                // Primary color
-    uint8_t r2, g2, b2;             // Second color for gradient
-    uint8_t gradient_speed;         // Animation speed (1-50)
-    uint16_t gradient_position;     // Current position (0-510 for ping-pong)
-    uint16_t rainbow_hue;           // Current hue for rainbow mode (0-359)
-    uint8_t prev_mode;
-    uint8_t prev_r, prev_g, prev_b;
-    bool needs_update;
+    FxState fx;                     // Colors and animation state of the selected effect
 } RgbState;
 
 /**
@@ -57,13 +57,38 @@ void rgb_set_mode(RgbState* state, uint8_t mode, uint8_t r, uint8_t g, uint8_t b
                   uint8_t r2 = 0, uint8_t g2 = 0, uint8_t b2 = 0, uint8_t speed = 10);
 
 /**
- * Update the RGB strip (call from animation loop).
- * Handles state changes and animations.
+ * Update the RGB strip (call from animation loop when rgb_frame_wait_ms() is 0).
+ * Draws the effect selected by rgb_set_mode(); the PWM duty is only
+ * rewritten when it changes.
  *
  * @param state Pointer to state structure
  */
 void rgb_update(RgbState* state);
 
+/**
+ * Time until the strip needs its next frame.
+ *
+ * @param state Pointer to state structure
+ * @param now_ms Current time (millis())
+ * @return Milliseconds (0 = due now), or ANIMATION_WAIT_IDLE for an up-to-date static frame
+ */
+uint32_t rgb_frame_wait_ms(const RgbState* state, uint32_t now_ms);
+
+/**
+ * Whether the current color needs dither frames: dithering is enabled and a
+ * channel's gamma-corrected duty has a fractional part. A static effect draws
+ * no frames of its own, so the animation task calls rgb_dither_frame() once
+ * per animation period while this holds.
+ *
+ * @return True if the PWM duty should be rewritten every animation period
+ */
+bool rgb_dither_active();
+
+/**
+ * Rewrite the current color, carrying the dither error one frame further.
+ */
+void rgb_dither_frame();
+
 /**
  * Set RGB color directly.
  *
@@ -81,6 +106,21 @@ void rgb_set(uint8_t r, uint8_t g, uint8_t b);
  */
 void rgb_set_hsv(uint16_t hue);
 
+/**
+ * Estimated current the strip draws at its demanded (unscaled) duty.
+ *
+ * @return Current in mA (POWER_RGB_MA_PER_CHANNEL per fully-on channel)
+ */
+uint16_t rgb_load_ma();
+
+/**
+ * Apply the global LED power scale (see compositor_power_scale).
+ * Rewrites the PWM duty if the scale changed.
+ *
+ * @param scale Scale (0-COMPOSITOR_POWER_SCALE_FULL)
+ */
+void rgb_set_power_scale(uint16_t scale);
+
 /**
  * Turn RGB strip off.
  */
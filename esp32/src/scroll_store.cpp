@@ -0,0 +1,151 @@
+#include "scroll_store.h"
+#include "scroll_texts.h"
+#include "freertos/FreeRTOS.h"
+#include <Preferences.h>
+#include <stddef.h>
+
+// NVS namespace for persisted slots (keys "slot0".."slotN")
+#define SCROLL_STORE_NAMESPACE  "scroll"
+
+// Persisted bytes per slot: type + len + used part of data
+#define SLOT_HEADER_SIZE        offsetof(ScrollSlot, data)
+
+// Live slots, read by the animation task
+static ScrollSlot slots[SCROLL_SLOT_COUNT];
+
+// Upload in progress (comm task only)
+static ScrollSlot staging;
+static int8_t staging_slot = -1;
+
+// Guards slot copies between the comm and animation tasks
+static portMUX_TYPE store_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void slot_key(uint8_t slot, char* key) {
+    snprintf(key, 8, "slot%u", (unsigned)slot);
+}
+
+static size_t slot_data_size(const ScrollSlot* s) {
+    return (s->type == SCROLL_SLOT_FRAMES) ? (size_t)s->len * SCROLL_GLYPH_WIDTH : s->len;
+}
+
+static bool slot_well_formed(const ScrollSlot* s) {
+    if (s->type == SCROLL_SLOT_TEXT) return s->len > 0 && s->len <= SCROLL_SLOT_DATA_MAX;
+    if (s->type == SCROLL_SLOT_FRAMES) return s->len > 0 && s->len <= SCROLL_SLOT_MAX_FRAMES;
+    return false;
+}
+
+// Start or continue a staged upload; returns false on a gap or type switch
+static bool stage(uint8_t slot, uint8_t type, uint8_t position) {
+    if (slot >= SCROLL_SLOT_COUNT) return false;
+
+    if (position == 0) {
+        staging_slot = slot;
+        staging.type = type;
+        staging.len = 0;
+        return true;
+    }
+
+    return staging_slot == slot && staging.type == type && staging.len == position;
+}
+
+void scroll_store_init() {
+    memset(slots, 0, sizeof(slots));
+    staging_slot = -1;
+
+    Preferences prefs;
+    if (!prefs.begin(SCROLL_STORE_NAMESPACE, true)) {
+        DEBUG_PRINTLN("Scroll store: no saved slots");
+        return;
+    }
+
+    for (uint8_t i = 0; i < SCROLL_SLOT_COUNT; i++) {
+        char key[8];
+        slot_key(i, key);
+
+        ScrollSlot s;
+        memset(&s, 0, sizeof(s));
+        size_t n = prefs.getBytes(key, &s, sizeof(s));
+
+        if (n >= SLOT_HEADER_SIZE && slot_well_formed(&s) && n == SLOT_HEADER_SIZE + slot_data_size(&s)) {
+            slots[i] = s;
+            DEBUG_PRINTF("Scroll store: slot %d loaded (type %d, len %d)\n", i, s.type, s.len);
+        }
+    }
+
+    prefs.end();
+}
+
+bool scroll_store_write_text(uint8_t slot, uint8_t offset, const char* text, uint8_t len) {
+    if (len == 0 || !stage(slot, SCROLL_SLOT_TEXT, offset)) return false;
+    if ((size_t)offset + len > SCROLL_SLOT_DATA_MAX) return false;
+
+    memcpy(&staging.data[offset], text, len);
+    staging.len = offset + len;
+    return true;
+}
+
+bool scroll_store_write_frame(uint8_t slot, uint8_t index, const uint8_t* rows) {
+    if (index >= SCROLL_SLOT_MAX_FRAMES || !stage(slot, SCROLL_SLOT_FRAMES, index)) return false;
+
+    // Store transposed, in the same column form as the glyph atlas
+    uint8_t* columns = &staging.data[index * SCROLL_GLYPH_WIDTH];
+    for (int col = 0; col < SCROLL_GLYPH_WIDTH; col++) {
+        columns[col] = scroll_glyph_column(rows, col);
+    }
+    staging.len = index + 1;
+    return true;
+}
+
+bool scroll_store_commit(uint8_t slot) {
+    if (slot >= SCROLL_SLOT_COUNT || staging_slot != slot || !slot_well_formed(&staging)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&store_mux);
+    slots[slot] = staging;
+    portEXIT_CRITICAL(&store_mux);
+    staging_slot = -1;
+
+    Preferences prefs;
+    if (prefs.begin(SCROLL_STORE_NAMESPACE, false)) {
+        char key[8];
+        slot_key(slot, key);
+        prefs.putBytes(key, &slots[slot], SLOT_HEADER_SIZE + slot_data_size(&slots[slot]));
+        prefs.end();
+    }
+
+    DEBUG_PRINTF("Scroll store: slot %d committed (type %d, len %d)\n",
+                 slot, slots[slot].type, slots[slot].len);
+    return true;
+}
+
+bool scroll_store_erase(uint8_t slot) {
+    if (slot >= SCROLL_SLOT_COUNT) return false;
+
+    portENTER_CRITICAL(&store_mux);
+    slots[slot].type = SCROLL_SLOT_EMPTY;
+    slots[slot].len = 0;
+    portEXIT_CRITICAL(&store_mux);
+
+    if (staging_slot == slot) staging_slot = -1;
+
+    Preferences prefs;
+    if (prefs.begin(SCROLL_STORE_NAMESPACE, false)) {
+        char key[8];
+        slot_key(slot, key);
+        prefs.remove(key);
+        prefs.end();
+    }
+
+    return true;
+}
+
+bool scroll_store_read(uint8_t slot, ScrollSlot* out) {
+    if (slot >= SCROLL_SLOT_COUNT) return false;
+
+    portENTER_CRITICAL(&store_mux);
+    *out = slots[slot];
+    portEXIT_CRITICAL(&store_mux);
+
+    return out->type != SCROLL_SLOT_EMPTY;
+}
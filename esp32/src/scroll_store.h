@@ -0,0 +1,93 @@
+#ifndef SCROLL_STORE_H
+#define SCROLL_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// Scroll Slot Store
+// =============================================================================
+// RAM table of scroll contents uploaded by the Pi, mirrored to NVS so they
+// survive a reboot. A slot holds either a text string or a sequence of raw
+// 5x5 frames, and is selected with NPM_MODE_SCROLL text IDs
+// SCROLL_TEXT_CUSTOM .. SCROLL_TEXT_CUSTOM + SCROLL_SLOT_COUNT - 1.
+//
+// Uploads are staged chunk by chunk and only replace the live slot on
+// commit, so the matrix never scrolls a half-uploaded text.
+// =============================================================================
+
+// Slot content types
+#define SCROLL_SLOT_EMPTY   0
+#define SCROLL_SLOT_TEXT    1       // data = characters
+#define SCROLL_SLOT_FRAMES  2       // data = 5 column bytes per frame
+
+// Maximum frames per slot
+#define SCROLL_SLOT_MAX_FRAMES  (SCROLL_SLOT_DATA_MAX / 5)
+
+// $SLT actions
+#define SCROLL_SLOT_ACTION_ERASE    0
+#define SCROLL_SLOT_ACTION_COMMIT   1
+
+typedef struct {
+    uint8_t type;                       // SCROLL_SLOT_*
+    uint8_t len;                        // Characters (TEXT) or frames (FRAMES)
+    uint8_t data[SCROLL_SLOT_DATA_MAX];
+} ScrollSlot;
+
+/**
+ * Load all slots from NVS.
+ * Call once from setup() before the tasks start.
+ */
+void scroll_store_init();
+
+/**
+ * Stage a chunk of text for a slot.
+ * Offset 0 starts a new upload; later chunks must continue where the
+ * previous one ended.
+ *
+ * @param slot Slot index (0 to SCROLL_SLOT_COUNT-1)
+ * @param offset Character offset of this chunk
+ * @param text Chunk characters (not null terminated)
+ * @param len Number of characters
+ * @return True if the chunk was staged
+ */
+bool scroll_store_write_text(uint8_t slot, uint8_t offset, const char* text, uint8_t len);
+
+/**
+ * Stage one 5x5 frame for a slot.
+ * Index 0 starts a new upload; later frames must be sent in order.
+ *
+ * @param slot Slot index (0 to SCROLL_SLOT_COUNT-1)
+ * @param index Frame index
+ * @param rows Five row bytes, bit 4 = leftmost column (same as SCROLL_FONT_5X5)
+ * @return True if the frame was staged
+ */
+bool scroll_store_write_frame(uint8_t slot, uint8_t index, const uint8_t* rows);
+
+/**
+ * Replace a slot with its staged upload and persist it.
+ * Blocks for the flash write - only call from the comm task.
+ *
+ * @param slot Slot index (0 to SCROLL_SLOT_COUNT-1)
+ * @return True if a complete upload for this slot was committed
+ */
+bool scroll_store_commit(uint8_t slot);
+
+/**
+ * Clear a slot in RAM and NVS.
+ *
+ * @param slot Slot index (0 to SCROLL_SLOT_COUNT-1)
+ * @return True if the slot index is valid
+ */
+bool scroll_store_erase(uint8_t slot);
+
+/**
+ * Copy a slot's current contents (safe from any task).
+ *
+ * @param slot Slot index (0 to SCROLL_SLOT_COUNT-1)
+ * @param out Destination
+ * @return True if the slot holds content
+ */
+bool scroll_store_read(uint8_t slot, ScrollSlot* out);
+
+#endif // SCROLL_STORE_H
@@ -5,7 +5,8 @@
 // Scroll Text Definitions for NeoPixel 5x5 Matrix
 // =============================================================================
 // Predefined text strings that can be scrolled across the matrix.
-// Each text is identified by an ID (0-15) sent via UART.
+// Each text is identified by an ID (0-15) sent via UART. IDs from
+// SCROLL_TEXT_CUSTOM on select slots uploaded at runtime (see scroll_store.h).
 // =============================================================================
 
 // Scroll text IDs
@@ -19,7 +20,7 @@
 #define SCROLL_TEXT_BOX          7   // "BOX"
 #define SCROLL_TEXT_CHEERS       8   // "CHEERS"
 #define SCROLL_TEXT_DRINK        9   // "DRINK"
-#define SCROLL_TEXT_CUSTOM       10  // Reserved for future use
+#define SCROLL_TEXT_CUSTOM       10  // First uploaded slot (10 + SCROLL_SLOT_COUNT - 1 is the last)
 #define SCROLL_TEXT_COUNT        11  // Number of predefined texts
 
 // Maximum text length (including null terminator)
@@ -37,7 +38,7 @@ static const char* const SCROLL_TEXTS[SCROLL_TEXT_COUNT] = {
     "BOX",           // 7
     "CHEERS",        // 8
     "DRINK",         // 9
-    "?",             // 10 - placeholder
+    "?",             // 10 - shown while uploaded slot 0 is empty
 };
 
 // Scroll animation speeds (ms per column shift)
@@ -51,7 +52,7 @@ static const char* const SCROLL_TEXTS[SCROLL_TEXT_COUNT] = {
 // Characters are stored as 5 consecutive bytes (columns left to right)
 // Gap column (0x00) is added between characters during scrolling
 
-static const uint8_t SCROLL_FONT_5X5[26][5] = {
+static constexpr uint8_t SCROLL_FONT_5X5[26][5] = {
     // A
     {0b01110, 0b10001, 0b11111, 0b10001, 0b10001},
     // B
@@ -107,7 +108,64 @@ static const uint8_t SCROLL_FONT_5X5[26][5] = {
 };
 
 // Special characters (space, question mark, etc.)
-static const uint8_t SCROLL_FONT_SPACE[5] = {0b00000, 0b00000, 0b00000, 0b00000, 0b00000};
-static const uint8_t SCROLL_FONT_QUESTION[5] = {0b01110, 0b00001, 0b00110, 0b00000, 0b00100};
+static constexpr uint8_t SCROLL_FONT_SPACE[5] = {0b00000, 0b00000, 0b00000, 0b00000, 0b00000};
+static constexpr uint8_t SCROLL_FONT_QUESTION[5] = {0b01110, 0b00001, 0b00110, 0b00000, 0b00100};
+
+// =============================================================================
+// Column Glyph Atlas
+// =============================================================================
+// The row-based font above, transposed at compile time into columns so the
+// scroller can fetch a glyph column with a single lookup.
+// Column bit 0 = top row, bit 4 = bottom row; columns left to right.
+// =============================================================================
+
+#define SCROLL_GLYPH_WIDTH      5
+#define SCROLL_GLYPH_SPACE      26  // Atlas index for ' '
+#define SCROLL_GLYPH_QUESTION   27  // Atlas index for '?'
+#define SCROLL_GLYPH_COUNT      28
+
+typedef struct {
+    uint8_t columns[SCROLL_GLYPH_COUNT][SCROLL_GLYPH_WIDTH];
+} ScrollGlyphAtlas;
+
+// Transpose one column out of a row-based glyph (row bit 4 = leftmost column)
+constexpr uint8_t scroll_glyph_column(const uint8_t* rows, int col) {
+    uint8_t column = 0;
+    for (int row = 0; row < 5; row++) {
+        if (rows[row] & (1 << (4 - col))) {
+            column |= (1 << row);
+        }
+    }
+    return column;
+}
+
+constexpr ScrollGlyphAtlas scroll_build_glyph_atlas() {
+    ScrollGlyphAtlas atlas = {};
+    for (int g = 0; g < 26; g++) {
+        for (int col = 0; col < SCROLL_GLYPH_WIDTH; col++) {
+            atlas.columns[g][col] = scroll_glyph_column(SCROLL_FONT_5X5[g], col);
+        }
+    }
+    // SCROLL_GLYPH_SPACE stays blank
+    for (int col = 0; col < SCROLL_GLYPH_WIDTH; col++) {
+        atlas.columns[SCROLL_GLYPH_QUESTION][col] = scroll_glyph_column(SCROLL_FONT_QUESTION, col);
+    }
+    return atlas;
+}
+
+static constexpr ScrollGlyphAtlas SCROLL_GLYPH_ATLAS = scroll_build_glyph_atlas();
+
+// Spot-check the transposition: 'A' has rows 1-4 lit in its left column
+static_assert(SCROLL_GLYPH_ATLAS.columns[0][0] == 0b11110, "Glyph atlas transposition is wrong");
+
+/**
+ * Map a character to its atlas index (case-insensitive; unknown -> space).
+ */
+constexpr uint8_t scroll_glyph_index(char c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c - 'A') :
+           (c >= 'a' && c <= 'z') ? (uint8_t)(c - 'a') :
+           (c == '?')             ? (uint8_t)SCROLL_GLYPH_QUESTION :
+                                    (uint8_t)SCROLL_GLYPH_SPACE;
+}
 
 #endif // SCROLL_TEXTS_H
@@ -1,5 +1,6 @@
 #include "servo_controller.h"
 #include "config.h"
+#include "param_store.h"
 
 // Servo pin assignments
 static const uint8_t servo_pins[NUM_SERVOS] = {
@@ -15,12 +16,33 @@ static const uint8_t servo_channels[NUM_SERVOS] = {
     SERVO_3_PWM_CHANNEL
 };
 
-// Current servo angles (valve servo starts at closed position)
-static float current_angles[NUM_SERVOS] = {
-    SERVO_CENTER_ANGLE,
-    SERVO_CENTER_ANGLE,
-    VALVE_CLOSED_ANGLE  // Valve servo (index 2)
-};
+// Per-servo motion planner state
+typedef struct {
+    float position;         // Current angle (degrees)
+    float velocity;         // Current speed (degrees/second, signed)
+    float target;           // Target angle (degrees)
+    float feedforward;      // Target velocity (degrees/second)
+    float max_velocity;     // Speed limit (degrees/second)
+    float max_accel;        // Acceleration limit (degrees/second^2)
+    uint32_t duty;          // Last duty written to the PWM channel
+    volatile int8_t motion_dir; // Sign of the last non-zero velocity (ISR reads it)
+    volatile int8_t fence;      // Direction the servo may not move in (0 = free)
+} ServoAxis;
+
+static ServoAxis axes[NUM_SERVOS];
+static bool attached[NUM_SERVOS];
+
+// Angle -> duty mapping, precomputed in fixed point from the PWM settings.
+// duty = DUTY_MIN + tenths_of_degree * DUTY_PER_TENTH (Q16)
+static constexpr uint32_t DUTY_MAX = (1UL << SERVO_PWM_RESOLUTION) - 1;
+static constexpr uint32_t DUTY_MIN =
+    (uint64_t)SERVO_MIN_PULSE_US * DUTY_MAX * SERVO_PWM_FREQ / 1000000;
+static constexpr uint32_t DUTY_PER_TENTH_Q16 =
+    ((uint64_t)(SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) * DUTY_MAX * SERVO_PWM_FREQ << 16) /
+    (1000000ULL * 1800);
+
+// Full range must fit the 32-bit product in angle_to_duty()
+static_assert((uint64_t)1800 * DUTY_PER_TENTH_Q16 < (1ULL << 32), "Servo duty mapping overflows");
 
 /**
  * Convert angle to PWM duty cycle.
@@ -32,32 +54,72 @@ static uint32_t angle_to_duty(float angle) {
     // Constrain angle
     angle = constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
 
-    // Calculate pulse width in microseconds
-    float pulse_us = SERVO_MIN_PULSE_US +
-        (angle / 180.0f) * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US);
+    uint32_t tenths = (uint32_t)(angle * 10.0f + 0.5f);
+    return DUTY_MIN + ((tenths * DUTY_PER_TENTH_Q16 + 0x8000) >> 16);
+}
 
-    // Convert to duty cycle
-    // PWM period at 50Hz = 20000 microseconds
-    // Resolution is 16-bit = 65535 max
-    float period_us = 1000000.0f / SERVO_PWM_FREQ;
-    uint32_t max_duty = (1 << SERVO_PWM_RESOLUTION) - 1;
-    uint32_t duty = (uint32_t)((pulse_us / period_us) * max_duty);
+// Move the PWM output to an angle (skips the write if the duty is unchanged)
+static void write_angle(uint8_t servo_index, float angle) {
+    uint32_t duty = angle_to_duty(angle);
+    if (duty != axes[servo_index].duty) {
+        ledcWrite(servo_channels[servo_index], duty);
+        axes[servo_index].duty = duty;
+    }
+    axes[servo_index].position = angle;
+}
 
-    return duty;
+// Hold a fenced axis where it is instead of letting it continue past the fence
+static void apply_fence(ServoAxis* axis) {
+    int8_t fence = axis->fence;
+    if (fence == 0) {
+        return;
+    }
+    if ((axis->target - axis->position) * fence > 0.0f) {
+        axis->target = axis->position;
+    }
+    if (axis->feedforward * fence > 0.0f) {
+        axis->feedforward = 0.0f;
+    }
+    if (axis->velocity * fence > 0.0f) {
+        axis->velocity = 0.0f;
+    }
 }
 
-void servo_init() {
-    // Configure PWM channels for all servos
-    for (int i = 0; i < NUM_SERVOS; i++) {
-        ledcSetup(servo_channels[i], SERVO_PWM_FREQ, SERVO_PWM_RESOLUTION);
-        ledcAttachPin(servo_pins[i], servo_channels[i]);
+// Attach one servo's PWM channel and move it to its start position
+static void init_axis(uint8_t i) {
+    ledcSetup(servo_channels[i], SERVO_PWM_FREQ, SERVO_PWM_RESOLUTION);
+    ledcAttachPin(servo_pins[i], servo_channels[i]);
 
-        // Move to initial position (valve starts closed, others at center)
-        float initial_angle = (i == VALVE_SERVO_INDEX) ? VALVE_CLOSED_ANGLE : SERVO_CENTER_ANGLE;
-        servo_set_angle(i, initial_angle);
+    if (i == VALVE_SERVO_INDEX) {
+        servo_set_limits(i, VALVE_MAX_VELOCITY_DPS, VALVE_MAX_ACCEL_DPS2);
+    } else {
+        servo_set_limits(i, g_params.servo_max_velocity, g_params.servo_max_accel);
+    }
 
-        DEBUG_PRINTF("Servo %d initialized on pin %d, channel %d\n",
-                     i + 1, servo_pins[i], servo_channels[i]);
+    // Move to initial position (valve starts closed, others at center)
+    axes[i].duty = UINT32_MAX;
+    axes[i].motion_dir = 0;
+    axes[i].fence = 0;
+    float initial_angle = (i == VALVE_SERVO_INDEX) ? VALVE_CLOSED_ANGLE : SERVO_CENTER_ANGLE;
+    servo_set_angle(i, initial_angle);
+    attached[i] = true;
+
+    DEBUG_PRINTF("Servo %d initialized on pin %d, channel %d\n",
+                 i + 1, servo_pins[i], servo_channels[i]);
+}
+
+void servo_init_valve() {
+    if (!attached[VALVE_SERVO_INDEX]) {
+        init_axis(VALVE_SERVO_INDEX);
+    }
+}
+
+void servo_init() {
+    // Configure PWM channels for all servos not brought up yet
+    for (uint8_t i = 0; i < NUM_SERVOS; i++) {
+        if (!attached[i]) {
+            init_axis(i);
+        }
     }
 
     DEBUG_PRINTLN("All servos initialized");
@@ -71,47 +133,114 @@ void servo_set_angle(uint8_t servo_index, float angle) {
     // Constrain angle
     angle = constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
 
-    // Update PWM
-    uint32_t duty = angle_to_duty(angle);
-    ledcWrite(servo_channels[servo_index], duty);
-
-    current_angles[servo_index] = angle;
+    ServoAxis* axis = &axes[servo_index];
+    write_angle(servo_index, angle);
+    axis->target = angle;
+    axis->velocity = 0.0f;
+    axis->feedforward = 0.0f;
 
     DEBUG_PRINTF("Servo %d set to %.1f degrees (duty=%d)\n",
-                 servo_index + 1, angle, duty);
+                 servo_index + 1, angle, axis->duty);
+}
+
+void servo_force_pwm(uint8_t servo_index, float angle) {
+    if (servo_index >= NUM_SERVOS) {
+        return;
+    }
+
+    // No write_angle(): its duty cache and position belong to the control task
+    ledcWrite(servo_channels[servo_index],
+              angle_to_duty(constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE)));
 }
 
-float servo_move_toward(uint8_t servo_index, float current, float target, float speed) {
+void servo_set_limits(uint8_t servo_index, float max_velocity, float max_accel) {
+    if (servo_index >= NUM_SERVOS || max_velocity <= 0.0f || max_accel <= 0.0f) {
+        return;
+    }
+
+    axes[servo_index].max_velocity = max_velocity;
+    axes[servo_index].max_accel = max_accel;
+}
+
+void servo_set_target(uint8_t servo_index, float target, float feedforward) {
     if (servo_index >= NUM_SERVOS) {
-        return current;
+        return;
     }
 
-    float diff = target - current;
+    ServoAxis* axis = &axes[servo_index];
+    axis->target = constrain(target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    axis->feedforward = constrain(feedforward, -axis->max_velocity, axis->max_velocity);
+    apply_fence(axis);
+}
 
-    // Check if already at target
-    if (abs(diff) < 0.1f) {
-        return current;
+float servo_update(uint8_t servo_index, float dt) {
+    if (servo_index >= NUM_SERVOS || dt <= 0.0f) {
+        return servo_get_angle(servo_index);
     }
 
-    // Calculate movement amount
-    float move_amount;
-    if (abs(diff) <= speed) {
-        move_amount = diff;
-    } else {
-        move_amount = (diff > 0) ? speed : -speed;
+    ServoAxis* axis = &axes[servo_index];
+    apply_fence(axis);
+    float error = axis->target - axis->position;
+    float dv = axis->max_accel * dt;
+
+    // Settle exactly on a static target once slow enough to stop in one tick
+    if (fabsf(error) < SERVO_SETTLE_DEG && fabsf(axis->velocity) <= dv &&
+        axis->feedforward == 0.0f) {
+        axis->velocity = 0.0f;
+        write_angle(servo_index, axis->target);
+        return axis->position;
     }
 
-    float new_angle = current + move_amount;
-    new_angle = constrain(new_angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    // Planned speed: the fastest we can go and still stop at the target
+    // (deceleration leg), capped so one tick never jumps past it
+    float distance = fabsf(error);
+    float speed = sqrtf(2.0f * axis->max_accel * distance);
+    speed = min(speed, distance / dt);
+    speed = min(speed, axis->max_velocity);
 
-    servo_set_angle(servo_index, new_angle);
+    float desired = ((error >= 0.0f) ? speed : -speed) + axis->feedforward;
+    desired = constrain(desired, -axis->max_velocity, axis->max_velocity);
 
-    return new_angle;
+    // Acceleration limit (acceleration leg of the trapezoid)
+    axis->velocity += constrain(desired - axis->velocity, -dv, dv);
+    if (axis->fence != 0 && axis->velocity * axis->fence > 0.0f) {
+        axis->velocity = 0.0f;
+    }
+    if (axis->velocity != 0.0f) {
+        axis->motion_dir = (axis->velocity > 0.0f) ? 1 : -1;
+    }
+
+    float angle = axis->position + axis->velocity * dt;
+    if (angle <= SERVO_MIN_ANGLE || angle >= SERVO_MAX_ANGLE) {
+        angle = constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        axis->velocity = 0.0f;
+    }
+
+    write_angle(servo_index, angle);
+    return angle;
+}
+
+void IRAM_ATTR servo_set_fence(uint8_t servo_index, int8_t direction) {
+    if (servo_index < NUM_SERVOS) {
+        axes[servo_index].fence = direction;
+    }
+}
+
+int8_t IRAM_ATTR servo_get_motion_dir(uint8_t servo_index) {
+    return (servo_index < NUM_SERVOS) ? axes[servo_index].motion_dir : 0;
+}
+
+bool servo_is_moving(uint8_t servo_index) {
+    if (servo_index >= NUM_SERVOS) {
+        return false;
+    }
+    const ServoAxis* axis = &axes[servo_index];
+    return axis->velocity != 0.0f || axis->position != axis->target;
 }
 
 float servo_get_angle(uint8_t servo_index) {
     if (servo_index >= NUM_SERVOS) {
         return SERVO_CENTER_ANGLE;
     }
-    return current_angles[servo_index];
+    return axes[servo_index].position;
 }
@@ -4,15 +4,35 @@
 #include <Arduino.h>
 #include "config.h"
 
+// =============================================================================
+// Servo Controller
+// =============================================================================
+// Each servo follows its target through a trapezoidal velocity profile:
+// accelerate at max_accel up to max_velocity, then decelerate so it arrives
+// at the target with zero speed. An optional feed-forward velocity (from the
+// Pi's tracker) is added to the planned speed so a moving target is pursued
+// without waiting for the position error to build up.
+// =============================================================================
+
+/**
+ * Bring up the valve servo alone, already at VALVE_CLOSED_ANGLE.
+ * Needs no other module: call first thing in setup(), so the valve pin
+ * carries the closed pulse while the rest of the board initializes.
+ */
+void servo_init_valve();
+
 /**
  * Initialize all servo controllers.
  *
- * Sets up PWM channels for all servos and moves them to center position.
+ * Sets up PWM channels for the servos not brought up yet and moves them to
+ * their start position (valve closed, others at center). Reads the motion
+ * limits from g_params, so call it after param_store_init().
  */
 void servo_init();
 
 /**
- * Set a specific servo to a specific angle.
+ * Set a specific servo to a specific angle immediately.
+ * Bypasses the planner: the servo jumps and its target is set to the angle.
  *
  * @param servo_index Servo index (0, 1, or 2)
  * @param angle Angle in degrees (0-180)
@@ -20,15 +40,67 @@ void servo_init();
 void servo_set_angle(uint8_t servo_index, float angle);
 
 /**
- * Move a servo toward target angle at specified speed.
+ * Drive a servo's PWM to an angle without touching its planner state.
+ * For the control timer's failsafe, which runs beside the control task: the
+ * planner does not know about the jump, so follow up with servo_set_angle()
+ * from the control task.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @param angle Angle in degrees (0-180)
+ */
+void servo_force_pwm(uint8_t servo_index, float angle);
+
+/**
+ * Set the motion limits of a servo.
  *
  * @param servo_index Servo index (0, 1, or 2)
- * @param current Current angle
- * @param target Target angle
- * @param speed Maximum degrees to move per call
+ * @param max_velocity Maximum speed (degrees/second)
+ * @param max_accel Maximum acceleration (degrees/second^2)
+ */
+void servo_set_limits(uint8_t servo_index, float max_velocity, float max_accel);
+
+/**
+ * Set the planner target of a servo.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @param target Target angle in degrees (0-180)
+ * @param feedforward Target velocity in degrees/second (0 = static target)
+ */
+void servo_set_target(uint8_t servo_index, float target, float feedforward = 0.0f);
+
+/**
+ * Advance a servo's motion profile by one control period and update its PWM.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @param dt Time since the last update (seconds)
  * @return New angle after movement
  */
-float servo_move_toward(uint8_t servo_index, float current, float target, float speed);
+float servo_update(uint8_t servo_index, float dt);
+
+/**
+ * Block a servo from moving in one direction (e.g. into a limit switch).
+ * Takes effect on the next target or update; safe to call from an ISR.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @param direction +1 blocks increasing angles, -1 decreasing, 0 clears the fence
+ */
+void servo_set_fence(uint8_t servo_index, int8_t direction);
+
+/**
+ * Get the direction a servo was last moving in. Safe to call from an ISR.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @return +1 (increasing angle), -1 (decreasing), or 0 if it never moved
+ */
+int8_t servo_get_motion_dir(uint8_t servo_index);
+
+/**
+ * Check whether a servo is still moving toward its target.
+ *
+ * @param servo_index Servo index (0, 1, or 2)
+ * @return True if the servo has not settled
+ */
+bool servo_is_moving(uint8_t servo_index);
 
 /**
  * Get current servo angle.
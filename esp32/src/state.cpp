@@ -1,10 +1,72 @@
 #include "state.h"
+#include "param_store.h"
+
+// Published copies, one seqlock per writer task
+typedef struct {
+    InputState input;
+    OutputState output;
+} PublishedOutputs;
+
+static CommandState published_command;
+static PublishedOutputs published_outputs;
+static volatile uint32_t command_seq = 0;
+static volatile uint32_t outputs_seq = 0;
+
+// Seqlock write: odd sequence while the copy is in progress
+static void seqlock_write(volatile uint32_t* seq, void* shared, const void* src, size_t size) {
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    __atomic_store_n(seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(shared, src, size);
+    __atomic_store_n(seq, s + 2, __ATOMIC_RELEASE);
+}
+
+// Seqlock read: retry until the copy was not overlapped by a write.
+// Writers are short memcpys on the other core, so this rarely loops.
+static void seqlock_read(volatile uint32_t* seq, void* dst, const void* shared, size_t size) {
+    uint32_t before, after;
+    do {
+        before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(dst, shared, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(seq, __ATOMIC_RELAXED);
+        if (before == after) {
+            return;
+        }
+    } while (true);
+}
+
+void state_publish_command(const CommandState* command) {
+    seqlock_write(&command_seq, &published_command, command, sizeof(CommandState));
+}
+
+void state_read_command(CommandState* command) {
+    seqlock_read(&command_seq, command, &published_command, sizeof(CommandState));
+}
+
+void state_publish_outputs(const InputState* input, const OutputState* output) {
+    PublishedOutputs p;
+    p.input = *input;
+    p.output = *output;
+    seqlock_write(&outputs_seq, &published_outputs, &p, sizeof(p));
+}
+
+void state_read_outputs(InputState* input, OutputState* output) {
+    PublishedOutputs p;
+    seqlock_read(&outputs_seq, &p, &published_outputs, sizeof(p));
+    *input = p.input;
+    *output = p.output;
+}
 
 void state_init(DeviceState* state) {
     // Initialize input state
     state->input.limit_triggered = false;
     state->input.limit_direction = LIMIT_NONE;
-    state->input.limit_trigger_time = 0;
+    state->input.limit_trigger_us = 0;
+    state->input.limit_chatter = 0;
 
     // Initialize output state
     for (int i = 0; i < NUM_SERVOS; i++) {
@@ -14,13 +76,27 @@ void state_init(DeviceState* state) {
     // Valve servo starts at closed position
     state->output.servo_angles[VALVE_SERVO_INDEX] = VALVE_CLOSED_ANGLE;
     state->output.light_on = false;
+    state->output.valve_open = false;
+    state->output.valve_enabled = true;
+    state->output.valve_open_ms = 0;
+    state->output.pour_phase = 0;
+    state->output.pour_seq = 0;
+    state->output.pour_end_reason = 0;
+    state->output.pour_target_ml = 0.0f;
+    state->output.pour_ml = 0.0f;
+    state->output.pour_duration_ms = 0;
+    state->output.control_failsafe = false;
 
     // Initialize command state
     for (int i = 0; i < NUM_SERVOS; i++) {
         state->command.target_servo_angles[i] = SERVO_CENTER_ANGLE;
+        state->command.target_servo_velocity[i] = 0.0f;
     }
     // Valve servo target starts at closed position
     state->command.target_servo_angles[VALVE_SERVO_INDEX] = VALVE_CLOSED_ANGLE;
+    state->command.target_timed = false;
+    state->command.target_seq = 0;
+    state->command.target_capture_ms = 0;
     state->command.light_command = LIGHT_CMD_AUTO;
     state->command.flags = 0;
 
@@ -62,26 +138,32 @@ void state_init(DeviceState* state) {
     // Valve control
     state->command.valve_open = false;
     state->command.valve_enabled = true;
+    state->command.pour_ml = 0.0f;
+    state->command.valve_seq = 0;
+    state->command.flags_seq = 0;
+    state->command.pour_seq = 0;
 
     state->command.last_command_time = 0;
     state->command.connected = false;
 }
 
-void state_update_limit(DeviceState* state, bool limit_active, uint8_t direction) {
+void state_update_limit(DeviceState* state, bool limit_active, uint8_t direction,
+                        uint32_t trigger_us, uint16_t chatter) {
     if (limit_active && !state->input.limit_triggered) {
         // Limit just triggered
-        state->input.limit_trigger_time = millis();
+        state->input.limit_trigger_us = trigger_us;
     }
 
     state->input.limit_triggered = limit_active;
     state->input.limit_direction = limit_active ? direction : LIMIT_NONE;
+    state->input.limit_chatter = chatter;
 }
 
 void state_update_command(DeviceState* state, float servo1_target, float servo2_target,
                           float servo3_target, uint8_t light_cmd, uint8_t flags) {
-    state->command.target_servo_angles[0] = constrain(servo1_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    state->command.target_servo_angles[1] = constrain(servo2_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    state->command.target_servo_angles[2] = constrain(servo3_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    state->command.target_servo_angles[0] = constrain(servo1_target, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[1] = constrain(servo2_target, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[2] = constrain(servo3_target, g_params.servo_min_angle, g_params.servo_max_angle);
     state->command.light_command = light_cmd;
     state->command.flags = flags;
     // Keep existing RGB/matrix values for backwards compatibility
@@ -94,9 +176,9 @@ void state_update_command_extended(DeviceState* state,
                                    uint8_t light_cmd, uint8_t flags,
                                    uint8_t rgb_r, uint8_t rgb_g, uint8_t rgb_b,
                                    uint8_t matrix_left, uint8_t matrix_right) {
-    state->command.target_servo_angles[0] = constrain(servo1_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    state->command.target_servo_angles[1] = constrain(servo2_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    state->command.target_servo_angles[2] = constrain(servo3_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    state->command.target_servo_angles[0] = constrain(servo1_target, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[1] = constrain(servo2_target, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[2] = constrain(servo3_target, g_params.servo_min_angle, g_params.servo_max_angle);
     state->command.light_command = light_cmd;
     state->command.flags = flags;
     state->command.rgb_r = rgb_r;
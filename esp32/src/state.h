@@ -10,7 +10,8 @@
 typedef struct {
     bool limit_triggered;       // True if any limit switch is active
     uint8_t limit_direction;    // LIMIT_NONE, LIMIT_CW, or LIMIT_CCW
-    uint32_t limit_trigger_time; // Timestamp when limit was triggered
+    uint32_t limit_trigger_us;  // micros() at the triggering edge
+    uint16_t limit_chatter;     // Switch edges that did not change state (wraps)
 } InputState;
 
 /**
@@ -20,6 +21,21 @@ typedef struct {
     float servo_angles[NUM_SERVOS];     // Current servo positions (degrees)
     bool servo_moving[NUM_SERVOS];      // True if servo is in motion
     bool light_on;                      // Current light state
+
+    // Valve (mirrored from ValveState so telemetry never touches it)
+    bool valve_open;                    // Valve actually open
+    bool valve_enabled;                 // False = emergency stop active
+    uint32_t valve_open_ms;             // How long the valve has been open
+
+    // Metered pour (mirrored from DispenseState)
+    uint8_t pour_phase;                 // DISPENSE_* phase
+    uint8_t pour_seq;                   // Incremented when a pour finishes
+    uint8_t pour_end_reason;            // DISPENSE_END_* of the last finished pour
+    float pour_target_ml;               // Requested volume
+    float pour_ml;                      // Volume poured so far / by the last pour
+    uint32_t pour_duration_ms;          // Valve open to shut, of the last pour
+
+    bool control_failsafe;              // Control loop stalled, valve held shut
 } OutputState;
 
 /**
@@ -27,11 +43,15 @@ typedef struct {
  */
 typedef struct {
     float target_servo_angles[NUM_SERVOS];  // Desired servo positions (degrees)
+    float target_servo_velocity[NUM_SERVOS]; // Feed-forward target velocity (degrees/second)
+    bool target_timed;          // Targets carry a capture time (run the predictor)
+    uint16_t target_seq;        // Pi measurement sequence number of the targets
+    uint32_t target_capture_ms; // ESP32 millis() at which the targets were measured
     uint8_t light_command;      // LIGHT_CMD_OFF, LIGHT_CMD_ON, or LIGHT_CMD_AUTO
     uint8_t flags;              // Reserved flags
 
     // RGB strip
-    uint8_t rgb_mode;           // 0=solid, 1=rainbow, 2=gradient
+    uint8_t rgb_mode;           // RGB_MODE_* (0=solid, 1=rainbow, etc.)
     uint8_t rgb_r;              // RGB red value (0-255)
     uint8_t rgb_g;              // RGB green value (0-255)
     uint8_t rgb_b;              // RGB blue value (0-255)
@@ -68,6 +88,12 @@ typedef struct {
     // Valve control
     bool valve_open;            // True to open valve
     bool valve_enabled;         // False = emergency stop active
+    float pour_ml;              // Metered pour volume (ml, 0 = cancel)
+
+    // Per-packet counters so readers of a snapshot can detect one-shot commands
+    uint8_t valve_seq;          // Incremented on every $VLV
+    uint8_t flags_seq;          // Incremented on every $FLG
+    uint8_t pour_seq;           // Incremented on every $POR
 
     uint32_t last_command_time; // Timestamp of last received command
     bool connected;             // True if receiving commands
@@ -82,6 +108,46 @@ typedef struct {
     CommandState command;
 } DeviceState;
 
+// =============================================================================
+// Cross-task publication
+// =============================================================================
+// Each half of DeviceState has exactly one writer task:
+//   - command:        comm task (uart_handler)
+//   - input + output: control task
+// The writer works on its own copy in g_state and publishes it through a
+// seqlock; readers copy a consistent snapshot without blocking the writer.
+// =============================================================================
+
+/**
+ * Publish the comm task's command state (call only from the comm task).
+ *
+ * @param command Command state to publish
+ */
+void state_publish_command(const CommandState* command);
+
+/**
+ * Read a consistent snapshot of the latest published command state.
+ *
+ * @param command Destination for the snapshot
+ */
+void state_read_command(CommandState* command);
+
+/**
+ * Publish the control task's input and output state (call only from the control task).
+ *
+ * @param input Input state to publish
+ * @param output Output state to publish
+ */
+void state_publish_outputs(const InputState* input, const OutputState* output);
+
+/**
+ * Read a consistent snapshot of the latest published input and output state.
+ *
+ * @param input Destination for the input snapshot
+ * @param output Destination for the output snapshot
+ */
+void state_read_outputs(InputState* input, OutputState* output);
+
 /**
  * Initialize device state with default values.
  *
@@ -95,8 +161,11 @@ void state_init(DeviceState* state);
  * @param state Pointer to device state
  * @param limit_active True if limit switch is triggered
  * @param direction Limit direction (LIMIT_CW or LIMIT_CCW)
+ * @param trigger_us Edge timestamp of the hit (micros)
+ * @param chatter Chatter edge count from the limit switch
  */
-void state_update_limit(DeviceState* state, bool limit_active, uint8_t direction);
+void state_update_limit(DeviceState* state, bool limit_active, uint8_t direction,
+                        uint32_t trigger_us, uint16_t chatter);
 
 /**
  * Update command state from received packet (basic - for backwards compatibility).
@@ -0,0 +1,97 @@
+#include "target_predictor.h"
+#include "param_store.h"
+
+// Filter state per servo axis
+typedef struct {
+    float position;         // Filtered target at sample_ms (degrees)
+    float velocity;         // Filtered target velocity (degrees/second)
+    uint32_t sample_ms;     // Capture time of the last accepted sample
+    uint16_t seq;           // Sequence number of the last accepted sample
+    bool valid;
+} PredictorAxis;
+
+static PredictorAxis axes[NUM_SERVOS];
+
+void predictor_init() {
+    for (uint8_t i = 0; i < NUM_SERVOS; i++) {
+        predictor_reset(i);
+    }
+}
+
+void predictor_reset(uint8_t axis) {
+    if (axis >= NUM_SERVOS) return;
+
+    axes[axis].position = 0.0f;
+    axes[axis].velocity = 0.0f;
+    axes[axis].sample_ms = 0;
+    axes[axis].seq = 0;
+    axes[axis].valid = false;
+}
+
+void predictor_sample(uint8_t axis, float position, float velocity,
+                      uint32_t capture_ms, uint16_t seq) {
+    if (axis >= NUM_SERVOS) return;
+    PredictorAxis* a = &axes[axis];
+
+    if (a->valid) {
+        // Wrap-safe ordering: the Pi resends the last measurement as a heartbeat
+        int16_t seq_delta = (int16_t)(seq - a->seq);
+        int32_t dt_ms = (int32_t)(capture_ms - a->sample_ms);
+
+        if (seq_delta == 0) return;
+        if (seq_delta < 0 && seq_delta > -PREDICTOR_SEQ_RESTART &&
+            dt_ms < PREDICTOR_RESET_MS) return;
+
+        if (seq_delta > 0 && dt_ms > 0 && dt_ms < PREDICTOR_RESET_MS) {
+            float dt = dt_ms / 1000.0f;
+            float predicted = a->position + a->velocity * dt;
+            float residual = position - predicted;
+
+            a->position = predicted + PREDICTOR_ALPHA * residual;
+            a->velocity = (velocity != 0.0f)
+                ? velocity
+                : a->velocity + (PREDICTOR_BETA / dt) * residual;
+            a->sample_ms = capture_ms;
+            a->seq = seq;
+            return;
+        }
+        // Restarted Pi, long gap or capture time going backwards: start over
+    }
+
+    a->position = position;
+    a->velocity = velocity;
+    a->sample_ms = capture_ms;
+    a->seq = seq;
+    a->valid = true;
+}
+
+float predictor_predict(uint8_t axis, uint32_t now_ms, float* velocity_out) {
+    if (axis >= NUM_SERVOS || !axes[axis].valid) {
+        if (velocity_out) *velocity_out = 0.0f;
+        return SERVO_CENTER_ANGLE;
+    }
+    const PredictorAxis* a = &axes[axis];
+
+    int32_t horizon_ms = (int32_t)(now_ms - a->sample_ms);
+    float velocity = a->velocity;
+    if (horizon_ms < 0) {
+        horizon_ms = 0;
+    } else if (horizon_ms > PREDICTOR_MAX_HORIZON_MS) {
+        // Stale sample: hold the furthest prediction instead of running away
+        horizon_ms = PREDICTOR_MAX_HORIZON_MS;
+        velocity = 0.0f;
+    }
+
+    float target = a->position + a->velocity * (horizon_ms / 1000.0f);
+    if (target < g_params.servo_min_angle || target > g_params.servo_max_angle) {
+        target = constrain(target, g_params.servo_min_angle, g_params.servo_max_angle);
+        velocity = 0.0f;
+    }
+
+    if (velocity_out) *velocity_out = velocity;
+    return target;
+}
+
+bool predictor_valid(uint8_t axis) {
+    return axis < NUM_SERVOS && axes[axis].valid;
+}
@@ -0,0 +1,67 @@
+#ifndef TARGET_PREDICTOR_H
+#define TARGET_PREDICTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// Target Predictor
+// =============================================================================
+// Timestamped servo targets from the Pi describe where the face was when the
+// camera frame was captured, which is tens of milliseconds in the past by the
+// time the packet is applied. Each axis runs an alpha-beta filter over those
+// samples (in ESP32 time) and control_task extrapolates the filtered target
+// to "now" on every tick, so the servo chases where the face is rather than
+// where it was. If the Pi supplies a velocity, it replaces the filter's own
+// estimate (constant-velocity model).
+//
+// Only control_task calls into this module.
+// =============================================================================
+
+/**
+ * Reset all axes (no prediction until the next sample).
+ */
+void predictor_init();
+
+/**
+ * Forget an axis' history; the next sample restarts the filter.
+ *
+ * @param axis Servo index
+ */
+void predictor_reset(uint8_t axis);
+
+/**
+ * Feed a measured target into the filter.
+ * Samples whose seq repeats or goes backwards (heartbeat resends, reordering)
+ * are ignored; a large backwards jump or a long gap restarts the filter.
+ *
+ * @param axis Servo index
+ * @param position Measured target (degrees)
+ * @param velocity Target velocity from the Pi (degrees/second), 0 = estimate it
+ * @param capture_ms ESP32 millis() at which the target was measured
+ * @param seq Pi measurement sequence number
+ */
+void predictor_sample(uint8_t axis, float position, float velocity,
+                      uint32_t capture_ms, uint16_t seq);
+
+/**
+ * Extrapolate an axis to the given time.
+ * The horizon is clamped to PREDICTOR_MAX_HORIZON_MS; past it the target
+ * holds still and the returned velocity drops to zero.
+ *
+ * @param axis Servo index
+ * @param now_ms Time to predict for (millis())
+ * @param velocity_out Predicted target velocity (degrees/second), may be NULL
+ * @return Predicted target (degrees), clamped to the servo range
+ */
+float predictor_predict(uint8_t axis, uint32_t now_ms, float* velocity_out);
+
+/**
+ * Check whether an axis has a sample to predict from.
+ *
+ * @param axis Servo index
+ * @return True once a sample has been accepted since the last reset
+ */
+bool predictor_valid(uint8_t axis);
+
+#endif // TARGET_PREDICTOR_H
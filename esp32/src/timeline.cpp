@@ -0,0 +1,201 @@
+#include "timeline.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    TimelineKey keys[TIMELINE_SEQ_MAX_KEYS];
+    uint8_t count;
+} TimelineSeq;
+
+// Preallocated keyframe pool, one fixed block per sequence.
+// Written by the comm task only while the sequence is not playing.
+static TimelineSeq sequences[TIMELINE_SEQ_COUNT];
+
+// Player state (shared between the comm and animation tasks)
+static int8_t play_seq = -1;
+static bool play_loop = false;
+static uint32_t play_start_ms = 0;
+static uint32_t play_generation = 0;
+
+static portMUX_TYPE timeline_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Last target reported per device (animation task only)
+static TimelineKey last_out[TIMELINE_DEV_COUNT];
+static bool last_valid[TIMELINE_DEV_COUNT];
+static uint32_t last_generation = 0;
+
+// Map a 0-255 segment position through an easing curve
+static uint8_t ease(uint8_t easing, uint8_t t) {
+    switch (easing) {
+        case TIMELINE_EASE_IN:
+            return (uint16_t)t * t / 255;
+        case TIMELINE_EASE_OUT:
+            return 255 - (uint16_t)(255 - t) * (255 - t) / 255;
+        case TIMELINE_EASE_IN_OUT:
+            return (uint32_t)t * t * (3 * 255 - 2 * t) / (255 * 255);
+        default:
+            return t;
+    }
+}
+
+static uint8_t mix(uint8_t a, uint8_t b, uint8_t t) {
+    return a + (((int16_t)b - a) * t) / 255;
+}
+
+// Target of one device at a point in the sequence; false before its first keyframe
+static bool evaluate(const TimelineSeq* seq, uint8_t device, uint32_t t_ms, TimelineKey* out) {
+    const TimelineKey* prev = nullptr;
+    const TimelineKey* next = nullptr;
+
+    for (uint8_t i = 0; i < seq->count; i++) {
+        const TimelineKey* k = &seq->keys[i];
+        if (k->device != device) continue;
+        if (k->time_ms <= t_ms) {
+            prev = k;
+        } else {
+            next = k;
+            break;
+        }
+    }
+
+    if (prev == nullptr) return false;
+    *out = *prev;
+
+    if (next != nullptr && next->easing != TIMELINE_EASE_STEP && next->mode == prev->mode) {
+        uint8_t t = (uint8_t)((t_ms - prev->time_ms) * 255 / (next->time_ms - prev->time_ms));
+        t = ease(next->easing, t);
+        out->r = mix(prev->r, next->r, t);
+        out->g = mix(prev->g, next->g, t);
+        out->b = mix(prev->b, next->b, t);
+        out->r2 = mix(prev->r2, next->r2, t);
+        out->g2 = mix(prev->g2, next->g2, t);
+        out->b2 = mix(prev->b2, next->b2, t);
+    }
+
+    return true;
+}
+
+void timeline_init() {
+    memset(sequences, 0, sizeof(sequences));
+    play_seq = -1;
+    play_generation = 0;
+    memset(last_valid, 0, sizeof(last_valid));
+    last_generation = 0;
+}
+
+bool timeline_write_key(uint8_t seq, uint8_t index, const TimelineKey* key) {
+    if (seq >= TIMELINE_SEQ_COUNT || index >= TIMELINE_SEQ_MAX_KEYS) return false;
+    if (key->device >= TIMELINE_DEV_COUNT || key->easing >= TIMELINE_EASE_COUNT) return false;
+
+    TimelineSeq* s = &sequences[seq];
+
+    portENTER_CRITICAL(&timeline_mux);
+    bool playing = (play_seq == seq);
+    if (playing && index == 0) {
+        // Re-uploading a playing sequence stops it
+        play_seq = -1;
+        playing = false;
+    }
+    portEXIT_CRITICAL(&timeline_mux);
+
+    if (playing) return false;
+
+    if (index == 0) {
+        s->count = 0;
+    } else if (index != s->count || key->time_ms < s->keys[index - 1].time_ms) {
+        return false;
+    }
+
+    s->keys[index] = *key;
+    s->count = index + 1;
+    return true;
+}
+
+bool timeline_trigger(uint8_t seq, uint8_t action) {
+    if (seq >= TIMELINE_SEQ_COUNT) return false;
+
+    if (action == TIMELINE_ACTION_STOP) {
+        portENTER_CRITICAL(&timeline_mux);
+        if (play_seq == seq) play_seq = -1;
+        portEXIT_CRITICAL(&timeline_mux);
+        return true;
+    }
+
+    if ((action != TIMELINE_ACTION_PLAY && action != TIMELINE_ACTION_LOOP) ||
+        sequences[seq].count == 0) {
+        return false;
+    }
+
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&timeline_mux);
+    play_seq = seq;
+    play_loop = (action == TIMELINE_ACTION_LOOP);
+    play_start_ms = now;
+    play_generation++;
+    portEXIT_CRITICAL(&timeline_mux);
+
+    return true;
+}
+
+uint8_t timeline_update(uint32_t now_ms, TimelineKey out[TIMELINE_DEV_COUNT]) {
+    portENTER_CRITICAL(&timeline_mux);
+    int8_t seq_index = play_seq;
+    bool loop = play_loop;
+    uint32_t start_ms = play_start_ms;
+    uint32_t generation = play_generation;
+    portEXIT_CRITICAL(&timeline_mux);
+
+    if (seq_index < 0) return 0;
+
+    // A new trigger re-reports every device, even if a target is unchanged
+    if (generation != last_generation) {
+        memset(last_valid, 0, sizeof(last_valid));
+        last_generation = generation;
+    }
+
+    const TimelineSeq* seq = &sequences[seq_index];
+    uint32_t duration = seq->keys[seq->count - 1].time_ms;
+    uint32_t t_ms = now_ms - start_ms;
+    bool finished = false;
+
+    if (t_ms >= duration) {
+        if (loop && duration > 0) {
+            t_ms %= duration;
+        } else {
+            t_ms = duration;
+            finished = true;
+        }
+    }
+
+    uint8_t changed = 0;
+    for (uint8_t d = 0; d < TIMELINE_DEV_COUNT; d++) {
+        TimelineKey target;
+        if (!evaluate(seq, d, t_ms, &target)) continue;
+
+        // Compare the visible fields only (time and easing vary between keys)
+        target.time_ms = 0;
+        target.easing = TIMELINE_EASE_STEP;
+        if (last_valid[d] && memcmp(&target, &last_out[d], sizeof(target)) == 0) continue;
+
+        last_out[d] = target;
+        last_valid[d] = true;
+        out[d] = target;
+        changed |= (1 << d);
+    }
+
+    if (finished) {
+        // Hold the final keyframes; stop unless re-triggered meanwhile
+        portENTER_CRITICAL(&timeline_mux);
+        if (play_generation == generation) play_seq = -1;
+        portEXIT_CRITICAL(&timeline_mux);
+    }
+
+    return changed;
+}
+
+bool timeline_active() {
+    portENTER_CRITICAL(&timeline_mux);
+    bool active = (play_seq >= 0);
+    portEXIT_CRITICAL(&timeline_mux);
+    return active;
+}
@@ -0,0 +1,97 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// Keyframe Timeline Player
+// =============================================================================
+// Plays Pi-uploaded keyframe sequences across the NeoPixel matrix, ring and
+// RGB strip from the animation task, so a visual transition costs a single
+// $SEQ packet instead of a stream of $NPM/$NPR/$RGB updates.
+//
+// Each keyframe sets one device's mode and colors at a time offset from the
+// sequence start. A keyframe's easing controls the approach from the
+// previous keyframe of the same device: colors are interpolated when both
+// keyframes use the same mode, otherwise the mode switches at the offset.
+//
+// Time is measured from the $SEQ trigger, not accumulated per tick, so all
+// devices stay in sync and playback never drifts.
+// =============================================================================
+
+// Target devices
+#define TIMELINE_DEV_NPM        0
+#define TIMELINE_DEV_NPR        1
+#define TIMELINE_DEV_RGB        2
+#define TIMELINE_DEV_COUNT      3
+
+// Easing into a keyframe
+#define TIMELINE_EASE_STEP      0   // Jump at the keyframe time
+#define TIMELINE_EASE_LINEAR    1
+#define TIMELINE_EASE_IN        2   // Quadratic, slow start
+#define TIMELINE_EASE_OUT       3   // Quadratic, slow finish
+#define TIMELINE_EASE_IN_OUT    4   // Smoothstep
+#define TIMELINE_EASE_COUNT     5
+
+// $SEQ actions
+#define TIMELINE_ACTION_STOP    0
+#define TIMELINE_ACTION_PLAY    1   // Play once, hold the last keyframes
+#define TIMELINE_ACTION_LOOP    2   // Restart after the last keyframe
+
+typedef struct __attribute__((packed)) {
+    uint8_t device;                 // TIMELINE_DEV_*
+    uint16_t time_ms;               // Offset from sequence start
+    uint8_t mode;                   // Device mode (NPM_MODE_* / NPR_MODE_* / RGB_MODE_*)
+    char letter;                    // NPM letter / scroll text ID
+    uint8_t r, g, b;
+    uint8_t r2, g2, b2;
+    uint8_t speed;                  // Gradient speed (1-50)
+    uint8_t easing;                 // TIMELINE_EASE_*
+} TimelineKey;
+
+/**
+ * Clear all sequences and stop playback.
+ */
+void timeline_init();
+
+/**
+ * Store a keyframe in a sequence.
+ * Index 0 starts a new sequence (stopping it if it is playing); later
+ * keyframes must follow in order with non-decreasing times.
+ *
+ * @param seq Sequence index (0 to TIMELINE_SEQ_COUNT-1)
+ * @param index Keyframe index within the sequence
+ * @param key Keyframe to store
+ * @return True if the keyframe was stored
+ */
+bool timeline_write_key(uint8_t seq, uint8_t index, const TimelineKey* key);
+
+/**
+ * Start or stop a sequence ($SEQ).
+ * Playback time starts at the call, so call it as soon as the packet arrives.
+ *
+ * @param seq Sequence index (0 to TIMELINE_SEQ_COUNT-1)
+ * @param action TIMELINE_ACTION_*
+ * @return True if the action was accepted
+ */
+bool timeline_trigger(uint8_t seq, uint8_t action);
+
+/**
+ * Evaluate the playing sequence (call from the animation task).
+ * Only devices whose target changed since the last call are reported.
+ *
+ * @param now_ms Current time (millis())
+ * @param out Per-device targets, indexed by TIMELINE_DEV_*
+ * @return Bitmask of devices (1 << TIMELINE_DEV_*) with a new target in out
+ */
+uint8_t timeline_update(uint32_t now_ms, TimelineKey out[TIMELINE_DEV_COUNT]);
+
+/**
+ * Check whether a sequence is playing.
+ *
+ * @return True while a sequence is playing
+ */
+bool timeline_active();
+
+#endif // TIMELINE_H
@@ -0,0 +1,129 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0,
+              "TRACE_BUFFER_SIZE must be a power of two");
+
+#define TRACE_MASK (TRACE_BUFFER_SIZE - 1)
+
+// Record ring; head and tail are free-running byte counts, masked on access
+static uint8_t trace_buffer[TRACE_BUFFER_SIZE];
+static uint32_t trace_head = 0;     // Where the next record goes
+static uint32_t trace_tail = 0;     // Start of the oldest record
+static uint32_t trace_dropped = 0;
+static bool trace_paused = false;
+
+// Records come from both cores (comm task, control task)
+static portMUX_TYPE trace_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Copy into the ring at a free-running position, wrapping at the end
+static void ring_put(uint32_t pos, const void* data, size_t len) {
+    if (len == 0) return;
+    size_t start = pos & TRACE_MASK;
+    size_t first = TRACE_BUFFER_SIZE - start;
+    if (first > len) first = len;
+    memcpy(&trace_buffer[start], data, first);
+    memcpy(trace_buffer, (const uint8_t*)data + first, len - first);
+}
+
+/**
+ * Append one record made of an optional prefix and a body.
+ * Caller must hold trace_mux.
+ */
+static void write_record(uint8_t type, const void* prefix, uint8_t prefix_len,
+                         const void* body, uint8_t body_len) {
+    uint8_t len = prefix_len + body_len;
+    uint32_t total = TRACE_HEADER_SIZE + len;
+
+    // Make room by dropping whole records from the old end
+    while (trace_head - trace_tail + total > TRACE_BUFFER_SIZE) {
+        uint8_t old_len = trace_buffer[(trace_tail + TRACE_HEADER_SIZE - 1) & TRACE_MASK];
+        trace_tail += TRACE_HEADER_SIZE + old_len;
+        trace_dropped++;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    uint32_t now = micros();
+    memcpy(header, &now, sizeof(now));
+    header[4] = type;
+    header[5] = len;
+
+    ring_put(trace_head, header, sizeof(header));
+    ring_put(trace_head + TRACE_HEADER_SIZE, prefix, prefix_len);
+    ring_put(trace_head + TRACE_HEADER_SIZE + prefix_len, body, body_len);
+    trace_head += total;
+}
+
+void trace_record(uint8_t type, const void* payload, uint8_t len) {
+    portENTER_CRITICAL(&trace_mux);
+    if (!trace_paused) {
+        write_record(type, NULL, 0, payload, len);
+    }
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+void trace_rx(bool binary, bool accepted, const void* data, size_t len) {
+    uint8_t flags = (binary ? TRACE_RX_BINARY : 0) | (accepted ? TRACE_RX_ACCEPTED : 0);
+    if (len > UINT8_MAX - 1) len = UINT8_MAX - 1;
+
+    portENTER_CRITICAL(&trace_mux);
+    if (!trace_paused) {
+        write_record(TRACE_EV_RX, &flags, 1, data, (uint8_t)len);
+    }
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+void trace_status(uint8_t kind, bool binary, uint16_t mask) {
+    uint8_t payload[4] = {kind, (uint8_t)(binary ? 1 : 0)};
+    memcpy(&payload[2], &mask, sizeof(mask));
+    trace_record(TRACE_EV_STATUS, payload, sizeof(payload));
+}
+
+void trace_task_event(uint8_t type, uint8_t task, uint32_t us) {
+    uint8_t payload[5] = {task};
+    memcpy(&payload[1], &us, sizeof(us));
+    trace_record(type, payload, sizeof(payload));
+}
+
+void trace_set_paused(bool paused) {
+    portENTER_CRITICAL(&trace_mux);
+    trace_paused = paused;
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+void trace_clear() {
+    portENTER_CRITICAL(&trace_mux);
+    trace_tail = trace_head;
+    trace_dropped = 0;
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+void trace_get_info(TraceInfo* info) {
+    portENTER_CRITICAL(&trace_mux);
+    info->bytes = trace_head - trace_tail;
+    info->dropped = trace_dropped;
+    info->paused = trace_paused;
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+size_t trace_read(uint32_t offset, uint8_t* out, size_t size) {
+    portENTER_CRITICAL(&trace_mux);
+    uint32_t held = trace_head - trace_tail;
+    size_t n = (offset < held) ? held - offset : 0;
+    if (n > size) n = size;
+
+    size_t start = (trace_tail + offset) & TRACE_MASK;
+    size_t first = TRACE_BUFFER_SIZE - start;
+    if (first > n) first = n;
+    memcpy(out, &trace_buffer[start], first);
+    memcpy(out + first, trace_buffer, n - first);
+    portEXIT_CRITICAL(&trace_mux);
+
+    return n;
+}
+
+#endif // TRACE_ENABLED
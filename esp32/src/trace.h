@@ -0,0 +1,138 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =============================================================================
+// Trace Recorder
+// =============================================================================
+// Binary log of what the unit received and did, for reproducing a stutter
+// on a desk without DEBUG_ENABLED (whose prints would corrupt the Pi link):
+// - Every received packet, raw, with whether it was accepted
+// - Every status emission ($STS keyframe or $STD delta)
+// - Task overruns and state lock timeouts, from the profiler hooks
+// - Control loop failsafe trips (valve forced shut by the control timer)
+//
+// Records go into a fixed RAM ring of TRACE_BUFFER_SIZE bytes; when it is
+// full the oldest records are dropped (and counted), so the buffer always
+// holds the most recent history. Each record is
+//     [t_us:u32][type:u8][len:u8][payload:len]
+// with t_us from micros(). Recording is one short copy under a spinlock.
+//
+// The Pi pauses recording and pages the buffer out with $TRC (see
+// protocol/uart_protocol.md); rpi/src/tools/esp_trace.py saves it and replays
+// the received packets against the native build (bench/replay).
+//
+// With TRACE_ENABLED set to 0 every hook below is an empty inline.
+// =============================================================================
+
+// Record header size (t_us, type, len)
+#define TRACE_HEADER_SIZE   6
+
+// Record types
+#define TRACE_EV_RX         1   // Packet: [flags][raw bytes between the framing markers]
+#define TRACE_EV_STATUS     2   // Status sent: [kind][binary][mask:u16]
+#define TRACE_EV_OVERRUN    3   // Loop over its period: [task][exec_us:u32]
+#define TRACE_EV_LOCK_TIMEOUT 4 // state_lock() timed out: [task][wait_us:u32]
+#define TRACE_EV_FAILSAFE   5   // Control failsafe tripped: [task][stall_us:u32]
+
+// TRACE_EV_RX flags
+#define TRACE_RX_BINARY     0x01    // COBS frame (else ASCII line without '\n')
+#define TRACE_RX_ACCEPTED   0x02    // Parsed and applied
+
+// TRACE_EV_STATUS kinds
+#define TRACE_STATUS_FULL   0   // $STS / binary STS keyframe
+#define TRACE_STATUS_DELTA  1   // $STD / binary STD
+
+// Buffer state for a dump
+typedef struct {
+    uint32_t bytes;     // Bytes of whole records held
+    uint32_t dropped;   // Records overwritten since the last clear
+    bool paused;        // Recording stopped for a dump
+} TraceInfo;
+
+#if TRACE_ENABLED
+
+/**
+ * Record one event (drops the oldest records to make room).
+ * No effect while paused.
+ *
+ * @param type TRACE_EV_*
+ * @param payload Record payload
+ * @param len Payload length (at most 255 bytes)
+ */
+void trace_record(uint8_t type, const void* payload, uint8_t len);
+
+/**
+ * Record a received packet.
+ *
+ * @param binary True for a COBS frame
+ * @param accepted True if it parsed and was applied
+ * @param data Raw packet bytes between the framing markers
+ * @param len Number of bytes
+ */
+void trace_rx(bool binary, bool accepted, const void* data, size_t len);
+
+/**
+ * Record a status emission.
+ *
+ * @param kind TRACE_STATUS_*
+ * @param binary True if sent as a binary frame
+ * @param mask Fields sent (STS_FIELD_*)
+ */
+void trace_status(uint8_t kind, bool binary, uint16_t mask);
+
+/**
+ * Record a task timing event.
+ *
+ * @param type TRACE_EV_OVERRUN, TRACE_EV_LOCK_TIMEOUT or TRACE_EV_FAILSAFE
+ * @param task PRF_TASK_* index
+ * @param us Iteration time, lock wait or stall (microseconds)
+ */
+void trace_task_event(uint8_t type, uint8_t task, uint32_t us);
+
+/**
+ * Stop or resume recording. Paused, the buffer stays as it is, so it can
+ * be read out consistently.
+ *
+ * @param paused True to pause
+ */
+void trace_set_paused(bool paused);
+
+/**
+ * Drop every record and reset the drop count.
+ */
+void trace_clear();
+
+/**
+ * Get the buffer state.
+ *
+ * @param info Destination
+ */
+void trace_get_info(TraceInfo* info);
+
+/**
+ * Copy bytes of the record stream, oldest record first.
+ *
+ * @param offset Byte offset into the stream (0 = start of the oldest record)
+ * @param out Destination buffer
+ * @param size Bytes wanted
+ * @return Bytes copied (less than size at the end of the stream)
+ */
+size_t trace_read(uint32_t offset, uint8_t* out, size_t size);
+
+#else
+
+inline void trace_record(uint8_t type, const void* payload, uint8_t len) {}
+inline void trace_rx(bool binary, bool accepted, const void* data, size_t len) {}
+inline void trace_status(uint8_t kind, bool binary, uint16_t mask) {}
+inline void trace_task_event(uint8_t type, uint8_t task, uint32_t us) {}
+inline void trace_set_paused(bool paused) {}
+inline void trace_clear() {}
+inline void trace_get_info(TraceInfo* info) { info->bytes = 0; info->dropped = 0; info->paused = false; }
+inline size_t trace_read(uint32_t offset, uint8_t* out, size_t size) { return 0; }
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_H
@@ -1,74 +1,339 @@
 #include "uart_handler.h"
 #include "config.h"
-#include "valve_safety.h"
-
-// Use USB Serial for protocol communication
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "binary_protocol.h"
+#include "profiler.h"
+#include "scroll_store.h"
+#include "timeline.h"
+#include "neopixel_matrix.h"
+#include "rgb_strip.h"
+#include "packet_fields.h"
+#include "param_store.h"
+#include "dispense.h"
+#include "trace.h"
+
+// USB Serial to one Pi, or an RS-485 transceiver on a shared bus
+#if BUS_ENABLED
+#define PiSerial Serial2
+#else
 #define PiSerial Serial
+#endif
+
+// Receive framing state (ASCII and binary packets share one stream)
+typedef enum {
+    RX_IDLE,        // After a 0x00 - next byte selects the framing
+    RX_ASCII,       // Inside a $XXX,...\n packet
+    RX_BINARY,      // Inside a COBS frame, waiting for 0x00
+    RX_HUNT         // Discarding bytes until a '$' or a 0x00 (only a 0x00
+                    // arms binary framing, so noise cannot start a frame)
+} RxFraming;
 
 // Receive buffer
 static char rx_buffer[UART_RX_BUFFER_SIZE];
 static size_t rx_index = 0;
+static RxFraming rx_framing = RX_HUNT;
+
+// Status format negotiated by the Pi ($BIN,1 / $BIN,0)
+static bool status_binary = false;
+
+// Link rate negotiated by the Pi ($BDR). A rate switch is deferred until the
+// packet that asked for it has been answered at the old rate.
+static uint32_t link_baud = UART_BAUD_RATE;
+static uint32_t link_baud_request = 0;     // Rate to switch to after dispatch (0 = none)
+static bool link_baud_pending = false;     // Switched, but nothing valid received at the new rate yet
+static uint32_t link_rx_ok_ms = 0;         // Last valid packet
+
+// Rates the Pi may ask for (the USB-UART bridge has to support them as well)
+static const uint32_t link_baud_rates[] = {115200, 230400, 460800, 921600, 1500000, 2000000};
+
+// Status mode negotiated by the Pi ($TLM,1 = keyframes + deltas, $TLM,0 = periodic)
+static bool telemetry_delta = false;
+static bool telemetry_keyframe_due = true;
+
+// Open transaction ($TXN): sub-commands are staged here and committed together
+static DeviceState txn_staging;
+static uint8_t txn_remaining = 0;      // Sub-packets still expected (0 = none open)
+static uint32_t txn_start_ms = 0;
+static uint8_t txn_abort_reason = TXN_ABORT_INVALID;  // Set when a sub-packet is refused
+
+// Time of the last UART driver RX event (written from the driver's event task)
+static volatile uint32_t rx_event_us = 0;
+
+// Length of the packet being dispatched (bytes between its framing markers)
+static size_t rx_packet_len = 0;
+
+// Bus address the packet being dispatched was sent to (BUS_ADDR_NONE if untagged)
+static uint8_t rx_address = BUS_ADDR_NONE;
+
+// Replies are dropped while set: answers to a broadcast (or, on a bus, to an
+// untagged packet) would come from every unit at once
+static bool tx_muted = false;
+
+// Reply slot opened by the last $POL (bus members only)
+static bool bus_poll_pending = false;
+static uint32_t bus_poll_us = 0;           // When the poll arrived
+static uint32_t bus_slot_delay_us = 0;     // Poll to this unit's slot
+
+// RX event -> target_servo_angles latency, accumulated per report window
+static uint32_t latency_last_us = 0;
+static uint32_t latency_max_us = 0;
+static uint32_t latency_sum_us = 0;
+static uint16_t latency_count = 0;
+
+// Comm task handle (defined in main.cpp), woken on every RX event
+extern TaskHandle_t g_comm_task_handle;
 
 // External function to notify command received (defined in main.cpp)
 extern void on_command_received();
 
-// External valve state (defined in main.cpp)
-extern ValveState g_valve_state;
+// Wakes the animation task for a glyph or timeline change (defined in main.cpp)
+extern void on_leds_changed();
 
-// External functions for valve state (defined in main.cpp)
-extern bool get_valve_open();
-extern bool get_valve_enabled();
-extern uint32_t get_valve_open_ms();
+// Brackets an NVS write, which stalls every task while the flash cache is
+// off, so the control loop supervision can allow for it (defined in main.cpp)
+extern void on_flash_write(bool active);
 
-/**
- * Parse a servo command packet.
- * Format: $SRV,<s1>,<s2>,<s3>
- */
-static bool parse_servo_packet(const char* buffer, DeviceState* state) {
-    float servo1_target, servo2_target, servo3_target;
+// =============================================================================
+// Transmit
+// =============================================================================
+// Everything the ESP32 sends goes through these. A unit with an address
+// (PARAM_UNIT_ADDRESS) tags its packets so the Pi can tell the units on a
+// bus apart: "$XXX,..." goes out as "$XXX@<n>,...", a binary frame with
+// BIN_TYPE_ADDRESSED and the address byte.
 
-    int parsed = sscanf(buffer + 5, "%f,%f,%f",
-                        &servo1_target, &servo2_target, &servo3_target);
+static_assert(sizeof(BinProfilePayload) + 1 + BIN_FRAME_OVERHEAD <= BIN_FRAME_MAX_SIZE,
+              "Largest TX frame must still fit once addressed");
 
-    if (parsed != 3) {
-        DEBUG_PRINTF("SRV parse error: got %d fields\n", parsed);
-        return false;
+static bool bus_member() {
+    return g_params.unit_address != BUS_ADDR_NONE;
+}
+
+// Send one formatted "$XXX,...\n" line
+static void tx_line(const char* line) {
+    if (tx_muted) return;
+    if (!bus_member()) {
+        PiSerial.print(line);
+        return;
     }
 
-    // Validate ranges
-    servo1_target = constrain(servo1_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    servo2_target = constrain(servo2_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    servo3_target = constrain(servo3_target, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    char tagged[UART_TX_BUFFER_SIZE + 8];
+    snprintf(tagged, sizeof(tagged), "%.4s@%u%s", line, (unsigned)g_params.unit_address, line + 4);
+    PiSerial.print(tagged);
+}
+
+static void tx_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+static void tx_printf(const char* format, ...) {
+    char line[UART_TX_BUFFER_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    tx_line(line);
+}
+
+// Send one binary frame
+static void tx_frame(uint8_t type, const void* payload, uint8_t payload_len) {
+    if (tx_muted) return;
+
+    uint8_t out[BIN_COBS_MAX_SIZE + 2];
+    size_t n = bus_member()
+        ? bin_build_addressed_frame(type, g_params.unit_address, payload, payload_len, out)
+        : bin_build_frame(type, payload, payload_len, out);
+    if (n > 0) {
+        PiSerial.write(out, n);
+    }
+}
 
-    // Update state
-    state->command.target_servo_angles[0] = servo1_target;
-    state->command.target_servo_angles[1] = servo2_target;
-    state->command.target_servo_angles[2] = servo3_target;
+// =============================================================================
+// Command application (shared by ASCII and binary paths)
+// =============================================================================
+
+static void apply_servo(DeviceState* state, float s1, float s2, float s3,
+                        float v1 = 0.0f, float v2 = 0.0f, float v3 = 0.0f) {
+    state->command.target_servo_angles[0] = constrain(s1, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[1] = constrain(s2, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_angles[2] = constrain(s3, g_params.servo_min_angle, g_params.servo_max_angle);
+    state->command.target_servo_velocity[0] = v1;
+    state->command.target_servo_velocity[1] = v2;
+    state->command.target_servo_velocity[2] = v3;
+    state->command.target_timed = false;
     state->command.last_command_time = millis();
     state->command.connected = true;
 
-    DEBUG_PRINTF("SRV: (%.1f,%.1f,%.1f)\n", servo1_target, servo2_target, servo3_target);
-    return true;
+    // Measure how long the targets waited since the packet end was detected
+    uint32_t latency = micros() - rx_event_us;
+    latency_last_us = latency;
+    if (latency > latency_max_us) latency_max_us = latency;
+    latency_sum_us += latency;
+    latency_count++;
 }
 
 /**
- * Parse a light command packet.
- * Format: $LGT,<cmd>
+ * Apply servo targets that carry the Pi's measurement seq and capture age.
+ * The capture time is moved onto the ESP32 clock by walking back from the RX
+ * event: the age the Pi reported when it wrote the packet, plus the time the
+ * packet spent on the wire.
  */
-static bool parse_light_packet(const char* buffer, DeviceState* state) {
-    int light_cmd;
+static void apply_servo_timed(DeviceState* state, float s1, float s2, float s3,
+                              float v1, float v2, float v3,
+                              uint16_t seq, uint16_t age_ms) {
+    // Start + end marker (or delimiters), 10 bit times per byte
+    uint32_t wire_us = (uint32_t)((uint64_t)(rx_packet_len + 2) * 10 * 1000000UL / link_baud);
+    uint32_t since_rx_us = micros() - rx_event_us;
+
+    apply_servo(state, s1, s2, s3, v1, v2, v3);
+    state->command.target_timed = true;
+    state->command.target_seq = seq;
+    state->command.target_capture_ms = millis() - (since_rx_us + wire_us) / 1000 - age_ms;
+}
+
+static void apply_light(DeviceState* state, int light_cmd) {
+    state->command.light_command = (uint8_t)constrain(light_cmd, 0, 2);
+}
+
+static void apply_rgb(DeviceState* state, int mode, int r, int g, int b,
+                      int r2, int g2, int b2, int speed) {
+    state->command.rgb_mode = (uint8_t)constrain(mode, 0, RGB_MODE_COUNT - 1);  // RGB_MODE_*
+    state->command.rgb_r = (uint8_t)constrain(r, 0, 255);
+    state->command.rgb_g = (uint8_t)constrain(g, 0, 255);
+    state->command.rgb_b = (uint8_t)constrain(b, 0, 255);
+    state->command.rgb_r2 = (uint8_t)constrain(r2, 0, 255);
+    state->command.rgb_g2 = (uint8_t)constrain(g2, 0, 255);
+    state->command.rgb_b2 = (uint8_t)constrain(b2, 0, 255);
+    state->command.rgb_gradient_speed = (uint8_t)constrain(speed, 1, 50);
+}
+
+static void apply_matrix(DeviceState* state, int left, int right) {
+    state->command.matrix_left = (uint8_t)left;
+    state->command.matrix_right = (uint8_t)right;
+}
+
+static void apply_npm(DeviceState* state, int mode, char letter, int r, int g, int b,
+                      int r2, int g2, int b2, int speed) {
+    state->command.npm_mode = (uint8_t)constrain(mode, 0, NPM_MODE_COUNT - 1);
+    state->command.npm_letter = letter;
+    state->command.npm_r = (uint8_t)constrain(r, 0, 255);
+    state->command.npm_g = (uint8_t)constrain(g, 0, 255);
+    state->command.npm_b = (uint8_t)constrain(b, 0, 255);
+    state->command.npm_r2 = (uint8_t)constrain(r2, 0, 255);
+    state->command.npm_g2 = (uint8_t)constrain(g2, 0, 255);
+    state->command.npm_b2 = (uint8_t)constrain(b2, 0, 255);
+    state->command.npm_gradient_speed = (uint8_t)constrain(speed, 1, 50);
+}
+
+static void apply_npr(DeviceState* state, int mode, int r, int g, int b,
+                      int r2, int g2, int b2, int speed) {
+    state->command.npr_mode = (uint8_t)constrain(mode, 0, 10);
+    state->command.npr_r = (uint8_t)constrain(r, 0, 255);
+    state->command.npr_g = (uint8_t)constrain(g, 0, 255);
+    state->command.npr_b = (uint8_t)constrain(b, 0, 255);
+    state->command.npr_r2 = (uint8_t)constrain(r2, 0, 255);
+    state->command.npr_g2 = (uint8_t)constrain(g2, 0, 255);
+    state->command.npr_b2 = (uint8_t)constrain(b2, 0, 255);
+    state->command.npr_gradient_speed = (uint8_t)constrain(speed, 1, 50);
+}
 
-    int parsed = sscanf(buffer + 5, "%d", &light_cmd);
+static void apply_valve(DeviceState* state, bool should_open) {
+    state->command.valve_open = should_open;
 
-    if (parsed != 1) {
-        DEBUG_PRINTF("LGT parse error: got %d fields\n", parsed);
+    // control_task hands each new $VLV to the safety module exactly once
+    state->command.valve_seq++;
+}
+
+// Metered pour in tenths of a ml (0 cancels the pour in progress)
+static bool apply_pour(DeviceState* state, int32_t ml_tenths) {
+    if (ml_tenths < 0 || ml_tenths > (int32_t)(DISPENSE_MAX_ML * 10)) {
         return false;
     }
 
-    light_cmd = constrain(light_cmd, 0, 2);
-    state->command.light_command = (uint8_t)light_cmd;
+    state->command.pour_ml = ml_tenths / 10.0f;
+    state->command.pour_seq++;
+    return true;
+}
+
+static void apply_flags(DeviceState* state, uint8_t flags) {
+    state->command.flags = flags;
+    state->command.flags_seq++;
+}
 
-    DEBUG_PRINTF("LGT: %d\n", light_cmd);
+/**
+ * Open this unit's reply slot. A poll to every unit (broadcast, or untagged
+ * on a bus) gives unit n the slot (n - 1) * BUS_SLOT_US after it; a poll
+ * addressed to this unit alone is answered at once.
+ */
+static bool apply_poll(bool keyframe) {
+    if (keyframe) {
+        telemetry_keyframe_due = true;
+    }
+    if (bus_member()) {
+        bus_poll_pending = true;
+        bus_poll_us = rx_event_us;
+        bus_slot_delay_us = (rx_address == g_params.unit_address)
+            ? 0 : (uint32_t)(g_params.unit_address - 1) * BUS_SLOT_US;
+    }
+    return true;
+}
+
+static bool apply_slot_action(int slot, int action) {
+    if (slot < 0 || slot >= SCROLL_SLOT_COUNT) return false;
+
+    bool ok;
+    on_flash_write(true);
+    switch (action) {
+        case SCROLL_SLOT_ACTION_COMMIT: ok = scroll_store_commit(slot); break;
+        case SCROLL_SLOT_ACTION_ERASE:  ok = scroll_store_erase(slot); break;
+        default:                        ok = false; break;
+    }
+    on_flash_write(false);
+    return ok;
+}
+
+// =============================================================================
+// ASCII packet parsers
+// =============================================================================
+// Fields are converted by packet_fields_parse() against each packet's schema
+// (see ascii_schemas below) before a parser runs; parsers only see packets
+// with at least the schema's required field count.
+
+/**
+ * Parse a servo command packet.
+ * Format: $SRV,<s1>,<s2>,<s3>[,<v1>,<v2>,<v3>[,<seq>,<age_ms>]]
+ * Extended format adds feed-forward target velocities in degrees/second;
+ * timestamped format adds the measurement seq and its age at send time
+ */
+static bool parse_servo_packet(const PacketFields* f, DeviceState* state) {
+    if (f->count != 3 && f->count != 6 && f->count != 8) return false;
+
+    // Angles and velocities arrive as tenths; velocities default to 0 (static targets)
+    float s1 = f->value[0] * 0.1f;
+    float s2 = f->value[1] * 0.1f;
+    float s3 = f->value[2] * 0.1f;
+    float v1 = (f->count >= 6) ? f->value[3] * 0.1f : 0.0f;
+    float v2 = (f->count >= 6) ? f->value[4] * 0.1f : 0.0f;
+    float v3 = (f->count >= 6) ? f->value[5] * 0.1f : 0.0f;
+
+    if (f->count == 8) {
+        int32_t age_ms = constrain(f->value[7], 0, 0xFFFF);
+        apply_servo_timed(state, s1, s2, s3, v1, v2, v3,
+                          (uint16_t)f->value[6], (uint16_t)age_ms);
+    } else {
+        apply_servo(state, s1, s2, s3, v1, v2, v3);
+    }
+
+    DEBUG_PRINTF("SRV: (%.1f,%.1f,%.1f)\n", s1, s2, s3);
+    return true;
+}
+
+/**
+ * Parse a light command packet.
+ * Format: $LGT,<cmd>
+ */
+static bool parse_light_packet(const PacketFields* f, DeviceState* state) {
+    apply_light(state, f->value[0]);
+
+    DEBUG_PRINTF("LGT: %d\n", (int)f->value[0]);
     return true;
 }
 
@@ -77,38 +342,18 @@ static bool parse_light_packet(const char* buffer, DeviceState* state) {
  * Format: $RGB,<mode>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]
  * Extended format adds gradient parameters (backwards compatible)
  */
-static bool parse_rgb_packet(const char* buffer, DeviceState* state) {
-    int mode, r, g, b;
-    int r2 = 0, g2 = 0, b2 = 0, speed = 10;  // Defaults for gradient
+static bool parse_rgb_packet(const PacketFields* f, DeviceState* state) {
+    // Defaults for gradient
+    int r2 = (f->count > 4) ? f->value[4] : 0;
+    int g2 = (f->count > 5) ? f->value[5] : 0;
+    int b2 = (f->count > 6) ? f->value[6] : 0;
+    int speed = (f->count > 7) ? f->value[7] : 10;
 
-    int parsed = sscanf(buffer + 5, "%d,%d,%d,%d,%d,%d,%d,%d",
-                        &mode, &r, &g, &b, &r2, &g2, &b2, &speed);
-
-    if (parsed < 4) {
-        DEBUG_PRINTF("RGB parse error: got %d fields\n", parsed);
-        return false;
-    }
-
-    mode = constrain(mode, 0, 2);  // 0=OFF, 1=SOLID, 2=GRADIENT
-    r = constrain(r, 0, 255);
-    g = constrain(g, 0, 255);
-    b = constrain(b, 0, 255);
-    r2 = constrain(r2, 0, 255);
-    g2 = constrain(g2, 0, 255);
-    b2 = constrain(b2, 0, 255);
-    speed = constrain(speed, 1, 50);
-
-    state->command.rgb_mode = (uint8_t)mode;
-    state->command.rgb_r = (uint8_t)r;
-    state->command.rgb_g = (uint8_t)g;
-    state->command.rgb_b = (uint8_t)b;
-    state->command.rgb_r2 = (uint8_t)r2;
-    state->command.rgb_g2 = (uint8_t)g2;
-    state->command.rgb_b2 = (uint8_t)b2;
-    state->command.rgb_gradient_speed = (uint8_t)speed;
+    apply_rgb(state, f->value[0], f->value[1], f->value[2], f->value[3], r2, g2, b2, speed);
 
     DEBUG_PRINTF("RGB: mode=%d, (%d,%d,%d)->(%d,%d,%d) speed=%d\n",
-                 mode, r, g, b, r2, g2, b2, speed);
+                 (int)f->value[0], (int)f->value[1], (int)f->value[2], (int)f->value[3],
+                 r2, g2, b2, speed);
     return true;
 }
 
@@ -116,289 +361,1413 @@ static bool parse_rgb_packet(const char* buffer, DeviceState* state) {
  * Parse a MAX7219 matrix command packet.
  * Format: $MTX,<left>,<right>
  */
-static bool parse_matrix_packet(const char* buffer, DeviceState* state) {
-    int left, right;
+static bool parse_matrix_packet(const PacketFields* f, DeviceState* state) {
+    apply_matrix(state, f->value[0], f->value[1]);
 
-    int parsed = sscanf(buffer + 5, "%d,%d", &left, &right);
+    DEBUG_PRINTF("MTX: (%d,%d)\n", (int)f->value[0], (int)f->value[1]);
+    return true;
+}
 
-    if (parsed != 2) {
-        DEBUG_PRINTF("MTX parse error: got %d fields\n", parsed);
-        return false;
-    }
+/**
+ * Parse a NeoPixel matrix command packet.
+ * Format: $NPM,<mode>,<letter>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]
+ * Extended format adds gradient parameters (backwards compatible)
+ */
+static bool parse_npm_packet(const PacketFields* f, DeviceState* state) {
+    char letter = (char)f->value[1];
+    // Defaults for gradient
+    int r2 = (f->count > 5) ? f->value[5] : 0;
+    int g2 = (f->count > 6) ? f->value[6] : 0;
+    int b2 = (f->count > 7) ? f->value[7] : 0;
+    int speed = (f->count > 8) ? f->value[8] : 10;
 
-    state->command.matrix_left = (uint8_t)left;
-    state->command.matrix_right = (uint8_t)right;
+    apply_npm(state, f->value[0], letter, f->value[2], f->value[3], f->value[4],
+              r2, g2, b2, speed);
 
-    DEBUG_PRINTF("MTX: (%d,%d)\n", left, right);
+    DEBUG_PRINTF("NPM: mode=%d, letter=%c, (%d,%d,%d)->(%d,%d,%d) speed=%d\n",
+                 (int)f->value[0], letter, (int)f->value[2], (int)f->value[3], (int)f->value[4],
+                 r2, g2, b2, speed);
     return true;
 }
 
 /**
- * Parse a NeoPixel matrix command packet.
- * Format: $NPM,<mode>,<letter>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]
+ * Parse a NeoPixel ring command packet.
+ * Format: $NPR,<mode>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]
  * Extended format adds gradient parameters (backwards compatible)
  */
-static bool parse_npm_packet(const char* buffer, DeviceState* state) {
-    int mode;
-    char letter;
-    int r, g, b;
-    int r2 = 0, g2 = 0, b2 = 0, speed = 10;  // Defaults for gradient
+static bool parse_npr_packet(const PacketFields* f, DeviceState* state) {
+    // Defaults for gradient
+    int r2 = (f->count > 4) ? f->value[4] : 0;
+    int g2 = (f->count > 5) ? f->value[5] : 0;
+    int b2 = (f->count > 6) ? f->value[6] : 0;
+    int speed = (f->count > 7) ? f->value[7] : 10;
+
+    apply_npr(state, f->value[0], f->value[1], f->value[2], f->value[3], r2, g2, b2, speed);
+
+    DEBUG_PRINTF("NPR: mode=%d, (%d,%d,%d)->(%d,%d,%d) speed=%d\n",
+                 (int)f->value[0], (int)f->value[1], (int)f->value[2], (int)f->value[3],
+                 r2, g2, b2, speed);
+    return true;
+}
+
+/**
+ * Parse a valve command packet.
+ * Format: $VLV,<open>
+ */
+static bool parse_valve_packet(const PacketFields* f, DeviceState* state) {
+    apply_valve(state, f->value[0] != 0);
+
+    DEBUG_PRINTF("VLV: %d\n", (int)f->value[0]);
+    return true;
+}
+
+/**
+ * Parse a metered pour packet.
+ * Format: $POR,<ml>
+ * The ESP32 closes the valve itself at the target and answers with $PRD
+ * when the pour is over. $POR,0 stops the pour in progress.
+ */
+static bool parse_pour_packet(const PacketFields* f, DeviceState* state) {
+    bool ok = apply_pour(state, f->value[0]);
+
+    DEBUG_PRINTF("POR: %d tenths %s\n", (int)f->value[0], ok ? "ok" : "rejected");
+    return ok;
+}
+
+/**
+ * Parse an emergency stop command packet.
+ * Format: $EST,<enable>
+ */
+static bool parse_estop_packet(const PacketFields* f, DeviceState* state) {
+    state->command.valve_enabled = (f->value[0] != 0);
+
+    DEBUG_PRINTF("EST: %d\n", (int)f->value[0]);
+    return true;
+}
+
+/**
+ * Parse a flags command packet.
+ * Format: $FLG,<flags>
+ */
+static bool parse_flags_packet(const PacketFields* f, DeviceState* state) {
+    apply_flags(state, (uint8_t)f->value[0]);
 
-    int parsed = sscanf(buffer + 5, "%d,%c,%d,%d,%d,%d,%d,%d,%d",
-                        &mode, &letter, &r, &g, &b, &r2, &g2, &b2, &speed);
+    DEBUG_PRINTF("FLG: %d\n", (int)f->value[0]);
+    return true;
+}
 
-    if (parsed < 5) {
-        DEBUG_PRINTF("NPM parse error: got %d fields\n", parsed);
+/**
+ * Parse a scroll text upload chunk.
+ * Format: $TXT,<slot>,<offset>,<text>
+ * Text runs to the end of the packet (commas allowed); offset 0 starts a new upload.
+ */
+static bool parse_text_packet(const PacketFields* f, DeviceState* state) {
+    int slot = f->value[0];
+    int offset = f->value[1];
+    const char* text = f->rest;
+    size_t len = strlen(text);
+
+    if (slot < 0 || offset < 0 || offset > 255 || len > SCROLL_UPLOAD_CHUNK_MAX) {
+        DEBUG_PRINTLN("TXT chunk out of range");
         return false;
     }
 
-    mode = constrain(mode, 0, 10);
-    r = constrain(r, 0, 255);
-    g = constrain(g, 0, 255);
-    b = constrain(b, 0, 255);
-    r2 = constrain(r2, 0, 255);
-    g2 = constrain(g2, 0, 255);
-    b2 = constrain(b2, 0, 255);
-    speed = constrain(speed, 1, 50);
+    if (!scroll_store_write_text(slot, offset, text, len)) {
+        DEBUG_PRINTF("TXT chunk rejected: slot %d offset %d\n", slot, offset);
+        return false;
+    }
 
-    state->command.npm_mode = (uint8_t)mode;
-    state->command.npm_letter = letter;
-    state->command.npm_r = (uint8_t)r;
-    state->command.npm_g = (uint8_t)g;
-    state->command.npm_b = (uint8_t)b;
-    state->command.npm_r2 = (uint8_t)r2;
-    state->command.npm_g2 = (uint8_t)g2;
-    state->command.npm_b2 = (uint8_t)b2;
-    state->command.npm_gradient_speed = (uint8_t)speed;
+    DEBUG_PRINTF("TXT: slot=%d offset=%d len=%d\n", slot, offset, (int)len);
+    return true;
+}
 
-    DEBUG_PRINTF("NPM: mode=%d, letter=%c, (%d,%d,%d)->(%d,%d,%d) speed=%d\n",
-                 mode, letter, r, g, b, r2, g2, b2, speed);
+/**
+ * Parse a scroll frame upload packet.
+ * Format: $FRM,<slot>,<index>,<row0>,<row1>,<row2>,<row3>,<row4>
+ * Rows are 5-bit bitmaps (bit 4 = leftmost column); index 0 starts a new upload.
+ */
+static bool parse_frame_packet(const PacketFields* f, DeviceState* state) {
+    int slot = f->value[0];
+    int index = f->value[1];
+
+    uint8_t frame[5];
+    for (int i = 0; i < 5; i++) {
+        frame[i] = (uint8_t)(f->value[2 + i] & 0x1F);
+    }
+
+    if (slot < 0 || index < 0 || index > 255 || !scroll_store_write_frame(slot, index, frame)) {
+        DEBUG_PRINTF("FRM rejected: slot %d index %d\n", slot, index);
+        return false;
+    }
+
+    DEBUG_PRINTF("FRM: slot=%d index=%d\n", slot, index);
     return true;
 }
 
 /**
- * Parse a NeoPixel ring command packet.
- * Format: $NPR,<mode>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]
- * Extended format adds gradient parameters (backwards compatible)
+ * Parse a user glyph upload packet.
+ * Format: $GLY,<slot>,<row0>,<row1>,<row2>,<row3>,<row4>
+ * Rows are 5-bit bitmaps (bit 4 = leftmost column), shown with NPM_MODE_GLYPH.
  */
-static bool parse_npr_packet(const char* buffer, DeviceState* state) {
-    int mode, r, g, b;
-    int r2 = 0, g2 = 0, b2 = 0, speed = 10;  // Defaults for gradient
+static bool parse_glyph_packet(const PacketFields* f, DeviceState* state) {
+    int slot = f->value[0];
 
-    int parsed = sscanf(buffer + 5, "%d,%d,%d,%d,%d,%d,%d,%d",
-                        &mode, &r, &g, &b, &r2, &g2, &b2, &speed);
+    uint8_t rows[5];
+    for (int i = 0; i < 5; i++) {
+        rows[i] = (uint8_t)(f->value[1 + i] & 0x1F);
+    }
 
-    if (parsed < 4) {
-        DEBUG_PRINTF("NPR parse error: got %d fields\n", parsed);
+    if (slot < 0 || !npm_set_user_glyph(slot, rows)) {
+        DEBUG_PRINTF("GLY rejected: slot %d\n", slot);
         return false;
     }
+    on_leds_changed();
 
-    mode = constrain(mode, 0, 10);
-    r = constrain(r, 0, 255);
-    g = constrain(g, 0, 255);
-    b = constrain(b, 0, 255);
-    r2 = constrain(r2, 0, 255);
-    g2 = constrain(g2, 0, 255);
-    b2 = constrain(b2, 0, 255);
-    speed = constrain(speed, 1, 50);
-
-    state->command.npr_mode = (uint8_t)mode;
-    state->command.npr_r = (uint8_t)r;
-    state->command.npr_g = (uint8_t)g;
-    state->command.npr_b = (uint8_t)b;
-    state->command.npr_r2 = (uint8_t)r2;
-    state->command.npr_g2 = (uint8_t)g2;
-    state->command.npr_b2 = (uint8_t)b2;
-    state->command.npr_gradient_speed = (uint8_t)speed;
+    DEBUG_PRINTF("GLY: slot=%d\n", slot);
+    return true;
+}
 
-    DEBUG_PRINTF("NPR: mode=%d, (%d,%d,%d)->(%d,%d,%d) speed=%d\n",
-                 mode, r, g, b, r2, g2, b2, speed);
+/**
+ * Parse a scroll slot control packet.
+ * Format: $SLT,<slot>,<action>
+ * Action 1 commits the staged upload (and saves it to NVS), 0 erases the slot.
+ */
+static bool parse_slot_packet(const PacketFields* f, DeviceState* state) {
+    int slot = f->value[0];
+    int action = f->value[1];
+
+    if (!apply_slot_action(slot, action)) {
+        DEBUG_PRINTF("SLT rejected: slot %d action %d\n", slot, action);
+        return false;
+    }
+
+    DEBUG_PRINTF("SLT: slot=%d action=%d\n", slot, action);
     return true;
 }
 
 /**
- * Parse a valve command packet.
- * Format: $VLV,<open>
+ * Parse a timeline keyframe packet.
+ * Format: $KEY,<seq>,<index>,<device>,<time_ms>,<mode>,<letter>,<r>,<g>,<b>,<r2>,<g2>,<b2>,<speed>,<easing>
+ * Index 0 starts a new sequence; keyframes must follow in time order.
  */
-static bool parse_valve_packet(const char* buffer, DeviceState* state) {
-    int open;
+static bool parse_key_packet(const PacketFields* f, DeviceState* state) {
+    int seq = f->value[0];
+    int index = f->value[1];
+    int device = f->value[2];
+    int time_ms = f->value[3];
+    int easing = f->value[13];
+
+    if (seq < 0 || index < 0 || index > 255 || device < 0 || easing < 0 ||
+        time_ms < 0 || time_ms > 0xFFFF) {
+        DEBUG_PRINTLN("KEY field out of range");
+        return false;
+    }
 
-    int parsed = sscanf(buffer + 5, "%d", &open);
+    TimelineKey key;
+    key.device = (uint8_t)device;
+    key.time_ms = (uint16_t)time_ms;
+    key.mode = (uint8_t)constrain(f->value[4], 0, 255);   // *_set_mode maps unknown modes
+    key.letter = (char)f->value[5];
+    key.r = (uint8_t)constrain(f->value[6], 0, 255);
+    key.g = (uint8_t)constrain(f->value[7], 0, 255);
+    key.b = (uint8_t)constrain(f->value[8], 0, 255);
+    key.r2 = (uint8_t)constrain(f->value[9], 0, 255);
+    key.g2 = (uint8_t)constrain(f->value[10], 0, 255);
+    key.b2 = (uint8_t)constrain(f->value[11], 0, 255);
+    key.speed = (uint8_t)constrain(f->value[12], 1, 50);
+    key.easing = (uint8_t)easing;
+
+    if (!timeline_write_key(seq, index, &key)) {
+        DEBUG_PRINTF("KEY rejected: seq %d index %d\n", seq, index);
+        return false;
+    }
 
-    if (parsed != 1) {
-        DEBUG_PRINTF("VLV parse error: got %d fields\n", parsed);
+    DEBUG_PRINTF("KEY: seq=%d index=%d dev=%d t=%d mode=%d\n",
+                 seq, index, device, time_ms, (int)key.mode);
+    return true;
+}
+
+/**
+ * Parse a timeline trigger packet.
+ * Format: $SEQ,<seq>,<action>
+ * Action 0 stops, 1 plays once, 2 loops.
+ */
+static bool parse_seq_packet(const PacketFields* f, DeviceState* state) {
+    int seq = f->value[0];
+    int action = f->value[1];
+
+    if (seq < 0 || action < 0 || !timeline_trigger(seq, action)) {
+        DEBUG_PRINTF("SEQ rejected: seq %d action %d\n", seq, action);
         return false;
     }
+    on_leds_changed();
 
-    bool should_open = (open != 0);
-    state->command.valve_open = should_open;
+    DEBUG_PRINTF("SEQ: seq=%d action=%d\n", seq, action);
+    return true;
+}
 
-    // Set valve command in safety module (this is the only place it should be set)
-    valve_safety_set_command(&g_valve_state, should_open);
+/**
+ * Parse a link mode packet.
+ * Format: $BIN,<enable>
+ * Switches status telemetry between ASCII and binary frames.
+ */
+static bool parse_binary_mode_packet(const PacketFields* f, DeviceState* state) {
+    status_binary = (f->value[0] != 0);
+    telemetry_keyframe_due = true;  // Resend everything in the new framing
 
-    DEBUG_PRINTF("VLV: %d\n", open);
+    DEBUG_PRINTF("BIN: %d\n", (int)f->value[0]);
     return true;
 }
 
 /**
- * Parse an emergency stop command packet.
- * Format: $EST,<enable>
+ * Parse a telemetry mode packet.
+ * Format: $TLM,<mode>
+ * 0 = full status every status period, 1 = keyframes + change-only deltas.
  */
-static bool parse_estop_packet(const char* buffer, DeviceState* state) {
-    int enable;
+static bool parse_telemetry_mode_packet(const PacketFields* f, DeviceState* state) {
+    telemetry_delta = (f->value[0] != 0);
+    telemetry_keyframe_due = true;
+
+    DEBUG_PRINTF("TLM: %d\n", (int)f->value[0]);
+    return true;
+}
 
-    int parsed = sscanf(buffer + 5, "%d", &enable);
+/**
+ * Parse a link rate packet.
+ * Format: $BDR,<baud>
+ * Answers $BDR,<baud> at the current rate and switches right after. An
+ * unsupported rate is answered with the current one and changes nothing.
+ */
+static bool parse_baud_packet(const PacketFields* f, DeviceState* state) {
+    uint32_t rate = (f->value[0] > 0) ? (uint32_t)f->value[0] : 0;
+    bool supported = false;
+    for (size_t i = 0; i < sizeof(link_baud_rates) / sizeof(link_baud_rates[0]); i++) {
+        if (link_baud_rates[i] == rate) supported = true;
+    }
 
-    if (parsed != 1) {
-        DEBUG_PRINTF("EST parse error: got %d fields\n", parsed);
+    if (!supported) {
+        tx_printf("$BDR,%u\n", (unsigned)link_baud);
+        DEBUG_PRINTF("BDR rejected: %d\n", (int)f->value[0]);
         return false;
     }
 
-    state->command.valve_enabled = (enable != 0);
+    tx_printf("$BDR,%u\n", (unsigned)rate);
+    if (rate != link_baud) {
+        link_baud_request = rate;
+    }
+    return true;
+}
 
-    DEBUG_PRINTF("EST: %d\n", enable);
+/**
+ * Parse a ping packet.
+ * Format: $PNG,<token>
+ * Echoed straight back so the Pi can time the round trip.
+ */
+static bool parse_ping_packet(const PacketFields* f, DeviceState* state) {
+    tx_printf("$PNG,%d\n", (int)f->value[0]);
     return true;
 }
 
+// Report one parameter as $PRM,<id>,<value>,<flags>, value in its own unit
+static void send_param(uint8_t id) {
+    int32_t tenths;
+    if (param_get(id, &tenths)) {
+        tx_printf("$PRM,%u,%.1f,%u\n", (unsigned)id, tenths / 10.0f, (unsigned)param_flags(id));
+    }
+}
+
 /**
- * Parse a flags command packet.
- * Format: $FLG,<flags>
+ * Parse a bus poll.
+ * Format: $POL,<keyframe>
+ * Every polled unit sends its status in its own reply slot (see
+ * uart_tx_slot_open); keyframe=1 asks for a full status instead of a delta.
+ * Standalone, keyframe=1 only forces the next status to be a keyframe.
  */
-static bool parse_flags_packet(const char* buffer, DeviceState* state) {
-    int flags;
+static bool parse_poll_packet(const PacketFields* f, DeviceState* state) {
+    return apply_poll(f->value[0] != 0);
+}
 
-    int parsed = sscanf(buffer + 5, "%d", &flags);
+/**
+ * Parse a parameter packet.
+ * Format: $PRM,<id>[,<value>]
+ * Without a value the parameter is read back; with one it is set (in g_params
+ * only, see $PSV). Either way the reply is $PRM,<id>,<value>,<flags> with the
+ * value now in effect, so a refused set answers the unchanged value. Id -1
+ * reads every parameter, followed by $PRM,-1,<schema>,<count>.
+ */
+static bool parse_param_packet(const PacketFields* f, DeviceState* state) {
+    int id = f->value[0];
 
-    if (parsed != 1) {
-        DEBUG_PRINTF("FLG parse error: got %d fields\n", parsed);
+    if (id == -1 && f->count == 1) {
+        for (uint8_t i = 0; i < PARAM_COUNT; i++) {
+            send_param(i);
+        }
+        tx_printf("$PRM,-1,%d,%d\n", PARAM_SCHEMA_VERSION, PARAM_COUNT);
+        return true;
+    }
+
+    if (id < 0 || id >= PARAM_COUNT) {
+        DEBUG_PRINTF("PRM rejected: id %d\n", id);
         return false;
     }
 
-    state->command.flags = (uint8_t)flags;
+    bool ok = true;
+    if (f->count >= 2) {
+        ok = param_set((uint8_t)id, f->value[1]);
+        DEBUG_PRINTF("PRM: id=%d value=%d tenths %s\n", id, (int)f->value[1], ok ? "set" : "rejected");
+    }
+    send_param((uint8_t)id);
+    return ok;
+}
+
+/**
+ * Parse a parameter store packet.
+ * Format: $PSV,<action>
+ * Action 1 saves every parameter to NVS, 0 restores the defaults and erases
+ * the saved copy. Answers $PSV,<action>,<ok>.
+ */
+static bool parse_param_save_packet(const PacketFields* f, DeviceState* state) {
+    int action = f->value[0];
+    bool ok;
+
+    on_flash_write(true);
+    switch (action) {
+        case 1:  ok = param_store_save(); break;
+        case 0:  ok = param_store_reset(); break;
+        default: ok = false; break;
+    }
+    on_flash_write(false);
+
+    tx_printf("$PSV,%d,%d\n", action, ok ? 1 : 0);
+    return ok;
+}
+
+// Answer a $TRC action with the buffer state
+static void send_trace_info(int action) {
+    TraceInfo info;
+    trace_get_info(&info);
+    tx_printf("$TRC,%d,%u,%u,%u\n", action, (unsigned)info.bytes,
+              (unsigned)info.dropped, (unsigned)micros());
+}
+
+static_assert(TRACE_DUMP_LINE_BYTES * 2 + 18 <= UART_TX_BUFFER_SIZE,
+              "$TRD line does not fit UART_TX_BUFFER_SIZE");
+
+/**
+ * Parse a trace packet.
+ * Format: $TRC,<action>[,<offset>]
+ * 1 pauses recording, 0 resumes it, 3 clears the buffer and resumes; each
+ * answers $TRC,<action>,<bytes>,<dropped>,<now_us>. 2 sends one page of the
+ * record stream from <offset> as $TRD,<offset>,<hex> lines
+ * (TRACE_DUMP_PAGE_LINES lines of TRACE_DUMP_LINE_BYTES), so the Pi pages
+ * through a paused buffer without holding the comm task for the whole dump.
+ */
+static bool parse_trace_packet(const PacketFields* f, DeviceState* state) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    int action = f->value[0];
+
+    switch (action) {
+        case 0:
+        case 1:
+            trace_set_paused(action == 1);
+            break;
+        case 2: {
+            if (f->count < 2 || f->value[1] < 0) return false;
+            uint32_t offset = (uint32_t)f->value[1];
+            for (int line_no = 0; line_no < TRACE_DUMP_PAGE_LINES; line_no++) {
+                uint8_t bytes[TRACE_DUMP_LINE_BYTES];
+                size_t n = trace_read(offset, bytes, sizeof(bytes));
+                if (n == 0) break;
+
+                char line[UART_TX_BUFFER_SIZE];
+                int len = snprintf(line, sizeof(line), "$TRD,%u,", (unsigned)offset);
+                for (size_t i = 0; i < n; i++) {
+                    line[len++] = HEX_DIGITS[bytes[i] >> 4];
+                    line[len++] = HEX_DIGITS[bytes[i] & 0x0F];
+                }
+                line[len++] = '\n';
+                line[len] = '\0';
+                tx_line(line);
+                offset += n;
+            }
+            return true;
+        }
+        case 3:
+            trace_clear();
+            trace_set_paused(false);
+            break;
+        default:
+            return false;
+    }
+
+    send_trace_info(action);
+    return true;
+}
+
+/**
+ * Tell the Pi an open transaction was dropped and nothing in it applied.
+ * Format: $TXA,<reason> (TXN_ABORT_*)
+ */
+static void send_txn_abort(uint8_t reason) {
+    if (status_binary) {
+        BinBytePayload p;
+        p.value = reason;
+        tx_frame(BIN_TYPE_TXA, &p, sizeof(p));
+    } else {
+        tx_printf("$TXA,%u\n", (unsigned)reason);
+    }
+}
 
-    DEBUG_PRINTF("FLG: %d\n", flags);
+/**
+ * Open a transaction: the next `count` packets are applied to a staged copy
+ * of the commands and published together, or not at all.
+ */
+static bool begin_transaction(int count, DeviceState* state) {
+    // A nested TXN never gets here: it is not staged, so the open
+    // transaction is aborted with TXN_ABORT_UNSTAGED first
+    if (count < 1 || count > TXN_MAX_COMMANDS) return false;
+
+    txn_staging.command = state->command;
+    txn_remaining = (uint8_t)count;
+    txn_start_ms = millis();
+    txn_abort_reason = TXN_ABORT_INVALID;
     return true;
 }
 
+/**
+ * Parse a transaction header.
+ * Format: $TXN,<count>
+ */
+static bool parse_transaction_packet(const PacketFields* f, DeviceState* state) {
+    DEBUG_PRINTF("TXN: %d\n", (int)f->value[0]);
+    return begin_transaction(f->value[0], state);
+}
+
+typedef bool (*AsciiParser)(const PacketFields* fields, DeviceState* state);
+
+typedef struct {
+    char tag[4];                // Packet name between '$' and ','
+    const char* schema;         // Field kinds (see packet_fields.h)
+    uint8_t min_fields;         // Required fields; the rest of the schema is optional
+    bool staged;                // Only writes state->command, so a $TXN can hold it
+    AsciiParser parser;
+} AsciiSchema;
+
+// Every ASCII packet the ESP32 accepts, with its field layout
+static const AsciiSchema ascii_schemas[] = {
+    {"SRV", "ttttttii",       3,  true,  parse_servo_packet},
+    {"LGT", "i",              1,  true,  parse_light_packet},
+    {"RGB", "iiiiiiii",       4,  true,  parse_rgb_packet},
+    {"MTX", "ii",             2,  true,  parse_matrix_packet},
+    {"NPM", "iciiiiiii",      5,  true,  parse_npm_packet},
+    {"NPR", "iiiiiiii",       4,  true,  parse_npr_packet},
+    {"VLV", "i",              1,  true,  parse_valve_packet},
+    {"POR", "t",              1,  true,  parse_pour_packet},
+    {"EST", "i",              1,  true,  parse_estop_packet},
+    {"FLG", "i",              1,  true,  parse_flags_packet},
+    {"BIN", "i",              1,  false, parse_binary_mode_packet},
+    {"TLM", "i",              1,  false, parse_telemetry_mode_packet},
+    {"TXN", "i",              1,  false, parse_transaction_packet},
+    {"TXT", "iis",            3,  false, parse_text_packet},
+    {"FRM", "iiiiiii",        7,  false, parse_frame_packet},
+    {"SLT", "ii",             2,  false, parse_slot_packet},
+    {"GLY", "iiiiii",         6,  false, parse_glyph_packet},
+    {"KEY", "iiiiiciiiiiiii", 14, false, parse_key_packet},
+    {"SEQ", "ii",             2,  false, parse_seq_packet},
+    {"BDR", "i",              1,  false, parse_baud_packet},
+    {"PNG", "i",              1,  false, parse_ping_packet},
+    {"PRM", "it",             1,  false, parse_param_packet},
+    {"PSV", "i",              1,  false, parse_param_save_packet},
+    {"TRC", "ii",             1,  false, parse_trace_packet},
+    {"POL", "i",              1,  false, parse_poll_packet},
+};
+
 /**
  * Parse any incoming packet based on its header.
+ *
+ * @param buffer Null-terminated packet
+ * @param tag_len Length of the "@<n>" address after the name (0 if untagged)
  */
-static bool parse_packet(const char* buffer, DeviceState* state) {
-    if (strncmp(buffer, "$SRV,", 5) == 0) {
-        return parse_servo_packet(buffer, state);
+static bool parse_packet(const char* buffer, size_t tag_len, DeviceState* state) {
+    for (size_t i = 0; i < sizeof(ascii_schemas) / sizeof(ascii_schemas[0]); i++) {
+        const AsciiSchema* s = &ascii_schemas[i];
+        if (buffer[1] != s->tag[0] || buffer[2] != s->tag[1] ||
+            buffer[3] != s->tag[2] || buffer[4 + tag_len] != ',') {
+            continue;
+        }
+        if (txn_remaining > 0 && !s->staged) {
+            DEBUG_PRINTF("%s cannot be staged in a TXN\n", s->tag);
+            txn_abort_reason = TXN_ABORT_UNSTAGED;
+            return false;
+        }
+
+        PacketFields fields;
+        if (packet_fields_parse(buffer + 5 + tag_len, s->schema, &fields) < s->min_fields) {
+            DEBUG_PRINTF("%s parse error: got %d fields\n", s->tag, fields.count);
+            return false;
+        }
+        return s->parser(&fields, state);
     }
-    else if (strncmp(buffer, "$LGT,", 5) == 0) {
-        return parse_light_packet(buffer, state);
+
+    DEBUG_PRINTF("Unknown packet type: %.5s\n", buffer);
+    return false;
+}
+
+// =============================================================================
+// Binary frame handlers
+// =============================================================================
+// Payload length is checked against the jump table before a handler runs,
+// so handlers can copy their struct straight out of the frame.
+
+static bool handle_bin_servo(const uint8_t* payload, DeviceState* state) {
+    BinServoPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_servo(state, p.s1 * 0.1f, p.s2 * 0.1f, p.s3 * 0.1f);
+    return true;
+}
+
+static bool handle_bin_servo_velocity(const uint8_t* payload, DeviceState* state) {
+    BinServoVelocityPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_servo(state, p.s1 * 0.1f, p.s2 * 0.1f, p.s3 * 0.1f,
+                p.v1 * 0.1f, p.v2 * 0.1f, p.v3 * 0.1f);
+    return true;
+}
+
+static bool handle_bin_servo_timed(const uint8_t* payload, DeviceState* state) {
+    BinServoTimedPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_servo_timed(state, p.s1 * 0.1f, p.s2 * 0.1f, p.s3 * 0.1f,
+                      p.v1 * 0.1f, p.v2 * 0.1f, p.v3 * 0.1f, p.seq, p.age_ms);
+    return true;
+}
+
+static bool handle_bin_light(const uint8_t* payload, DeviceState* state) {
+    apply_light(state, payload[0]);
+    return true;
+}
+
+static bool handle_bin_rgb(const uint8_t* payload, DeviceState* state) {
+    BinRgbPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_rgb(state, p.mode, p.r, p.g, p.b, p.r2, p.g2, p.b2, p.speed);
+    return true;
+}
+
+static bool handle_bin_matrix(const uint8_t* payload, DeviceState* state) {
+    BinMatrixPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_matrix(state, p.left, p.right);
+    return true;
+}
+
+static bool handle_bin_npm(const uint8_t* payload, DeviceState* state) {
+    BinNpmPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_npm(state, p.mode, p.letter, p.r, p.g, p.b, p.r2, p.g2, p.b2, p.speed);
+    return true;
+}
+
+static bool handle_bin_npr(const uint8_t* payload, DeviceState* state) {
+    BinNprPayload p;
+    memcpy(&p, payload, sizeof(p));
+    apply_npr(state, p.mode, p.r, p.g, p.b, p.r2, p.g2, p.b2, p.speed);
+    return true;
+}
+
+static bool handle_bin_valve(const uint8_t* payload, DeviceState* state) {
+    apply_valve(state, payload[0] != 0);
+    return true;
+}
+
+static bool handle_bin_pour(const uint8_t* payload, DeviceState* state) {
+    BinPourPayload p;
+    memcpy(&p, payload, sizeof(p));
+    return apply_pour(state, p.ml);
+}
+
+static bool handle_bin_estop(const uint8_t* payload, DeviceState* state) {
+    state->command.valve_enabled = (payload[0] != 0);
+    return true;
+}
+
+static bool handle_bin_flags(const uint8_t* payload, DeviceState* state) {
+    apply_flags(state, payload[0]);
+    return true;
+}
+
+static bool handle_bin_mode(const uint8_t* payload, DeviceState* state) {
+    status_binary = (payload[0] != 0);
+    telemetry_keyframe_due = true;
+    return true;
+}
+
+static bool handle_bin_telemetry(const uint8_t* payload, DeviceState* state) {
+    telemetry_delta = (payload[0] != 0);
+    telemetry_keyframe_due = true;
+    return true;
+}
+
+static bool handle_bin_transaction(const uint8_t* payload, DeviceState* state) {
+    return begin_transaction(payload[0], state);
+}
+
+static bool handle_bin_text(const uint8_t* payload, DeviceState* state) {
+    BinTextPayload p;
+    memcpy(&p, payload, sizeof(p));
+    if (p.len > SCROLL_UPLOAD_CHUNK_MAX) return false;
+    return scroll_store_write_text(p.slot, p.offset, p.text, p.len);
+}
+
+static bool handle_bin_frame(const uint8_t* payload, DeviceState* state) {
+    BinFramePayload p;
+    memcpy(&p, payload, sizeof(p));
+    for (int i = 0; i < 5; i++) {
+        p.rows[i] &= 0x1F;
     }
-    else if (strncmp(buffer, "$RGB,", 5) == 0) {
-        return parse_rgb_packet(buffer, state);
+    return scroll_store_write_frame(p.slot, p.index, p.rows);
+}
+
+static bool handle_bin_glyph(const uint8_t* payload, DeviceState* state) {
+    BinGlyphPayload p;
+    memcpy(&p, payload, sizeof(p));
+    for (int i = 0; i < 5; i++) {
+        p.rows[i] &= 0x1F;
     }
-    else if (strncmp(buffer, "$MTX,", 5) == 0) {
-        return parse_matrix_packet(buffer, state);
+    if (!npm_set_user_glyph(p.slot, p.rows)) return false;
+    on_leds_changed();
+    return true;
+}
+
+static bool handle_bin_slot(const uint8_t* payload, DeviceState* state) {
+    BinSlotPayload p;
+    memcpy(&p, payload, sizeof(p));
+    return apply_slot_action(p.slot, p.action);
+}
+
+static bool handle_bin_key(const uint8_t* payload, DeviceState* state) {
+    BinKeyPayload p;
+    memcpy(&p, payload, sizeof(p));
+    p.key.speed = (uint8_t)constrain(p.key.speed, 1, 50);
+    return timeline_write_key(p.seq, p.index, &p.key);
+}
+
+static bool handle_bin_seq(const uint8_t* payload, DeviceState* state) {
+    BinSeqPayload p;
+    memcpy(&p, payload, sizeof(p));
+    if (!timeline_trigger(p.seq, p.action)) return false;
+    on_leds_changed();
+    return true;
+}
+
+static bool handle_bin_ping(const uint8_t* payload, DeviceState* state) {
+    tx_frame(BIN_TYPE_ECHO, payload, sizeof(BinPingPayload));
+    return true;
+}
+
+static bool handle_bin_poll(const uint8_t* payload, DeviceState* state) {
+    return apply_poll(payload[0] != 0);
+}
+
+typedef bool (*BinHandler)(const uint8_t* payload, DeviceState* state);
+
+typedef struct {
+    uint8_t payload_len;
+    bool staged;                // Only writes state->command, so a TXN can hold it
+    BinHandler handler;
+} BinDispatchEntry;
+
+// Indexed by frame type; unused slots have a null handler
+static const BinDispatchEntry bin_dispatch[BIN_TYPE_COUNT] = {
+    /* 0x00         */ {0,                         false, nullptr},
+    /* BIN_TYPE_SRV */ {sizeof(BinServoPayload),   true,  handle_bin_servo},
+    /* BIN_TYPE_LGT */ {sizeof(BinLightPayload),   true,  handle_bin_light},
+    /* BIN_TYPE_RGB */ {sizeof(BinRgbPayload),     true,  handle_bin_rgb},
+    /* BIN_TYPE_MTX */ {sizeof(BinMatrixPayload),  true,  handle_bin_matrix},
+    /* BIN_TYPE_NPM */ {sizeof(BinNpmPayload),     true,  handle_bin_npm},
+    /* BIN_TYPE_NPR */ {sizeof(BinNprPayload),     true,  handle_bin_npr},
+    /* BIN_TYPE_VLV */ {sizeof(BinBytePayload),    true,  handle_bin_valve},
+    /* BIN_TYPE_EST */ {sizeof(BinBytePayload),    true,  handle_bin_estop},
+    /* BIN_TYPE_FLG */ {sizeof(BinBytePayload),    true,  handle_bin_flags},
+    /* BIN_TYPE_MODE*/ {sizeof(BinBytePayload),    false, handle_bin_mode},
+    /* BIN_TYPE_TXT */ {sizeof(BinTextPayload),    false, handle_bin_text},
+    /* BIN_TYPE_FRM */ {sizeof(BinFramePayload),   false, handle_bin_frame},
+    /* BIN_TYPE_SLT */ {sizeof(BinSlotPayload),    false, handle_bin_slot},
+    /* BIN_TYPE_KEY */ {sizeof(BinKeyPayload),     false, handle_bin_key},
+    /* BIN_TYPE_SEQ */ {sizeof(BinSeqPayload),     false, handle_bin_seq},
+    /* BIN_TYPE_SRVV*/ {sizeof(BinServoVelocityPayload), true,  handle_bin_servo_velocity},
+    /* BIN_TYPE_SRVT*/ {sizeof(BinServoTimedPayload),    true,  handle_bin_servo_timed},
+    /* BIN_TYPE_TLM */ {sizeof(BinBytePayload),    false, handle_bin_telemetry},
+    /* BIN_TYPE_TXN */ {sizeof(BinBytePayload),    false, handle_bin_transaction},
+    /* BIN_TYPE_PNG */ {sizeof(BinPingPayload),    false, handle_bin_ping},
+    /* BIN_TYPE_GLY */ {sizeof(BinGlyphPayload),   false, handle_bin_glyph},
+    /* BIN_TYPE_POR */ {sizeof(BinPourPayload),    true,  handle_bin_pour},
+    /* BIN_TYPE_POL */ {sizeof(BinBytePayload),    false, handle_bin_poll},
+};
+
+/**
+ * Dispatch one decoded frame (CRC already checked by bin_frame_address).
+ * An addressed frame's payload starts after its address byte.
+ */
+static bool parse_binary_frame(const uint8_t* frame, size_t frame_len, DeviceState* state) {
+    if (frame_len == 0) {
+        DEBUG_PRINTLN("BIN frame rejected (encoding/CRC)");
+        return false;
     }
-    else if (strncmp(buffer, "$NPM,", 5) == 0) {
-        return parse_npm_packet(buffer, state);
+
+    uint8_t type = frame[0] & ~BIN_TYPE_ADDRESSED;
+    uint8_t skip = (frame[0] & BIN_TYPE_ADDRESSED) ? 1 : 0;
+    if (type >= BIN_TYPE_COUNT || bin_dispatch[type].handler == nullptr ||
+        frame[1] < skip || bin_dispatch[type].payload_len != frame[1] - skip) {
+        DEBUG_PRINTF("BIN frame rejected (type 0x%02X, len %d)\n", frame[0], frame[1]);
+        return false;
     }
-    else if (strncmp(buffer, "$NPR,", 5) == 0) {
-        return parse_npr_packet(buffer, state);
+    if (txn_remaining > 0 && !bin_dispatch[type].staged) {
+        DEBUG_PRINTF("BIN type 0x%02X cannot be staged in a TXN\n", type);
+        txn_abort_reason = TXN_ABORT_UNSTAGED;
+        return false;
     }
-    else if (strncmp(buffer, "$VLV,", 5) == 0) {
-        return parse_valve_packet(buffer, state);
+
+    return bin_dispatch[type].handler(&frame[2 + skip], state);
+}
+
+/**
+ * Decode the COBS frame in rx_buffer and read its bus address.
+ *
+ * @param frame Decoded frame (BIN_FRAME_MAX_SIZE bytes)
+ * @param frame_len Set to the frame length, 0 if the encoding or CRC is bad
+ * @return Address, BUS_ADDR_NONE if untagged or bad (left to the parser to reject)
+ */
+static uint8_t bin_frame_address(uint8_t* frame, size_t* frame_len) {
+    size_t len = bin_cobs_decode((const uint8_t*)rx_buffer, rx_index, frame, BIN_FRAME_MAX_SIZE);
+    if (len == 0 || !bin_frame_valid(frame, len)) {
+        *frame_len = 0;
+        return BUS_ADDR_NONE;
     }
-    else if (strncmp(buffer, "$EST,", 5) == 0) {
-        return parse_estop_packet(buffer, state);
+
+    *frame_len = len;
+    return (frame[0] & BIN_TYPE_ADDRESSED) && frame[1] >= 1 ? frame[2] : BUS_ADDR_NONE;
+}
+
+/**
+ * Read the "@<n>" bus address after the ASCII packet name in rx_buffer.
+ *
+ * @param tag_len Set to the length of "@<n>", 0 if untagged or malformed
+ * @return Address, BUS_ADDR_NONE if untagged or malformed (left to the parser to reject)
+ */
+static uint8_t ascii_address(size_t* tag_len) {
+    *tag_len = 0;
+    if (rx_index < 5 || rx_buffer[4] != BUS_ADDRESS_MARKER) {
+        return BUS_ADDR_NONE;
     }
-    else if (strncmp(buffer, "$FLG,", 5) == 0) {
-        return parse_flags_packet(buffer, state);
+
+    unsigned address = 0;
+    size_t i = 5;
+    while (i < rx_index && i < 8 && rx_buffer[i] >= '0' && rx_buffer[i] <= '9') {
+        address = address * 10 + (rx_buffer[i] - '0');
+        i++;
+    }
+    if (i == 5 || rx_buffer[i] != ',' || address == BUS_ADDR_NONE || address > BUS_ADDR_BROADCAST) {
+        return BUS_ADDR_NONE;
     }
 
-    DEBUG_PRINTF("Unknown packet type: %.5s\n", buffer);
-    return false;
+    *tag_len = i - 4;
+    return (uint8_t)address;
+}
+
+/**
+ * UART driver RX callback.
+ * Runs in the Arduino UART event task when bytes arrive or the line goes
+ * idle after a packet, and wakes the comm task instead of waiting for a poll.
+ */
+static void uart_rx_event() {
+    rx_event_us = micros();
+    if (g_comm_task_handle != NULL) {
+        xTaskNotifyGive(g_comm_task_handle);
+    }
+}
+
+/**
+ * Move the link to a new rate. Whatever is still queued for TX goes out at
+ * the old rate first; a packet cut in half by the switch is discarded.
+ */
+static void set_link_baud(uint32_t rate) {
+    PiSerial.flush();
+    PiSerial.updateBaudRate(rate);
+    link_baud = rate;
+    link_baud_pending = (rate != UART_BAUD_RATE);
+    link_rx_ok_ms = millis();
+    rx_framing = RX_HUNT;
+
+    DEBUG_PRINTF("Link baud: %u\n", (unsigned)rate);
 }
 
 void uart_init() {
     // USB Serial is already initialized in setup()
     // Clear buffers
     rx_index = 0;
+    rx_framing = RX_HUNT;
+    status_binary = false;
+    telemetry_delta = false;
+    telemetry_keyframe_due = true;
+    txn_remaining = 0;
+    bus_poll_pending = false;
+    link_baud = UART_BAUD_RATE;
+    link_baud_request = 0;
+    link_baud_pending = false;
     memset(rx_buffer, 0, sizeof(rx_buffer));
+
+    // Event-driven RX: the driver fires on FIFO threshold and on the idle
+    // timeout that follows the end of each packet burst
+    PiSerial.setRxTimeout(UART_RX_TIMEOUT_SYMBOLS);
+    PiSerial.onReceive(uart_rx_event, false);
+}
+
+/**
+ * Handle a completed packet of either framing.
+ * Packets addressed to another unit are dropped unread; broadcasts are
+ * applied without a reply.
+ * Inside a transaction packets land in the staging copy; the last one
+ * commits it into state->command, and any failure - including a packet that
+ * is not command state and so cannot be staged - discards it whole and is
+ * answered with $TXA.
+ */
+static void dispatch_packet(bool binary, DeviceState* state) {
+    bool ok;
+    bool in_txn = (txn_remaining > 0);
+    DeviceState* target = in_txn ? &txn_staging : state;
+    uint8_t frame[BIN_FRAME_MAX_SIZE];
+    size_t frame_len = 0;
+    size_t tag_len = 0;
+
+    rx_packet_len = rx_index;
+    if (!binary) {
+        rx_buffer[rx_index] = '\0';  // Null terminate
+    }
+    rx_address = binary ? bin_frame_address(frame, &frame_len) : ascii_address(&tag_len);
+
+    // Traffic for other units on the bus is none of this unit's business:
+    // not parsed, traced, counted in a transaction or taken as a heartbeat
+    if (rx_address != BUS_ADDR_NONE && rx_address != BUS_ADDR_BROADCAST &&
+        rx_address != g_params.unit_address) {
+        return;
+    }
+    bool muted = (rx_address == BUS_ADDR_BROADCAST) ||
+                 (bus_member() && rx_address == BUS_ADDR_NONE);
+    tx_muted = muted;
+
+    if (binary) {
+        ok = parse_binary_frame(frame, frame_len, target);
+    } else {
+        DEBUG_PRINTF("Packet received: %s\n", rx_buffer);
+        ok = parse_packet(rx_buffer, tag_len, target);
+    }
+    tx_muted = false;
+    trace_rx(binary, ok, rx_buffer, rx_index);
+
+    if (in_txn) {
+        if (!ok || txn_remaining == 0) {
+            // Bad or unstageable sub-packet (a nested $TXN is one): drop
+            // everything staged so far
+            txn_remaining = 0;
+            tx_muted = muted;
+            send_txn_abort(txn_abort_reason);
+            tx_muted = false;
+            DEBUG_PRINTF("TXN aborted (%u)\n", (unsigned)txn_abort_reason);
+            return;
+        }
+        if (--txn_remaining > 0) {
+            return;
+        }
+        state->command = txn_staging.command;
+        DEBUG_PRINTLN("TXN committed");
+    } else if (ok && txn_remaining > 0) {
+        // Header accepted - wait for its sub-packets before waking anyone
+        return;
+    }
+
+    if (ok) {
+        link_rx_ok_ms = millis();
+        link_baud_pending = false;
+
+        // Notify that we received a valid command
+        on_command_received();
+        DEBUG_PRINTLN("Packet parsed OK");
+    } else {
+        DEBUG_PRINTLN("Packet parse FAILED");
+    }
 }
 
 void uart_receive(DeviceState* state) {
+    // Fall back to ASCII status when the Pi goes away, so a restarted
+    // host (or a bench terminal) always starts from the readable format
+    if (!state->command.connected) {
+        status_binary = false;
+        telemetry_delta = false;
+    }
+
+    // A rate the Pi never confirmed, or a link gone silent, drops back to the
+    // boot rate so a restarted Pi always finds the ESP32 where it starts
+    if (link_baud != UART_BAUD_RATE) {
+        uint32_t quiet_ms = millis() - link_rx_ok_ms;
+        if ((link_baud_pending && quiet_ms >= UART_BAUD_CONFIRM_MS) || quiet_ms >= UART_BAUD_IDLE_MS) {
+            set_link_baud(UART_BAUD_RATE);
+        }
+    }
+
+    // A transaction whose sub-packets never arrived is dropped, not half-applied
+    if (txn_remaining > 0 && millis() - txn_start_ms >= TXN_TIMEOUT_MS) {
+        txn_remaining = 0;
+        // On a bus this is outside any reply slot: the Pi sees the missing
+        // commands in the next status instead
+        if (!bus_member()) {
+            send_txn_abort(TXN_ABORT_TIMEOUT);
+        }
+        DEBUG_PRINTLN("TXN timed out");
+    }
+
     while (PiSerial.available() > 0) {
         char c = PiSerial.read();
 
-        // Check for packet start
-        if (c == PACKET_START_MARKER) {
-            // Start new packet
-            rx_index = 0;
-            rx_buffer[rx_index++] = c;
-        }
-        // Check for packet end
-        else if (c == PACKET_END_MARKER) {
-            if (rx_index > 0 && rx_index < UART_RX_BUFFER_SIZE - 1) {
-                rx_buffer[rx_index] = '\0';  // Null terminate
-
-                DEBUG_PRINTF("Packet received: %s\n", rx_buffer);
-
-                // Parse packet
-                if (parse_packet(rx_buffer, state)) {
-                    // Notify that we received a valid command
-                    on_command_received();
-                    DEBUG_PRINTLN("Packet parsed OK");
+        switch (rx_framing) {
+            case RX_IDLE:
+            case RX_HUNT:
+                if (c == PACKET_START_MARKER) {
+                    rx_index = 0;
+                    rx_buffer[rx_index++] = c;
+                    rx_framing = RX_ASCII;
+                } else if (c == PACKET_BINARY_DELIMITER) {
+                    rx_framing = RX_IDLE;
+                } else if (rx_framing == RX_IDLE) {
+                    // First COBS code byte of a binary frame
+                    rx_index = 0;
+                    rx_buffer[rx_index++] = c;
+                    rx_framing = RX_BINARY;
+                }
+                break;
+
+            case RX_ASCII:
+                if (c == PACKET_START_MARKER) {
+                    // Start new packet
+                    rx_index = 0;
+                    rx_buffer[rx_index++] = c;
+                } else if (c == PACKET_END_MARKER) {
+                    dispatch_packet(false, state);
+                    // A binary frame must follow its leading 0x00
+                    rx_framing = RX_HUNT;
+                } else if (c == PACKET_BINARY_DELIMITER) {
+                    // Truncated ASCII packet followed by a binary frame
+                    rx_framing = RX_IDLE;
+                } else if (rx_index < UART_RX_BUFFER_SIZE - 1) {
+                    rx_buffer[rx_index++] = c;
                 } else {
-                    DEBUG_PRINTLN("Packet parse FAILED");
+                    rx_framing = RX_HUNT;
+                    DEBUG_PRINTLN("UART RX buffer overflow");
                 }
-            }
-            rx_index = 0;
-        }
-        // Add character to buffer
-        else if (rx_index > 0 && rx_index < UART_RX_BUFFER_SIZE - 1) {
-            rx_buffer[rx_index++] = c;
+                break;
+
+            case RX_BINARY:
+                if (c == PACKET_BINARY_DELIMITER) {
+                    dispatch_packet(true, state);
+                    rx_framing = RX_IDLE;
+                } else if (rx_index < BIN_COBS_MAX_SIZE) {
+                    rx_buffer[rx_index++] = c;
+                } else {
+                    rx_framing = RX_HUNT;
+                    DEBUG_PRINTLN("BIN frame overflow");
+                }
+                break;
         }
 
-        // Prevent buffer overflow
-        if (rx_index >= UART_RX_BUFFER_SIZE - 1) {
-            rx_index = 0;
-            DEBUG_PRINTLN("UART RX buffer overflow");
+        // $BDR switches only once its answer has gone out at the old rate
+        if (link_baud_request != 0) {
+            set_link_baud(link_baud_request);
+            link_baud_request = 0;
         }
     }
 }
 
+bool uart_tx_slot_open() {
+    if (!bus_member()) return true;
+    if (!bus_poll_pending || micros() - bus_poll_us < bus_slot_delay_us) return false;
+
+    bus_poll_pending = false;
+    return true;
+}
+
+uint32_t uart_tx_wait_ms(uint32_t idle_ms) {
+    if (!bus_member() || !bus_poll_pending) return idle_ms;
+
+    uint32_t waited_us = micros() - bus_poll_us;
+    if (waited_us >= bus_slot_delay_us) return 0;
+    uint32_t wait_ms = (bus_slot_delay_us - waited_us + 999) / 1000;
+    return (wait_ms < idle_ms) ? wait_ms : idle_ms;
+}
+
+// =============================================================================
+// Status telemetry
+// =============================================================================
+
 // External function to check test status (defined in main.cpp)
 extern bool is_test_active();
 
-void uart_send_status(DeviceState* state) {
-    // Build status packet (extended format with valve state)
-    // Format: $STS,<limit>,<s1>,<s2>,<s3>,<light>,<flags>,<test>,<valve_open>,<valve_enabled>,<valve_ms>
-
-    uint8_t limit = state->input.limit_direction;
-    float servo1_pos = state->output.servo_angles[0];
-    float servo2_pos = state->output.servo_angles[1];
-    float servo3_pos = state->output.servo_angles[2];
-    uint8_t light_state = state->output.light_on ? 1 : 0;
-    uint8_t flags = 0;
-    uint8_t test_active = is_test_active() ? 1 : 0;
-
-    // Get valve state from external functions
-    uint8_t valve_open = get_valve_open() ? 1 : 0;
-    uint8_t valve_enabled = get_valve_enabled() ? 1 : 0;
-    uint32_t valve_ms = get_valve_open_ms();
+// One status sample in wire units (servo angles in tenths of a degree)
+typedef struct {
+    uint8_t limit;
+    int16_t servo[NUM_SERVOS];
+    uint8_t light;
+    uint8_t flags;
+    uint8_t test;
+    uint8_t valve_open;
+    uint8_t valve_enabled;
+    uint32_t valve_ms;
+    uint16_t chatter;
+} StatusFields;
+
+// Fields whose change is sent at once instead of waiting for the delta period
+#define STS_EVENT_FIELDS (STS_FIELD_LIMIT | STS_FIELD_LIGHT | STS_FIELD_TEST | \
+                          STS_FIELD_VALVE_OPEN | STS_FIELD_VALVE_ENABLED)
+
+// Last values the Pi was told about (keyframe + deltas) and send times
+static StatusFields telemetry_sent;
+static uint32_t telemetry_keyframe_ms = 0;
+static uint32_t telemetry_delta_ms = 0;
+
+static void status_capture(const DeviceState* state, StatusFields* f) {
+    f->limit = state->input.limit_direction;
+    for (int i = 0; i < NUM_SERVOS; i++) {
+        f->servo[i] = (int16_t)lroundf(state->output.servo_angles[i] * 10.0f);
+    }
+    f->light = state->output.light_on ? 1 : 0;
+    f->test = is_test_active() ? 1 : 0;
+    f->valve_open = state->output.valve_open ? 1 : 0;
+    f->valve_enabled = state->output.valve_enabled ? 1 : 0;
+    f->valve_ms = state->output.valve_open_ms;
+    f->chatter = state->input.limit_chatter;
 
     // Set flags - any servo moving sets bit 0
+    f->flags = 0;
     for (int i = 0; i < NUM_SERVOS; i++) {
         if (state->output.servo_moving[i]) {
-            flags |= 0x01;
+            f->flags |= STS_FLAG_MOVING;
             break;
         }
     }
+    if (state->output.control_failsafe) {
+        f->flags |= STS_FLAG_FAILSAFE;
+    }
+    if (telemetry_delta) {
+        f->flags |= STS_FLAG_DELTA;
+    }
+}
+
+/**
+ * Fields of cur that differ meaningfully from what was last sent.
+ * Servo angles and the valve timer use a deadband; the rest compare exactly.
+ */
+static uint16_t status_changes(const StatusFields* sent, const StatusFields* cur) {
+    uint16_t mask = 0;
+
+    if (cur->limit != sent->limit) mask |= STS_FIELD_LIMIT;
+    for (int i = 0; i < NUM_SERVOS; i++) {
+        if (abs(cur->servo[i] - sent->servo[i]) >= TELEMETRY_SERVO_DEADBAND) {
+            mask |= (STS_FIELD_S1 << i);
+        }
+    }
+    if (cur->light != sent->light) mask |= STS_FIELD_LIGHT;
+    if (cur->flags != sent->flags) mask |= STS_FIELD_FLAGS;
+    if (cur->test != sent->test) mask |= STS_FIELD_TEST;
+    if (cur->valve_open != sent->valve_open) mask |= STS_FIELD_VALVE_OPEN;
+    if (cur->valve_enabled != sent->valve_enabled) mask |= STS_FIELD_VALVE_ENABLED;
+
+    // The valve timer ticks every millisecond while open; report it in steps,
+    // and always alongside a valve edge so the Pi sees the final duration
+    uint32_t valve_step = (cur->valve_ms > sent->valve_ms)
+        ? cur->valve_ms - sent->valve_ms : sent->valve_ms - cur->valve_ms;
+    if (valve_step >= TELEMETRY_VALVE_MS_STEP ||
+        (valve_step != 0 && (mask & STS_FIELD_VALVE_OPEN))) {
+        mask |= STS_FIELD_VALVE_MS;
+    }
+    if (cur->chatter != sent->chatter) mask |= STS_FIELD_CHATTER;
 
-    // Send packet with all fields including valve state
-    PiSerial.printf("$STS,%d,%.1f,%.1f,%.1f,%d,%d,%d,%d,%d,%lu\n",
-                    limit, servo1_pos, servo2_pos, servo3_pos,
-                    light_state, flags, test_active,
-                    valve_open, valve_enabled, valve_ms);
+    return mask;
+}
 
-    DEBUG_PRINTF("STS: limit=%d, servos=(%.1f,%.1f,%.1f), valve=%d/%d/%lu\n",
-                 limit, servo1_pos, servo2_pos, servo3_pos,
-                 valve_open, valve_enabled, valve_ms);
+// Write a tenths-of-a-degree angle as "<deg>.<tenth>" (no float formatting)
+static int format_tenths(char* out, size_t size, int16_t tenths) {
+    const char* sign = (tenths < 0) ? "-" : "";
+    int value = abs(tenths);
+    return snprintf(out, size, "%s%d.%d", sign, value / 10, value % 10);
+}
+
+static void send_status_full(const StatusFields* f) {
+    if (status_binary) {
+        BinStatusPayload p;
+        p.limit = f->limit;
+        p.s1 = f->servo[0];
+        p.s2 = f->servo[1];
+        p.s3 = f->servo[2];
+        p.light = f->light;
+        p.flags = f->flags;
+        p.test = f->test;
+        p.valve_open = f->valve_open;
+        p.valve_enabled = f->valve_enabled;
+        p.valve_ms = f->valve_ms;
+        p.chatter = f->chatter;
+
+        tx_frame(BIN_TYPE_STS, &p, sizeof(p));
+        return;
+    }
+
+    // Format: $STS,<limit>,<s1>,<s2>,<s3>,<light>,<flags>,<test>,<valve_open>,<valve_enabled>,<valve_ms>,<chatter>
+    char s1[8], s2[8], s3[8];
+    format_tenths(s1, sizeof(s1), f->servo[0]);
+    format_tenths(s2, sizeof(s2), f->servo[1]);
+    format_tenths(s3, sizeof(s3), f->servo[2]);
+
+    tx_printf("$STS,%u,%s,%s,%s,%u,%u,%u,%u,%u,%u,%u\n",
+              (unsigned)f->limit, s1, s2, s3,
+              (unsigned)f->light, (unsigned)f->flags, (unsigned)f->test,
+              (unsigned)f->valve_open, (unsigned)f->valve_enabled,
+              (unsigned)f->valve_ms, (unsigned)f->chatter);
+
+    DEBUG_PRINTF("STS: limit=%u, servos=(%s,%s,%s), valve=%u/%u/%u\n",
+                 (unsigned)f->limit, s1, s2, s3,
+                 (unsigned)f->valve_open, (unsigned)f->valve_enabled, (unsigned)f->valve_ms);
+}
+
+/**
+ * Send only the fields in mask, in STS field order.
+ * Format: $STD,<mask_hex>,<field>... (angles as tenths of a degree)
+ */
+static void send_status_delta(uint16_t mask, const StatusFields* f) {
+    if (status_binary) {
+        uint8_t payload[sizeof(uint16_t) + sizeof(BinStatusPayload)];
+        size_t len = 0;
+
+        memcpy(&payload[len], &mask, sizeof(mask));
+        len += sizeof(mask);
+        if (mask & STS_FIELD_LIMIT) payload[len++] = f->limit;
+        for (int i = 0; i < NUM_SERVOS; i++) {
+            if (mask & (STS_FIELD_S1 << i)) {
+                memcpy(&payload[len], &f->servo[i], sizeof(int16_t));
+                len += sizeof(int16_t);
+            }
+        }
+        if (mask & STS_FIELD_LIGHT) payload[len++] = f->light;
+        if (mask & STS_FIELD_FLAGS) payload[len++] = f->flags;
+        if (mask & STS_FIELD_TEST) payload[len++] = f->test;
+        if (mask & STS_FIELD_VALVE_OPEN) payload[len++] = f->valve_open;
+        if (mask & STS_FIELD_VALVE_ENABLED) payload[len++] = f->valve_enabled;
+        if (mask & STS_FIELD_VALVE_MS) {
+            memcpy(&payload[len], &f->valve_ms, sizeof(uint32_t));
+            len += sizeof(uint32_t);
+        }
+        if (mask & STS_FIELD_CHATTER) {
+            memcpy(&payload[len], &f->chatter, sizeof(uint16_t));
+            len += sizeof(uint16_t);
+        }
+
+        tx_frame(BIN_TYPE_STD, payload, (uint8_t)len);
+        return;
+    }
+
+    char line[UART_TX_BUFFER_SIZE];
+    int len = snprintf(line, sizeof(line), "$STD,%X", (unsigned)mask);
+    if (mask & STS_FIELD_LIMIT) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->limit);
+    for (int i = 0; i < NUM_SERVOS; i++) {
+        if (mask & (STS_FIELD_S1 << i)) {
+            len += snprintf(line + len, sizeof(line) - len, ",%d", (int)f->servo[i]);
+        }
+    }
+    if (mask & STS_FIELD_LIGHT) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->light);
+    if (mask & STS_FIELD_FLAGS) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->flags);
+    if (mask & STS_FIELD_TEST) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->test);
+    if (mask & STS_FIELD_VALVE_OPEN) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->valve_open);
+    if (mask & STS_FIELD_VALVE_ENABLED) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->valve_enabled);
+    if (mask & STS_FIELD_VALVE_MS) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->valve_ms);
+    if (mask & STS_FIELD_CHATTER) len += snprintf(line + len, sizeof(line) - len, ",%u", (unsigned)f->chatter);
+    snprintf(line + len, sizeof(line) - len, "\n");
+
+    tx_line(line);
+}
+
+/**
+ * Record what the Pi now knows: every field after a keyframe, only the
+ * sent fields after a delta (so slow drift still crosses the deadband).
+ */
+static void status_mark_sent(uint16_t mask, const StatusFields* f) {
+    if (mask & STS_FIELD_LIMIT) telemetry_sent.limit = f->limit;
+    for (int i = 0; i < NUM_SERVOS; i++) {
+        if (mask & (STS_FIELD_S1 << i)) telemetry_sent.servo[i] = f->servo[i];
+    }
+    if (mask & STS_FIELD_LIGHT) telemetry_sent.light = f->light;
+    if (mask & STS_FIELD_FLAGS) telemetry_sent.flags = f->flags;
+    if (mask & STS_FIELD_TEST) telemetry_sent.test = f->test;
+    if (mask & STS_FIELD_VALVE_OPEN) telemetry_sent.valve_open = f->valve_open;
+    if (mask & STS_FIELD_VALVE_ENABLED) telemetry_sent.valve_enabled = f->valve_enabled;
+    if (mask & STS_FIELD_VALVE_MS) telemetry_sent.valve_ms = f->valve_ms;
+    if (mask & STS_FIELD_CHATTER) telemetry_sent.chatter = f->chatter;
+}
+
+void uart_send_status(DeviceState* state) {
+    StatusFields f;
+    status_capture(state, &f);
+    send_status_full(&f);
+    status_mark_sent(STS_FIELD_ALL, &f);
+    trace_status(TRACE_STATUS_FULL, status_binary, STS_FIELD_ALL);
+    telemetry_keyframe_ms = millis();
+}
+
+void uart_send_telemetry(DeviceState* state) {
+    uint32_t now = millis();
+
+    // On a bus this runs once per reply slot, and the slot is always used
+    // (an empty delta tells the Pi the unit is still there)
+    bool slot = bus_member();
+
+    if (!telemetry_delta) {
+        // Periodic mode: a full status every status period
+        if (slot || now - telemetry_keyframe_ms >= g_params.status_period_ms) {
+            uart_send_status(state);
+        }
+        return;
+    }
+
+    if (telemetry_keyframe_due || now - telemetry_keyframe_ms >= TELEMETRY_KEYFRAME_PERIOD_MS) {
+        uart_send_status(state);
+        telemetry_keyframe_due = false;
+        telemetry_delta_ms = now;
+        return;
+    }
+
+    StatusFields f;
+    status_capture(state, &f);
+    uint16_t mask = status_changes(&telemetry_sent, &f);
+
+    // Events go out on this wake; motion is batched to the delta period
+    bool failsafe_edge = ((f.flags ^ telemetry_sent.flags) & STS_FLAG_FAILSAFE) != 0;
+    if (slot || (mask & STS_EVENT_FIELDS) || failsafe_edge ||
+        (mask != 0 && now - telemetry_delta_ms >= g_params.status_period_ms)) {
+        send_status_delta(mask, &f);
+        status_mark_sent(mask, &f);
+        trace_status(TRACE_STATUS_DELTA, status_binary, mask);
+        telemetry_delta_ms = now;
+    }
+}
+
+void uart_send_latency() {
+    uint32_t avg_us = latency_count ? (latency_sum_us / latency_count) : 0;
+
+    if (status_binary) {
+        BinLatencyPayload p;
+        p.last_us = latency_last_us;
+        p.avg_us = avg_us;
+        p.max_us = latency_max_us;
+        p.count = latency_count;
+
+        tx_frame(BIN_TYPE_LAT, &p, sizeof(p));
+    } else {
+        tx_printf("$LAT,%u,%u,%u,%u\n",
+                  (unsigned)latency_last_us, (unsigned)avg_us,
+                  (unsigned)latency_max_us, (unsigned)latency_count);
+    }
+
+    // Start a new report window
+    latency_max_us = 0;
+    latency_sum_us = 0;
+    latency_count = 0;
+}
+
+void uart_send_boot_report(uint8_t reset_reason, uint32_t valve_us, uint32_t control_us,
+                           uint32_t link_us, uint32_t leds_us) {
+    if (status_binary) {
+        BinBootPayload p;
+        p.reset_reason = reset_reason;
+        p.valve_us = valve_us;
+        p.control_us = control_us;
+        p.link_us = link_us;
+        p.leds_us = leds_us;
+
+        tx_frame(BIN_TYPE_BOT, &p, sizeof(p));
+    } else {
+        tx_printf("$BOT,%u,%u,%u,%u,%u\n", (unsigned)reset_reason,
+                  (unsigned)valve_us, (unsigned)control_us,
+                  (unsigned)link_us, (unsigned)leds_us);
+    }
+}
+
+void uart_send_pour_report(float target_ml, float poured_ml, uint8_t reason,
+                           uint32_t duration_ms) {
+    if (status_binary) {
+        BinPourReportPayload p;
+        p.target = (uint16_t)lroundf(target_ml * 10.0f);
+        p.poured = (uint16_t)lroundf(poured_ml * 10.0f);
+        p.reason = reason;
+        p.duration_ms = duration_ms;
+
+        tx_frame(BIN_TYPE_PRD, &p, sizeof(p));
+    } else {
+        tx_printf("$PRD,%.1f,%.1f,%u,%u\n", target_ml, poured_ml,
+                  (unsigned)reason, (unsigned)duration_ms);
+    }
+}
+
+void uart_send_schedule(uint16_t npm_ms, uint16_t npr_ms, uint16_t rgb_ms,
+                        uint16_t matrix_ms, uint8_t render_core) {
+#if PROFILER_ENABLED
+    uint16_t load[PRF_CORE_COUNT];
+    profiler_take_core_load(load);
+
+    if (status_binary) {
+        BinSchedulePayload p;
+        p.npm_ms = npm_ms;
+        p.npr_ms = npr_ms;
+        p.rgb_ms = rgb_ms;
+        p.matrix_ms = matrix_ms;
+        p.render_core = render_core;
+        p.load_permille[0] = load[0];
+        p.load_permille[1] = load[1];
+
+        tx_frame(BIN_TYPE_SCH, &p, sizeof(p));
+    } else {
+        tx_printf("$SCH,%u,%u,%u,%u,%u,%u,%u\n", (unsigned)npm_ms, (unsigned)npr_ms,
+                  (unsigned)rgb_ms, (unsigned)matrix_ms, (unsigned)render_core,
+                  (unsigned)load[0], (unsigned)load[1]);
+    }
+#endif
+}
+
+void uart_send_profile() {
+#if PROFILER_ENABLED
+    for (uint8_t task = 0; task < PRF_TASK_COUNT; task++) {
+        ProfilerReport r;
+        profiler_take_report(task, &r);
+
+        if (status_binary) {
+            BinProfilePayload p;
+            p.task = task;
+            p.loops = r.loops;
+            p.exec_min_us = r.exec_min_us;
+            p.exec_avg_us = r.exec_avg_us;
+            p.exec_max_us = r.exec_max_us;
+            p.overruns = r.overruns;
+            p.jitter_max_us = r.jitter_max_us;
+            p.lock_wait_avg_us = r.lock_wait_avg_us;
+            p.lock_wait_max_us = r.lock_wait_max_us;
+            p.lock_timeouts = r.lock_timeouts;
+            p.stack_free = r.stack_free;
+
+            tx_frame(BIN_TYPE_PRF, &p, sizeof(p));
+            continue;
+        }
+
+        tx_printf("$PRF,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+                  (unsigned)task, (unsigned)r.loops,
+                  (unsigned)r.exec_min_us, (unsigned)r.exec_avg_us, (unsigned)r.exec_max_us,
+                  (unsigned)r.overruns, (unsigned)r.jitter_max_us,
+                  (unsigned)r.lock_wait_avg_us, (unsigned)r.lock_wait_max_us,
+                  (unsigned)r.lock_timeouts, (unsigned)r.stack_free);
+    }
+#endif
 }
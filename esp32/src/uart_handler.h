@@ -6,6 +6,9 @@
 
 /**
  * Initialize UART for communication with Raspberry Pi.
+ *
+ * Registers an RX event callback that notifies the comm task as soon as a
+ * packet has arrived (g_comm_task_handle may be set after this call).
  */
 void uart_init();
 
@@ -13,16 +16,125 @@ void uart_init();
  * Receive and parse incoming UART data.
  *
  * Checks for complete packets and updates device state with received commands.
+ * Accepts ASCII `$XXX,...` packets and COBS-framed binary packets on the same
+ * stream; binary frames with a bad length or CRC are dropped whole.
+ * $BDR and $PNG are answered from here (link rate switch, ping echo); a
+ * rate the Pi does not confirm within UART_BAUD_CONFIRM_MS, or a link silent
+ * for UART_BAUD_IDLE_MS, falls back to UART_BAUD_RATE.
+ * Packets tagged with another unit's address are ignored, broadcasts
+ * (BUS_ADDR_BROADCAST) are applied but never answered.
+ * A $TXN holds command packets only; anything else inside it, a bad
+ * sub-packet or a timeout drops the whole transaction and is answered $TXA.
+ * Only state->command is written; the caller publishes it afterwards.
  *
  * @param state Pointer to device state to update
  */
 void uart_receive(DeviceState* state);
 
+/**
+ * Check whether this unit may send unsolicited packets now (status, reports).
+ *
+ * Always true standalone (PARAM_UNIT_ADDRESS 0). On a bus, true once per
+ * $POL, when this unit's reply slot starts: unit n waits (n - 1) * BUS_SLOT_US
+ * after a broadcast poll, none after a poll addressed to it alone.
+ *
+ * @return True if the caller should send now (the slot is consumed)
+ */
+bool uart_tx_slot_open();
+
+/**
+ * Get how long the comm task may sleep without missing its reply slot.
+ *
+ * @param idle_ms Sleep when no slot is pending
+ * @return Milliseconds until the slot (0 = open now), at most idle_ms
+ */
+uint32_t uart_tx_wait_ms(uint32_t idle_ms);
+
 /**
  * Send status packet to Raspberry Pi.
  *
- * @param state Pointer to device state to read
+ * Uses the binary STS frame once the Pi has negotiated it with $BIN,1,
+ * otherwise the ASCII $STS line.
+ *
+ * @param state Pointer to device state to read (input/output from a published snapshot)
  */
 void uart_send_status(DeviceState* state);
 
+/**
+ * Send status telemetry in the mode negotiated by the Pi (call on every wake).
+ *
+ * Periodic mode ($TLM,0, the default): a full status every status period
+ * (PARAM_STATUS_PERIOD_MS, STATUS_TX_PERIOD_MS unless tuned).
+ * Delta mode ($TLM,1): a full status every TELEMETRY_KEYFRAME_PERIOD_MS, and
+ * in between $STD deltas carrying only the fields that changed. Limit, light,
+ * test and valve edges are sent immediately; servo motion at most every
+ * status period.
+ * On a bus call it only when uart_tx_slot_open(): every call then sends, a
+ * keyframe in periodic mode and a (possibly empty) delta in delta mode.
+ *
+ * @param state Pointer to device state to read (input/output from a published snapshot)
+ */
+void uart_send_telemetry(DeviceState* state);
+
+/**
+ * Send link latency report to Raspberry Pi.
+ *
+ * Reports the time from the UART RX event that delivered a servo packet to
+ * the update of target_servo_angles (last/avg/max in microseconds, and the
+ * number of samples), then starts a new measurement window.
+ * Format: $LAT,<last_us>,<avg_us>,<max_us>,<count>
+ */
+void uart_send_latency();
+
+/**
+ * Send the result of a metered pour to Raspberry Pi (call when it finishes).
+ * Format: $PRD,<target_ml>,<poured_ml>,<reason>,<duration_ms>
+ *
+ * @param target_ml Requested volume
+ * @param poured_ml Volume poured, including the closing stroke
+ * @param reason DISPENSE_END_*
+ * @param duration_ms Valve open to shut (0 if it never opened)
+ */
+void uart_send_pour_report(float target_ml, float poured_ml, uint8_t reason,
+                           uint32_t duration_ms);
+
+/**
+ * Send the boot report to Raspberry Pi (call when the link comes up).
+ * Stage times are microseconds since reset, 0 if the stage has not finished.
+ * Format: $BOT,<reset_reason>,<valve_us>,<control_us>,<link_us>,<leds_us>
+ *
+ * @param reset_reason esp_reset_reason() of this boot
+ * @param valve_us Valve servo holding the closed pulse
+ * @param control_us First control tick done
+ * @param link_us UART link up
+ * @param leds_us LED drivers initialized
+ */
+void uart_send_boot_report(uint8_t reset_reason, uint32_t valve_us, uint32_t control_us,
+                           uint32_t link_us, uint32_t leds_us);
+
+/**
+ * Send task profiler reports to Raspberry Pi.
+ *
+ * One $PRF packet (or binary PRF frame) per profiled task, then starts a new
+ * report window. No-op when PROFILER_ENABLED is 0.
+ */
+void uart_send_profile();
+
+/**
+ * Send the LED schedule to Raspberry Pi (with the profiler reports).
+ * Frame intervals are what each output's effect last asked for, 0 for a
+ * static frame that is only redrawn when it changes. Core load is the busy
+ * time of the profiled tasks per core since the last report, in 0.1 %.
+ * Format: $SCH,<npm_ms>,<npr_ms>,<rgb_ms>,<matrix_ms>,<render_core>,<load0>,<load1>
+ * No-op when PROFILER_ENABLED is 0.
+ *
+ * @param npm_ms NeoPixel matrix frame interval
+ * @param npr_ms NeoPixel ring frame interval
+ * @param rgb_ms RGB strip frame interval
+ * @param matrix_ms MAX7219 frame interval
+ * @param render_core Core the animation task runs on
+ */
+void uart_send_schedule(uint16_t npm_ms, uint16_t npr_ms, uint16_t rgb_ms,
+                        uint16_t matrix_ms, uint8_t render_core);
+
 #endif // UART_HANDLER_H
@@ -1,4 +1,5 @@
 #include "valve_safety.h"
+#include "param_store.h"
 
 void valve_safety_init(ValveState* state) {
     state->commanded_open = false;
@@ -35,7 +36,7 @@ bool valve_safety_update(ValveState* state, bool connected) {
     // Safety check 2: Auto-close after max open time (5 seconds)
     if (state->actual_open) {
         uint32_t open_duration = now - state->open_start_time;
-        if (open_duration >= VALVE_MAX_OPEN_MS) {
+        if (open_duration >= g_params.valve_max_open_ms) {
             state->actual_open = false;
             state->last_close_time = now;
             state->safety_triggered = true;
@@ -51,7 +52,7 @@ bool valve_safety_update(ValveState* state, bool connected) {
         // Want to open - check cooldown
         if (state->last_close_time > 0) {
             uint32_t since_close = now - state->last_close_time;
-            if (since_close < VALVE_COOLDOWN_MS) {
+            if (since_close < g_params.valve_cooldown_ms) {
                 return false;  // Still in cooldown
             }
         }
@@ -13,7 +13,8 @@
 // - Connection loss failsafe (auto-close)
 // =============================================================================
 
-// Valve safety settings
+// Valve safety settings (open and cooldown times are the defaults of
+// PARAM_VALVE_MAX_OPEN_MS / PARAM_VALVE_COOLDOWN_MS, see param_store.h)
 #define VALVE_MAX_OPEN_MS 15000 // Auto-close after 5 seconds
 #define VALVE_COOLDOWN_MS 500   // Minimum time between pours (0.5 seconds)
 #define VALVE_PULSE_MIN_MS 100  // Minimum pulse duration
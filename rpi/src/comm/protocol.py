@@ -1,7 +1,8 @@
 """UART protocol encoding and decoding.
 
 Multi-message protocol format:
-- $SRV,<s1>,<s2>,<s3>                         - Servo targets (sent at 50Hz)
+- $SRV,<s1>,<s2>,<s3>[,<v1>,<v2>,<v3>]        - Servo targets (sent at 50Hz), optional
+                                                 feed-forward velocities (deg/s)
 - $LGT,<cmd>                                   - Light command (sent on change)
 - $RGB,<mode>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>] - RGB strip (extended for gradient)
 - $MTX,<left>,<right>                          - MAX7219 patterns (sent on change)
@@ -9,22 +10,60 @@ Multi-message protocol format:
 - $NPR,<mode>,<r>,<g>,<b>[,<r2>,<g2>,<b2>,<speed>]          - NeoPixel ring
 - $FLG,<flags>                                 - Command flags (sent on change)
 - $VLV,<open>                                  - Valve command: 0=close, 1=open
+- $BIN,<enable>                                - Negotiate binary framed mode
+- $TLM,<mode>                                  - Status telemetry: 0=periodic, 1=keyframe + deltas
+- $TXN,<count>                                 - Next <count> packets are applied together
+- $BDR,<baud>                                  - Switch the link rate (always ASCII)
+- $PNG,<token>                                 - Ping, echoed back as $PNG,<token>
+- $TXT,<slot>,<offset>,<text>                  - Scroll slot text chunk
+- $FRM,<slot>,<index>,<row0>..<row4>           - Scroll slot 5x5 frame
+- $SLT,<slot>,<action>                         - Scroll slot commit (1) / erase (0)
+- $GLY,<slot>,<row0>..<row4>                   - NeoPixel matrix user glyph (NPM_MODE_GLYPH)
+- $KEY,<seq>,<index>,<device>,<time_ms>,<mode>,<letter>,<r>,<g>,<b>,<r2>,<g2>,<b2>,<speed>,<easing>
+                                               - Timeline keyframe upload
+- $SEQ,<seq>,<action>                          - Timeline stop (0) / play (1) / loop (2)
+- $POL,<keyframe>                              - Bus poll: each unit sends its status in its slot
 
 RGB/NPM/NPR extended fields (optional, for gradient mode):
 - r2, g2, b2: Second color (0-255)
 - speed: Animation speed (1-50)
 
 Status from ESP32:
-- $STS,<limit>,<s1>,<s2>,<s3>,<light>,<flags>,<test>,<valve_open>,<valve_enabled>,<valve_ms>
+- $STS,<limit>,<s1>,<s2>,<s3>,<light>,<flags>,<test>,<valve_open>,<valve_enabled>,<valve_ms>,<chatter>
+- $STD,<mask_hex>,<field>...                   - Status delta: only the fields in mask
+                                                 (after $TLM,1; angles in tenths)
+- $LAT,<last_us>,<avg_us>,<max_us>,<count>     - RX event -> servo target latency (1 Hz)
+- $PRF,<task>,<loops>,<min>,<avg>,<max>,<overruns>,<jitter>,<lock_avg>,<lock_max>,<lock_timeouts>,<stack>
+                                               - Task profiler window, one per task (1 Hz)
+- $SCH,<npm_ms>,<npr_ms>,<rgb_ms>,<mtx_ms>,<core>,<load0>,<load1>
+                                               - LED frame intervals (0 = static), render
+                                                 core, per-core load in 0.1 % (with $PRF)
+- $TXA,<reason>                                - $TXN dropped, nothing in it applied
+- $BDR,<baud>                                  - Rate the ESP32 switches to (sent at the old rate)
+- $PNG,<token>                                 - Ping echo
+
+Binary framed mode (after $BIN,1):
+- Frame: [type:1][len:1][payload:len][crc16:2], CRC-16/CCITT-FALSE, little-endian
+- Wire:  0x00 + COBS(frame) + 0x00
+- Payloads are fixed-size structs (see esp32/src/binary_protocol.h)
+- ASCII packets remain accepted in both directions for bench debugging
+
+Shared bus (several units on one RS-485 pair, esp32 BUS_ENABLED):
+- Any packet may carry a unit address: $SRV@<n>,... or a binary type with
+  BIN_TYPE_ADDRESSED and the address as the first payload byte
+- BUS_ADDR_BROADCAST reaches every unit and is never answered
+- Units on a bus tag everything they send with their own address
 
 Note: Valve auto-closes after 5 seconds. Extended fields are backwards compatible.
 """
 
 from __future__ import annotations
 
+import binascii
 import logging
+import struct
 from dataclasses import dataclass
-from typing import Optional
+from typing import Optional, Union
 
 logger = logging.getLogger(__name__)
 
@@ -56,9 +95,29 @@ SCROLL_TEXT_BOX = '7'           # "BOX"
 SCROLL_TEXT_CHEERS = '8'        # "CHEERS"
 SCROLL_TEXT_DRINK = '9'         # "DRINK"
 
+# Uploaded scroll slots (see create_scroll_text_messages), selected with
+# letters 'K'-'N'. Committed slots persist on the ESP32 across reboots.
+SCROLL_SLOT_COUNT = 4
+SCROLL_SLOT_DATA_MAX = 80       # Characters per slot
+SCROLL_SLOT_MAX_FRAMES = 16     # 5x5 frames per slot
+SCROLL_UPLOAD_CHUNK_MAX = 20    # Characters per $TXT chunk
+SCROLL_SLOT_ACTION_ERASE = 0
+SCROLL_SLOT_ACTION_COMMIT = 1
+SCROLL_TEXT_SLOTS = ('K', 'L', 'M', 'N')
+
 # NeoPixel Matrix gradient mode
 NPM_MODE_GRADIENT = 9  # Ping-pong gradient between 2 colors
 
+# NeoPixel Matrix user glyphs (see create_glyph_message), selected with the
+# letter field '0'-'7'. Held in ESP32 RAM only: re-upload after a reboot.
+NPM_MODE_GLYPH = 10
+NPM_USER_GLYPH_COUNT = 8
+
+# NeoPixel Matrix modes shared with the ring (same effect code on the ESP32)
+NPM_MODE_BREATHE = 11  # Breathing/pulse effect
+NPM_MODE_CHASE = 12    # Single LED chase animation
+NPM_MODE_SPINNER = 13  # Spinning dot animation
+
 # NeoPixel Ring modes
 NPR_MODE_OFF = 0      # All LEDs off
 NPR_MODE_SOLID = 1    # Solid color fill
@@ -72,6 +131,363 @@ NPR_MODE_GRADIENT = 6 # Ping-pong gradient between 2 colors
 RGB_MODE_SOLID = 0    # Static solid color
 RGB_MODE_RAINBOW = 1  # Rainbow animation
 RGB_MODE_GRADIENT = 2 # Ping-pong gradient between 2 colors
+RGB_MODE_BREATHE = 3  # Breathing/pulse effect
+
+# Timeline player (must match esp32/src/timeline.h)
+TIMELINE_SEQ_COUNT = 4
+TIMELINE_SEQ_MAX_KEYS = 16
+TIMELINE_DEV_NPM = 0
+TIMELINE_DEV_NPR = 1
+TIMELINE_DEV_RGB = 2
+TIMELINE_EASE_STEP = 0
+TIMELINE_EASE_LINEAR = 1
+TIMELINE_EASE_IN = 2
+TIMELINE_EASE_OUT = 3
+TIMELINE_EASE_IN_OUT = 4
+TIMELINE_ACTION_STOP = 0
+TIMELINE_ACTION_PLAY = 1
+TIMELINE_ACTION_LOOP = 2
+
+# Tuned parameters ($PRM / $PSV, must match esp32/src/param_store.h)
+PARAM_SCHEMA_VERSION = 1
+PARAM_SERVO_MIN_ANGLE = 0       # Aim servo travel, low end (degrees)
+PARAM_SERVO_MAX_ANGLE = 1       # Aim servo travel, high end (degrees)
+PARAM_SERVO_MAX_VELOCITY = 2    # Aim servo speed limit (degrees/second)
+PARAM_SERVO_MAX_ACCEL = 3       # Aim servo acceleration limit (degrees/second^2)
+PARAM_VALVE_MAX_OPEN_MS = 4     # Valve auto-close time
+PARAM_VALVE_COOLDOWN_MS = 5     # Minimum time between pours
+PARAM_NPM_BRIGHTNESS = 6        # NeoPixel matrix brightness (0-255)
+PARAM_NPR_BRIGHTNESS = 7        # NeoPixel ring brightness (0-255)
+PARAM_MATRIX_BRIGHTNESS = 8     # MAX7219 intensity (0-15)
+PARAM_ANIMATION_PERIOD_MS = 9   # Animation task period
+PARAM_CONTROL_PERIOD_MS = 10    # Control task period (applied at boot)
+PARAM_STATUS_PERIOD_MS = 11     # Status telemetry period
+PARAM_FLOW_ML_PER_S = 12        # Pour flow with the valve fully open (ml/second)
+PARAM_FLOW_PULSES_PER_L = 13    # Flow meter calibration (0 = flow curve only)
+PARAM_UNIT_ADDRESS = 14         # Bus address (0 = standalone, 1-254 on a shared bus)
+PARAM_ALL = -1                  # $PRM id that reads every parameter
+PARAM_FLAG_REBOOT = 0x01        # Takes effect after $PSV,1 and a reset
+PARAM_NAMES = {
+    PARAM_SERVO_MIN_ANGLE: "servo_min_angle",
+    PARAM_SERVO_MAX_ANGLE: "servo_max_angle",
+    PARAM_SERVO_MAX_VELOCITY: "servo_max_velocity",
+    PARAM_SERVO_MAX_ACCEL: "servo_max_accel",
+    PARAM_VALVE_MAX_OPEN_MS: "valve_max_open_ms",
+    PARAM_VALVE_COOLDOWN_MS: "valve_cooldown_ms",
+    PARAM_NPM_BRIGHTNESS: "npm_brightness",
+    PARAM_NPR_BRIGHTNESS: "npr_brightness",
+    PARAM_MATRIX_BRIGHTNESS: "matrix_brightness",
+    PARAM_ANIMATION_PERIOD_MS: "animation_period_ms",
+    PARAM_CONTROL_PERIOD_MS: "control_period_ms",
+    PARAM_STATUS_PERIOD_MS: "status_period_ms",
+    PARAM_FLOW_ML_PER_S: "flow_ml_per_s",
+    PARAM_FLOW_PULSES_PER_L: "flow_pulses_per_l",
+    PARAM_UNIT_ADDRESS: "unit_address",
+}
+
+# Binary frame types (must match esp32/src/binary_protocol.h)
+BIN_TYPE_SRV = 0x01
+BIN_TYPE_LGT = 0x02
+BIN_TYPE_RGB = 0x03
+BIN_TYPE_MTX = 0x04
+BIN_TYPE_NPM = 0x05
+BIN_TYPE_NPR = 0x06
+BIN_TYPE_VLV = 0x07
+BIN_TYPE_EST = 0x08
+BIN_TYPE_FLG = 0x09
+BIN_TYPE_MODE = 0x0A
+BIN_TYPE_TXT = 0x0B
+BIN_TYPE_FRM = 0x0C
+BIN_TYPE_SLT = 0x0D
+BIN_TYPE_KEY = 0x0E
+BIN_TYPE_SEQ = 0x0F
+BIN_TYPE_SRVV = 0x10
+BIN_TYPE_SRVT = 0x11
+BIN_TYPE_TLM = 0x12
+BIN_TYPE_TXN = 0x13
+BIN_TYPE_PNG = 0x14
+BIN_TYPE_GLY = 0x15
+BIN_TYPE_POR = 0x16
+BIN_TYPE_POL = 0x17
+BIN_TYPE_STS = 0x81
+BIN_TYPE_LAT = 0x82
+BIN_TYPE_PRF = 0x83
+BIN_TYPE_STD = 0x84
+BIN_TYPE_ECHO = 0x85
+BIN_TYPE_BOT = 0x86
+BIN_TYPE_PRD = 0x87
+BIN_TYPE_SCH = 0x88
+BIN_TYPE_TXA = 0x89
+BIN_TYPE_ADDRESSED = 0x40  # Type flag: first payload byte is a unit address
+
+BIN_TYPE_NAMES = {
+    BIN_TYPE_SRV: "SRV", BIN_TYPE_LGT: "LGT", BIN_TYPE_RGB: "RGB",
+    BIN_TYPE_MTX: "MTX", BIN_TYPE_NPM: "NPM", BIN_TYPE_NPR: "NPR",
+    BIN_TYPE_VLV: "VLV", BIN_TYPE_EST: "EST", BIN_TYPE_FLG: "FLG",
+    BIN_TYPE_MODE: "MODE", BIN_TYPE_TXT: "TXT", BIN_TYPE_FRM: "FRM",
+    BIN_TYPE_SLT: "SLT", BIN_TYPE_KEY: "KEY", BIN_TYPE_SEQ: "SEQ",
+    BIN_TYPE_SRVV: "SRVV", BIN_TYPE_SRVT: "SRVT", BIN_TYPE_TLM: "TLM",
+    BIN_TYPE_TXN: "TXN", BIN_TYPE_PNG: "PNG", BIN_TYPE_GLY: "GLY",
+    BIN_TYPE_POR: "POR", BIN_TYPE_POL: "POL",
+    BIN_TYPE_STS: "STS", BIN_TYPE_LAT: "LAT",
+    BIN_TYPE_PRF: "PRF", BIN_TYPE_STD: "STD",
+    BIN_TYPE_ECHO: "ECHO", BIN_TYPE_BOT: "BOT", BIN_TYPE_PRD: "PRD",
+    BIN_TYPE_SCH: "SCH", BIN_TYPE_TXA: "TXA",
+}
+
+BIN_DELIMITER = b"\x00"
+TXN_MAX_COMMANDS = 16  # Sub-packets per $TXN (TXN_MAX_COMMANDS in firmware)
+
+# Why a transaction was dropped ($TXA reason, TXN_ABORT_* in firmware)
+TXN_ABORT_INVALID = 0   # A sub-packet failed to parse or apply
+TXN_ABORT_UNSTAGED = 1  # A sub-packet that is not command state
+TXN_ABORT_TIMEOUT = 2   # Sub-packets missing after 50 ms
+TXN_ABORT_NAMES = {
+    TXN_ABORT_INVALID: "invalid sub-packet",
+    TXN_ABORT_UNSTAGED: "cannot be staged",
+    TXN_ABORT_TIMEOUT: "timed out",
+}
+BIN_FRAME_MAX_SIZE = 32  # Raw frame bytes (type + len + payload + crc)
+
+# Shared bus addressing (BUS_ADDR_* in esp32/include/config.h)
+BUS_ADDR_NONE = 0  # Untagged: a unit on a dedicated link
+BUS_ADDR_BROADCAST = 255
+BUS_ADDR_MAX = 254
+
+# Status payload: limit, s1, s2, s3 (tenths), light, flags, test,
+# valve_open, valve_enabled, valve_ms, limit_chatter
+BIN_STATUS_FORMAT = "<BhhhBBBBBIH"
+
+# Status flags
+STS_FLAG_MOVING = 0x01  # Any servo moving
+STS_FLAG_FAILSAFE = 0x04  # Control loop stalled, valve held shut
+STS_FLAG_DELTA = 0x80  # ESP32 is sending keyframes + deltas ($TLM,1 acknowledged)
+
+# Status delta field mask: a delta carries only the selected fields, in STS
+# order. (attribute, binary struct code) per bit, see STS_FIELD_* in firmware.
+STS_DELTA_FIELDS = (
+    ("limit", "B"),
+    ("s1", "h"),
+    ("s2", "h"),
+    ("s3", "h"),
+    ("light_state", "B"),
+    ("flags", "B"),
+    ("test_active", "B"),
+    ("valve_open", "B"),
+    ("valve_enabled", "B"),
+    ("valve_ms", "I"),
+    ("limit_chatter", "H"),
+)
+
+# Keyframe payload: seq, index, device, time_ms, mode, letter, r, g, b,
+# r2, g2, b2, speed, easing
+BIN_KEY_FORMAT = "<BBBHBcBBBBBBBB"
+
+# Latency payload: last_us, avg_us, max_us, count
+BIN_LATENCY_FORMAT = "<IIIH"
+
+# Boot payload: reset_reason, valve_us, control_us, link_us, leds_us
+BIN_BOOT_FORMAT = "<BIIII"
+
+# esp_reset_reason() values the ESP32 reports in $BOT
+RESET_REASON_NAMES = {
+    0: "unknown", 1: "power-on", 2: "external", 3: "software", 4: "panic",
+    5: "interrupt watchdog", 6: "task watchdog", 7: "watchdog", 8: "deep sleep",
+    9: "brownout", 10: "SDIO",
+}
+
+# Pour done payload: target, poured (tenths of a ml), reason, duration_ms
+BIN_POUR_FORMAT = "<HHBI"
+
+# Largest pour the ESP32 accepts (DISPENSE_MAX_ML in firmware)
+POUR_MAX_ML = 1000.0
+
+# Why a pour ended ($PRD reason, DISPENSE_END_* in firmware)
+POUR_END_TARGET = 0     # Target volume reached
+POUR_END_CANCEL = 1     # $POR,0 or a $VLV took the valve over
+POUR_END_SAFETY = 2     # Max-open auto-close
+POUR_END_LINK = 3       # Pi connection lost
+POUR_END_NAMES = {
+    POUR_END_TARGET: "target",
+    POUR_END_CANCEL: "cancelled",
+    POUR_END_SAFETY: "safety timeout",
+    POUR_END_LINK: "link lost",
+}
+
+# LED schedule payload: npm_ms, npr_ms, rgb_ms, matrix_ms, render_core, load0, load1
+BIN_SCHEDULE_FORMAT = "<HHHHBHH"
+
+# Ping / echo payload: token
+BIN_PING_FORMAT = "<I"
+
+# Trace recorder ($TRC actions, $TRD dump; esp32/src/trace.h)
+TRACE_RESUME = 0
+TRACE_PAUSE = 1
+TRACE_READ = 2
+TRACE_CLEAR = 3
+TRACE_PAGE_BYTES = 256  # TRACE_DUMP_LINE_BYTES * TRACE_DUMP_PAGE_LINES in firmware
+
+# Trace record: [t_us:u32][type:u8][len:u8][payload]
+TRACE_HEADER_FORMAT = "<IBB"
+TRACE_EV_RX = 1             # [flags][raw packet without framing markers]
+TRACE_EV_STATUS = 2         # [kind][binary][mask:u16]
+TRACE_EV_OVERRUN = 3        # [task][exec_us:u32]
+TRACE_EV_LOCK_TIMEOUT = 4   # [task][wait_us:u32]
+TRACE_EV_FAILSAFE = 5       # [task][stall_us:u32]
+TRACE_RX_BINARY = 0x01
+TRACE_RX_ACCEPTED = 0x02
+TRACE_STATUS_FULL = 0
+TRACE_STATUS_DELTA = 1
+
+# Profiled tasks ($PRF task, trace task events)
+PRF_TASK_NAMES = {0: "comm", 1: "animation", 2: "control"}
+
+# Profiler payload: task, loops, exec min/avg/max, overruns, jitter_max,
+# lock_wait avg/max, lock_timeouts, stack_free
+BIN_PROFILE_FORMAT = "<BHIIIHHHHHH"
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """COBS-encode data (no delimiter)."""
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out.extend(block)
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out.extend(block)
+                block.clear()
+    out.append(len(block) + 1)
+    out.extend(block)
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> Optional[bytes]:
+    """COBS-decode data (delimiters stripped). Returns None if invalid."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out.extend(data[i + 1 : i + code])
+        i += code
+        if code != 255 and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def build_frame(frame_type: int, payload: bytes) -> bytes:
+    """Build a complete binary wire frame (0x00 + COBS(frame) + 0x00)."""
+    body = bytes((frame_type, len(payload))) + payload
+    body += struct.pack("<H", crc16(body))
+    return BIN_DELIMITER + cobs_encode(body) + BIN_DELIMITER
+
+
+def parse_frame(encoded: bytes) -> Optional[tuple[int, bytes]]:
+    """
+    Decode and validate a COBS frame.
+
+    Returns:
+        (type, payload) if the encoding, length and CRC are valid, None otherwise
+    """
+    frame = cobs_decode(encoded)
+    if frame is None or len(frame) < 4:
+        return None
+    if frame[1] + 4 != len(frame):
+        return None
+    (expected,) = struct.unpack("<H", frame[-2:])
+    if crc16(frame[:-2]) != expected:
+        return None
+    return frame[0], frame[2:-2]
+
+
+def split_address(packet: bytes) -> tuple[int, bytes]:
+    """
+    Split the unit address off an ASCII line ($XXX@<n>,...).
+
+    Returns:
+        (address, packet without the tag); BUS_ADDR_NONE and the packet
+        unchanged if it carries no valid tag
+    """
+    if packet[4:5] != b"@":
+        return BUS_ADDR_NONE, packet
+    end = packet.find(b",", 5)
+    digits = packet[5:end] if end > 5 else b""
+    if not digits.isdigit() or len(digits) > 3 or not 0 < int(digits) <= BUS_ADDR_BROADCAST:
+        return BUS_ADDR_NONE, packet
+    return int(digits), packet[:4] + packet[end:]
+
+
+def address_message(data: bytes, address: int) -> bytes:
+    """
+    Tag every packet in data with a unit address for a shared bus.
+
+    ASCII lines become $XXX@<n>,..., binary frames are rebuilt with
+    BIN_TYPE_ADDRESSED and the address byte. Packets already tagged are
+    left as they are; BUS_ADDR_NONE returns data unchanged.
+
+    Args:
+        data: One or more encoded messages (create_* output)
+        address: Unit address (1-254) or BUS_ADDR_BROADCAST
+    """
+    if address == BUS_ADDR_NONE:
+        return data
+
+    out = bytearray()
+    tag = f"@{int(address)}".encode("ascii")
+    i = 0
+    while i < len(data):
+        if data[i] == 0:
+            i += 1
+            continue
+
+        if data[i] == ord("$"):
+            end = data.find(b"\n", i)
+            end = len(data) if end < 0 else end + 1
+            line = data[i:end]
+            out += line[:4] + tag + line[4:] if line[4:5] == b"," else line
+            i = end
+            continue
+
+        end = data.find(BIN_DELIMITER, i)
+        end = len(data) if end < 0 else end
+        parsed = parse_frame(data[i:end])
+        if parsed is None or parsed[0] & BIN_TYPE_ADDRESSED:
+            out += BIN_DELIMITER + data[i:end] + BIN_DELIMITER
+        else:
+            frame_type, payload = parsed
+            out += build_frame(frame_type | BIN_TYPE_ADDRESSED, bytes((address,)) + payload)
+        i = end + 1
+    return bytes(out)
+
+
+@dataclass
+class Keyframe:
+    """One timeline keyframe (see esp32/src/timeline.h)."""
+
+    device: int  # TIMELINE_DEV_*
+    time_ms: int  # Offset from sequence start (0-65535)
+    mode: int  # NPM_MODE_* / NPR_MODE_* / RGB_MODE_* for the device
+    r: int = 0
+    g: int = 0
+    b: int = 0
+    r2: int = 0
+    g2: int = 0
+    b2: int = 0
+    speed: int = 10
+    easing: int = TIMELINE_EASE_STEP  # Approach from the device's previous keyframe
+    letter: str = "A"  # NPM letter / scroll text ID
 
 
 @dataclass
@@ -86,6 +502,9 @@ class StatusPacket:
     valve_open: int = 0  # 1 when valve is open
     valve_enabled: int = 1  # 0 when emergency stop active
     valve_ms: int = 0  # How long valve has been open (ms)
+    limit_chatter: int = 0  # Limit switch edges that did not change state (wraps at 65536)
+    binary: bool = False  # True if received as a binary frame
+    delta: bool = False  # True if rebuilt from a delta on top of the last status
 
     @classmethod
     def decode(cls, data: bytes) -> Optional["StatusPacket"]:
@@ -111,8 +530,8 @@ class StatusPacket:
             content = line[5:]  # Remove "$STS,"
             fields = content.split(",")
 
-            # Format: limit, servo1, servo2, servo3, light_state, flags, test_active, valve_open, valve_enabled, valve_ms
-            # Minimum 6 fields, maximum 10 (backwards compatible)
+            # Format: limit, servo1, servo2, servo3, light_state, flags, test_active, valve_open, valve_enabled, valve_ms, chatter
+            # Minimum 6 fields, maximum 11 (backwards compatible)
             if len(fields) < 6:
                 logger.debug(f"Invalid field count: {len(fields)}")
                 return None
@@ -122,6 +541,7 @@ class StatusPacket:
             valve_open = int(fields[7]) if len(fields) >= 8 else 0
             valve_enabled = int(fields[8]) if len(fields) >= 9 else 1
             valve_ms = int(fields[9]) if len(fields) >= 10 else 0
+            limit_chatter = int(fields[10]) if len(fields) >= 11 else 0
 
             return cls(
                 limit=int(fields[0]),
@@ -136,12 +556,530 @@ class StatusPacket:
                 valve_open=valve_open,
                 valve_enabled=valve_enabled,
                 valve_ms=valve_ms,
+                limit_chatter=limit_chatter,
             )
 
         except (ValueError, UnicodeDecodeError) as e:
             logger.debug(f"Packet decode error: {e}")
             return None
 
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["StatusPacket"]:
+        """
+        Decode a binary STS frame payload.
+
+        Args:
+            payload: Frame payload (already CRC-checked)
+
+        Returns:
+            StatusPacket if the payload has the expected size, None otherwise
+        """
+        if len(payload) != struct.calcsize(BIN_STATUS_FORMAT):
+            logger.debug(f"Invalid binary status size: {len(payload)}")
+            return None
+
+        (limit, s1, s2, s3, light, flags, test,
+         valve_open, valve_enabled, valve_ms, limit_chatter) = struct.unpack(BIN_STATUS_FORMAT, payload)
+
+        return cls(
+            limit=limit,
+            servo_positions=(s1 / 10.0, s2 / 10.0, s3 / 10.0),
+            light_state=light,
+            flags=flags,
+            test_active=test,
+            valve_open=valve_open,
+            valve_enabled=valve_enabled,
+            valve_ms=valve_ms,
+            limit_chatter=limit_chatter,
+            binary=True,
+        )
+
+    def apply_delta(self, values: dict, binary: bool) -> "StatusPacket":
+        """
+        Build the status that results from a delta on top of this one.
+
+        Args:
+            values: Changed fields by STS_DELTA_FIELDS name (angles in tenths)
+            binary: True if the delta arrived as a binary frame
+
+        Returns:
+            New StatusPacket (self is left unchanged)
+        """
+        servos = list(self.servo_positions)
+        for i, name in enumerate(("s1", "s2", "s3")):
+            if name in values:
+                servos[i] = values.pop(name) / 10.0
+        fields = {
+            "limit": self.limit,
+            "light_state": self.light_state,
+            "flags": self.flags,
+            "test_active": self.test_active,
+            "valve_open": self.valve_open,
+            "valve_enabled": self.valve_enabled,
+            "valve_ms": self.valve_ms,
+            "limit_chatter": self.limit_chatter,
+        }
+        fields.update(values)
+        return StatusPacket(
+            servo_positions=(servos[0], servos[1], servos[2]),
+            binary=binary,
+            delta=True,
+            **fields,
+        )
+
+    @staticmethod
+    def decode_delta(data: bytes) -> Optional[dict]:
+        """
+        Decode an ASCII $STD line into its changed fields.
+
+        Returns:
+            Field values by STS_DELTA_FIELDS name, None if invalid
+        """
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$STD,"):
+                return None
+            fields = line[5:].split(",")
+            mask = int(fields[0], 16)
+            names = [name for bit, (name, _) in enumerate(STS_DELTA_FIELDS) if mask & (1 << bit)]
+            if len(fields) - 1 != len(names):
+                logger.debug(f"Invalid delta field count: {line}")
+                return None
+            return {name: int(value) for name, value in zip(names, fields[1:])}
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Delta decode error: {e}")
+            return None
+
+    @staticmethod
+    def decode_delta_binary(payload: bytes) -> Optional[dict]:
+        """Decode a binary STD frame payload. Returns None if invalid."""
+        if len(payload) < 2:
+            return None
+        (mask,) = struct.unpack_from("<H", payload)
+        selected = [(name, code) for bit, (name, code) in enumerate(STS_DELTA_FIELDS) if mask & (1 << bit)]
+        fmt = "<" + "".join(code for _, code in selected)
+        if len(payload) - 2 != struct.calcsize(fmt):
+            logger.debug(f"Invalid binary delta size: {len(payload)}")
+            return None
+        values = struct.unpack_from(fmt, payload, 2)
+        return {name: value for (name, _), value in zip(selected, values)}
+
+
+@dataclass
+class LatencyPacket:
+    """Link latency report from ESP32 (RX event -> servo target update)."""
+
+    last_us: int
+    avg_us: int
+    max_us: int
+    count: int
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["LatencyPacket"]:
+        """Decode an ASCII $LAT line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$LAT,"):
+                return None
+            fields = [int(f) for f in line[5:].split(",")]
+            if len(fields) != 4:
+                return None
+            return cls(*fields)
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Latency decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["LatencyPacket"]:
+        """Decode a binary LAT frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_LATENCY_FORMAT):
+            return None
+        return cls(*struct.unpack(BIN_LATENCY_FORMAT, payload), binary=True)
+
+
+@dataclass
+class ProfilePacket:
+    """Task profiler report from ESP32 (one report window of one task)."""
+
+    task: int
+    loops: int
+    exec_min_us: int
+    exec_avg_us: int
+    exec_max_us: int
+    overruns: int
+    jitter_max_us: int
+    lock_wait_avg_us: int
+    lock_wait_max_us: int
+    lock_timeouts: int
+    stack_free: int
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["ProfilePacket"]:
+        """Decode an ASCII $PRF line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$PRF,"):
+                return None
+            fields = [int(f) for f in line[5:].split(",")]
+            if len(fields) != 11:
+                return None
+            return cls(*fields)
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Profile decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["ProfilePacket"]:
+        """Decode a binary PRF frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_PROFILE_FORMAT):
+            return None
+        return cls(*struct.unpack(BIN_PROFILE_FORMAT, payload), binary=True)
+
+
+@dataclass
+class SchedulePacket:
+    """
+    LED schedule from ESP32 ($SCH), sent with the profiler reports.
+
+    Frame intervals are what each output's current effect asks for (0 = a
+    static frame, only redrawn when it changes). Core load is the profiled
+    tasks' busy time per core over the report window, in tenths of a percent.
+    """
+
+    npm_ms: int         # NeoPixel matrix
+    npr_ms: int         # NeoPixel ring
+    rgb_ms: int         # RGB strip
+    matrix_ms: int      # MAX7219 matrices
+    render_core: int    # Core the animation task runs on
+    load0_permille: int
+    load1_permille: int
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["SchedulePacket"]:
+        """Decode an ASCII $SCH line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$SCH,"):
+                return None
+            fields = [int(f) for f in line[5:].split(",")]
+            if len(fields) != 7:
+                return None
+            return cls(*fields)
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Schedule decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["SchedulePacket"]:
+        """Decode a binary SCH frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_SCHEDULE_FORMAT):
+            return None
+        return cls(*struct.unpack(BIN_SCHEDULE_FORMAT, payload), binary=True)
+
+
+@dataclass
+class BaudPacket:
+    """Link rate answer from ESP32 ($BDR): the rate it is switching to."""
+
+    baud: int
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["BaudPacket"]:
+        """Decode an ASCII $BDR line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$BDR,"):
+                return None
+            return cls(int(line[5:]))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Baud decode error: {e}")
+            return None
+
+
+@dataclass
+class BootPacket:
+    """
+    Boot report from ESP32 ($BOT), sent whenever the link comes up.
+
+    Stage times are microseconds since reset (0 = stage not finished yet).
+    """
+
+    reset_reason: int
+    valve_us: int       # Valve servo holding the closed pulse
+    control_us: int     # First control tick done
+    link_us: int        # UART link up
+    leds_us: int        # LED drivers initialized
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["BootPacket"]:
+        """Decode an ASCII $BOT line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$BOT,"):
+                return None
+            fields = [int(f) for f in line[5:].split(",")]
+            if len(fields) != 5:
+                return None
+            return cls(*fields)
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Boot decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["BootPacket"]:
+        """Decode a binary BOT frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_BOOT_FORMAT):
+            return None
+        return cls(*struct.unpack(BIN_BOOT_FORMAT, payload), binary=True)
+
+    @property
+    def reset_name(self) -> str:
+        return RESET_REASON_NAMES.get(self.reset_reason, str(self.reset_reason))
+
+
+@dataclass
+class PourPacket:
+    """Result of a metered pour from ESP32 ($PRD), sent when the valve has shut."""
+
+    target_ml: float
+    poured_ml: float    # Including the closing stroke
+    reason: int         # POUR_END_*
+    duration_ms: int    # Valve open to shut (0 if it never opened)
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["PourPacket"]:
+        """Decode an ASCII $PRD line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$PRD,"):
+                return None
+            target, poured, reason, duration = line[5:].split(",")
+            return cls(float(target), float(poured), int(reason), int(duration))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Pour decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["PourPacket"]:
+        """Decode a binary PRD frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_POUR_FORMAT):
+            return None
+        target, poured, reason, duration = struct.unpack(BIN_POUR_FORMAT, payload)
+        return cls(target / 10.0, poured / 10.0, reason, duration, binary=True)
+
+    @property
+    def reason_name(self) -> str:
+        return POUR_END_NAMES.get(self.reason, str(self.reason))
+
+
+@dataclass
+class EchoPacket:
+    """Ping echo from ESP32 (token of the $PNG / PNG frame it answers)."""
+
+    token: int
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["EchoPacket"]:
+        """Decode an ASCII $PNG echo. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$PNG,"):
+                return None
+            return cls(int(line[5:]))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Echo decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["EchoPacket"]:
+        """Decode a binary ECHO frame payload. Returns None if invalid."""
+        if len(payload) != struct.calcsize(BIN_PING_FORMAT):
+            return None
+        return cls(*struct.unpack(BIN_PING_FORMAT, payload), binary=True)
+
+
+@dataclass
+class TxnAbortPacket:
+    """Dropped transaction from ESP32 ($TXA): none of its sub-packets applied."""
+
+    reason: int         # TXN_ABORT_*
+    binary: bool = False
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["TxnAbortPacket"]:
+        """Decode an ASCII $TXA line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$TXA,"):
+                return None
+            return cls(int(line[5:]))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Transaction abort decode error: {e}")
+            return None
+
+    @classmethod
+    def decode_binary(cls, payload: bytes) -> Optional["TxnAbortPacket"]:
+        """Decode a binary TXA frame payload. Returns None if invalid."""
+        if len(payload) != 1:
+            return None
+        return cls(payload[0], binary=True)
+
+    @property
+    def reason_name(self) -> str:
+        return TXN_ABORT_NAMES.get(self.reason, str(self.reason))
+
+
+@dataclass
+class ParamPacket:
+    """
+    Parameter report from ESP32 ($PRM): the value now in effect.
+
+    The end of a read-all is reported as param_id PARAM_ALL, with the schema
+    version in value and the parameter count in flags.
+    """
+
+    param_id: int
+    value: float
+    flags: int
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["ParamPacket"]:
+        """Decode an ASCII $PRM line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$PRM,"):
+                return None
+            param_id, value, flags = line[5:].split(",")
+            return cls(int(param_id), float(value), int(flags))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Param decode error: {e}")
+            return None
+
+
+@dataclass
+class ParamSavePacket:
+    """Parameter store answer from ESP32 ($PSV): action and whether it worked."""
+
+    action: int
+    ok: bool
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["ParamSavePacket"]:
+        """Decode an ASCII $PSV line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$PSV,"):
+                return None
+            action, ok = line[5:].split(",")
+            return cls(int(action), ok == "1")
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Param save decode error: {e}")
+            return None
+
+
+@dataclass
+class TraceInfoPacket:
+    """Trace recorder answer from ESP32 ($TRC): action and buffer state."""
+
+    action: int     # TRACE_*
+    size: int       # Bytes of records held
+    dropped: int    # Records overwritten since the last clear
+    now_us: int     # ESP32 micros() when answered
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["TraceInfoPacket"]:
+        """Decode an ASCII $TRC line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$TRC,"):
+                return None
+            action, size, dropped, now_us = (int(f) for f in line[5:].split(","))
+            return cls(action, size, dropped, now_us)
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Trace info decode error: {e}")
+            return None
+
+
+@dataclass
+class TraceDataPacket:
+    """One line of a trace page from ESP32 ($TRD): bytes at an offset."""
+
+    offset: int
+    data: bytes
+
+    @classmethod
+    def decode(cls, data: bytes) -> Optional["TraceDataPacket"]:
+        """Decode an ASCII $TRD line. Returns None if invalid."""
+        try:
+            line = data.decode("ascii").strip()
+            if not line.startswith("$TRD,"):
+                return None
+            offset, hex_data = line[5:].split(",")
+            return cls(int(offset), bytes.fromhex(hex_data))
+        except (ValueError, UnicodeDecodeError) as e:
+            logger.debug(f"Trace data decode error: {e}")
+            return None
+
+
+@dataclass
+class TraceRecord:
+    """One record of a trace dump."""
+
+    t_us: int
+    type: int       # TRACE_EV_*
+    payload: bytes
+
+    def describe(self) -> str:
+        """Readable one-line form of the record."""
+        p = self.payload
+        if self.type == TRACE_EV_RX and p:
+            verdict = "ok" if p[0] & TRACE_RX_ACCEPTED else "rejected"
+            body = p[1:]
+            if p[0] & TRACE_RX_BINARY:
+                parsed = parse_frame(body)
+                text = f"bin type 0x{parsed[0]:02X} {parsed[1].hex()}" if parsed else f"bin {body.hex()}"
+            else:
+                text = body.decode("ascii", errors="replace")
+            return f"RX {verdict}: {text}"
+        if self.type == TRACE_EV_STATUS and len(p) == 4:
+            kind, binary, mask = struct.unpack("<BBH", p)
+            kind_name = "full" if kind == TRACE_STATUS_FULL else "delta"
+            return f"status {kind_name}{' (binary)' if binary else ''} mask {mask:03X}"
+        if self.type in (TRACE_EV_OVERRUN, TRACE_EV_LOCK_TIMEOUT) and len(p) == 5:
+            task, us = struct.unpack("<BI", p)
+            what = "overrun" if self.type == TRACE_EV_OVERRUN else "lock timeout"
+            return f"{what} task {PRF_TASK_NAMES.get(task, task)}, {us} us"
+        if self.type == TRACE_EV_FAILSAFE and len(p) == 5:
+            task, us = struct.unpack("<BI", p)
+            return f"failsafe: task {PRF_TASK_NAMES.get(task, task)} stalled {us} us, valve shut"
+        return f"type {self.type} {p.hex()}"
+
+
+def decode_trace(data: bytes) -> list[TraceRecord]:
+    """Split a trace dump into records (a truncated last record is dropped)."""
+    records = []
+    header_size = struct.calcsize(TRACE_HEADER_FORMAT)
+    pos = 0
+    while pos + header_size <= len(data):
+        t_us, record_type, length = struct.unpack_from(TRACE_HEADER_FORMAT, data, pos)
+        end = pos + header_size + length
+        if end > len(data):
+            break
+        records.append(TraceRecord(t_us, record_type, bytes(data[pos + header_size:end])))
+        pos = end
+    return records
+
+
+EspPacket = Union[StatusPacket, LatencyPacket, ProfilePacket, BaudPacket, EchoPacket,
+                  ParamPacket, ParamSavePacket, BootPacket, PourPacket,
+                  TraceInfoPacket, TraceDataPacket, SchedulePacket, TxnAbortPacket]
+
 
 class Protocol:
     """
@@ -149,6 +1087,10 @@ class Protocol:
 
     Manages packet encoding/decoding and buffer handling.
     Uses multi-message format for flexible control.
+
+    When binary_tx is set (after the ESP32 has acknowledged $BIN,1 by sending
+    a binary status frame), create_* methods return binary frames instead of
+    ASCII lines. Received data may mix both framings.
     """
 
     START_MARKER = b"$"
@@ -158,6 +1100,30 @@ class Protocol:
     def __init__(self) -> None:
         """Initialize protocol handler."""
         self.rx_buffer = bytearray()
+        self.binary_tx = False
+        self.rx_crc_errors = 0
+        # Last full status per unit address, the base that $STD deltas are applied to
+        self._last_status: dict[int, StatusPacket] = {}
+
+    @staticmethod
+    def _angle_tenths(angle: float) -> int:
+        return int(round(max(0.0, min(180.0, angle)) * 10))
+
+    @staticmethod
+    def describe(packet: bytes) -> str:
+        """Human-readable form of an outgoing packet (for logs/dashboard)."""
+        if packet.startswith(Protocol.START_MARKER):
+            return packet.decode("ascii")
+        parsed = parse_frame(packet.strip(BIN_DELIMITER))
+        if parsed is None:
+            return f"<BIN ? {len(packet)}B>"
+        frame_type, payload = parsed
+        unit = ""
+        if frame_type & BIN_TYPE_ADDRESSED and payload:
+            frame_type &= ~BIN_TYPE_ADDRESSED
+            unit, payload = f"@{payload[0]}", payload[1:]
+        name = BIN_TYPE_NAMES.get(frame_type, f"0x{frame_type:02X}")
+        return f"<BIN {name}{unit} {payload.hex()}>"
 
     # =========================================================================
     # Message Creation Functions
@@ -168,6 +1134,9 @@ class Protocol:
         s1: float,
         s2: float,
         s3: float,
+        velocities: Optional[tuple[float, float, float]] = None,
+        seq: Optional[int] = None,
+        age_ms: int = 0,
     ) -> bytes:
         """
         Create servo target message.
@@ -176,14 +1145,45 @@ class Protocol:
             s1: Servo 1 target angle (0-180)
             s2: Servo 2 target angle (0-180)
             s3: Servo 3 target angle (0-180)
+            velocities: Optional feed-forward target velocities (deg/s); omitted if all zero
+            seq: Optional measurement sequence number; enables ESP32-side prediction
+            age_ms: Age of the measurement at send time (ms), used with seq
 
         Returns:
-            Encoded message bytes: $SRV,<s1>,<s2>,<s3>\n
+            Encoded message bytes: $SRV,<s1>,<s2>,<s3>[,<v1>,<v2>,<v3>[,<seq>,<age_ms>]]\n
         """
         s1 = max(0.0, min(180.0, s1))
         s2 = max(0.0, min(180.0, s2))
         s3 = max(0.0, min(180.0, s3))
-        return f"$SRV,{s1:.1f},{s2:.1f},{s3:.1f}\n".encode("ascii")
+        if velocities is not None and not any(velocities):
+            velocities = None
+        if seq is not None and velocities is None:
+            velocities = (0.0, 0.0, 0.0)  # Timestamped form always carries velocities
+        if velocities is not None:
+            velocities = tuple(max(-3000.0, min(3000.0, v)) for v in velocities)
+        if seq is not None:
+            seq &= 0xFFFF
+            age_ms = max(0, min(0xFFFF, int(age_ms)))
+
+        if self.binary_tx:
+            payload = struct.pack(
+                "<hhh", self._angle_tenths(s1), self._angle_tenths(s2), self._angle_tenths(s3)
+            )
+            if velocities is None:
+                return build_frame(BIN_TYPE_SRV, payload)
+            payload += struct.pack("<hhh", *(int(round(v * 10)) for v in velocities))
+            if seq is None:
+                return build_frame(BIN_TYPE_SRVV, payload)
+            payload += struct.pack("<HH", seq, age_ms)
+            return build_frame(BIN_TYPE_SRVT, payload)
+        if velocities is None:
+            return f"$SRV,{s1:.1f},{s2:.1f},{s3:.1f}\n".encode("ascii")
+        v1, v2, v3 = velocities
+        if seq is None:
+            return f"$SRV,{s1:.1f},{s2:.1f},{s3:.1f},{v1:.1f},{v2:.1f},{v3:.1f}\n".encode("ascii")
+        return (
+            f"$SRV,{s1:.1f},{s2:.1f},{s3:.1f},{v1:.1f},{v2:.1f},{v3:.1f},{seq},{age_ms}\n"
+        ).encode("ascii")
 
     def create_light_message(self, cmd: int) -> bytes:
         """
@@ -196,6 +1196,8 @@ class Protocol:
             Encoded message bytes: $LGT,<cmd>\n
         """
         cmd = max(0, min(2, cmd))
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_LGT, bytes((cmd,)))
         return f"$LGT,{cmd}\n".encode("ascii")
 
     def create_rgb_message(
@@ -234,6 +1236,8 @@ class Protocol:
         b2 = max(0, min(255, b2))
         speed = max(1, min(50, speed))
 
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_RGB, bytes((mode, r, g, b, r2, g2, b2, speed)))
         if mode == RGB_MODE_GRADIENT:
             return f"$RGB,{mode},{r},{g},{b},{r2},{g2},{b2},{speed}\n".encode("ascii")
         return f"$RGB,{mode},{r},{g},{b}\n".encode("ascii")
@@ -249,6 +1253,8 @@ class Protocol:
         Returns:
             Encoded message bytes: $MTX,<left>,<right>\n
         """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_MTX, bytes((left & 0xFF, right & 0xFF)))
         return f"$MTX,{left},{right}\n".encode("ascii")
 
     def create_npm_message(
@@ -290,6 +1296,9 @@ class Protocol:
         # Ensure single character
         letter = letter[0] if letter else "A"
 
+        if self.binary_tx:
+            payload = bytes((mode, ord(letter) & 0xFF, r, g, b, r2, g2, b2, speed))
+            return build_frame(BIN_TYPE_NPM, payload)
         if mode == NPM_MODE_GRADIENT:
             return f"$NPM,{mode},{letter},{r},{g},{b},{r2},{g2},{b2},{speed}\n".encode("ascii")
         return f"$NPM,{mode},{letter},{r},{g},{b}\n".encode("ascii")
@@ -329,6 +1338,8 @@ class Protocol:
         b2 = max(0, min(255, b2))
         speed = max(1, min(50, speed))
 
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_NPR, bytes((mode, r, g, b, r2, g2, b2, speed)))
         if mode == NPR_MODE_GRADIENT:
             return f"$NPR,{mode},{r},{g},{b},{r2},{g2},{b2},{speed}\n".encode("ascii")
         return f"$NPR,{mode},{r},{g},{b}\n".encode("ascii")
@@ -343,6 +1354,8 @@ class Protocol:
         Returns:
             Encoded message bytes: $FLG,<flags>\n
         """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_FLG, bytes((flags & 0xFF,)))
         return f"$FLG,{flags}\n".encode("ascii")
 
     def create_valve_message(self, open: bool) -> bytes:
@@ -355,8 +1368,28 @@ class Protocol:
         Returns:
             Encoded message bytes: $VLV,<open>\n
         """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_VLV, bytes((1 if open else 0,)))
         return f"$VLV,{1 if open else 0}\n".encode("ascii")
 
+    def create_pour_message(self, ml: float) -> bytes:
+        """
+        Create metered pour message.
+
+        The ESP32 opens the valve, closes it itself once the volume is poured
+        and answers with $PRD. A $VLV or 0 ml stops the pour in progress.
+
+        Args:
+            ml: Volume to pour (0 to POUR_MAX_ML, one decimal)
+
+        Returns:
+            Encoded message bytes: $POR,<ml>\n
+        """
+        ml = max(0.0, min(POUR_MAX_ML, ml))
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_POR, struct.pack("<H", round(ml * 10)))
+        return f"$POR,{ml:.1f}\n".encode("ascii")
+
     def create_estop_message(self, enable: bool) -> bytes:
         """
         Create emergency stop message.
@@ -370,13 +1403,317 @@ class Protocol:
         Returns:
             Encoded message bytes: $EST,<enable>\n
         """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_EST, bytes((1 if enable else 0,)))
         return f"$EST,{1 if enable else 0}\n".encode("ascii")
 
+    def create_binary_mode_message(self, enable: bool) -> bytes:
+        """
+        Create link mode negotiation message.
+
+        Always ASCII, so it is understood regardless of the current mode.
+        The ESP32 answers by switching its status packets to binary frames.
+
+        Args:
+            enable: True to request binary mode, False for ASCII
+
+        Returns:
+            Encoded message bytes: $BIN,<enable>\n
+        """
+        return f"$BIN,{1 if enable else 0}\n".encode("ascii")
+
+    def create_transaction_message(self, count: int) -> bytes:
+        """
+        Create transaction header message.
+
+        The ESP32 stages the next `count` packets and applies them to its
+        command state in one commit. If one of them is invalid or not a
+        command packet, or they do not all arrive within 50 ms, none of them
+        is applied and the ESP32 answers $TXA.
+
+        Args:
+            count: Number of packets that follow (1-16)
+
+        Returns:
+            Encoded message bytes: $TXN,<count>\n
+        """
+        count = max(1, min(TXN_MAX_COMMANDS, count))
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_TXN, bytes((count,)))
+        return f"$TXN,{count}\n".encode("ascii")
+
+    def create_telemetry_mode_message(self, delta: bool) -> bytes:
+        """
+        Create status telemetry mode message.
+
+        In delta mode the ESP32 sends a full status every 250 ms and, in
+        between, change-only $STD deltas (limit and valve edges immediately).
+        It acknowledges by setting STS_FLAG_DELTA in its status flags.
+
+        Args:
+            delta: True for keyframes + deltas, False for periodic full status
+
+        Returns:
+            Encoded message bytes: $TLM,<mode>\n
+        """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_TLM, bytes((1 if delta else 0,)))
+        return f"$TLM,{1 if delta else 0}\n".encode("ascii")
+
+    def create_baud_message(self, baud: int) -> bytes:
+        """
+        Create link rate message.
+
+        Always ASCII and sent at the current rate. The ESP32 answers with
+        $BDR,<baud> (its current rate if it refuses) and then switches; it
+        falls back to 115200 unless a valid packet arrives at the new rate.
+
+        Args:
+            baud: Requested rate (115200, 230400, 460800, 921600, 1500000, 2000000)
+
+        Returns:
+            Encoded message bytes: $BDR,<baud>\n
+        """
+        return f"$BDR,{int(baud)}\n".encode("ascii")
+
+    def create_ping_message(self, token: int) -> bytes:
+        """
+        Create ping message, echoed straight back by the ESP32.
+
+        Args:
+            token: Value to echo (31 bits in ASCII, 32 bits in binary)
+
+        Returns:
+            Encoded message bytes: $PNG,<token>\n
+        """
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_PNG, struct.pack(BIN_PING_FORMAT, token & 0xFFFFFFFF))
+        return f"$PNG,{token & 0x7FFFFFFF}\n".encode("ascii")
+
+    def create_param_message(self, param_id: int, value: Optional[float] = None) -> bytes:
+        """
+        Create parameter read or set message (always ASCII).
+
+        The ESP32 answers $PRM,<id>,<value>,<flags> with the value in effect,
+        so a refused set reports the unchanged value. A set is not saved to
+        NVS until create_param_save_message(True).
+
+        Args:
+            param_id: PARAM_* id, or PARAM_ALL to read every parameter
+            value: New value in the parameter's unit (one decimal), None to read
+
+        Returns:
+            Encoded message bytes: $PRM,<id>[,<value>]\n
+        """
+        if value is None:
+            return f"$PRM,{int(param_id)}\n".encode("ascii")
+        return f"$PRM,{int(param_id)},{value:.1f}\n".encode("ascii")
+
+    def create_param_save_message(self, save: bool) -> bytes:
+        """
+        Create parameter store message (always ASCII), answered by $PSV,<action>,<ok>.
+
+        Args:
+            save: True to save every parameter to NVS, False to restore the
+                defaults and erase the saved copy
+
+        Returns:
+            Encoded message bytes: $PSV,<action>\n
+        """
+        return f"$PSV,{1 if save else 0}\n".encode("ascii")
+
+    def create_trace_message(self, action: int, offset: Optional[int] = None) -> bytes:
+        """
+        Create trace recorder message (always ASCII).
+
+        TRACE_PAUSE / TRACE_RESUME / TRACE_CLEAR are answered by
+        $TRC,<action>,<bytes>,<dropped>,<now_us>; TRACE_READ by up to
+        TRACE_PAGE_BYTES of records as $TRD,<offset>,<hex> lines.
+
+        Args:
+            action: TRACE_*
+            offset: Byte offset for TRACE_READ
+
+        Returns:
+            Encoded message bytes: $TRC,<action>[,<offset>]\n
+        """
+        if offset is None:
+            return f"$TRC,{int(action)}\n".encode("ascii")
+        return f"$TRC,{int(action)},{int(offset)}\n".encode("ascii")
+
+    def create_poll_message(self, address: int = BUS_ADDR_BROADCAST, keyframe: bool = False) -> bytes:
+        """
+        Create bus poll message.
+
+        Units on a bus only send status when polled. After a broadcast poll
+        unit n answers (n - 1) reply slots later (BUS_SLOT_US in firmware);
+        a poll addressed to one unit is answered at once.
+
+        Args:
+            address: Unit to poll, or BUS_ADDR_BROADCAST for every unit
+            keyframe: Ask for a full status instead of a delta
+
+        Returns:
+            Encoded message bytes: $POL@<address>,<keyframe>\n
+        """
+        if self.binary_tx:
+            message = build_frame(BIN_TYPE_POL, bytes((1 if keyframe else 0,)))
+        else:
+            message = f"$POL,{1 if keyframe else 0}\n".encode("ascii")
+        return address_message(message, address)
+
+    def create_scroll_text_messages(self, slot: int, text: str) -> list[bytes]:
+        """
+        Create the packets that upload and commit a scroll slot text.
+
+        Args:
+            slot: Slot index (0 to SCROLL_SLOT_COUNT-1)
+            text: Text to scroll (A-Z, space, '?'; truncated to SCROLL_SLOT_DATA_MAX)
+
+        Returns:
+            Encoded messages in send order: $TXT chunks then $SLT,<slot>,1
+        """
+        slot = max(0, min(SCROLL_SLOT_COUNT - 1, slot))
+        data = text.upper().encode("ascii", "replace")[:SCROLL_SLOT_DATA_MAX] or b" "
+
+        packets = []
+        for offset in range(0, len(data), SCROLL_UPLOAD_CHUNK_MAX):
+            chunk = data[offset:offset + SCROLL_UPLOAD_CHUNK_MAX]
+            if self.binary_tx:
+                payload = struct.pack("<BBB", slot, offset, len(chunk))
+                payload += chunk.ljust(SCROLL_UPLOAD_CHUNK_MAX, b"\x00")
+                packets.append(build_frame(BIN_TYPE_TXT, payload))
+            else:
+                packets.append(b"$TXT,%d,%d," % (slot, offset) + chunk + b"\n")
+        packets.append(self.create_scroll_slot_message(slot, SCROLL_SLOT_ACTION_COMMIT))
+        return packets
+
+    def create_scroll_frames_messages(self, slot: int, frames: list[list[int]]) -> list[bytes]:
+        """
+        Create the packets that upload and commit a scroll slot of 5x5 frames.
+
+        Args:
+            slot: Slot index (0 to SCROLL_SLOT_COUNT-1)
+            frames: Up to SCROLL_SLOT_MAX_FRAMES frames of 5 row bitmaps
+                    (top to bottom, bit 4 = leftmost column)
+
+        Returns:
+            Encoded messages in send order: $FRM per frame then $SLT,<slot>,1
+        """
+        slot = max(0, min(SCROLL_SLOT_COUNT - 1, slot))
+
+        packets = []
+        for index, frame in enumerate(frames[:SCROLL_SLOT_MAX_FRAMES]):
+            rows = [(row & 0x1F) for row in (list(frame) + [0] * 5)[:5]]
+            if self.binary_tx:
+                packets.append(build_frame(BIN_TYPE_FRM, bytes([slot, index] + rows)))
+            else:
+                fields = ",".join(str(row) for row in rows)
+                packets.append(f"$FRM,{slot},{index},{fields}\n".encode("ascii"))
+        packets.append(self.create_scroll_slot_message(slot, SCROLL_SLOT_ACTION_COMMIT))
+        return packets
+
+    def create_glyph_message(self, slot: int, rows: list[int]) -> bytes:
+        """
+        Create a NeoPixel matrix user glyph upload message.
+
+        Args:
+            slot: User glyph slot (0 to NPM_USER_GLYPH_COUNT-1)
+            rows: 5 row bitmaps (top to bottom, bit 4 = leftmost column)
+
+        Returns:
+            Encoded message bytes: $GLY,<slot>,<row0>,...,<row4>\n
+        """
+        slot = max(0, min(NPM_USER_GLYPH_COUNT - 1, slot))
+        rows = [(row & 0x1F) for row in (list(rows) + [0] * 5)[:5]]
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_GLY, bytes([slot] + rows))
+        fields = ",".join(str(row) for row in rows)
+        return f"$GLY,{slot},{fields}\n".encode("ascii")
+
+    def create_scroll_slot_message(self, slot: int, action: int) -> bytes:
+        """
+        Create scroll slot control message.
+
+        Args:
+            slot: Slot index (0 to SCROLL_SLOT_COUNT-1)
+            action: SCROLL_SLOT_ACTION_COMMIT or SCROLL_SLOT_ACTION_ERASE
+
+        Returns:
+            Encoded message bytes: $SLT,<slot>,<action>\n
+        """
+        slot = max(0, min(SCROLL_SLOT_COUNT - 1, slot))
+        action = 1 if action else 0
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_SLT, bytes((slot, action)))
+        return f"$SLT,{slot},{action}\n".encode("ascii")
+
+    def create_keyframe_message(self, seq: int, index: int, key: Keyframe) -> bytes:
+        """
+        Create timeline keyframe message.
+
+        Args:
+            seq: Sequence index (0 to TIMELINE_SEQ_COUNT-1)
+            index: Keyframe index (0 starts a new sequence)
+            key: Keyframe to store
+
+        Returns:
+            Encoded message bytes: $KEY,<seq>,<index>,<device>,<time_ms>,<mode>,<letter>,...\n
+        """
+        seq = max(0, min(TIMELINE_SEQ_COUNT - 1, seq))
+        time_ms = max(0, min(0xFFFF, int(key.time_ms)))
+        colors = [max(0, min(255, c)) for c in (key.r, key.g, key.b, key.r2, key.g2, key.b2)]
+        speed = max(1, min(50, key.speed))
+        letter = key.letter[0] if key.letter else "A"
+
+        if self.binary_tx:
+            payload = struct.pack(
+                BIN_KEY_FORMAT, seq, index, key.device, time_ms, key.mode,
+                letter.encode("ascii"), *colors, speed, key.easing,
+            )
+            return build_frame(BIN_TYPE_KEY, payload)
+        fields = ",".join(str(c) for c in colors)
+        return (
+            f"$KEY,{seq},{index},{key.device},{time_ms},{key.mode},{letter},"
+            f"{fields},{speed},{key.easing}\n"
+        ).encode("ascii")
+
+    def create_timeline_messages(self, seq: int, keys: list[Keyframe]) -> list[bytes]:
+        """
+        Create the packets that upload a whole timeline sequence.
+
+        Args:
+            seq: Sequence index (0 to TIMELINE_SEQ_COUNT-1)
+            keys: Up to TIMELINE_SEQ_MAX_KEYS keyframes (sorted by time here)
+
+        Returns:
+            Encoded $KEY messages in send order
+        """
+        ordered = sorted(keys, key=lambda k: k.time_ms)[:TIMELINE_SEQ_MAX_KEYS]
+        return [self.create_keyframe_message(seq, i, k) for i, k in enumerate(ordered)]
+
+    def create_sequence_message(self, seq: int, action: int) -> bytes:
+        """
+        Create timeline trigger message.
+
+        Args:
+            seq: Sequence index (0 to TIMELINE_SEQ_COUNT-1)
+            action: TIMELINE_ACTION_STOP, TIMELINE_ACTION_PLAY or TIMELINE_ACTION_LOOP
+
+        Returns:
+            Encoded message bytes: $SEQ,<seq>,<action>\n
+        """
+        seq = max(0, min(TIMELINE_SEQ_COUNT - 1, seq))
+        action = max(0, min(2, action))
+        if self.binary_tx:
+            return build_frame(BIN_TYPE_SEQ, bytes((seq, action)))
+        return f"$SEQ,{seq},{action}\n".encode("ascii")
+
     # =========================================================================
     # Receive Buffer Handling
     # =========================================================================
 
-    def feed(self, data: bytes) -> list[StatusPacket]:
+    def feed(self, data: bytes) -> list[EspPacket]:
         """
         Feed received data into the protocol buffer.
 
@@ -384,13 +1721,129 @@ class Protocol:
             data: Raw bytes received from UART
 
         Returns:
-            List of complete StatusPackets parsed from buffer
+            List of complete packets (StatusPacket / LatencyPacket / ProfilePacket /
+            BaudPacket / EchoPacket / ParamPacket / ParamSavePacket / BootPacket /
+            PourPacket / TraceInfoPacket / TraceDataPacket / SchedulePacket /
+            TxnAbortPacket)
+        """
+        return [packet for _, packet in self.feed_units(data)]
+
+    def feed_units(self, data: bytes) -> list[tuple[int, EspPacket]]:
+        """
+        Feed received data from a shared bus into the protocol buffer.
+
+        Like feed(), with each packet's unit address (BUS_ADDR_NONE for a
+        unit on a dedicated link). Deltas are applied per unit.
+
+        Returns:
+            List of (address, packet)
         """
         packets = []
 
         self.rx_buffer.extend(data)
 
-        # Prevent buffer overflow
+        # Process complete packets. The first byte of a packet selects the
+        # framing: '$' starts an ASCII line, anything else a COBS frame
+        # (a COBS code byte can never be '$' for frames this short).
+        while self.rx_buffer:
+            # Skip frame delimiters between packets
+            if self.rx_buffer[0] == 0:
+                del self.rx_buffer[0]
+                continue
+
+            if self.rx_buffer[0] == self.START_MARKER[0]:
+                end_idx = self.rx_buffer.find(self.END_MARKER)
+                if end_idx < 0:
+                    # Incomplete packet, wait for more data
+                    break
+
+                packet_data = bytes(self.rx_buffer[: end_idx + 1])
+                self.rx_buffer = self.rx_buffer[end_idx + 1 :]
+                unit, packet_data = split_address(packet_data)
+
+                if packet_data.startswith(b"$LAT,"):
+                    packet = LatencyPacket.decode(packet_data)
+                elif packet_data.startswith(b"$PRF,"):
+                    packet = ProfilePacket.decode(packet_data)
+                elif packet_data.startswith(b"$SCH,"):
+                    packet = SchedulePacket.decode(packet_data)
+                elif packet_data.startswith(b"$STD,"):
+                    packet = self._apply_delta(unit, StatusPacket.decode_delta(packet_data), False)
+                elif packet_data.startswith(b"$PNG,"):
+                    packet = EchoPacket.decode(packet_data)
+                elif packet_data.startswith(b"$BDR,"):
+                    packet = BaudPacket.decode(packet_data)
+                elif packet_data.startswith(b"$PRM,"):
+                    packet = ParamPacket.decode(packet_data)
+                elif packet_data.startswith(b"$PSV,"):
+                    packet = ParamSavePacket.decode(packet_data)
+                elif packet_data.startswith(b"$BOT,"):
+                    packet = BootPacket.decode(packet_data)
+                elif packet_data.startswith(b"$PRD,"):
+                    packet = PourPacket.decode(packet_data)
+                elif packet_data.startswith(b"$TXA,"):
+                    packet = TxnAbortPacket.decode(packet_data)
+                elif packet_data.startswith(b"$TRD,"):
+                    packet = TraceDataPacket.decode(packet_data)
+                elif packet_data.startswith(b"$TRC,"):
+                    packet = TraceInfoPacket.decode(packet_data)
+                else:
+                    packet = self._track_status(unit, StatusPacket.decode(packet_data))
+                if packet:
+                    packets.append((unit, packet))
+                continue
+
+            end_idx = self.rx_buffer.find(BIN_DELIMITER)
+            if end_idx < 0:
+                if len(self.rx_buffer) > BIN_FRAME_MAX_SIZE + 2:
+                    # Not a frame - resync on the next marker
+                    self._resync()
+                    continue
+                break
+
+            encoded = bytes(self.rx_buffer[:end_idx])
+            self.rx_buffer = self.rx_buffer[end_idx + 1 :]
+
+            parsed = parse_frame(encoded)
+            if parsed is None:
+                self.rx_crc_errors += 1
+                logger.debug(f"Binary frame rejected: {encoded.hex()}")
+                # Line noise ahead of an ASCII packet - retry from its '$'
+                start_idx = encoded.find(self.START_MARKER)
+                if start_idx > 0:
+                    self.rx_buffer[0:0] = encoded[start_idx:] + BIN_DELIMITER
+                continue
+
+            frame_type, payload = parsed
+            unit = BUS_ADDR_NONE
+            if frame_type & BIN_TYPE_ADDRESSED and payload:
+                frame_type &= ~BIN_TYPE_ADDRESSED
+                unit, payload = payload[0], payload[1:]
+
+            packet = None
+            if frame_type == BIN_TYPE_STS:
+                packet = self._track_status(unit, StatusPacket.decode_binary(payload))
+            elif frame_type == BIN_TYPE_STD:
+                packet = self._apply_delta(unit, StatusPacket.decode_delta_binary(payload), True)
+            elif frame_type == BIN_TYPE_LAT:
+                packet = LatencyPacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_PRF:
+                packet = ProfilePacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_SCH:
+                packet = SchedulePacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_ECHO:
+                packet = EchoPacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_BOT:
+                packet = BootPacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_PRD:
+                packet = PourPacket.decode_binary(payload)
+            elif frame_type == BIN_TYPE_TXA:
+                packet = TxnAbortPacket.decode_binary(payload)
+            if packet:
+                packets.append((unit, packet))
+
+        # Prevent buffer overflow from an unterminated packet (checked after
+        # decoding, so one large read - a $PRM or $TRC dump - loses nothing)
         if len(self.rx_buffer) > self.MAX_PACKET_SIZE * 2:
             # Find last start marker and discard everything before it
             last_start = self.rx_buffer.rfind(self.START_MARKER)
@@ -399,35 +1852,37 @@ class Protocol:
             else:
                 self.rx_buffer.clear()
 
-        # Process complete packets
-        while True:
-            # Find start marker
-            start_idx = self.rx_buffer.find(self.START_MARKER)
-            if start_idx < 0:
-                self.rx_buffer.clear()
-                break
-
-            # Discard data before start marker
-            if start_idx > 0:
-                self.rx_buffer = self.rx_buffer[start_idx:]
-
-            # Find end marker
-            end_idx = self.rx_buffer.find(self.END_MARKER)
-            if end_idx < 0:
-                # Incomplete packet, wait for more data
-                break
-
-            # Extract packet
-            packet_data = bytes(self.rx_buffer[: end_idx + 1])
-            self.rx_buffer = self.rx_buffer[end_idx + 1 :]
+        return packets
 
-            # Decode packet
-            status = StatusPacket.decode(packet_data)
-            if status:
-                packets.append(status)
+    def _track_status(self, unit: int, packet: Optional[StatusPacket]) -> Optional[StatusPacket]:
+        """Remember a full status as the base for the unit's following deltas."""
+        if packet is not None:
+            self._last_status[unit] = packet
+        return packet
 
-        return packets
+    def _apply_delta(self, unit: int, values: Optional[dict], binary: bool) -> Optional[StatusPacket]:
+        """Merge a decoded delta into the unit's last status (dropped until a keyframe)."""
+        last = self._last_status.get(unit)
+        if values is None or last is None:
+            return None
+        self._last_status[unit] = last.apply_delta(values, binary)
+        return self._last_status[unit]
+
+    def _resync(self) -> None:
+        """Discard buffered bytes up to the next start marker or delimiter."""
+        candidates = [
+            idx for idx in (
+                self.rx_buffer.find(self.START_MARKER, 1),
+                self.rx_buffer.find(BIN_DELIMITER, 1),
+            ) if idx > 0
+        ]
+        if candidates:
+            self.rx_buffer = self.rx_buffer[min(candidates):]
+        else:
+            self.rx_buffer.clear()
 
     def reset(self) -> None:
-        """Reset the protocol buffer."""
+        """Reset the protocol buffer and fall back to ASCII transmit."""
         self.rx_buffer.clear()
+        self.binary_tx = False
+        self._last_status = {}
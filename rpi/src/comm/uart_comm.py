@@ -13,7 +13,13 @@ import sys
 sys.path.append("..")
 import config
 from state import AppState, CommandState
-from .protocol import Protocol
+from .protocol import (
+    BUS_ADDR_BROADCAST, BUS_ADDR_NONE, PARAM_ALL, PARAM_NAMES, POUR_END_CANCEL,
+    POUR_END_TARGET, STS_FLAG_DELTA, STS_FLAG_FAILSAFE, TRACE_CLEAR, TRACE_PAGE_BYTES,
+    TRACE_PAUSE, TRACE_READ, TRACE_RESUME, BaudPacket, BootPacket, EchoPacket, EspPacket,
+    LatencyPacket, ParamPacket, ParamSavePacket, PourPacket, ProfilePacket, Protocol,
+    SchedulePacket, TraceDataPacket, TraceInfoPacket, TxnAbortPacket, address_message,
+)
 
 logger = logging.getLogger(__name__)
 
@@ -39,6 +45,7 @@ class LastSentState:
     npr_g: int = -1
     npr_b: int = -1
     valve_open: bool = False
+    pour_seq: int = 0
     flags: int = -1
 
 
@@ -49,6 +56,8 @@ class MockSerial:
     Simulates ESP32 responses with realistic behavior.
     """
 
+    MOCK_FLOW_ML_PER_S = 25.0  # Flow of a simulated metered pour
+
     def __init__(self) -> None:
         self.is_open = True
         self._rx_buffer = bytearray()
@@ -58,6 +67,8 @@ class MockSerial:
         self._valve_open = 0
         self._valve_enabled = 1
         self._valve_ms = 0
+        self._pour_target = 0.0  # Metered pour in progress (0 = none)
+        self._pour_ml = 0.0
         self._last_update = time.time()
 
     @property
@@ -109,10 +120,21 @@ class MockSerial:
                 # Valve command: $VLV,<open>
                 parts = line[5:].split(",")
                 if len(parts) >= 1:
+                    self._finish_pour(POUR_END_CANCEL)
                     self._valve_open = int(parts[0])
                     if self._valve_open:
                         self._valve_ms = 0  # Reset timer on open
 
+            elif line.startswith("$POR,"):
+                # Metered pour: $POR,<ml> (0 stops the pour in progress)
+                ml = float(line[5:])
+                self._finish_pour(POUR_END_CANCEL)
+                if ml > 0:
+                    self._pour_target = ml
+                    self._pour_ml = 0.0
+                    self._valve_open = 1
+                    self._valve_ms = 0
+
             # Note: $EST (emergency stop) command removed - valve is always enabled
 
         except Exception:
@@ -131,6 +153,17 @@ class MockSerial:
             return target
         return current + (speed if diff > 0 else -speed)
 
+    def _finish_pour(self, reason: int) -> None:
+        """End the metered pour in progress (if any) and report it."""
+        if self._pour_target <= 0:
+            return
+        self._rx_buffer.extend(
+            f"$PRD,{self._pour_target:.1f},{self._pour_ml:.1f},{reason},{self._valve_ms}\n"
+            .encode("ascii")
+        )
+        self._pour_target = 0.0
+        self._valve_open = 0
+
     def _generate_status(self) -> None:
         """Generate periodic status packets."""
         now = time.time()
@@ -139,6 +172,13 @@ class MockSerial:
             if self._valve_open and self._valve_enabled:
                 self._valve_ms += int((now - self._last_update) * 1000)
 
+            # Metered pour at a fully open valve's flow
+            if self._pour_target > 0:
+                self._pour_ml += self.MOCK_FLOW_ML_PER_S * (now - self._last_update)
+                if self._pour_ml >= self._pour_target:
+                    self._pour_ml = self._pour_target
+                    self._finish_pour(POUR_END_TARGET)
+
             # Add some noise to simulate real hardware
             noise = [random.uniform(-0.5, 0.5) for _ in range(3)]
 
@@ -181,6 +221,10 @@ class UartComm(threading.Thread):
         self.mock_mode = config.UART_MOCK_ENABLED
 
         self.serial: Optional[object] = None  # serial.Serial or MockSerial
+
+        # Unit driven on a shared bus (every packet tagged, status polled), or
+        # BUS_ADDR_NONE for a dedicated link
+        self.unit_address = BUS_ADDR_NONE if self.mock_mode else config.UART_UNIT_ADDRESS
         self.tx_interval = 1.0 / config.UART_TX_RATE_HZ
         self.last_tx_time = 0.0
 
@@ -190,6 +234,39 @@ class UartComm(threading.Thread):
         # Flag to force sending all commands (used for shutdown)
         self._force_send_all = False
 
+        # Binary link negotiation ($BIN,1 is re-sent until the ESP32 answers)
+        self.binary_enabled = config.UART_BINARY_PROTOCOL and not self.mock_mode
+        self._last_binary_request = 0.0
+
+        # Delta telemetry negotiation ($TLM,1 is re-sent until STS_FLAG_DELTA shows up)
+        self.delta_enabled = config.UART_DELTA_TELEMETRY and not self.mock_mode
+        self._delta_acked = False
+        self._last_delta_request = 0.0
+
+        # Control loop failsafe reported by the ESP32 (STS_FLAG_FAILSAFE)
+        self._esp_failsafe = False
+
+        # Packets built during one transmit cycle (see _flush_batch)
+        self._tx_batch: list[bytes] = []
+
+        # Link rate ($BDR): current port rate and when the ESP32 was last heard at it
+        self.link_baud = config.UART_BAUDRATE
+        self._last_packet_time = 0.0
+        self._ping_token = 0
+
+        # Packets decoded while waiting for a specific reply (see _await_packet)
+        self._rx_pending: list[EspPacket] = []
+
+        # Last parameter values and flags the ESP32 reported ($PRM), by PARAM_* id
+        self.esp_params: dict[int, float] = {}
+        self.esp_param_flags: dict[int, int] = {}
+
+        # Last boot report ($BOT), sent by the ESP32 whenever the link comes up
+        self.esp_boot: Optional[BootPacket] = None
+
+        # Result of the last metered pour ($PRD)
+        self.esp_last_pour: Optional[PourPacket] = None
+
     def run(self) -> None:
         """Main UART communication loop."""
         mode_str = "MOCK" if self.mock_mode else "HARDWARE"
@@ -223,11 +300,14 @@ class UartComm(threading.Thread):
             return
 
         logger.info("UART connected successfully")
+        self._negotiate_baud()
+        self.sync_params()
 
         while not self.stop_event.is_set():
             try:
                 # Receive data
                 self._receive()
+                self._check_link_rate()
 
                 # Send commands at regular interval
                 now = time.time()
@@ -252,6 +332,9 @@ class UartComm(threading.Thread):
                     if not self._connect():
                         logger.error("UART reconnection failed")
                         time.sleep(5.0)  # Wait longer before next attempt
+                    else:
+                        self._negotiate_baud()
+                        self.sync_params()
 
         self._disconnect()
         logger.info("UART communication thread stopped")
@@ -288,6 +371,8 @@ class UartComm(threading.Thread):
             # Use default DTR/RTS settings (like hardware_test.py)
             # This allows ESP32 to reset when serial port closes
             self.protocol.reset()
+            self.link_baud = config.UART_BAUDRATE
+            self._rx_pending = []
             return True
 
         except ImportError:
@@ -391,7 +476,24 @@ class UartComm(threading.Thread):
         """
         self._force_send_all = True
         # Reset last sent state to force all values to be sent
-        self._last_sent = LastSentState()
+        # (except pours, which must never be repeated)
+        self._last_sent = LastSentState(pour_seq=self._last_sent.pour_seq)
+
+    def _write(self, data: bytes) -> None:
+        """Send encoded messages to this app's unit (tagged with its bus address)."""
+        self.serial.write(address_message(data, self.unit_address))
+
+    def broadcast(self, messages: list[bytes]) -> None:
+        """
+        Send messages to every unit on the bus at once (e.g. a $SEQ that starts
+        the same light show everywhere). Broadcasts are never answered.
+        """
+        if not self.serial:
+            return
+        data = address_message(b"".join(messages), BUS_ADDR_BROADCAST)
+        self.serial.write(data)
+        for message in messages:
+            self.state.increment_uart_tx(self.protocol.describe(message))
 
     def _receive(self) -> None:
         """Receive and process data from UART."""
@@ -399,76 +501,622 @@ class UartComm(threading.Thread):
             return
 
         try:
-            # Read available data
-            if self.serial.in_waiting > 0:
-                data = self.serial.read(self.serial.in_waiting)
-
-                # Log raw received data for debugging
-                logger.debug(f"Raw RX ({len(data)} bytes): {data}")
-
-                # Feed to protocol parser
-                packets = self.protocol.feed(data)
-
-                # Process received packets
-                for packet in packets:
-                    self.state.update_esp_from_packet(
-                        limit=packet.limit,
-                        servo_positions=packet.servo_positions,
-                        light_state=packet.light_state,
-                        flags=packet.flags,
-                        test_active=packet.test_active,
-                        valve_open=packet.valve_open,
-                        valve_enabled=packet.valve_enabled,
-                        valve_ms=packet.valve_ms,
-                    )
-                    rx_str = (
-                        f"$STS,{packet.limit},"
-                        f"{packet.servo_positions[0]:.1f},"
-                        f"{packet.servo_positions[1]:.1f},"
-                        f"{packet.servo_positions[2]:.1f},"
-                        f"{packet.light_state},{packet.flags},{packet.test_active},"
-                        f"{packet.valve_open},{packet.valve_enabled},{packet.valve_ms}"
-                    )
-                    self.state.increment_uart_rx(rx_str)
-                    logger.debug(
-                        f"RX: limit={packet.limit}, servos={packet.servo_positions}, "
-                        f"valve_open={packet.valve_open}, valve_ms={packet.valve_ms}"
-                    )
+            for packet in self._poll_packets():
+                self._handle_packet(packet)
 
         except Exception as e:
             logger.error(f"UART receive error: {e}")
             if not self.mock_mode:
                 raise
 
+    def _poll_packets(self) -> list[EspPacket]:
+        """Read whatever has arrived and decode it (packets set aside by _await_packet first)."""
+        packets = self._rx_pending
+        self._rx_pending = []
+
+        if self.serial.in_waiting > 0:
+            data = self.serial.read(self.serial.in_waiting)
+
+            # Log raw received data for debugging
+            logger.debug(f"Raw RX ({len(data)} bytes): {data}")
+
+            # Feed to protocol parser (on a bus, only this app's unit)
+            if self.unit_address == BUS_ADDR_NONE:
+                packets.extend(self.protocol.feed(data))
+            else:
+                packets.extend(packet for unit, packet in self.protocol.feed_units(data)
+                               if unit == self.unit_address)
+
+        if packets:
+            self._last_packet_time = time.time()
+        return packets
+
+    def _handle_packet(self, packet: EspPacket) -> None:
+        """Apply one received packet to the application state."""
+        if isinstance(packet, ParamPacket):
+            if packet.param_id != PARAM_ALL:
+                self.esp_params[packet.param_id] = packet.value
+                self.esp_param_flags[packet.param_id] = packet.flags
+            return
+
+        if isinstance(packet, (BaudPacket, EchoPacket, ParamSavePacket,
+                               TraceInfoPacket, TraceDataPacket)):
+            # Only meaningful to whoever is waiting for it (_await_packet)
+            logger.debug(f"RX unsolicited {packet}")
+            return
+
+        if isinstance(packet, BootPacket):
+            self.esp_boot = packet
+            logger.info(
+                f"ESP32 boot ({packet.reset_name} reset): valve closed at "
+                f"{packet.valve_us / 1000:.1f}ms, first control tick "
+                f"{packet.control_us / 1000:.1f}ms, link {packet.link_us / 1000:.1f}ms, "
+                f"LEDs {packet.leds_us / 1000:.1f}ms"
+            )
+            return
+
+        if isinstance(packet, TxnAbortPacket):
+            # None of that cycle's commands applied: send everything again
+            # (but never repeat a pour)
+            logger.warning(f"ESP32 dropped a transaction ({packet.reason_name})")
+            self._last_sent = LastSentState(pour_seq=self._last_sent.pour_seq)
+            return
+
+        if isinstance(packet, PourPacket):
+            self.esp_last_pour = packet
+            logger.info(
+                f"Pour done ({packet.reason_name}): {packet.poured_ml:.1f} of "
+                f"{packet.target_ml:.1f}ml in {packet.duration_ms}ms"
+            )
+            return
+
+        if isinstance(packet, LatencyPacket):
+            self.state.update_esp_latency(
+                packet.last_us, packet.avg_us, packet.max_us
+            )
+            logger.debug(
+                f"RX LAT: last={packet.last_us}us avg={packet.avg_us}us "
+                f"max={packet.max_us}us n={packet.count}"
+            )
+            return
+
+        if isinstance(packet, ProfilePacket):
+            self.state.update_esp_profile(
+                packet.task,
+                loops=packet.loops,
+                exec_min_us=packet.exec_min_us,
+                exec_avg_us=packet.exec_avg_us,
+                exec_max_us=packet.exec_max_us,
+                overruns=packet.overruns,
+                jitter_max_us=packet.jitter_max_us,
+                lock_wait_avg_us=packet.lock_wait_avg_us,
+                lock_wait_max_us=packet.lock_wait_max_us,
+                lock_timeouts=packet.lock_timeouts,
+                stack_free=packet.stack_free,
+            )
+            return
+
+        if isinstance(packet, SchedulePacket):
+            self.state.update_esp_schedule(
+                npm_ms=packet.npm_ms,
+                npr_ms=packet.npr_ms,
+                rgb_ms=packet.rgb_ms,
+                matrix_ms=packet.matrix_ms,
+                render_core=packet.render_core,
+                core_load=(packet.load0_permille / 10.0, packet.load1_permille / 10.0),
+            )
+            return
+
+        self._track_link_mode(packet.binary)
+        self._track_telemetry_mode(packet.flags)
+        self._track_failsafe(packet.flags)
+        flags = packet.flags & ~STS_FLAG_DELTA
+        self.state.update_esp_from_packet(
+            limit=packet.limit,
+            servo_positions=packet.servo_positions,
+            light_state=packet.light_state,
+            flags=flags,
+            test_active=packet.test_active,
+            valve_open=packet.valve_open,
+            valve_enabled=packet.valve_enabled,
+            valve_ms=packet.valve_ms,
+            limit_chatter=packet.limit_chatter,
+        )
+        rx_str = (
+            f"$STS,{packet.limit},"
+            f"{packet.servo_positions[0]:.1f},"
+            f"{packet.servo_positions[1]:.1f},"
+            f"{packet.servo_positions[2]:.1f},"
+            f"{packet.light_state},{flags},{packet.test_active},"
+            f"{packet.valve_open},{packet.valve_enabled},{packet.valve_ms},"
+            f"{packet.limit_chatter}"
+        )
+        self.state.increment_uart_rx(rx_str)
+        logger.debug(
+            f"RX: limit={packet.limit}, servos={packet.servo_positions}, "
+            f"valve_open={packet.valve_open}, valve_ms={packet.valve_ms}"
+        )
+
+    def _track_link_mode(self, received_binary: bool) -> None:
+        """Switch transmit framing to match what the ESP32 is sending."""
+        if not self.binary_enabled:
+            return
+
+        if received_binary and not self.protocol.binary_tx:
+            logger.info("ESP32 acknowledged binary mode")
+            self.protocol.binary_tx = True
+            # Re-send everything in the new framing (but never repeat a pour)
+            self._last_sent = LastSentState(pour_seq=self._last_sent.pour_seq)
+        elif not received_binary and self.protocol.binary_tx:
+            # ESP32 dropped back to ASCII (reset or connection timeout)
+            logger.warning("ESP32 reverted to ASCII status, renegotiating")
+            self.protocol.binary_tx = False
+            self._last_binary_request = 0.0
+
+    def _track_telemetry_mode(self, flags: int) -> None:
+        """Follow whether the ESP32 is sending deltas (it drops them on disconnect)."""
+        if not self.delta_enabled:
+            return
+
+        acked = bool(flags & STS_FLAG_DELTA)
+        if acked and not self._delta_acked:
+            logger.info("ESP32 acknowledged delta telemetry")
+        elif not acked and self._delta_acked:
+            logger.warning("ESP32 reverted to periodic status, renegotiating")
+            self._last_delta_request = 0.0
+        self._delta_acked = acked
+
+    def _track_failsafe(self, flags: int) -> None:
+        """Log the ESP32's control loop failsafe going on and off."""
+        failsafe = bool(flags & STS_FLAG_FAILSAFE)
+        if failsafe and not self._esp_failsafe:
+            logger.error("ESP32 control loop stalled: valve forced shut, re-send $VLV to reopen")
+        elif not failsafe and self._esp_failsafe:
+            logger.info("ESP32 control loop recovered")
+        self._esp_failsafe = failsafe
+
+    def _request_delta_telemetry(self) -> None:
+        """Ask the ESP32 for keyframe + delta telemetry (rate limited)."""
+        now = time.time()
+        if now - self._last_delta_request < config.UART_BINARY_RETRY_S:
+            return
+
+        packet = self.protocol.create_telemetry_mode_message(True)
+        self._write(packet)
+        self.state.increment_uart_tx(self.protocol.describe(packet))
+        self._last_delta_request = now
+        logger.debug("TX TLM: 1")
+
+    def _request_binary_mode(self) -> None:
+        """Ask the ESP32 to switch to binary frames (rate limited)."""
+        now = time.time()
+        if now - self._last_binary_request < config.UART_BINARY_RETRY_S:
+            return
+
+        packet = self.protocol.create_binary_mode_message(True)
+        self._write(packet)
+        self.state.increment_uart_tx(self.protocol.describe(packet))
+        self._last_binary_request = now
+        logger.debug("TX BIN: 1")
+
+    # -------------------------------------------------------------------------
+    # Link rate negotiation and benchmark
+    # -------------------------------------------------------------------------
+
+    def _await_packet(self, match, timeout: float) -> Optional[EspPacket]:
+        """
+        Wait for the first received packet that satisfies match.
+
+        Packets that arrive in the meantime are handled as usual; ones decoded
+        after the match are kept for the next poll.
+
+        Returns:
+            The matching packet, or None on timeout
+        """
+        deadline = time.perf_counter() + timeout
+        while True:
+            packets = self._poll_packets()
+            for i, packet in enumerate(packets):
+                if match(packet):
+                    self._rx_pending = packets[i + 1:] + self._rx_pending
+                    return packet
+                self._handle_packet(packet)
+            if time.perf_counter() >= deadline:
+                return None
+            time.sleep(0.0001)
+
+    def _next_ping_token(self) -> int:
+        self._ping_token = (self._ping_token + 1) & 0x7FFFFFFF
+        return self._ping_token
+
+    def ping(self, timeout: float) -> Optional[float]:
+        """
+        Send one $PNG (framed like other commands) and wait for its echo.
+
+        Returns:
+            Round-trip time in seconds, or None if no echo arrived in time
+        """
+        token = self._next_ping_token()
+        packet = self.protocol.create_ping_message(token)
+        start = time.perf_counter()
+        self._write(packet)
+        echo = self._await_packet(
+            lambda p: isinstance(p, EchoPacket) and p.token == token, timeout
+        )
+        if echo is None:
+            return None
+        return time.perf_counter() - start
+
+    def _wait_for_esp(self, timeout: float) -> bool:
+        """Ping until the ESP32 answers (it resets when the port is opened)."""
+        deadline = time.time() + timeout
+        while time.time() < deadline and not self.stop_event.is_set():
+            if self.ping(config.UART_BAUD_ANSWER_TIMEOUT_S) is not None:
+                return True
+        return False
+
+    def _switch_baud(self, baud: int) -> bool:
+        """
+        Try to move both ends of the link to baud.
+
+        Returns:
+            True if a ping round trip succeeded at the new rate
+        """
+        packet = self.protocol.create_baud_message(baud)
+        self._write(packet)
+        self.state.increment_uart_tx(self.protocol.describe(packet))
+        answer = self._await_packet(
+            lambda p: isinstance(p, BaudPacket), config.UART_BAUD_ANSWER_TIMEOUT_S
+        )
+        if answer is None or answer.baud != baud:
+            logger.info(f"ESP32 declined {baud} baud")
+            return False
+
+        self.serial.baudrate = baud
+        self.protocol.rx_buffer.clear()
+        # The ESP32 keeps the rate once it sees a valid packet at it
+        for _ in range(3):
+            if self.ping(config.UART_BAUD_ANSWER_TIMEOUT_S / 3) is not None:
+                self.link_baud = baud
+                return True
+
+        # Not confirmed: the ESP32 reverts on its own, follow it back
+        self._fall_back_to_boot_rate()
+        time.sleep(config.UART_BAUD_FALLBACK_S)
+        self.serial.reset_input_buffer()
+        self.protocol.rx_buffer.clear()
+        return False
+
+    def _fall_back_to_boot_rate(self) -> None:
+        self.serial.baudrate = config.UART_BAUDRATE
+        self.link_baud = config.UART_BAUDRATE
+        self.protocol.rx_buffer.clear()
+
+    def _negotiate_baud(self, rates: Optional[tuple[int, ...]] = None) -> None:
+        """
+        Move the link to the first rate in rates (default UART_LINK_BAUDRATES)
+        that survives a ping round trip; stays at UART_BAUDRATE if none does,
+        or if the firmware does not answer pings at all.
+        """
+        rates = config.UART_LINK_BAUDRATES if rates is None else rates
+        # Units sharing a bus would have to switch together, and a broadcast
+        # $BDR cannot be confirmed - a bus stays at UART_BAUDRATE
+        if self.unit_address != BUS_ADDR_NONE:
+            rates = ()
+        if self.mock_mode or not self.serial or not rates:
+            return
+
+        if not self._wait_for_esp(config.UART_BAUD_NEGOTIATE_S):
+            logger.warning(f"ESP32 does not answer pings, staying at {self.link_baud} baud")
+            return
+
+        for baud in rates:
+            if baud == self.link_baud or self._switch_baud(baud):
+                logger.info(f"UART link running at {baud} baud")
+                return
+        logger.warning(f"No faster link rate confirmed, staying at {self.link_baud} baud")
+
+    def _check_link_rate(self) -> None:
+        """Start over from the boot rate when the ESP32 went quiet at a negotiated one."""
+        if self.mock_mode or self.link_baud == config.UART_BAUDRATE:
+            return
+        if time.time() - self._last_packet_time < config.UART_LINK_LOST_S:
+            return
+
+        logger.warning(f"Nothing received at {self.link_baud} baud, renegotiating")
+        self._fall_back_to_boot_rate()
+        self.protocol.reset()
+        self._negotiate_baud()
+        self._last_packet_time = time.time()
+
+    # -------------------------------------------------------------------------
+    # Tuned parameters ($PRM / $PSV)
+    # -------------------------------------------------------------------------
+
+    def read_params(self) -> Optional[dict[int, float]]:
+        """
+        Read every parameter from the ESP32 (into esp_params).
+
+        Returns:
+            Values by PARAM_* id, or None if the read-all did not complete
+        """
+        self.esp_params.clear()
+        self._write(self.protocol.create_param_message(PARAM_ALL))
+        # Each report lands in esp_params via _handle_packet; the terminator ends it
+        end = self._await_packet(
+            lambda p: isinstance(p, ParamPacket) and p.param_id == PARAM_ALL,
+            config.UART_PARAM_ANSWER_TIMEOUT_S,
+        )
+        if end is None or len(self.esp_params) != end.flags:
+            return None
+        return dict(self.esp_params)
+
+    def set_param(self, param_id: int, value: float) -> Optional[float]:
+        """
+        Set one parameter (live, not saved until save_params).
+
+        Returns:
+            Value now in effect (unchanged if the ESP32 refused), or None on timeout
+        """
+        self._write(self.protocol.create_param_message(param_id, value))
+        answer = self._await_packet(
+            lambda p: isinstance(p, ParamPacket) and p.param_id == param_id,
+            config.UART_PARAM_ANSWER_TIMEOUT_S,
+        )
+        if answer is None:
+            return None
+        self._handle_packet(answer)
+        return answer.value
+
+    def save_params(self, save: bool = True) -> bool:
+        """
+        Save every parameter to the ESP32's NVS, or (save=False) restore its defaults.
+
+        Returns:
+            True if the ESP32 reported success
+        """
+        action = 1 if save else 0
+        self._write(self.protocol.create_param_save_message(save))
+        # NVS writes take a few tens of ms
+        answer = self._await_packet(
+            lambda p: isinstance(p, ParamSavePacket) and p.action == action,
+            config.UART_PARAM_ANSWER_TIMEOUT_S * 5,
+        )
+        return answer is not None and answer.ok
+
+    def _trace_action(self, action: int) -> Optional[TraceInfoPacket]:
+        """Send a $TRC pause / resume / clear and wait for its answer."""
+        self._write(self.protocol.create_trace_message(action))
+        return self._await_packet(
+            lambda p: isinstance(p, TraceInfoPacket) and p.action == action,
+            config.UART_PARAM_ANSWER_TIMEOUT_S,
+        )
+
+    def _read_trace_page(self, offset: int, length: int) -> Optional[bytes]:
+        """Read one $TRC page; None if a line went missing."""
+        self._write(self.protocol.create_trace_message(TRACE_READ, offset))
+        page = bytearray()
+        while len(page) < length:
+            line = self._await_packet(
+                lambda p: isinstance(p, TraceDataPacket),
+                config.UART_PARAM_ANSWER_TIMEOUT_S,
+            )
+            if line is None or line.offset != offset + len(page):
+                return None
+            page.extend(line.data)
+        return bytes(page)
+
+    def read_trace(self, clear: bool = False) -> Optional[tuple[bytes, TraceInfoPacket]]:
+        """
+        Dump the ESP32 trace recorder.
+
+        Recording is paused while the buffer is paged out (a page at a time,
+        retried if a line is lost), then resumed; with clear the buffer is
+        emptied as well, so the next dump only has what came after.
+
+        Returns:
+            The record stream (comm.protocol.decode_trace) and the buffer
+            state at the pause, or None if the ESP32 did not answer
+        """
+        info = self._trace_action(TRACE_PAUSE)
+        if info is None:
+            return None
+
+        data = bytearray()
+        try:
+            while len(data) < info.size:
+                length = min(TRACE_PAGE_BYTES, info.size - len(data))
+                for _ in range(3):
+                    page = self._read_trace_page(len(data), length)
+                    if page is not None:
+                        break
+                    time.sleep(config.UART_PARAM_ANSWER_TIMEOUT_S)
+                    self._poll_packets()    # Drop the rest of the bad page
+                else:
+                    return None
+                data.extend(page)
+        finally:
+            self._trace_action(TRACE_CLEAR if clear else TRACE_RESUME)
+        return bytes(data), info
+
+    def sync_params(self, desired: Optional[dict[str, float]] = None) -> bool:
+        """
+        Bring the ESP32 parameters to desired (default config.ESP_PARAMS).
+
+        The ESP32 boots with its saved values, so only the ones that differ
+        are sent, and saved; a unit already tuned costs one read-all.
+
+        Returns:
+            True if every desired value is in effect
+        """
+        desired = config.ESP_PARAMS if desired is None else desired
+        if self.mock_mode or not self.serial or not desired:
+            return True
+
+        ids = {name: param_id for param_id, name in PARAM_NAMES.items()}
+        current = self.read_params()
+        if current is None:
+            logger.warning("ESP32 did not report its parameters, leaving them alone")
+            return False
+
+        changed = False
+        ok = True
+        for name, value in desired.items():
+            param_id = ids.get(name)
+            if param_id is None:
+                logger.warning(f"Unknown ESP32 parameter {name}")
+                ok = False
+                continue
+            if abs(current.get(param_id, float("nan")) - value) < 0.05:
+                continue
+            applied = self.set_param(param_id, value)
+            if applied is None or abs(applied - value) >= 0.05:
+                logger.warning(f"ESP32 refused {name}={value} (now {applied})")
+                ok = False
+                continue
+            logger.info(f"ESP32 parameter {name} set to {applied}")
+            changed = True
+
+        if changed and not self.save_params():
+            logger.warning("ESP32 parameters applied but not saved")
+            ok = False
+        return ok
+
+    def run_link_benchmark(
+        self, count: int = 500, seconds: float = 5.0, window: int = 8, timeout: float = 0.1
+    ) -> dict:
+        """
+        Measure the link with $PNG echoes on an open, idle connection.
+
+        Latency: count pings one at a time, round-trip percentiles.
+        Throughput: for `seconds`, keep `window` pings in flight and count
+        echoes. Status telemetry keeps flowing meanwhile, as in normal use.
+        Pings use binary frames when protocol.binary_tx is set.
+
+        Returns:
+            Results (times in ms, rates per second)
+        """
+        rtts = []
+        lost = 0
+        for _ in range(count):
+            rtt = self.ping(timeout)
+            if rtt is None:
+                lost += 1
+            else:
+                rtts.append(rtt * 1000.0)
+        rtts.sort()
+
+        def percentile(pct: float) -> float:
+            if not rtts:
+                return 0.0
+            return rtts[min(len(rtts) - 1, int(len(rtts) * pct / 100.0))]
+
+        in_flight: dict[int, float] = {}
+        echoes = 0
+        tx_bytes = 0
+        start = time.perf_counter()
+        end = start + seconds
+        while time.perf_counter() < end:
+            now = time.perf_counter()
+            # Drop pings that will never be answered so the window keeps moving
+            for token in [t for t, sent in in_flight.items() if now - sent > timeout]:
+                del in_flight[token]
+            while len(in_flight) < window:
+                token = self._next_ping_token()
+                packet = self.protocol.create_ping_message(token)
+                self._write(packet)
+                tx_bytes += len(packet)
+                in_flight[token] = now
+            for packet in self._poll_packets():
+                if isinstance(packet, EchoPacket):
+                    if in_flight.pop(packet.token, None) is not None:
+                        echoes += 1
+                else:
+                    self._handle_packet(packet)
+            time.sleep(0.0001)
+        elapsed = time.perf_counter() - start
+
+        return {
+            "baud": self.link_baud,
+            "binary": self.protocol.binary_tx,
+            "pings": count,
+            "lost": lost,
+            "rtt_p50_ms": percentile(50),
+            "rtt_p90_ms": percentile(90),
+            "rtt_p99_ms": percentile(99),
+            "rtt_max_ms": rtts[-1] if rtts else 0.0,
+            "window": window,
+            "echoes_per_s": echoes / elapsed,
+            "tx_bytes_per_s": tx_bytes / elapsed,
+        }
+
     def _transmit(self) -> None:
         """Send command messages to ESP32."""
         if not self.serial:
             return
 
         try:
+            if self.binary_enabled and not self.protocol.binary_tx:
+                self._request_binary_mode()
+            if self.delta_enabled and not self._delta_acked:
+                self._request_delta_telemetry()
+
             # Get current command state
             command = self.state.get_command()
 
             # Always send servo command as heartbeat
+            self._tx_batch = []
             self._send_servo_message(command)
 
             # Send other messages only on change
             self._send_if_changed(command)
 
+            self._flush_batch()
+
         except Exception as e:
             logger.error(f"UART transmit error: {e}")
             if not self.mock_mode:
                 raise
 
+    def _flush_batch(self) -> None:
+        """
+        Write this cycle's packets in one go.
+
+        Several packets are wrapped in a transaction so the ESP32 applies them
+        together (a multi-device change never shows up half-applied).
+        """
+        packets = self._tx_batch
+        self._tx_batch = []
+        if not packets:
+            return
+
+        if len(packets) > 1:
+            packets.insert(0, self.protocol.create_transaction_message(len(packets)))
+        # On a bus the unit only sends status when polled (outside the transaction)
+        if self.unit_address != BUS_ADDR_NONE:
+            packets.append(self.protocol.create_poll_message(self.unit_address))
+        self._write(b"".join(packets))
+        for packet in packets:
+            self.state.increment_uart_tx(self.protocol.describe(packet))
+
     def _send_servo_message(self, command: CommandState) -> None:
         """Send servo target message (always sent as heartbeat)."""
+        # Timestamped targets let the ESP32 extrapolate over the link latency;
+        # the age is taken right before the write so it includes our own delays
+        seq = None
+        age_ms = 0
+        if command.servo_capture_time > 0.0:
+            seq = command.servo_seq
+            age_ms = int((time.time() - command.servo_capture_time) * 1000)
         packet = self.protocol.create_servo_message(
             command.servo_targets[0],
             command.servo_targets[1],
             command.servo_targets[2],
+            command.servo_velocities,
+            seq=seq,
+            age_ms=age_ms,
         )
-        self.serial.write(packet)
-        self.state.increment_uart_tx(packet.decode("ascii"))
+        self._tx_batch.append(packet)
         logger.debug(f"TX SRV: {command.servo_targets}")
 
     def _send_if_changed(self, command: CommandState) -> None:
@@ -478,8 +1126,7 @@ class UartComm(threading.Thread):
         # Light command
         if command.light_command != last.light_command:
             packet = self.protocol.create_light_message(command.light_command)
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.light_command = command.light_command
             logger.debug(f"TX LGT: {command.light_command}")
 
@@ -491,8 +1138,7 @@ class UartComm(threading.Thread):
             packet = self.protocol.create_rgb_message(
                 command.rgb_mode, command.rgb_r, command.rgb_g, command.rgb_b
             )
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.rgb_mode = command.rgb_mode
             last.rgb_r = command.rgb_r
             last.rgb_g = command.rgb_g
@@ -505,8 +1151,7 @@ class UartComm(threading.Thread):
             packet = self.protocol.create_matrix_message(
                 command.matrix_left, command.matrix_right
             )
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.matrix_left = command.matrix_left
             last.matrix_right = command.matrix_right
             logger.debug(f"TX MTX: ({command.matrix_left},{command.matrix_right})")
@@ -521,8 +1166,7 @@ class UartComm(threading.Thread):
                 command.npm_mode, command.npm_letter,
                 command.npm_r, command.npm_g, command.npm_b
             )
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.npm_mode = command.npm_mode
             last.npm_letter = command.npm_letter
             last.npm_r = command.npm_r
@@ -538,8 +1182,7 @@ class UartComm(threading.Thread):
             packet = self.protocol.create_npr_message(
                 command.npr_mode, command.npr_r, command.npr_g, command.npr_b
             )
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.npr_mode = command.npr_mode
             last.npr_r = command.npr_r
             last.npr_g = command.npr_g
@@ -549,15 +1192,20 @@ class UartComm(threading.Thread):
         # Valve (simplified: just open/close, no estop)
         if command.valve_open != last.valve_open:
             packet = self.protocol.create_valve_message(command.valve_open)
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.valve_open = command.valve_open
             logger.debug(f"TX VLV: {command.valve_open}")
 
+        # Metered pour: each request is sent once; the ESP32 closes the valve
+        if command.pour_seq != last.pour_seq:
+            packet = self.protocol.create_pour_message(command.pour_ml)
+            self._tx_batch.append(packet)
+            last.pour_seq = command.pour_seq
+            logger.debug(f"TX POR: {command.pour_ml:.1f}ml")
+
         # Flags (for LED test, etc.)
         if command.flags != last.flags:
             packet = self.protocol.create_flags_message(command.flags)
-            self.serial.write(packet)
-            self.state.increment_uart_tx(packet.decode("ascii"))
+            self._tx_batch.append(packet)
             last.flags = command.flags
             logger.debug(f"TX FLG: {command.flags}")
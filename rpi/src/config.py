@@ -169,11 +169,38 @@ else:
 UART_PORT = _auto_detect_serial_port()
 print(f"[Config] Using UART port: {UART_PORT}")
 
-UART_BAUDRATE = 115200
+UART_BAUDRATE = 115200  # Boot rate of the ESP32 (the link starts here)
 UART_TIMEOUT = 0.01  # seconds
 UART_TX_RATE_HZ = 30
 UART_CONNECTION_TIMEOUT_MS = 500
 
+# Compact binary framed protocol (negotiated with $BIN,1; ASCII still accepted)
+UART_BINARY_PROTOCOL = True
+UART_BINARY_RETRY_S = 1.0  # Re-send $BIN,1 until the ESP32 answers in binary
+
+# Delta telemetry: ESP32 sends change-only status deltas between keyframes
+UART_DELTA_TELEMETRY = True
+
+# Link rate negotiation ($BDR): try each rate in order, keep the first one a
+# ping round trip confirms; an empty tuple stays at UART_BAUDRATE
+UART_LINK_BAUDRATES = (921600, 460800, 230400)
+UART_BAUD_ANSWER_TIMEOUT_S = 0.2  # Wait for the $BDR answer / ping echo
+UART_BAUD_FALLBACK_S = 0.4  # ESP32 reverts an unconfirmed rate after 300 ms
+UART_BAUD_NEGOTIATE_S = 3.0  # How long to wait for the ESP32 to boot and answer
+UART_LINK_LOST_S = 1.5  # Silence at a negotiated rate before starting over at UART_BAUDRATE
+
+# Shared RS-485 bus (esp32 BUS_ENABLED): unit_address of the unit this app
+# drives, 0 for a dedicated USB link. On a bus every packet is tagged with it,
+# the unit is polled ($POL) each TX cycle and the link stays at UART_BAUDRATE
+UART_UNIT_ADDRESS = 0
+
+# ESP32 tuned parameters ($PRM, saved in its NVS): after connecting, only the
+# values that differ from what the ESP32 reports are sent, then saved. Keys are
+# names from comm.protocol.PARAM_NAMES, e.g. {"valve_max_open_ms": 8000}.
+# Empty leaves the ESP32 settings alone (tune them with tools/esp_params.py).
+ESP_PARAMS = {}
+UART_PARAM_ANSWER_TIMEOUT_S = 0.2  # Wait for a $PRM / $PSV answer
+
 # Enable mock UART for testing without hardware
 UART_MOCK_ENABLED = False  # Set True to simulate ESP32 responses
 
@@ -220,6 +247,7 @@ TRACKING_MIN_WIDTH_RATIO = 0.06 # Min face width ratio to track (0.15 = 15% of f
 # Dispensing / Pour Settings
 # -----------------------------------------------------------------------------
 POUR_DURATION = 2.0           # How long valve stays open when limit switch pressed (seconds)
+POUR_VOLUME_ML = 50.0         # Metered pour: ESP32 closes the valve at this volume ($POR; 0 = time it with POUR_DURATION)
 DISPENSE_FLASH_DURATION = 2.0 # How long aqua flash continues after dispense (seconds)
 REJECT_FLASH_DURATION = 1.0   # How long red flash on reject/repeat press (seconds)
 DISPENSE_HOLD_DURATION = 1.0  # How long limit switch must be held to start dispense (seconds)
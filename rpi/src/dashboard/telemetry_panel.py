@@ -2,6 +2,7 @@
 
 from __future__ import annotations
 
+from collections import deque
 from dataclasses import dataclass
 from typing import Optional, Tuple, TYPE_CHECKING
 
@@ -11,7 +12,7 @@ import numpy as np
 import sys
 sys.path.append("..")
 import config
-from state import FaceState, EspState, CommandState, SystemState
+from state import ESP_TASK_NAMES, FaceState, EspState, CommandState, SystemState
 
 if TYPE_CHECKING:
     from state_machine import StateMachine
@@ -66,6 +67,11 @@ class TelemetryPanel:
     MARGIN = 15
     LABEL_WIDTH = 140
 
+    # Profiler graph
+    PROFILE_HISTORY = 60           # Reports kept (1 Hz -> one minute)
+    PROFILE_GRAPH_HEIGHT = 40
+    PROFILE_TASK_COLORS = {0: (200, 160, 80), 1: (200, 100, 200), 2: (80, 200, 240)}
+
     # Button layout
     BUTTON_HEIGHT = 28
     BUTTON_WIDTH = 120
@@ -112,6 +118,12 @@ class TelemetryPanel:
         self.content_height = 0  # Will be calculated during render
         self.scroll_speed = 30  # Pixels per scroll tick
 
+        # ESP32 profiler history (one sample per $PRF report, per task)
+        self.profile_history: dict[int, deque] = {
+            task: deque(maxlen=self.PROFILE_HISTORY) for task in ESP_TASK_NAMES
+        }
+        self._profile_seen: dict[int, float] = {}
+
     def scroll(self, direction: int) -> None:
         """
         Scroll the panel content.
@@ -164,7 +176,7 @@ class TelemetryPanel:
         self.text_fields = []
 
         # Create a larger buffer for content (will be cropped to viewport)
-        buffer_height = max(self.height, 1200)  # Ensure enough space for all content
+        buffer_height = max(self.height, 1500)  # Ensure enough space for all content
         panel = np.zeros((buffer_height, self.width, 3), dtype=np.uint8)
         panel[:] = config.COLOR_PANEL_BG
 
@@ -205,6 +217,8 @@ class TelemetryPanel:
             limit_text = "CW" if esp.limit_direction == 1 else "CCW"
             limit_color = config.COLOR_FACING_NO
         y = self._draw_value(panel, "Limit", limit_text, y, limit_color)
+        if esp.limit_chatter:
+            y = self._draw_value(panel, "Chatter", f"{esp.limit_chatter} edges", y)
 
         y += self.SECTION_SPACING // 2
 
@@ -253,6 +267,10 @@ class TelemetryPanel:
                              config.COLOR_FACING_YES if esp.connected else config.COLOR_FACING_NO)
         y = self._draw_value(panel, "UART TX", str(system.uart_tx_count), y)
         y = self._draw_value(panel, "UART RX", str(system.uart_rx_count), y)
+        y = self._draw_value(
+            panel, "Link Lat",
+            f"{esp.rx_latency_avg_us / 1000:.1f} ms (max {esp.rx_latency_max_us / 1000:.1f})", y
+        )
 
         # Uptime
         uptime_str = self._format_uptime(system.uptime)
@@ -260,6 +278,11 @@ class TelemetryPanel:
 
         y += self.SECTION_SPACING // 2
 
+        # ESP32 task profiler section ($PRF)
+        y = self._draw_profiler_section(panel, y, esp)
+
+        y += self.SECTION_SPACING // 2
+
         # UART Packets section (for debugging)
         y = self._draw_section_header(panel, "UART PACKETS", y)
         # Truncate packets if too long
@@ -774,6 +797,85 @@ class TelemetryPanel:
 
         return y + 2 * (button_height + spacing) + 5
 
+    def _draw_profiler_section(
+        self,
+        panel: np.ndarray,
+        y: int,
+        esp: EspState,
+    ) -> int:
+        """Draw ESP32 task timing from $PRF reports and return new y position."""
+        y = self._draw_section_header(panel, "ESP PROFILER", y)
+
+        if not esp.task_profiles:
+            return self._draw_value(panel, "Status", "No $PRF reports", y, (128, 128, 128))
+
+        for task, name in ESP_TASK_NAMES.items():
+            profile = esp.task_profiles.get(task)
+            if profile is None:
+                continue
+
+            # Record one sample per report for the graph
+            if self._profile_seen.get(task) != profile.timestamp:
+                self._profile_seen[task] = profile.timestamp
+                self.profile_history[task].append(profile.exec_max_us)
+
+            late = profile.overruns > 0 or profile.lock_timeouts > 0
+            color = config.COLOR_FACING_NO if late else config.COLOR_TEXT
+            y = self._draw_value(
+                panel, f"{name} exec",
+                f"{profile.exec_avg_us}/{profile.exec_max_us} us  jit {profile.jitter_max_us}", y, color
+            )
+            y = self._draw_value(
+                panel, f"{name} lock",
+                f"{profile.lock_wait_max_us} us  to:{profile.lock_timeouts} "
+                f"ovr:{profile.overruns} stk:{profile.stack_free}", y, color
+            )
+
+        # LED scheduler ($SCH): frame interval per output, "-" for static
+        sched = esp.led_schedule
+        if sched is not None:
+            rates = "  ".join(
+                f"{name}:{ms if ms else '-'}"
+                for name, ms in (("npm", sched.npm_ms), ("npr", sched.npr_ms),
+                                 ("rgb", sched.rgb_ms), ("mtx", sched.matrix_ms))
+            )
+            y = self._draw_value(panel, "LED ms", rates, y)
+            y = self._draw_value(
+                panel, "Core load",
+                f"c0 {sched.core_load[0]:.1f}%  c1 {sched.core_load[1]:.1f}%  "
+                f"LEDs on c{sched.render_core}", y
+            )
+
+        return self._draw_profile_graph(panel, y)
+
+    def _draw_profile_graph(self, panel: np.ndarray, y: int) -> int:
+        """Draw max execution time history for each task and return new y position."""
+        x0 = self.MARGIN + 10
+        width = self.width - 2 * self.MARGIN - 10
+        height = self.PROFILE_GRAPH_HEIGHT
+
+        cv2.rectangle(panel, (x0, y), (x0 + width, y + height), (60, 60, 60), -1)
+
+        # Common scale across tasks so they can be compared directly
+        peak = max((max(h) for h in self.profile_history.values() if h), default=0)
+        if peak <= 0:
+            return y + height + 5
+
+        step = width / max(1, self.PROFILE_HISTORY - 1)
+        for task, history in self.profile_history.items():
+            if len(history) < 2:
+                continue
+            points = np.array([
+                (int(x0 + i * step), int(y + height - 1 - (value / peak) * (height - 2)))
+                for i, value in enumerate(history)
+            ], dtype=np.int32)
+            cv2.polylines(panel, [points], False, self.PROFILE_TASK_COLORS.get(task, (200, 200, 200)), 1)
+
+        cv2.putText(panel, f"{peak} us", (x0 + 4, y + 12),
+                    cv2.FONT_HERSHEY_SIMPLEX, 0.35, (150, 150, 150), 1)
+
+        return y + height + 5
+
     def _draw_servo_bar(
         self,
         panel: np.ndarray,
@@ -21,6 +21,9 @@ NPM_MODES = [
     (5, "Eye Closed"),
     (6, "Eye Open"),
     (9, "Gradient"),
+    (11, "Breathe"),
+    (12, "Chase"),
+    (13, "Spinner"),
 ]
 
 # NeoPixel Ring modes (8 LED ring)
@@ -39,6 +42,7 @@ RGB_MODES = [
     (0, "Solid Color"),
     (1, "Rainbow"),
     (2, "Gradient"),
+    (3, "Breathe"),
 ]
 
 
@@ -213,6 +213,7 @@ class VisionThread(threading.Thread):
                     frame_brightness=frame_brightness,
                     frame_variance=frame_variance,
                     camera_connected=True,
+                    capture_time=frame_start,
                 )
             else:
                 # Process frame with face tracker (same as vision_servo_test.py)
@@ -245,6 +246,7 @@ class VisionThread(threading.Thread):
                         frame_brightness=frame_brightness,
                         frame_variance=frame_variance,
                         camera_connected=True,
+                        capture_time=frame_start,
                     )
                 else:
                     self.state.update_face(
@@ -256,6 +258,7 @@ class VisionThread(threading.Thread):
                         frame_brightness=frame_brightness,
                         frame_variance=frame_variance,
                         camera_connected=True,
+                        capture_time=frame_start,
                     )
 
             # Update FPS (same as vision_servo_test.py)
@@ -318,7 +321,10 @@ class StateMachineThread(threading.Thread):
         self.state.set_command(
             servo_target_1=commands.get("servo_target_1", 90.0),
             servo_target_2=commands.get("servo_target_2", 90.0),
+            servo_velocities=(commands.get("servo_velocity_1", 0.0), 0.0, 0.0),
+            servo_capture_time=commands.get("servo_capture_time"),
             valve_open=commands.get("valve_open", False),
+            pour_ml=commands.get("pour_ml"),
             rgb_mode=commands.get("rgb_mode", 0),
             rgb_r=commands.get("rgb_r", 0),
             rgb_g=commands.get("rgb_g", 0),
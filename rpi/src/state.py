@@ -38,6 +38,7 @@ class FaceState:
     is_facing: bool = False
     confidence: float = 0.0
     timestamp: float = 0.0
+    capture_time: float = 0.0  # When the detection's frame was grabbed (time.time())
     # Multi-face tracking
     num_faces: int = 0  # Total faces detected
     num_facing: int = 0  # Number of faces looking at camera
@@ -68,6 +69,40 @@ class FaceState:
         # Note: processed_frame and frame dimensions are NOT cleared
 
 
+# Profiled ESP32 task indices (PRF_TASK_* in esp32/src/profiler.h)
+ESP_TASK_NAMES = {0: "Comm", 1: "Anim", 2: "Ctrl"}
+
+
+@dataclass
+class EspTaskProfile:
+    """One $PRF report window for an ESP32 RTOS task."""
+
+    loops: int = 0
+    exec_min_us: int = 0
+    exec_avg_us: int = 0
+    exec_max_us: int = 0
+    overruns: int = 0
+    jitter_max_us: int = 0
+    lock_wait_avg_us: int = 0
+    lock_wait_max_us: int = 0
+    lock_timeouts: int = 0
+    stack_free: int = 0
+    timestamp: float = 0.0
+
+
+@dataclass
+class EspLedSchedule:
+    """Last $SCH report: LED frame intervals and per-core load on the ESP32."""
+
+    npm_ms: int = 0  # Frame interval per output (0 = static, redrawn on change)
+    npr_ms: int = 0
+    rgb_ms: int = 0
+    matrix_ms: int = 0
+    render_core: int = 0  # Core the LED rendering runs on
+    core_load: tuple[float, float] = (0.0, 0.0)  # Profiled busy time per core (%)
+    timestamp: float = 0.0
+
+
 @dataclass
 class EspState:
     """State received from ESP32."""
@@ -82,7 +117,16 @@ class EspState:
     valve_open: bool = False  # True when valve is currently open
     valve_enabled: bool = True  # False when emergency stop active
     valve_ms: int = 0  # How long valve has been open (ms)
+    limit_chatter: int = 0  # Limit switch chatter edges reported by the ESP32
     last_rx_time: float = 0.0
+    # Link latency ($LAT): UART RX event -> servo target update on the ESP32
+    rx_latency_us: int = 0
+    rx_latency_avg_us: int = 0
+    rx_latency_max_us: int = 0
+    # Task profiler ($PRF), keyed by PRF_TASK_* index
+    task_profiles: dict[int, EspTaskProfile] = field(default_factory=dict)
+    # LED scheduler ($SCH), None until the first report
+    led_schedule: Optional[EspLedSchedule] = None
 
     def update_from_packet(
         self,
@@ -94,6 +138,7 @@ class EspState:
         valve_open: int = 0,
         valve_enabled: int = 1,
         valve_ms: int = 0,
+        limit_chatter: int = 0,
     ) -> None:
         """Update state from received packet."""
         self.connected = True
@@ -106,8 +151,23 @@ class EspState:
         self.valve_open = valve_open == 1
         self.valve_enabled = valve_enabled == 1
         self.valve_ms = valve_ms
+        self.limit_chatter = limit_chatter
         self.last_rx_time = time.time()
 
+    def update_latency(self, last_us: int, avg_us: int, max_us: int) -> None:
+        """Update link latency from a $LAT report."""
+        self.rx_latency_us = last_us
+        self.rx_latency_avg_us = avg_us
+        self.rx_latency_max_us = max_us
+
+    def update_profile(self, task: int, **fields) -> None:
+        """Replace one task's profile from a $PRF report."""
+        self.task_profiles[task] = EspTaskProfile(timestamp=time.time(), **fields)
+
+    def update_schedule(self, **fields) -> None:
+        """Replace the LED schedule from a $SCH report."""
+        self.led_schedule = EspLedSchedule(timestamp=time.time(), **fields)
+
     def check_connection(self, timeout_ms: float) -> None:
         """Check if connection is still active."""
         if time.time() - self.last_rx_time > timeout_ms / 1000.0:
@@ -119,6 +179,9 @@ class CommandState:
     """Commands to send to ESP32."""
 
     servo_targets: tuple[float, float, float] = (90.0, 90.0, 90.0)  # 3 servos
+    servo_velocities: tuple[float, float, float] = (0.0, 0.0, 0.0)  # Feed-forward (deg/s)
+    servo_capture_time: float = 0.0  # When the targets were measured (0 = untimestamped)
+    servo_seq: int = 0  # Measurement sequence, advances with servo_capture_time
     light_command: int = 2  # Default to AUTO
     flags: int = 0
     # RGB strip
@@ -142,6 +205,9 @@ class CommandState:
     npr_b: int = 255
     # Valve control (simplified: just open/close, auto-closes after 5s)
     valve_open: bool = False
+    # Metered pour: volume of the latest request, pour_seq counts requests
+    pour_ml: float = 0.0
+    pour_seq: int = 0
 
 
 @dataclass
@@ -232,6 +298,7 @@ class AppState:
         frame_brightness: float = 0.0,
         frame_variance: float = 0.0,
         camera_connected: bool = True,
+        capture_time: Optional[float] = None,
     ) -> None:
         """Thread-safe face state update."""
         with self._lock:
@@ -252,6 +319,9 @@ class AppState:
             self._face.frame_variance = frame_variance
             self._face.camera_connected = camera_connected
             self._face.timestamp = time.time()
+            self._face.capture_time = (
+                capture_time if capture_time is not None else self._face.timestamp
+            )
             # Store the frame this detection was made on (for synchronized display)
             if processed_frame is not None:
                 self._face.processed_frame = processed_frame.copy()
@@ -271,6 +341,7 @@ class AppState:
                 is_facing=self._face.is_facing,
                 confidence=self._face.confidence,
                 timestamp=self._face.timestamp,
+                capture_time=self._face.capture_time,
                 num_faces=self._face.num_faces,
                 num_facing=self._face.num_facing,
                 frame_width=self._face.frame_width,
@@ -305,12 +376,13 @@ class AppState:
         valve_open: int = 0,
         valve_enabled: int = 1,
         valve_ms: int = 0,
+        limit_chatter: int = 0,
     ) -> None:
         """Thread-safe ESP state update from received packet."""
         with self._lock:
             self._esp.update_from_packet(
                 limit, servo_positions, light_state, flags,
-                test_active, valve_open, valve_enabled, valve_ms
+                test_active, valve_open, valve_enabled, valve_ms, limit_chatter
             )
 
     def get_esp(self) -> EspState:
@@ -327,9 +399,30 @@ class AppState:
                 valve_open=self._esp.valve_open,
                 valve_enabled=self._esp.valve_enabled,
                 valve_ms=self._esp.valve_ms,
+                limit_chatter=self._esp.limit_chatter,
                 last_rx_time=self._esp.last_rx_time,
+                rx_latency_us=self._esp.rx_latency_us,
+                rx_latency_avg_us=self._esp.rx_latency_avg_us,
+                rx_latency_max_us=self._esp.rx_latency_max_us,
+                task_profiles=dict(self._esp.task_profiles),
+                led_schedule=self._esp.led_schedule,
             )
 
+    def update_esp_latency(self, last_us: int, avg_us: int, max_us: int) -> None:
+        """Thread-safe ESP link latency update."""
+        with self._lock:
+            self._esp.update_latency(last_us, avg_us, max_us)
+
+    def update_esp_profile(self, task: int, **fields) -> None:
+        """Thread-safe ESP task profile update."""
+        with self._lock:
+            self._esp.update_profile(task, **fields)
+
+    def update_esp_schedule(self, **fields) -> None:
+        """Thread-safe ESP LED schedule update."""
+        with self._lock:
+            self._esp.update_schedule(**fields)
+
     def check_esp_connection(self, timeout_ms: float) -> None:
         """Thread-safe ESP connection check."""
         with self._lock:
@@ -345,6 +438,8 @@ class AppState:
         servo_target_1: Optional[float] = None,
         servo_target_2: Optional[float] = None,
         servo_target_3: Optional[float] = None,
+        servo_velocities: Optional[tuple[float, float, float]] = None,
+        servo_capture_time: Optional[float] = None,
         light_command: Optional[int] = None,
         flags: Optional[int] = None,
         rgb_mode: Optional[int] = None,
@@ -363,6 +458,7 @@ class AppState:
         npr_g: Optional[int] = None,
         npr_b: Optional[int] = None,
         valve_open: Optional[bool] = None,
+        pour_ml: Optional[float] = None,
     ) -> None:
         """Thread-safe command update."""
         with self._lock:
@@ -378,6 +474,15 @@ class AppState:
                 if servo_target_3 is not None:
                     targets[2] = servo_target_3
                 self._command.servo_targets = tuple(targets)
+            if servo_velocities is not None:
+                self._command.servo_velocities = servo_velocities
+            if (
+                servo_capture_time is not None
+                and servo_capture_time != self._command.servo_capture_time
+            ):
+                # New measurement; resends of the same one keep their seq
+                self._command.servo_capture_time = servo_capture_time
+                self._command.servo_seq = (self._command.servo_seq + 1) & 0xFFFF
             if light_command is not None:
                 self._command.light_command = light_command
             if flags is not None:
@@ -414,12 +519,19 @@ class AppState:
                 self._command.npr_b = npr_b
             if valve_open is not None:
                 self._command.valve_open = valve_open
+            if pour_ml is not None:
+                # Every request is sent, even a repeat of the same volume
+                self._command.pour_ml = pour_ml
+                self._command.pour_seq += 1
 
     def get_command(self) -> CommandState:
         """Thread-safe command retrieval (returns copy)."""
         with self._lock:
             return CommandState(
                 servo_targets=self._command.servo_targets,
+                servo_velocities=self._command.servo_velocities,
+                servo_capture_time=self._command.servo_capture_time,
+                servo_seq=self._command.servo_seq,
                 light_command=self._command.light_command,
                 flags=self._command.flags,
                 rgb_mode=self._command.rgb_mode,
@@ -438,6 +550,8 @@ class AppState:
                 npr_g=self._command.npr_g,
                 npr_b=self._command.npr_b,
                 valve_open=self._command.valve_open,
+                pour_ml=self._command.pour_ml,
+                pour_seq=self._command.pour_seq,
             )
 
     def set_command_flag(self, flag: int) -> None:
@@ -541,6 +655,7 @@ class AppState:
                 is_facing=self._face.is_facing,
                 confidence=self._face.confidence,
                 timestamp=self._face.timestamp,
+                capture_time=self._face.capture_time,
                 num_faces=self._face.num_faces,
                 num_facing=self._face.num_facing,
                 is_dark=self._face.is_dark,
@@ -560,11 +675,20 @@ class AppState:
                 valve_open=self._esp.valve_open,
                 valve_enabled=self._esp.valve_enabled,
                 valve_ms=self._esp.valve_ms,
+                limit_chatter=self._esp.limit_chatter,
                 last_rx_time=self._esp.last_rx_time,
+                rx_latency_us=self._esp.rx_latency_us,
+                rx_latency_avg_us=self._esp.rx_latency_avg_us,
+                rx_latency_max_us=self._esp.rx_latency_max_us,
+                task_profiles=dict(self._esp.task_profiles),
+                led_schedule=self._esp.led_schedule,
             )
 
             command = CommandState(
                 servo_targets=self._command.servo_targets,
+                servo_velocities=self._command.servo_velocities,
+                servo_capture_time=self._command.servo_capture_time,
+                servo_seq=self._command.servo_seq,
                 light_command=self._command.light_command,
                 flags=self._command.flags,
                 rgb_mode=self._command.rgb_mode,
@@ -583,6 +707,8 @@ class AppState:
                 npr_g=self._command.npr_g,
                 npr_b=self._command.npr_b,
                 valve_open=self._command.valve_open,
+                pour_ml=self._command.pour_ml,
+                pour_seq=self._command.pour_seq,
             )
 
             self._system.update_uptime()
@@ -112,6 +112,7 @@ class StateMachineConfig:
     alive_entry_duration: float = 2.0     # Entry animation duration
     dead_entry_duration: float = 2.0      # Entry animation duration
     dispense_duration: float = None       # How long valve stays open
+    dispense_volume_ml: float = None      # Metered pour volume (0 = time the pour)
     dispense_flash_duration: float = None # How long to flash during dispense
     reject_flash_duration: float = None   # How long to flash on reject
     dispense_hold_duration: float = None  # How long to hold switch before dispense
@@ -152,6 +153,8 @@ class StateMachineConfig:
         # Dispense settings
         if self.dispense_duration is None:
             self.dispense_duration = getattr(config, 'POUR_DURATION', 3.0)
+        if self.dispense_volume_ml is None:
+            self.dispense_volume_ml = getattr(config, 'POUR_VOLUME_ML', 0.0)
         if self.dispense_flash_duration is None:
             self.dispense_flash_duration = getattr(config, 'DISPENSE_FLASH_DURATION', 2.0)
         if self.reject_flash_duration is None:
@@ -182,6 +185,7 @@ class StateMachine:
 
         # Tracking state
         self.tracking_base_position: float = 90.0
+        self._last_tracking_time: float = 0.0  # For feed-forward velocity (deg/s)
 
         # Arm wave state
         self.arm_wave_position: float = 90.0
@@ -199,6 +203,8 @@ class StateMachine:
         # Timing for behaviors
         self._dispense_start: float = 0.0
         self._reject_start: float = 0.0
+        self._pour_requested: bool = False  # $POR sent for the current dispense
+        self._pour_cancel: bool = False     # Stop the metered pour on the next tick
         self._limit_switch_hold_start: float = 0.0  # When limit switch was first pressed
 
         # Outcome
@@ -485,6 +491,7 @@ class StateMachine:
                         # Held long enough while facing - start dispense
                         self._has_dispensed = True
                         self._dispense_start = time.time()
+                        self._pour_requested = False
                         self._limit_switch_hold_start = 0  # Reset for next time
                         return AliveBehavior.DISPENSING
                     # Still holding, not long enough yet - continue with normal behavior
@@ -548,12 +555,22 @@ class StateMachine:
         """ALIVE detected: Green if facing, yellow-green if not facing."""
         # Update tracking position
         velocity = self._calculate_tracking_velocity_from_position(face)
+        previous_position = self.tracking_base_position
         self.tracking_base_position += velocity
         self.tracking_base_position = max(
             self.config.tracking_base_min,
             min(self.config.tracking_base_max, self.tracking_base_position)
         )
 
+        # Feed-forward: how fast the target moves, so the ESP32 planner can
+        # pursue it instead of lagging behind each step
+        tick_time = time.time()
+        dt = tick_time - self._last_tracking_time
+        self._last_tracking_time = tick_time
+        base_velocity = 0.0
+        if 0.0 < dt < 0.2:
+            base_velocity = (self.tracking_base_position - previous_position) / dt
+
         # Periodic arm wave - triggers every arm_wave_interval seconds
         arm_pos = 90.0
         now = time.time()
@@ -575,6 +592,8 @@ class StateMachine:
             return self._make_commands(
                 servo_target_1=self.tracking_base_position,
                 servo_target_2=arm_pos,
+                servo_velocity_1=base_velocity,
+                servo_capture_time=face.capture_time,
                 valve_open=False,
                 npm_mode=NPM_EYE_OPEN,
                 npm_r=0, npm_g=255, npm_b=0,  # Green
@@ -588,6 +607,8 @@ class StateMachine:
             return self._make_commands(
                 servo_target_1=self.tracking_base_position,
                 servo_target_2=arm_pos,
+                servo_velocity_1=base_velocity,
+                servo_capture_time=face.capture_time,
                 valve_open=False,
                 npm_mode=NPM_EYE_OPEN,
                 npm_r=180, npm_g=255, npm_b=0,  # Yellow-green
@@ -606,8 +627,16 @@ class StateMachine:
             # _has_dispensed was already set at start of dispense
             self._dispense_start = 0
 
-        # Valve open only for the actual pour duration
-        valve_open = self.dispensing_enabled and (dispense_elapsed < self.config.dispense_duration)
+        # Metered pours are closed by the ESP32 at the volume; otherwise the
+        # valve is open only for the pour duration
+        pour_ml = None
+        if self.config.dispense_volume_ml > 0:
+            valve_open = False
+            if self.dispensing_enabled and not self._pour_requested:
+                pour_ml = self.config.dispense_volume_ml
+                self._pour_requested = True
+        else:
+            valve_open = self.dispensing_enabled and (dispense_elapsed < self.config.dispense_duration)
 
         # Fast flashing aqua/cyan (8Hz for obvious blink, full on/off)
         flash = int(time.time() * 8) % 2 == 0
@@ -617,6 +646,7 @@ class StateMachine:
             servo_target_1=self.tracking_base_position,
             servo_target_2=90.0,
             valve_open=valve_open,
+            pour_ml=pour_ml,
             npm_mode=NPM_EYE_OPEN,  # Open eyes = dispensing (not X)
             npm_r=0, npm_g=brightness, npm_b=brightness,  # Aqua flash
             npr_mode=NPR_SOLID,
@@ -823,7 +853,10 @@ class StateMachine:
         self,
         servo_target_1: float = 90.0,
         servo_target_2: float = 90.0,
+        servo_velocity_1: float = 0.0,
+        servo_capture_time: Optional[float] = None,
         valve_open: bool = False,
+        pour_ml: Optional[float] = None,
         rgb_mode: int = RGB_SOLID,
         rgb_r: int = 0,
         rgb_g: int = 0,
@@ -850,10 +883,21 @@ class StateMachine:
 
         actual_valve_open = valve_open or self._manual_valve_open
 
+        # A new metered pour (or 0 to stop one), sent once
+        if self._pour_cancel:
+            pour_ml = 0.0
+            self._pour_cancel = False
+
         return {
             "servo_target_1": servo_target_1,
             "servo_target_2": servo_target_2,
+            "servo_velocity_1": servo_velocity_1,
+            # Generated targets are "measured" now; tracking passes the frame time
+            "servo_capture_time": (
+                servo_capture_time if servo_capture_time is not None else time.time()
+            ),
             "valve_open": actual_valve_open,
+            "pour_ml": pour_ml,
             "rgb_mode": rgb_mode,
             "rgb_r": rgb_r,
             "rgb_g": rgb_g,
@@ -889,6 +933,7 @@ class StateMachine:
     def emergency_stop(self) -> None:
         """Emergency stop - disable dispensing."""
         self.dispensing_enabled = False
+        self._pour_cancel = True
 
     def enable_dispensing(self) -> None:
         """Re-enable dispensing after emergency stop."""
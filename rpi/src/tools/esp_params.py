@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+ESP32 parameter tool.
+
+Reads and tunes the parameters the ESP32 keeps in NVS ($PRM / $PSV), so
+servo limits, valve timing, brightness and task periods can be changed
+without a rebuild. Sets are live immediately; add --save to keep them
+across resets. Run it with the main app stopped.
+
+Examples:
+    python tools/esp_params.py list
+    python tools/esp_params.py set valve_max_open_ms 8000 --save
+    python tools/esp_params.py get servo_max_velocity
+    python tools/esp_params.py reset                    # defaults, NVS erased
+"""
+
+import argparse
+import logging
+import os
+import sys
+import threading
+
+# Add parent directory (rpi/src) to path for imports
+script_dir = os.path.dirname(os.path.abspath(__file__))
+src_dir = os.path.dirname(script_dir)  # rpi/src
+sys.path.insert(0, src_dir)
+
+import config
+from comm.protocol import PARAM_FLAG_REBOOT, PARAM_NAMES
+from comm.uart_comm import UartComm
+from state import AppState
+
+
+def param_id(name: str) -> int:
+    for pid, pname in PARAM_NAMES.items():
+        if pname == name:
+            return pid
+    raise SystemExit(f"Unknown parameter {name} (known: {', '.join(PARAM_NAMES.values())})")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="ESP32 parameter tool")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("list", help="Show every parameter")
+    get = sub.add_parser("get", help="Show one parameter")
+    get.add_argument("name")
+    put = sub.add_parser("set", help="Set one parameter")
+    put.add_argument("name")
+    put.add_argument("value", type=float)
+    put.add_argument("--save", action="store_true", help="Save every parameter to NVS afterwards")
+    sub.add_parser("save", help="Save every parameter to NVS")
+    sub.add_parser("reset", help="Restore the defaults and erase the saved copy")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format="%(levelname)s %(name)s: %(message)s")
+
+    if config.UART_MOCK_ENABLED:
+        print("UART_MOCK_ENABLED is set - no ESP32 to talk to")
+        return 1
+
+    comm = UartComm(AppState(), threading.Event())
+    if not comm._connect():
+        print("Could not open the UART port")
+        return 1
+
+    try:
+        comm._negotiate_baud()
+        return run(comm, args)
+    finally:
+        comm._disconnect()
+
+
+def run(comm: UartComm, args) -> int:
+    if args.command == "list":
+        values = comm.read_params()
+        if values is None:
+            print("ESP32 did not report its parameters")
+            return 1
+        for pid, value in sorted(values.items()):
+            print(f"  {pid:2d} {PARAM_NAMES.get(pid, '?'):22s} {value:g}")
+        return 0
+
+    if args.command == "get":
+        values = comm.read_params()
+        if values is None:
+            print("ESP32 did not report its parameters")
+            return 1
+        print(f"{args.name} = {values[param_id(args.name)]:g}")
+        return 0
+
+    if args.command == "set":
+        pid = param_id(args.name)
+        applied = comm.set_param(pid, args.value)
+        if applied is None:
+            print("No answer from the ESP32")
+            return 1
+        if abs(applied - args.value) >= 0.05:
+            print(f"Refused (out of range), {args.name} is still {applied:g}")
+            return 1
+        print(f"{args.name} = {applied:g}")
+        if args.save:
+            if not comm.save_params():
+                print("Save failed")
+                return 1
+            print("Saved")
+        if comm.esp_param_flags.get(pid, 0) & PARAM_FLAG_REBOOT:
+            print("Takes effect after a reset" + ("" if args.save else " (save it first)"))
+        return 0
+
+    if args.command == "save":
+        ok = comm.save_params()
+        print("Saved" if ok else "Save failed")
+        return 0 if ok else 1
+
+    ok = comm.save_params(save=False)
+    print("Defaults restored" if ok else "Reset failed")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+ESP32 trace tool.
+
+Dumps the ESP32 trace recorder ($TRC) - the last few seconds of received
+packets, status emissions, task overruns and lock timeouts, with
+microsecond timestamps - to a file, prints it, or replays it against the
+host build of the firmware (esp32 env:replay) to reproduce a stutter on a
+desk. Run dump with the main app stopped.
+
+Examples:
+    python tools/esp_trace.py dump -o unit.trc
+    python tools/esp_trace.py dump -o unit.trc --clear     # Start the next trace empty
+    python tools/esp_trace.py show unit.trc
+    python tools/esp_trace.py replay unit.trc --bin ../esp32/.pio/build/replay/program
+"""
+
+import argparse
+import logging
+import os
+import subprocess
+import sys
+import threading
+
+# Add parent directory (rpi/src) to path for imports
+script_dir = os.path.dirname(os.path.abspath(__file__))
+src_dir = os.path.dirname(script_dir)  # rpi/src
+sys.path.insert(0, src_dir)
+
+import config
+from comm.protocol import (
+    PRF_TASK_NAMES, TRACE_EV_FAILSAFE, TRACE_EV_LOCK_TIMEOUT, TRACE_EV_OVERRUN, TRACE_EV_RX,
+    TRACE_EV_STATUS, TRACE_RX_ACCEPTED, decode_trace,
+)
+
+DEFAULT_REPLAY_BIN = os.path.normpath(
+    os.path.join(src_dir, "..", "..", "esp32", ".pio", "build", "replay", "program"))
+
+
+def dump(args) -> int:
+    if config.UART_MOCK_ENABLED:
+        print("UART_MOCK_ENABLED is set - no ESP32 to talk to")
+        return 1
+
+    from comm.uart_comm import UartComm
+    from state import AppState
+
+    comm = UartComm(AppState(), threading.Event())
+    if not comm._connect():
+        print("Could not open the UART port")
+        return 1
+
+    try:
+        comm._negotiate_baud()
+        result = comm.read_trace(clear=args.clear)
+    finally:
+        comm._disconnect()
+
+    if result is None:
+        print("ESP32 did not answer the trace dump")
+        return 1
+
+    data, info = result
+    with open(args.output, "wb") as f:
+        f.write(data)
+    records = decode_trace(data)
+    print(f"{len(records)} records, {len(data)} bytes to {args.output}"
+          + (f" ({info.dropped} older records overwritten)" if info.dropped else ""))
+    return 0
+
+
+def show(args) -> int:
+    with open(args.file, "rb") as f:
+        records = decode_trace(f.read())
+    if not records:
+        print("Empty trace")
+        return 0
+
+    t0 = records[0].t_us
+    counts = {TRACE_EV_RX: 0, TRACE_EV_STATUS: 0, TRACE_EV_OVERRUN: 0, TRACE_EV_LOCK_TIMEOUT: 0,
+              TRACE_EV_FAILSAFE: 0}
+    rejected = 0
+    for record in records:
+        counts[record.type] = counts.get(record.type, 0) + 1
+        if record.type == TRACE_EV_RX and record.payload and not record.payload[0] & TRACE_RX_ACCEPTED:
+            rejected += 1
+        if args.events and record.type in (TRACE_EV_RX, TRACE_EV_STATUS):
+            continue
+        # micros() wraps every ~71 minutes; offsets stay right across one wrap
+        t_ms = ((record.t_us - t0) & 0xFFFFFFFF) / 1000.0
+        print(f"{t_ms:10.3f}  {record.describe()}")
+
+    span_ms = ((records[-1].t_us - t0) & 0xFFFFFFFF) / 1000.0
+    print(f"\n{span_ms:.1f} ms: {counts[TRACE_EV_RX]} packets ({rejected} rejected), "
+          f"{counts[TRACE_EV_STATUS]} status, {counts[TRACE_EV_OVERRUN]} overruns, "
+          f"{counts[TRACE_EV_LOCK_TIMEOUT]} lock timeouts, {counts[TRACE_EV_FAILSAFE]} failsafes")
+    return 0
+
+
+def replay(args) -> int:
+    if not os.path.exists(args.bin):
+        print(f"{args.bin} not found - build it with: cd esp32 && pio run -e replay")
+        return 1
+    cmd = [args.bin, args.file, "--gap-ms", str(args.gap_ms)]
+    if args.unit:
+        cmd += ["--unit", str(args.unit)]
+    if args.verbose:
+        cmd.append("--verbose")
+    return subprocess.call(cmd)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="ESP32 trace tool")
+    sub = parser.add_subparsers(dest="command", required=True)
+    dump_cmd = sub.add_parser("dump", help="Read the trace from the ESP32")
+    dump_cmd.add_argument("-o", "--output", required=True, help="Trace file to write")
+    dump_cmd.add_argument("--clear", action="store_true", help="Empty the ESP32 buffer afterwards")
+    show_cmd = sub.add_parser("show", help="Print a trace file")
+    show_cmd.add_argument("file")
+    show_cmd.add_argument("--events", action="store_true",
+                          help="Only overruns and lock timeouts (" + ", ".join(PRF_TASK_NAMES.values()) + ")")
+    replay_cmd = sub.add_parser("replay", help="Replay a trace file against the host build")
+    replay_cmd.add_argument("file")
+    replay_cmd.add_argument("--bin", default=DEFAULT_REPLAY_BIN, help="esp32 env:replay program")
+    replay_cmd.add_argument("--gap-ms", type=float, default=100.0, help="Report RX gaps longer than this")
+    replay_cmd.add_argument("--unit", type=int, default=0,
+                            help="unit_address of a unit traced on a shared bus")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format="%(levelname)s %(name)s: %(message)s")
+
+    if args.command == "dump":
+        return dump(args)
+    if args.command == "show":
+        return show(args)
+    return replay(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+UART link benchmark.
+
+Opens the ESP32 link like the main app, negotiates the link rate, then
+measures $PNG round trips (latency percentiles) and sustained echoes per
+second with several pings in flight. Run it with the main app stopped.
+
+Examples:
+    python tools/link_benchmark.py                      # UART_LINK_BAUDRATES
+    python tools/link_benchmark.py --baud 460800 --binary
+    python tools/link_benchmark.py --baud 115200        # boot rate only
+"""
+
+import argparse
+import logging
+import os
+import sys
+import threading
+
+# Add parent directory (rpi/src) to path for imports
+script_dir = os.path.dirname(os.path.abspath(__file__))
+src_dir = os.path.dirname(script_dir)  # rpi/src
+sys.path.insert(0, src_dir)
+
+import config
+from comm.uart_comm import UartComm
+from state import AppState
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="ESP32 UART link benchmark")
+    parser.add_argument("--baud", type=int, action="append",
+                        help="Link rate to try (repeatable, in order); default UART_LINK_BAUDRATES")
+    parser.add_argument("--binary", action="store_true", help="Send pings as binary frames")
+    parser.add_argument("--count", type=int, default=500, help="Sequential pings for latency")
+    parser.add_argument("--seconds", type=float, default=5.0, help="Throughput run length")
+    parser.add_argument("--window", type=int, default=8, help="Pings in flight for throughput")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format="%(levelname)s %(name)s: %(message)s")
+
+    if config.UART_MOCK_ENABLED:
+        print("UART_MOCK_ENABLED is set - nothing to measure")
+        return 1
+
+    comm = UartComm(AppState(), threading.Event())
+    if not comm._connect():
+        print("Could not open the UART port")
+        return 1
+
+    try:
+        rates = tuple(args.baud) if args.baud else None
+        comm._negotiate_baud(rates)
+        if args.baud and comm.link_baud not in args.baud:
+            print(f"Link rate not confirmed, measuring at {comm.link_baud} baud")
+        comm.protocol.binary_tx = args.binary
+
+        r = comm.run_link_benchmark(count=args.count, seconds=args.seconds, window=args.window)
+    finally:
+        comm._disconnect()
+
+    framing = "binary" if r["binary"] else "ASCII"
+    print(f"Link: {r['baud']} baud, {framing} pings")
+    print(f"  round trip  n={r['pings']} lost={r['lost']}  "
+          f"p50={r['rtt_p50_ms']:.2f}ms p90={r['rtt_p90_ms']:.2f}ms "
+          f"p99={r['rtt_p99_ms']:.2f}ms max={r['rtt_max_ms']:.2f}ms")
+    print(f"  sustained   window={r['window']}  {r['echoes_per_s']:.0f} echoes/s  "
+          f"{r['tx_bytes_per_s'] / 1000.0:.1f} kB/s out")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
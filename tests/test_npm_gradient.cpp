@@ -32,7 +32,7 @@ uint16_t gradient_position = 0;
 
 // Linear interpolation
 uint8_t lerp8(uint8_t a, uint8_t b, uint8_t t) {
-    return a + (((int16_t)b - a) * t) >> 8;
+    return (uint8_t)(a + ((((int16_t)b - a) * (t + (t >> 7))) >> 8));
 }
 
 // Get interpolation factor from position (0-510 -> 0-255-0)